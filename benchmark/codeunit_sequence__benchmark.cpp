@@ -7,6 +7,7 @@ void std_string_construct(benchmark::State& state)
 	for (auto _ : state)
 	{
 		std::string empty_string;
+		benchmark::DoNotOptimize(empty_string);
 	}
 }
 
@@ -14,9 +15,175 @@ void codeunit_sequence_construct(benchmark::State& state)
 {
 	for (auto _ : state)
 	{
-		easy::codeunit_sequence empty_sequence;
+		ostr::codeunit_sequence empty_sequence;
+		benchmark::DoNotOptimize(empty_sequence);
 	}
 }
 
 BENCHMARK(std_string_construct);
-BENCHMARK(codeunit_sequence_construct);
\ No newline at end of file
+BENCHMARK(codeunit_sequence_construct);
+
+// code-region-start: large buffers
+
+static constexpr char LOG_LINE[] = "[2023-01-01 00:00:00][info] player 1762757171 logged in.\n";
+
+void std_string_append_large(benchmark::State& state)
+{
+	const auto size = static_cast<ostr::u64>(state.range(0));
+	for (auto _ : state)
+	{
+		std::string buffer;
+		while(buffer.size() < size)
+			buffer.append(LOG_LINE, sizeof(LOG_LINE) - 1);
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void codeunit_sequence_append_large(benchmark::State& state)
+{
+	const auto size = static_cast<ostr::u64>(state.range(0));
+	for (auto _ : state)
+	{
+		ostr::codeunit_sequence buffer;
+		while(buffer.size() < size)
+			buffer.append(ostr::codeunit_sequence_view{ LOG_LINE, sizeof(LOG_LINE) - 1 });
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void codeunit_sequence_replace_large_same_size(benchmark::State& state)
+{
+	const auto size = static_cast<ostr::u64>(state.range(0));
+	ostr::codeunit_sequence buffer;
+	while(buffer.size() < size)
+		buffer.append(ostr::codeunit_sequence_view{ LOG_LINE, sizeof(LOG_LINE) - 1 });
+	bool flip = false;
+	for (auto _ : state)
+	{
+		if(flip)
+			buffer.replace("info"_cuqv, "warn"_cuqv);
+		else
+			buffer.replace("warn"_cuqv, "info"_cuqv);
+		flip = !flip;
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void codeunit_sequence_replace_large_growing(benchmark::State& state)
+{
+	const auto size = static_cast<ostr::u64>(state.range(0));
+	ostr::codeunit_sequence origin;
+	while(origin.size() < size)
+		origin.append(ostr::codeunit_sequence_view{ LOG_LINE, sizeof(LOG_LINE) - 1 });
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		ostr::codeunit_sequence buffer = origin;
+		state.ResumeTiming();
+		buffer.replace("information"_cuqv, "info"_cuqv);
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(std_string_append_large)->RangeMultiplier(32)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMillisecond);
+BENCHMARK(codeunit_sequence_append_large)->RangeMultiplier(32)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMillisecond);
+BENCHMARK(codeunit_sequence_replace_large_same_size)->RangeMultiplier(32)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMillisecond);
+BENCHMARK(codeunit_sequence_replace_large_growing)->RangeMultiplier(32)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMillisecond);
+
+// code-region-end: large buffers
+
+// code-region-start: comparison
+
+namespace
+{
+	// Two keys which differ only in the last codeunit, so the whole keys are compared.
+	std::pair<std::string, std::string> make_keys(const ostr::u64 size)
+	{
+		std::string lhs(size, 'k');
+		std::string rhs = lhs;
+		rhs.back() = 'm';
+		return { lhs, rhs };
+	}
+}
+
+void std_string_equal(benchmark::State& state)
+{
+	const auto [lhs, rhs] = make_keys(state.range(0));
+	const std::string lhs_copy = lhs;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(lhs == rhs);
+		benchmark::DoNotOptimize(lhs == lhs_copy);
+	}
+}
+
+void bytewise_equal(benchmark::State& state)
+{
+	const auto [lhs, rhs] = make_keys(state.range(0));
+	const std::string lhs_copy = lhs;
+	const auto equal = [](const std::string& a, const std::string& b)
+	{
+		if(a.size() != b.size())
+			return false;
+		for(ostr::u64 i = 0; i < a.size(); ++i)
+		{
+			benchmark::DoNotOptimize(i);
+			if(a[i] != b[i])
+				return false;
+		}
+		return true;
+	};
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(equal(lhs, rhs));
+		benchmark::DoNotOptimize(equal(lhs, lhs_copy));
+	}
+}
+
+void codeunit_sequence_equal(benchmark::State& state)
+{
+	const auto [lhs_string, rhs_string] = make_keys(state.range(0));
+	const ostr::codeunit_sequence lhs{ ostr::codeunit_sequence_view{ lhs_string.data(), lhs_string.size() } };
+	const ostr::codeunit_sequence rhs{ ostr::codeunit_sequence_view{ rhs_string.data(), rhs_string.size() } };
+	const ostr::codeunit_sequence lhs_copy = lhs;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(lhs == rhs);
+		benchmark::DoNotOptimize(lhs == lhs_copy);
+	}
+}
+
+void std_string_less(benchmark::State& state)
+{
+	const auto [lhs, rhs] = make_keys(state.range(0));
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(lhs < rhs);
+		benchmark::DoNotOptimize(rhs < lhs);
+	}
+}
+
+void codeunit_sequence_less(benchmark::State& state)
+{
+	const auto [lhs_string, rhs_string] = make_keys(state.range(0));
+	const ostr::codeunit_sequence lhs{ ostr::codeunit_sequence_view{ lhs_string.data(), lhs_string.size() } };
+	const ostr::codeunit_sequence rhs{ ostr::codeunit_sequence_view{ rhs_string.data(), rhs_string.size() } };
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(lhs < rhs);
+		benchmark::DoNotOptimize(rhs < lhs);
+	}
+}
+
+// Keys up to 14 codeunits are stored inline (sso), longer ones are on heap.
+BENCHMARK(std_string_equal)->Arg(8)->Arg(14)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(bytewise_equal)->Arg(8)->Arg(14)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(codeunit_sequence_equal)->Arg(8)->Arg(14)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(std_string_less)->Arg(8)->Arg(14)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(codeunit_sequence_less)->Arg(8)->Arg(14)->Arg(64)->Arg(512)->Arg(4096);
+
+// code-region-end: comparison
@@ -0,0 +1,327 @@
+#include "pch.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "codeunit_sequence_view.h"
+
+// code-region-start: byte search
+
+namespace
+{
+	// A haystack with the only needle at the end, which is the worst case of searching.
+	std::vector<char> make_haystack(const ostr::u64 size, const bool needle_at_front)
+	{
+		std::vector<char> haystack(size, 'a');
+		haystack[needle_at_front ? 0 : size - 1] = '}';
+		return haystack;
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void simd_index_of(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::vector<char> haystack = make_haystack(state.range(0), false);
+		const ostr::codeunit_sequence_view view{ haystack.data(), haystack.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.index_of('}'));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void simd_last_index_of(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::vector<char> haystack = make_haystack(state.range(0), true);
+		const ostr::codeunit_sequence_view view{ haystack.data(), haystack.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.last_index_of('}'));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+void memchr_index_of(benchmark::State& state)
+{
+	const std::vector<char> haystack = make_haystack(state.range(0), false);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(std::memchr(haystack.data(), '}', haystack.size()));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void scalar_index_of(benchmark::State& state)
+{
+	const std::vector<char> haystack = make_haystack(state.range(0), false);
+	for (auto _ : state)
+	{
+		ostr::u64 found = ostr::global_constant::INDEX_INVALID;
+		for(ostr::u64 i = 0; i < haystack.size(); ++i)
+		{
+			benchmark::DoNotOptimize(i);
+			if(haystack[i] == '}')
+			{
+				found = i;
+				break;
+			}
+		}
+		benchmark::DoNotOptimize(found);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(memchr_index_of)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK(scalar_index_of)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_last_index_of, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_last_index_of, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_last_index_of, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_last_index_of, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(16, 1 << 16);
+
+// code-region-end: byte search
+
+// code-region-start: substring search
+
+namespace
+{
+	// Log-like lines sharing long prefixes, the needle is at the end only.
+	std::string make_log(const ostr::u64 size)
+	{
+		std::string log;
+		while(log.size() < size)
+			log += "2022-01-01 12:00:00 [info] request served in 12ms\n";
+		log.resize(size);
+		log += "2022-01-01 12:00:00 [error] request failed\n";
+		return log;
+	}
+
+	constexpr std::string_view log_needle = "[error] request";
+
+	// Highly repetitive data which defeats candidate filter, the needle is absent.
+	constexpr std::string_view repetitive_needle = "aaaaaaaaaaaaaaaaaaaabaaaaaaaaaaaaaaaaaaaa";
+
+	template<ostr::simd::instruction_set Set>
+	void simd_index_of_pattern(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::string log = make_log(state.range(0));
+		const ostr::codeunit_sequence_view view{ log.data(), log.size() };
+		const ostr::codeunit_sequence_view pattern{ log_needle.data(), log_needle.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.index_of(pattern));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void simd_index_of_repetitive(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::vector<char> haystack(state.range(0), 'a');
+		const ostr::codeunit_sequence_view view{ haystack.data(), haystack.size() };
+		const ostr::codeunit_sequence_view pattern{ repetitive_needle.data(), repetitive_needle.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.index_of(pattern));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+void string_view_find(benchmark::State& state)
+{
+	const std::string log = make_log(state.range(0));
+	const std::string_view view = log;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(view.find(log_needle));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void string_view_find_repetitive(benchmark::State& state)
+{
+	const std::string haystack(state.range(0), 'a');
+	const std::string_view view = haystack;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(view.find(repetitive_needle));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+// The constant evaluated path, which is what index_of used to run.
+void horspool_index_of(benchmark::State& state)
+{
+	const std::string log = make_log(state.range(0));
+	const ostr::codeunit_sequence_view pattern{ log_needle.data(), log_needle.size() };
+	for (auto _ : state)
+	{
+		const std::string_view view = log;
+		ostr::u64 found = ostr::global_constant::INDEX_INVALID;
+		const char pattern_last = pattern.read_from_last(0);
+		for(ostr::u64 i = pattern.size() - 1; i < view.size(); ++i)
+		{
+			if(view[i] != pattern_last)
+				continue;
+			if(view.compare(i + 1 - pattern.size(), pattern.size(), log_needle) == 0)
+			{
+				found = i + 1 - pattern.size();
+				break;
+			}
+		}
+		benchmark::DoNotOptimize(found);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(string_view_find)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(horspool_index_of)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_pattern, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_pattern, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_pattern, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_pattern, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(string_view_find_repetitive)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_repetitive, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_repetitive, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_repetitive, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(simd_index_of_repetitive, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+// code-region-end: substring search
+
+// code-region-start: codeunit set search
+
+namespace
+{
+	// Plain text of a format mold with the only brace at the end.
+	std::vector<char> make_format_mold(const ostr::u64 size)
+	{
+		std::vector<char> mold;
+		const std::string_view words = "The quick brown fox jumps over the lazy dog. ";
+		while(mold.size() < size)
+			mold.push_back(words[mold.size() % words.size()]);
+		mold.back() = '{';
+		return mold;
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void simd_index_of_any(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		constexpr ostr::codeunit_set braces{ "{}" };
+		const std::vector<char> mold = make_format_mold(state.range(0));
+		const ostr::codeunit_sequence_view view{ mold.data(), mold.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.index_of_any(braces));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	// Sets with more than a few members go through nibble table lookup.
+	template<ostr::simd::instruction_set Set>
+	void simd_index_of_any_large_set(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		constexpr ostr::codeunit_set separators{ "{}[]()<>;|" };
+		const std::vector<char> mold = make_format_mold(state.range(0));
+		const ostr::codeunit_sequence_view view{ mold.data(), mold.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.index_of_any(separators));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void simd_trim(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		constexpr ostr::codeunit_set blanks{ " \t\r\n" };
+		std::vector<char> padded(state.range(0), ' ');
+		padded[padded.size() / 2] = 'x';
+		const ostr::codeunit_sequence_view view{ padded.data(), padded.size() };
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.trim(blanks));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+void scalar_index_of_any(benchmark::State& state)
+{
+	const std::vector<char> mold = make_format_mold(state.range(0));
+	const ostr::codeunit_sequence_view units{ "{}" };
+	for (auto _ : state)
+	{
+		ostr::u64 found = ostr::global_constant::INDEX_INVALID;
+		for(ostr::u64 i = 0; i < mold.size(); ++i)
+		{
+			benchmark::DoNotOptimize(i);
+			if(units.contains(mold[i]))
+			{
+				found = i;
+				break;
+			}
+		}
+		benchmark::DoNotOptimize(found);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void string_view_find_first_of(benchmark::State& state)
+{
+	const std::vector<char> mold = make_format_mold(state.range(0));
+	const std::string_view view{ mold.data(), mold.size() };
+	for (auto _ : state)
+		benchmark::DoNotOptimize(view.find_first_of("{}"));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(scalar_index_of_any)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK(string_view_find_first_of)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any_large_set, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any_large_set, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any_large_set, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_index_of_any_large_set, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_trim, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_trim, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_trim, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(simd_trim, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(16, 1 << 16);
+
+// code-region-end: codeunit set search
@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "deferred_logger.h"
+
+#include <memory>
+
+namespace
+{
+	// Created by the first thread, shared by all threads of a run.
+	std::unique_ptr<ostr::deferred_logger> shared_logger;
+
+	void deferred_log(benchmark::State& state, const ostr::log_overflow_policy policy)
+	{
+		if(state.thread_index() == 0)
+		{
+			ostr::deferred_logger_settings settings;
+			settings.overflow_policy = policy;
+			shared_logger = std::make_unique<ostr::deferred_logger>([](const ostr::codeunit_sequence_view& lines)
+			{
+				benchmark::DoNotOptimize(lines.data());
+			}, settings);
+		}
+		for(auto _ : state)
+		{
+			const bool logged = shared_logger->log("Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+			benchmark::DoNotOptimize(logged);
+		}
+		if(state.thread_index() == 0)
+		{
+			state.counters["dropped"] = static_cast<double>(shared_logger->get_dropped_count());
+			shared_logger.reset();
+		}
+	}
+
+	void deferred_log_block(benchmark::State& state)
+	{
+		deferred_log(state, ostr::log_overflow_policy::block);
+	}
+	BENCHMARK(deferred_log_block)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+	void deferred_log_drop(benchmark::State& state)
+	{
+		deferred_log(state, ostr::log_overflow_policy::drop);
+	}
+	BENCHMARK(deferred_log_drop)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+	// What producers pay when they format by themselves.
+	void synchronous_format(benchmark::State& state)
+	{
+		ostr::codeunit_sequence lines;
+		for(auto _ : state)
+		{
+			ostr::format_to(lines, "Player {} joined at {}:{}, health {:.1f}, flags {:x}.\n"_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+			if(lines.size() >= 64 * 1024)
+				lines.empty();
+		}
+	}
+	BENCHMARK(synchronous_format)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+}
@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "encoding.h"
+#include "format.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+	std::string make_random_bytes(const ostr::u64 size)
+	{
+		std::mt19937 random{ 42 };
+		std::string bytes(size, '\0');
+		for(char& b : bytes)
+			b = static_cast<char>(random());
+		return bytes;
+	}
+
+	// Kernels of Set are measured with bytes of size state.range(0), and the instruction set is restored after.
+	template<ostr::simd::instruction_set Set, class F>
+	void run_with_instruction_set(benchmark::State& state, F&& function)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::string bytes = make_random_bytes(state.range(0));
+		function(ostr::codeunit_sequence_view{ bytes.data(), bytes.size() });
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void encode_hex(benchmark::State& state)
+	{
+		run_with_instruction_set<Set>(state, [&state](const ostr::codeunit_sequence_view& bytes)
+		{
+			std::string hex(ostr::get_hex_encoded_size(bytes.size()), '\0');
+			for(auto _ : state)
+				benchmark::DoNotOptimize(ostr::encode_hex(bytes, hex.data()));
+		});
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void encode_hex_separated(benchmark::State& state)
+	{
+		run_with_instruction_set<Set>(state, [&state](const ostr::codeunit_sequence_view& bytes)
+		{
+			std::string hex(ostr::get_hex_encoded_size(bytes.size(), { ' ' }), '\0');
+			for(auto _ : state)
+				benchmark::DoNotOptimize(ostr::encode_hex(bytes, hex.data(), { ' ' }));
+		});
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void decode_hex(benchmark::State& state)
+	{
+		run_with_instruction_set<Set>(state, [&state](const ostr::codeunit_sequence_view& bytes)
+		{
+			const ostr::codeunit_sequence hex = ostr::to_hex(bytes);
+			std::string decoded(bytes.size(), '\0');
+			for(auto _ : state)
+				benchmark::DoNotOptimize(ostr::decode_hex(hex.view(), reinterpret_cast<ostr::byte*>(decoded.data())));
+		});
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void decode_hex_separated(benchmark::State& state)
+	{
+		run_with_instruction_set<Set>(state, [&state](const ostr::codeunit_sequence_view& bytes)
+		{
+			const ostr::codeunit_sequence hex = ostr::to_hex(bytes, { ' ' });
+			std::string decoded(bytes.size(), '\0');
+			for(auto _ : state)
+				benchmark::DoNotOptimize(ostr::decode_hex(hex.view(), reinterpret_cast<ostr::byte*>(decoded.data()), ' '));
+		});
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void encode_base64(benchmark::State& state)
+	{
+		run_with_instruction_set<Set>(state, [&state](const ostr::codeunit_sequence_view& bytes)
+		{
+			std::string base64(ostr::get_base64_encoded_size(bytes.size()), '\0');
+			for(auto _ : state)
+				benchmark::DoNotOptimize(ostr::encode_base64(bytes, base64.data()));
+		});
+	}
+
+	template<ostr::simd::instruction_set Set>
+	void decode_base64(benchmark::State& state)
+	{
+		run_with_instruction_set<Set>(state, [&state](const ostr::codeunit_sequence_view& bytes)
+		{
+			const ostr::codeunit_sequence base64 = ostr::to_base64(bytes);
+			std::string decoded(bytes.size() + 2, '\0');
+			for(auto _ : state)
+				benchmark::DoNotOptimize(ostr::decode_base64(base64.view(), reinterpret_cast<ostr::byte*>(decoded.data())));
+		});
+	}
+
+	struct raw_packet
+	{
+		ostr::byte payload[1024];
+	};
+
+	void format_raw_bytes(benchmark::State& state)
+	{
+		raw_packet packet;
+		const std::string bytes = make_random_bytes(sizeof(packet.payload));
+		std::memcpy(packet.payload, bytes.data(), bytes.size());
+		ostr::codeunit_sequence dump;
+		for(auto _ : state)
+		{
+			dump.empty();
+			ostr::format_to(dump, "{:r}"_cuqv, packet);
+			benchmark::DoNotOptimize(dump.data());
+		}
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * sizeof(packet.payload));
+	}
+}
+
+#define OPEN_STRING_ENCODING_BENCHMARK(function)	\
+	BENCHMARK_TEMPLATE(function, ostr::simd::instruction_set::portable)->Arg(64)->Arg(1 << 16);	\
+	BENCHMARK_TEMPLATE(function, ostr::simd::instruction_set::sse2)->Arg(64)->Arg(1 << 16);	\
+	BENCHMARK_TEMPLATE(function, ostr::simd::instruction_set::avx2)->Arg(64)->Arg(1 << 16);	\
+	BENCHMARK_TEMPLATE(function, ostr::simd::instruction_set::neon)->Arg(64)->Arg(1 << 16)
+
+OPEN_STRING_ENCODING_BENCHMARK(encode_hex);
+OPEN_STRING_ENCODING_BENCHMARK(encode_hex_separated);
+OPEN_STRING_ENCODING_BENCHMARK(decode_hex);
+OPEN_STRING_ENCODING_BENCHMARK(decode_hex_separated);
+OPEN_STRING_ENCODING_BENCHMARK(encode_base64);
+OPEN_STRING_ENCODING_BENCHMARK(decode_base64);
+BENCHMARK(format_raw_bytes);
@@ -1,5 +1,105 @@
 #include "pch.h"
 #include "format.h"
 
+#include <cstdio>
 
+namespace
+{
+    void format_runtime(benchmark::State& state)
+    {
+        for(auto _ : state)
+        {
+            auto result = ostr::format("Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    BENCHMARK(format_runtime);
 
+    void format_compiled(benchmark::State& state)
+    {
+        for(auto _ : state)
+        {
+            auto result = ostr::format(OPEN_STRING_COMPILED_FORMAT("Player {} joined at {}:{}, health {:.1f}, flags {:x}."), "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    BENCHMARK(format_compiled);
+
+    void format_prepared(benchmark::State& state)
+    {
+        const ostr::prepared_format prepared{ "Player {player} joined at {hour}:{minute}, health {health:.1f}, flags {flags:x}."_cuqv,
+            { "player"_cuqv, "hour"_cuqv, "minute"_cuqv, "health"_cuqv, "flags"_cuqv } };
+        for(auto _ : state)
+        {
+            auto result = ostr::format(prepared, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    BENCHMARK(format_prepared);
+
+    void format_to_sequence(benchmark::State& state)
+    {
+        ostr::codeunit_sequence result;
+        for(auto _ : state)
+        {
+            result.empty();
+            ostr::format_to(result, "Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    BENCHMARK(format_to_sequence);
+
+    void format_to_buffer(benchmark::State& state)
+    {
+        char buffer[256];
+        for(auto _ : state)
+        {
+            auto result = ostr::format_to(buffer, sizeof(buffer), "Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+    BENCHMARK(format_to_buffer);
+
+    void format_integers(benchmark::State& state)
+    {
+        char buffer[256];
+        ostr::u64 value = 0x9E3779B97F4A7C15ull;
+        for(auto _ : state)
+        {
+            value = value * 6364136223846793005ull + 1442695040888963407ull;
+            auto result = ostr::format_to(buffer, sizeof(buffer), "{} {} {:x} {:o} {:b} {}"_cuqv, value, static_cast<ostr::i64>(value), value, value, value >> 32, value >> 48);
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+    BENCHMARK(format_integers);
+
+    void format_floats(benchmark::State& state)
+    {
+        char buffer[256];
+        ostr::f64 value = 1.0;
+        for(auto _ : state)
+        {
+            value = value * 1.0000001 + 0.37;
+            auto result = ostr::format_to(buffer, sizeof(buffer), "{} {} {:.3f} {:e}"_cuqv, value, static_cast<ostr::f32>(value), value, value);
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+    BENCHMARK(format_floats);
+
+    void format_floats_snprintf(benchmark::State& state)
+    {
+        char buffer[256];
+        ostr::f64 value = 1.0;
+        for(auto _ : state)
+        {
+            value = value * 1.0000001 + 0.37;
+            auto result = std::snprintf(buffer, sizeof(buffer), "%.17g %.9g %.3f %e", value, static_cast<ostr::f32>(value), value, value);
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+    BENCHMARK(format_floats_snprintf);
+}
@@ -0,0 +1,60 @@
+#include "pch.h"
+#include <string>
+#include <vector>
+#include "multi_searcher.h"
+
+namespace
+{
+	// Pseudo words made of lowercase letters, like a list of banned words.
+	std::vector<std::string> make_words(const ostr::u64 count)
+	{
+		std::vector<std::string> words;
+		ostr::u32 seed = 17;
+		for(ostr::u64 i = 0; i < count; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			std::string word;
+			for(ostr::u64 j = 0; j < 5 + (seed >> 28) % 6; ++j)
+			{
+				seed = seed * 1103515245 + 12345;
+				word.push_back(static_cast<char>('a' + (seed >> 16) % 26));
+			}
+			words.push_back(std::move(word));
+		}
+		return words;
+	}
+
+	constexpr ostr::codeunit_sequence_view message{ "player 1762757171 says: meet me at the north gate after the raid, then we trade the loot and head to the dungeon." };
+}
+
+void index_of_each_word(benchmark::State& state)
+{
+	const std::vector<std::string> words = make_words(state.range(0));
+	for (auto _ : state)
+	{
+		ostr::u64 found = 0;
+		for(const std::string& word : words)
+			found += message.count({ word.data(), word.size() });
+		benchmark::DoNotOptimize(found);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * message.size());
+}
+
+void multi_searcher_find_all(benchmark::State& state)
+{
+	const std::vector<std::string> words = make_words(state.range(0));
+	std::vector<ostr::codeunit_sequence_view> patterns;
+	for(const std::string& word : words)
+		patterns.emplace_back(word.data(), word.size());
+	const ostr::multi_searcher searcher{ patterns };
+	std::vector<ostr::multi_searcher::match> matches;
+	for (auto _ : state)
+	{
+		matches.clear();
+		benchmark::DoNotOptimize(searcher.find_all(message, matches));
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * message.size());
+}
+
+BENCHMARK(index_of_each_word)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(multi_searcher_find_all)->RangeMultiplier(8)->Range(8, 4096);
@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "parse.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace
+{
+	constexpr ostr::u64 COLUMN_SIZE = 1024;
+
+	// A column of comma separated numbers, as read from a csv file.
+	template<class F>
+	std::string make_column(F&& make_number)
+	{
+		std::mt19937_64 random{ 42 };
+		std::string result;
+		for(ostr::u64 i = 0; i < COLUMN_SIZE; ++i)
+		{
+			result += make_number(random);
+			result += ',';
+		}
+		return result;
+	}
+
+	std::string make_integer_column()
+	{
+		return make_column([](std::mt19937_64& random)
+		{
+			return std::to_string(random() >> (34 + random() % 30));
+		});
+	}
+
+	std::string make_floating_point_column()
+	{
+		return make_column([](std::mt19937_64& random)
+		{
+			const double value = std::uniform_real_distribution<double>{ -1e6, 1e6 }(random);
+			char buffer[32];
+			const auto [ last, error ] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			return std::string{ buffer, last };
+		});
+	}
+}
+
+void parse_integers(benchmark::State& state)
+{
+	const std::string column = make_integer_column();
+	for(auto _ : state)
+	{
+		ostr::u64 sum = 0;
+		for(ostr::u64 i = 0; i < column.size(); )
+		{
+			const ostr::parse_result<ostr::u64> result = ostr::parse<ostr::u64>(ostr::codeunit_sequence_view{ column.data() + i, column.size() - i });
+			sum += result.value;
+			i += result.size + 1;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * COLUMN_SIZE);
+}
+
+void parse_integers_from_chars(benchmark::State& state)
+{
+	const std::string column = make_integer_column();
+	for(auto _ : state)
+	{
+		ostr::u64 sum = 0;
+		for(const char* first = column.data(), *last = column.data() + column.size(); first < last; )
+		{
+			ostr::u64 value = 0;
+			first = std::from_chars(first, last, value).ptr + 1;
+			sum += value;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * COLUMN_SIZE);
+}
+
+void parse_integers_strtoull(benchmark::State& state)
+{
+	const std::string column = make_integer_column();
+	for(auto _ : state)
+	{
+		ostr::u64 sum = 0;
+		for(const char* first = column.data(), *last = column.data() + column.size(); first < last; )
+		{
+			char* end = nullptr;
+			sum += std::strtoull(first, &end, 10);
+			first = end + 1;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * COLUMN_SIZE);
+}
+
+void parse_floating_points(benchmark::State& state)
+{
+	const std::string column = make_floating_point_column();
+	for(auto _ : state)
+	{
+		double sum = 0;
+		for(ostr::u64 i = 0; i < column.size(); )
+		{
+			const ostr::parse_result<double> result = ostr::parse<double>(ostr::codeunit_sequence_view{ column.data() + i, column.size() - i });
+			sum += result.value;
+			i += result.size + 1;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * COLUMN_SIZE);
+}
+
+void parse_floating_points_from_chars(benchmark::State& state)
+{
+	const std::string column = make_floating_point_column();
+	for(auto _ : state)
+	{
+		double sum = 0;
+		for(const char* first = column.data(), *last = column.data() + column.size(); first < last; )
+		{
+			double value = 0;
+			first = std::from_chars(first, last, value).ptr + 1;
+			sum += value;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * COLUMN_SIZE);
+}
+
+void parse_floating_points_strtod(benchmark::State& state)
+{
+	const std::string column = make_floating_point_column();
+	for(auto _ : state)
+	{
+		double sum = 0;
+		for(const char* first = column.data(), *last = column.data() + column.size(); first < last; )
+		{
+			char* end = nullptr;
+			sum += std::strtod(first, &end);
+			first = end + 1;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * COLUMN_SIZE);
+}
+
+BENCHMARK(parse_integers);
+BENCHMARK(parse_integers_from_chars);
+BENCHMARK(parse_integers_strtoull);
+BENCHMARK(parse_floating_points);
+BENCHMARK(parse_floating_points_from_chars);
+BENCHMARK(parse_floating_points_strtod);
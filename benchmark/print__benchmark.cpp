@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "print.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Lines are written to /dev/null, so only formatting, buffering and calls into the system are measured.
+namespace
+{
+	void print_file_descriptor(benchmark::State& state)
+	{
+		const int file_descriptor = open("/dev/null", O_WRONLY);
+		for(auto _ : state)
+		{
+			const bool written = ostr::println(file_descriptor, "Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+			benchmark::DoNotOptimize(written);
+		}
+		close(file_descriptor);
+	}
+	BENCHMARK(print_file_descriptor);
+
+	void print_buffered_writer(benchmark::State& state)
+	{
+		const int file_descriptor = open("/dev/null", O_WRONLY);
+		{
+			ostr::buffered_writer writer{ file_descriptor };
+			for(auto _ : state)
+				ostr::println(writer, "Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+		}
+		close(file_descriptor);
+	}
+	BENCHMARK(print_buffered_writer);
+
+	void print_file(benchmark::State& state)
+	{
+		std::FILE* file = std::fopen("/dev/null", "w");
+		for(auto _ : state)
+		{
+			const bool written = ostr::println(file, "Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+			benchmark::DoNotOptimize(written);
+		}
+		std::fclose(file);
+	}
+	BENCHMARK(print_file);
+
+	void print_fprintf(benchmark::State& state)
+	{
+		std::FILE* file = std::fopen("/dev/null", "w");
+		for(auto _ : state)
+		{
+			const int written = std::fprintf(file, "Player %s joined at %d:%d, health %.1f, flags %x.\n", "繁星明", 12, 34, 98.5, 0xBEEF);
+			benchmark::DoNotOptimize(written);
+		}
+		std::fclose(file);
+	}
+	BENCHMARK(print_fprintf);
+
+	// What it takes without print, a sequence is allocated for each line.
+	void print_format_fwrite(benchmark::State& state)
+	{
+		std::FILE* file = std::fopen("/dev/null", "w");
+		for(auto _ : state)
+		{
+			const ostr::codeunit_sequence line = ostr::format("Player {} joined at {}:{}, health {:.1f}, flags {:x}.\n"_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+			const size_t written = std::fwrite(line.c_str(), 1, line.size(), file);
+			benchmark::DoNotOptimize(written);
+		}
+		std::fclose(file);
+	}
+	BENCHMARK(print_format_fwrite);
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+#include <string>
+#include <vector>
+#include "searcher.h"
+
+namespace
+{
+	// Chat messages where one of every 64 has the term.
+	// First and last codeunits of the term are common in messages, which the prepared rare codeunits filter avoids.
+	std::vector<std::string> make_messages(const ostr::u64 count)
+	{
+		std::vector<std::string> messages;
+		messages.reserve(count);
+		for(ostr::u64 i = 0; i < count; ++i)
+		{
+			std::string message = "player " + std::to_string(i * 2654435761u) + " says: ";
+			for(ostr::u64 j = 0; j < 4; ++j)
+				message += "meet me at the north gate after the raid, then we trade the loot and head to the dungeon. ";
+			if(i % 64 == 0)
+				message += "then we trade the gold";
+			messages.push_back(std::move(message));
+		}
+		return messages;
+	}
+
+	constexpr ostr::codeunit_sequence_view term{ "then we trade the gold" };
+}
+
+void view_count_messages(benchmark::State& state)
+{
+	const std::vector<std::string> messages = make_messages(state.range(0));
+	for (auto _ : state)
+	{
+		ostr::u64 count = 0;
+		for(const std::string& message : messages)
+			count += ostr::codeunit_sequence_view{ message.data(), message.size() }.count(term);
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void searcher_count_messages(benchmark::State& state)
+{
+	const std::vector<std::string> messages = make_messages(state.range(0));
+	const ostr::searcher term_searcher{ term };
+	for (auto _ : state)
+	{
+		ostr::u64 count = 0;
+		for(const std::string& message : messages)
+			count += term_searcher.count({ message.data(), message.size() });
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void sequence_replace_messages(benchmark::State& state)
+{
+	const std::vector<std::string> messages = make_messages(state.range(0));
+	for (auto _ : state)
+	{
+		for(const std::string& message : messages)
+		{
+			ostr::codeunit_sequence sequence{ message.data(), message.size() };
+			sequence.replace("****"_cuqv, term);
+			benchmark::DoNotOptimize(sequence);
+		}
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void searcher_replace_messages(benchmark::State& state)
+{
+	const std::vector<std::string> messages = make_messages(state.range(0));
+	const ostr::searcher term_searcher{ term };
+	for (auto _ : state)
+	{
+		for(const std::string& message : messages)
+		{
+			ostr::codeunit_sequence sequence{ message.data(), message.size() };
+			term_searcher.replace(sequence, "****"_cuqv);
+			benchmark::DoNotOptimize(sequence);
+		}
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(view_count_messages)->Arg(1 << 12);
+BENCHMARK(searcher_count_messages)->Arg(1 << 12);
+BENCHMARK(sequence_replace_messages)->Arg(1 << 12);
+BENCHMARK(searcher_replace_messages)->Arg(1 << 12);
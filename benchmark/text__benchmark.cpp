@@ -0,0 +1,418 @@
+#include "pch.h"
+#include "text.h"
+#include "utf8_decoder.h"
+
+// code-region-start: random access
+
+namespace
+{
+	ostr::text make_mixed_text(const ostr::u64 codepoint_count)
+	{
+		ostr::text result;
+		while(result.raw().size() < codepoint_count * 2)
+			result.append("abc你好😀"_txtv);
+		result.subtext(0, codepoint_count);
+		return result;
+	}
+}
+
+void text_view_read_at_each(benchmark::State& state)
+{
+	const ostr::text content = make_mixed_text(state.range(0));
+	const ostr::text_view view = content.view();
+	const ostr::u64 size = view.size();
+	for (auto _ : state)
+		for(ostr::u64 i = 0; i < size; i += 7)
+			benchmark::DoNotOptimize(view.read_at(i));
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size / 7));
+}
+
+void text_read_at_each(benchmark::State& state)
+{
+	const ostr::text content = make_mixed_text(state.range(0));
+	const ostr::u64 size = content.size();
+	for (auto _ : state)
+		for(ostr::u64 i = 0; i < size; i += 7)
+			benchmark::DoNotOptimize(content.read_at(i));
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size / 7));
+}
+
+void text_get_utf16_index_each(benchmark::State& state)
+{
+	const ostr::text content = make_mixed_text(state.range(0));
+	const ostr::u64 size = content.size();
+	for (auto _ : state)
+		for(ostr::u64 i = 0; i < size; i += 7)
+			benchmark::DoNotOptimize(content.get_utf16_index(i));
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size / 7));
+}
+
+BENCHMARK(text_view_read_at_each)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK(text_read_at_each)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK(text_get_utf16_index_each)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+// code-region-end: random access
+
+// code-region-start: codepoint counting
+
+namespace
+{
+	template<ostr::simd::instruction_set Set>
+	void text_view_size(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const ostr::text content = make_mixed_text(state.range(0));
+		const ostr::text_view view = content.view();
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.size());
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(view.raw().size()));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+// The loop text_view::size used to run, decoding each lead codeunit.
+void walking_size(benchmark::State& state)
+{
+	const ostr::text content = make_mixed_text(state.range(0));
+	const ostr::codeunit_sequence_view raw = content.view().raw();
+	for (auto _ : state)
+	{
+		ostr::u64 index = 0;
+		for(ostr::u64 offset = 0; offset < raw.size(); ++index)
+		{
+			const ostr::u8 sequence_length = ostr::unicode::parse_utf8_length(raw.read_at(offset));
+			offset += sequence_length == 0 ? 1 : sequence_length;
+		}
+		benchmark::DoNotOptimize(index);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(raw.size()));
+}
+
+BENCHMARK(walking_size)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_size, ostr::simd::instruction_set::portable)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_size, ostr::simd::instruction_set::sse2)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_size, ostr::simd::instruction_set::avx2)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_size, ostr::simd::instruction_set::neon)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+// code-region-end: codepoint counting
+
+// code-region-start: cached metadata
+
+namespace
+{
+	ostr::text make_ascii_text(const ostr::u64 codepoint_count)
+	{
+		ostr::text result;
+		while(result.raw().size() < codepoint_count)
+			result.append("abcdefghijklmnopqrstuvwxyz"_txtv);
+		result.subtext(0, codepoint_count);
+		return result;
+	}
+
+	template<bool Ascii>
+	ostr::text make_text(const ostr::u64 codepoint_count)
+	{
+		return Ascii ? make_ascii_text(codepoint_count) : make_mixed_text(codepoint_count);
+	}
+
+	template<bool Ascii>
+	void text_read_at(benchmark::State& state)
+	{
+		const ostr::text content = make_text<Ascii>(state.range(0));
+		const ostr::u64 size = content.size();
+		for (auto _ : state)
+			for(ostr::u64 i = 0; i < size; i += 7)
+				benchmark::DoNotOptimize(content.read_at(i));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size / 7));
+	}
+
+	template<bool Ascii>
+	void text_subview(benchmark::State& state)
+	{
+		const ostr::text content = make_text<Ascii>(state.range(0));
+		const ostr::u64 size = content.size();
+		for (auto _ : state)
+			for(ostr::u64 i = 0; i < size; i += 7)
+				benchmark::DoNotOptimize(content.subview(i, 5));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size / 7));
+	}
+
+	template<bool Ascii>
+	void text_index_of(benchmark::State& state)
+	{
+		ostr::text content = make_text<Ascii>(state.range(0));
+		content.append("#"_txtv);
+		const ostr::u64 size = content.size();
+		for (auto _ : state)
+			for(ostr::u64 i = 0; i < size; i += size / 16 + 1)
+				benchmark::DoNotOptimize(content.index_of("#"_txtv, i));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 16);
+	}
+}
+
+BENCHMARK_TEMPLATE(text_read_at, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_read_at, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_subview, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_subview, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_index_of, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_index_of, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+// code-region-end: cached metadata
+
+// code-region-start: utf-8 validation
+
+namespace
+{
+	template<ostr::simd::instruction_set Set, bool Ascii>
+	void text_view_validate(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const ostr::text content = make_text<Ascii>(state.range(0));
+		const ostr::text_view view = content.view();
+		for (auto _ : state)
+			benchmark::DoNotOptimize(view.is_valid());
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(view.raw().size()));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::portable, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::sse2, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::avx2, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::neon, false)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::portable, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::sse2, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::avx2, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_view_validate, ostr::simd::instruction_set::neon, true)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+// code-region-end: utf-8 validation
+
+// code-region-start: utf-16 transcoding
+
+namespace
+{
+	enum class corpus : ostr::u8
+	{
+		ascii,
+		cjk,
+		emoji,
+	};
+
+	std::u16string make_utf16_corpus(const corpus kind, const ostr::u64 size)
+	{
+		const char16_t* const pieces[] = { u"The quick brown fox jumps over the lazy dog. ", u"天地玄黄宇宙洪荒日月盈昃辰宿列张", u"😀🌏🚀🎉" };
+		std::u16string result;
+		while(result.size() < size)
+			result += pieces[static_cast<ostr::u8>(kind)];
+		result.resize(size);
+		if(ostr::unicode::utf16::is_leading_surrogate(result.back()))
+			result.back() = u'.';
+		return result;
+	}
+
+	template<ostr::simd::instruction_set Set, corpus Kind>
+	void text_from_utf16(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::u16string content = make_utf16_corpus(Kind, state.range(0));
+		for (auto _ : state)
+			benchmark::DoNotOptimize(ostr::text::from_utf16(content.c_str()));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(content.size() * sizeof(char16_t)));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	template<ostr::simd::instruction_set Set, corpus Kind>
+	void utf8_to_utf16(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const ostr::text content = ostr::text::from_utf16(make_utf16_corpus(Kind, state.range(0)).c_str());
+		const ostr::codeunit_sequence_view raw = content.view().raw();
+		std::u16string destination(ostr::simd::count_utf16(raw.data(), raw.size()), u'\0');
+		for (auto _ : state)
+			benchmark::DoNotOptimize(ostr::simd::utf8_to_utf16(raw.data(), raw.size(), destination.data()));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(raw.size()));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+// The loop text::from_utf16 used to run, encoding each codepoint.
+template<corpus Kind>
+void codepoint_from_utf16(benchmark::State& state)
+{
+	const std::u16string content = make_utf16_corpus(Kind, state.range(0));
+	for (auto _ : state)
+	{
+		ostr::codeunit_sequence sequence;
+		for(const char16_t* p = content.c_str(); *p != 0; p += ostr::unicode::utf16::parse_utf16_length(*p))
+			sequence.append(ostr::codepoint{ p });
+		benchmark::DoNotOptimize(sequence);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(content.size() * sizeof(char16_t)));
+}
+
+BENCHMARK_TEMPLATE(codepoint_from_utf16, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::portable, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::sse2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::avx2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::neon, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(codepoint_from_utf16, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::portable, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::sse2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::avx2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::neon, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(codepoint_from_utf16, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::portable, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::sse2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::avx2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf16, ostr::simd::instruction_set::neon, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::portable, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::sse2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::avx2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::neon, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::portable, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::sse2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::avx2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::neon, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::portable, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::sse2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::avx2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf16, ostr::simd::instruction_set::neon, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+// code-region-end: utf-16 transcoding
+
+// code-region-start: utf-32 transcoding
+
+namespace
+{
+	std::u32string make_utf32_corpus(const corpus kind, const ostr::u64 size)
+	{
+		const char32_t* const pieces[] = { U"The quick brown fox jumps over the lazy dog. ", U"天地玄黄宇宙洪荒日月盈昃辰宿列张", U"😀🌏🚀🎉" };
+		std::u32string result;
+		while(result.size() < size)
+			result += pieces[static_cast<ostr::u8>(kind)];
+		result.resize(size);
+		return result;
+	}
+
+	template<ostr::simd::instruction_set Set, corpus Kind>
+	void text_from_utf32(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const std::u32string content = make_utf32_corpus(Kind, state.range(0));
+		for (auto _ : state)
+			benchmark::DoNotOptimize(ostr::text::from_utf32(content.c_str()));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(content.size() * sizeof(char32_t)));
+		ostr::simd::set_instruction_set(origin);
+	}
+
+	template<ostr::simd::instruction_set Set, corpus Kind>
+	void utf8_to_utf32(benchmark::State& state)
+	{
+		const ostr::simd::instruction_set origin = ostr::simd::get_instruction_set();
+		if(!ostr::simd::set_instruction_set(Set))
+		{
+			state.SkipWithError("Instruction set is not supported.");
+			return;
+		}
+		const ostr::text content = ostr::text::from_utf32(make_utf32_corpus(Kind, state.range(0)).c_str());
+		const ostr::codeunit_sequence_view raw = content.view().raw();
+		std::u32string destination(ostr::simd::count_codepoints(raw.data(), raw.size()), U'\0');
+		for (auto _ : state)
+			benchmark::DoNotOptimize(ostr::simd::utf8_to_utf32(raw.data(), raw.size(), destination.data()));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(raw.size()));
+		ostr::simd::set_instruction_set(origin);
+	}
+}
+
+// The loop text::from_utf32 used to run, appending each codepoint.
+template<corpus Kind>
+void codepoint_from_utf32(benchmark::State& state)
+{
+	const std::u32string content = make_utf32_corpus(Kind, state.range(0));
+	for (auto _ : state)
+	{
+		ostr::codeunit_sequence sequence;
+		for(const char32_t* p = content.c_str(); *p != 0; ++p)
+			sequence.append(ostr::codepoint{ *p });
+		benchmark::DoNotOptimize(sequence);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(content.size() * sizeof(char32_t)));
+}
+
+BENCHMARK_TEMPLATE(codepoint_from_utf32, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::portable, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::sse2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::avx2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::neon, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(codepoint_from_utf32, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::portable, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::sse2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::avx2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::neon, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(codepoint_from_utf32, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::portable, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::sse2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::avx2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(text_from_utf32, ostr::simd::instruction_set::neon, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::portable, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::sse2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::avx2, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::neon, corpus::ascii)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::portable, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::sse2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::avx2, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::neon, corpus::cjk)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::portable, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::sse2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::avx2, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK_TEMPLATE(utf8_to_utf32, ostr::simd::instruction_set::neon, corpus::emoji)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+// code-region-end: utf-32 transcoding
+
+// code-region-start: streaming decoding
+
+// Decode mixed text arriving in chunks of state.range(1) codeunits into utf-16.
+void utf8_decoder_chunked(benchmark::State& state)
+{
+	const ostr::text content = make_mixed_text(state.range(0));
+	const ostr::codeunit_sequence_view raw = content.view().raw();
+	const ostr::u64 chunk_size = state.range(1);
+	std::u16string destination(ostr::utf8_decoder::get_maximum_decoded_size(chunk_size), u'\0');
+	for (auto _ : state)
+	{
+		ostr::utf8_decoder decoder;
+		for(ostr::u64 offset = 0; offset < raw.size(); offset += chunk_size)
+			benchmark::DoNotOptimize(decoder.decode(raw.subview(offset, chunk_size), destination.data()));
+		benchmark::DoNotOptimize(decoder.finish(destination.data()));
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(raw.size()));
+}
+
+BENCHMARK(utf8_decoder_chunked)->ArgsProduct({ { 1 << 15 }, { 7, 64, 1500, 1 << 16 } });
+
+// code-region-end: streaming decoding
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "text_view.h"
+
+namespace ostr
+{
+	/**
+	 * \brief Sparse checkpoints of an utf-8 sequence, one for every STRIDE codepoints,
+	 * to convert between codepoint, codeunit and utf-16 indices without walking from the beginning.
+	 * A conversion is a lookup (or a binary search) and a walk of less than STRIDE codepoints.
+	 * The index does not own the sequence, it must be rebuilt once the sequence is changed.
+	 * Codepoints are counted like simd::count_codepoints, so results are the same as text_view.
+	 */
+	class OPEN_STRING_API codepoint_index
+	{
+	public:
+
+		static constexpr u64 STRIDE = 64;
+
+		codepoint_index() noexcept = default;
+		explicit codepoint_index(const codeunit_sequence_view& sequence);
+
+		void build(const codeunit_sequence_view& sequence);
+
+		/**
+		 * @return How many codepoints are in the indexed sequence.
+		 */
+		[[nodiscard]] u64 size() const noexcept;
+
+		/**
+		 * @return How many utf-16 codeunits are needed to encode the indexed sequence.
+		 */
+		[[nodiscard]] u64 utf16_size() const noexcept;
+
+		/**
+		 * @param sequence the indexed sequence
+		 * @return Count of codepoints which start before codeunit_index.
+		 */
+		[[nodiscard]] u64 get_codepoint_index(const codeunit_sequence_view& sequence, u64 codeunit_index) const noexcept;
+
+		/**
+		 * @param sequence the indexed sequence
+		 * @return Index of the first codeunit of the codepoint, or size of sequence if codepoint_index is out of range.
+		 */
+		[[nodiscard]] u64 get_codeunit_index(const codeunit_sequence_view& sequence, u64 codepoint_index) const noexcept;
+
+		/**
+		 * @param sequence the indexed sequence
+		 * @return Index of the codepoint in utf-16, where codepoints beyond BMP take two codeunits.
+		 */
+		[[nodiscard]] u64 get_utf16_index(const codeunit_sequence_view& sequence, u64 codepoint_index) const noexcept;
+
+		/**
+		 * @param sequence the indexed sequence
+		 * @return Count of codepoints which start before utf16_index in utf-16.
+		 */
+		[[nodiscard]] u64 get_codepoint_index_from_utf16(const codeunit_sequence_view& sequence, u64 utf16_index) const noexcept;
+
+	private:
+
+		struct checkpoint
+		{
+			u64 codeunit_index = 0;
+			u64 utf16_index = 0;
+		};
+
+		// checkpoints_[i] is where codepoint i * STRIDE starts.
+		std::vector<checkpoint> checkpoints_;
+		u64 size_ = 0;
+		u64 utf16_size_ = 0;
+	};
+}
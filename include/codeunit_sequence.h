@@ -112,6 +112,26 @@ namespace ostr
 		[[nodiscard]] bool operator!=(const codeunit_sequence& rhs) const noexcept;
 		[[nodiscard]] bool operator!=(const char* rhs) const noexcept;
 
+		/**
+		 * @param rhs Another codeunit sequence
+		 * @return Negative if this is ordered before rhs, positive if after, 0 if they are equal.
+		 * See codeunit_sequence_view::compare.
+		 */
+		[[nodiscard]] i32 compare(const codeunit_sequence_view& rhs) const noexcept;
+
+		[[nodiscard]] bool operator<(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] bool operator<(const codeunit_sequence& rhs) const noexcept;
+		[[nodiscard]] bool operator<(const char* rhs) const noexcept;
+		[[nodiscard]] bool operator<=(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] bool operator<=(const codeunit_sequence& rhs) const noexcept;
+		[[nodiscard]] bool operator<=(const char* rhs) const noexcept;
+		[[nodiscard]] bool operator>(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] bool operator>(const codeunit_sequence& rhs) const noexcept;
+		[[nodiscard]] bool operator>(const char* rhs) const noexcept;
+		[[nodiscard]] bool operator>=(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] bool operator>=(const codeunit_sequence& rhs) const noexcept;
+		[[nodiscard]] bool operator>=(const char* rhs) const noexcept;
+
 		/**
 		 * Append a codeunit sequence back.
 		 * @return ref of this codeunit sequence.
@@ -222,11 +242,13 @@ namespace ostr
 			std::array<char, SSO_SIZE_MAX + 1> data;
 		};
 
+		// Memory capacity is always a power of two,
+		// so only its exponent is stored and size can take the rest 57 bits.
 		struct norm
 		{
-			u32 alloc : 1;
-			u32 size : 15;
-			u32 capacity;	// character capacity, which is 1 less than memory capacity
+			u64 alloc : 1;
+			u64 size : 57;
+			u64 capacity_exponent : 6;	// memory capacity is 2^capacity_exponent, character capacity is 1 less
 			char* data;
 		};
 
@@ -241,6 +263,12 @@ namespace ostr
 
 		[[nodiscard]] u64 get_capacity() const;
 
+		/**
+		 * \brief Replace current storage with a heap storage which can hold at least size characters.
+		 * Current data is released without copying.
+		 */
+		void allocate(u64 size);
+
 		[[nodiscard]] char* last();
 
 		[[nodiscard]] const char* last() const;
@@ -301,4 +329,8 @@ namespace ostr
 	}
 
 	OPEN_STRING_API [[nodiscard]] bool operator==(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator<(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator<=(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator>(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator>=(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept;
 }
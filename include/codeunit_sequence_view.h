@@ -3,12 +3,14 @@
 #include "common/definitions.h"
 
 #include <cstddef>
+#include <cstring>
 #include <vector>
 
 #include "common/basic_types.h"
 #include "common/constants.h"
 #include "unicode.h"
 #include "common/functions.h"
+#include "common/simd.h"
 
 namespace ostr
 {
@@ -82,6 +84,22 @@ namespace ostr
 		[[nodiscard]] constexpr bool operator!=(const codeunit_sequence_view& rhs) const noexcept;
 		[[nodiscard]] constexpr bool operator!=(const char* rhs) const noexcept;
 
+		/**
+		 * \brief Lexicographic comparison of codeunits as unsigned bytes,
+		 * which is the same as comparison of codepoints for valid utf-8.
+		 * @return Negative if this is ordered before rhs, positive if after, 0 if they are equal.
+		 */
+		[[nodiscard]] constexpr i32 compare(const codeunit_sequence_view& rhs) const noexcept;
+
+		[[nodiscard]] constexpr bool operator<(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator<(const char* rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator<=(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator<=(const char* rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator>(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator>(const char* rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator>=(const codeunit_sequence_view& rhs) const noexcept;
+		[[nodiscard]] constexpr bool operator>=(const char* rhs) const noexcept;
+
 		[[nodiscard]] constexpr u64 size() const noexcept;
 
 		// This is not allowed for getting rid of misuse
@@ -116,8 +134,11 @@ namespace ostr
 		[[nodiscard]] constexpr u64 index_of(const codeunit_sequence_view& pattern, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
 		[[nodiscard]] constexpr u64 index_of(const char codeunit, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
 		[[nodiscard]] constexpr u64 last_index_of(const codeunit_sequence_view& pattern, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
+		[[nodiscard]] constexpr u64 last_index_of(const char codeunit, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
 		[[nodiscard]] constexpr u64 index_of_any(const codeunit_sequence_view& units, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
+		[[nodiscard]] constexpr u64 index_of_any(const codeunit_set& units, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
 		[[nodiscard]] constexpr u64 last_index_of_any(const codeunit_sequence_view& units, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
+		[[nodiscard]] constexpr u64 last_index_of_any(const codeunit_set& units, const u64 from = 0, const u64 size = SIZE_MAX) const noexcept;
 
 		[[nodiscard]] constexpr bool contains(const codeunit_sequence_view& pattern) const noexcept;
 		[[nodiscard]] constexpr bool contains(const char codeunit) const noexcept;
@@ -136,6 +157,9 @@ namespace ostr
 		[[nodiscard]] constexpr codeunit_sequence_view trim_start(const codeunit_sequence_view& units = codeunit_sequence_view(" \t")) const noexcept;
 		[[nodiscard]] constexpr codeunit_sequence_view trim_end(const codeunit_sequence_view& units = codeunit_sequence_view(" \t")) const noexcept;
 		[[nodiscard]] constexpr codeunit_sequence_view trim(const codeunit_sequence_view& units = codeunit_sequence_view(" \t")) const noexcept;
+		[[nodiscard]] constexpr codeunit_sequence_view trim_start(const codeunit_set& units) const noexcept;
+		[[nodiscard]] constexpr codeunit_sequence_view trim_end(const codeunit_set& units) const noexcept;
+		[[nodiscard]] constexpr codeunit_sequence_view trim(const codeunit_set& units) const noexcept;
 
 	private:
 
@@ -338,6 +362,9 @@ namespace ostr
 	{
 		if (this->size() != rhs.size()) 
 			return false;
+		// memcmp is vectorized by every c library, and it does not accept null data even if size is 0.
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+			return this->size_ == 0 || std::memcmp(this->data_, rhs.data_, this->size_) == 0;
 		for(u64 i = 0; i < this->size(); ++i)
 			if(this->read_at(i) != rhs.read_at(i))
 				return false;
@@ -359,6 +386,66 @@ namespace ostr
 		return !this->operator==(rhs);
 	}
 
+	constexpr i32 codeunit_sequence_view::compare(const codeunit_sequence_view& rhs) const noexcept
+	{
+		const u64 common_size = minimum(this->size_, rhs.size_);
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			// memcmp compares as unsigned char, which is the order we want.
+			if(const int result = common_size == 0 ? 0 : std::memcmp(this->data_, rhs.data_, common_size); result != 0)
+				return result < 0 ? -1 : 1;
+		}
+		else
+		{
+			for(u64 i = 0; i < common_size; ++i)
+				if(this->read_at(i) != rhs.read_at(i))
+					return static_cast<u8>(this->read_at(i)) < static_cast<u8>(rhs.read_at(i)) ? -1 : 1;
+		}
+		if(this->size_ == rhs.size_)
+			return 0;
+		return this->size_ < rhs.size_ ? -1 : 1;
+	}
+
+	constexpr bool codeunit_sequence_view::operator<(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->compare(rhs) < 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator<(const char* rhs) const noexcept
+	{
+		return this->compare(codeunit_sequence_view(rhs)) < 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator<=(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->compare(rhs) <= 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator<=(const char* rhs) const noexcept
+	{
+		return this->compare(codeunit_sequence_view(rhs)) <= 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator>(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->compare(rhs) > 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator>(const char* rhs) const noexcept
+	{
+		return this->compare(codeunit_sequence_view(rhs)) > 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator>=(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->compare(rhs) >= 0;
+	}
+
+	constexpr bool codeunit_sequence_view::operator>=(const char* rhs) const noexcept
+	{
+		return this->compare(codeunit_sequence_view(rhs)) >= 0;
+	}
+
 	constexpr u64 codeunit_sequence_view::size() const noexcept
 	{
 		return this->size_;
@@ -399,8 +486,15 @@ namespace ostr
 	constexpr u64 codeunit_sequence_view::index_of(const codeunit_sequence_view& pattern, const u64 from, const u64 size) const noexcept
 	{
 		const codeunit_sequence_view view = this->subview(from, size);
+		if(pattern.is_empty())
+			return global_constant::INDEX_INVALID;
 		if(view.size() < pattern.size())
 			return global_constant::INDEX_INVALID;
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			const u64 found = simd::index_of(view.data(), view.size(), pattern.data(), pattern.size());
+			return found == global_constant::INDEX_INVALID ? found : found + from;
+		}
 		const char pattern_last = pattern.read_from_last(0);
 		u64 skip = 1;
 		while(pattern.size() > skip && pattern.read_from_last(skip) != pattern_last)
@@ -430,6 +524,11 @@ namespace ostr
 		if(codeunit == 0)
 			return global_constant::INDEX_INVALID;
 		const codeunit_sequence_view view = this->subview(from, size);
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			const u64 found = simd::index_of(view.data(), view.size(), codeunit);
+			return found == global_constant::INDEX_INVALID ? found : found + from;
+		}
 		for(u64 i = 0; i < view.size(); ++i)
 			if(view.read_at(i) == codeunit)
 				return i + from;
@@ -443,6 +542,11 @@ namespace ostr
 			return global_constant::INDEX_INVALID;
 		if(view.size() < pattern.size())
 			return global_constant::INDEX_INVALID;
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			const u64 found = simd::last_index_of(view.data(), view.size(), pattern.data(), pattern.size());
+			return found == global_constant::INDEX_INVALID ? found : found + from;
+		}
 
 		const char pattern_first = pattern.read_at(0);
 		u64 skip = 1;
@@ -469,23 +573,57 @@ namespace ostr
 		return global_constant::INDEX_INVALID;
 	}
 
+	constexpr u64 codeunit_sequence_view::last_index_of(const char codeunit, const u64 from, const u64 size) const noexcept
+	{
+		if(codeunit == 0)
+			return global_constant::INDEX_INVALID;
+		const codeunit_sequence_view view = this->subview(from, size);
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			const u64 found = simd::last_index_of(view.data(), view.size(), codeunit);
+			return found == global_constant::INDEX_INVALID ? found : found + from;
+		}
+		for(u64 i = view.size(); i > 0; --i)
+			if(view.read_at(i - 1) == codeunit)
+				return i - 1 + from;
+		return global_constant::INDEX_INVALID;
+	}
+
 	constexpr u64 codeunit_sequence_view::index_of_any(const codeunit_sequence_view& units, const u64 from, const u64 size) const noexcept
 	{
-		const u64 actual_size = minimum(this->size() - from, size);
-		const u64 final_index = from + actual_size;
-		for(u64 i = from; i < final_index; ++i)
-			if(const char& unit = this->read_at(i); units.contains(unit))
-				return i;
+		return this->index_of_any(codeunit_set{ units.data_, units.size_ }, from, size);
+	}
+
+	constexpr u64 codeunit_sequence_view::index_of_any(const codeunit_set& units, const u64 from, const u64 size) const noexcept
+	{
+		const codeunit_sequence_view view = this->subview(from, size);
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			const u64 found = simd::index_of_any(view.data(), view.size(), units);
+			return found == global_constant::INDEX_INVALID ? found : found + from;
+		}
+		for(u64 i = 0; i < view.size(); ++i)
+			if(units.contains(view.read_at(i)))
+				return i + from;
 		return global_constant::INDEX_INVALID;
 	}
 
 	constexpr u64 codeunit_sequence_view::last_index_of_any(const codeunit_sequence_view& units, const u64 from, const u64 size) const noexcept
 	{
-		const u64 actual_size = minimum(this->size() - from, size);
-		const u64 final_index = from + actual_size;
-		for(u64 i = final_index - 1; i >= from; --i)
-			if(const char& unit = this->read_at(i); units.contains(unit))
-				return i;
+		return this->last_index_of_any(codeunit_set{ units.data_, units.size_ }, from, size);
+	}
+
+	constexpr u64 codeunit_sequence_view::last_index_of_any(const codeunit_set& units, const u64 from, const u64 size) const noexcept
+	{
+		const codeunit_sequence_view view = this->subview(from, size);
+		if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+		{
+			const u64 found = simd::last_index_of_any(view.data(), view.size(), units);
+			return found == global_constant::INDEX_INVALID ? found : found + from;
+		}
+		for(u64 i = view.size(); i > 0; --i)
+			if(units.contains(view.read_at(i - 1)))
+				return i - 1 + from;
 		return global_constant::INDEX_INVALID;
 	}
 
@@ -569,26 +707,32 @@ namespace ostr
 
 	constexpr codeunit_sequence_view codeunit_sequence_view::trim_start(const codeunit_sequence_view& units) const noexcept
 	{
-		if(this->is_empty())
-			return { };
-		for(u64 i = 0; i < this->size(); ++i)
-			if(const char codeunit = this->read_at(i); !units.contains(codeunit))
-				return this->subview(i);
-		return { };
+		return this->trim_start(codeunit_set{ units.data_, units.size_ });
 	}
 
 	constexpr codeunit_sequence_view codeunit_sequence_view::trim_end(const codeunit_sequence_view& units) const noexcept
 	{
-		if(this->is_empty())
-			return { };
-
-		for(u64 i = this->size(); i > 0; --i)
-			if(const char codeunit = this->read_at(i - 1); !units.contains(codeunit))
-				return this->subview(0, i);
-		return { };
+		return this->trim_end(codeunit_set{ units.data_, units.size_ });
 	}
 
 	constexpr codeunit_sequence_view codeunit_sequence_view::trim(const codeunit_sequence_view& units) const noexcept
+	{
+		return this->trim(codeunit_set{ units.data_, units.size_ });
+	}
+
+	constexpr codeunit_sequence_view codeunit_sequence_view::trim_start(const codeunit_set& units) const noexcept
+	{
+		const u64 first = this->index_of_any(units.complement());
+		return first == global_constant::INDEX_INVALID ? codeunit_sequence_view{ } : this->subview(first);
+	}
+
+	constexpr codeunit_sequence_view codeunit_sequence_view::trim_end(const codeunit_set& units) const noexcept
+	{
+		const u64 last = this->last_index_of_any(units.complement());
+		return last == global_constant::INDEX_INVALID ? codeunit_sequence_view{ } : this->subview(0, last + 1);
+	}
+
+	constexpr codeunit_sequence_view codeunit_sequence_view::trim(const codeunit_set& units) const noexcept
 	{
 		return this->trim_start(units).trim_end(units);
 	}
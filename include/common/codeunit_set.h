@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include "common/basic_types.h"
+
+namespace ostr
+{
+	/**
+	 * \brief A set of codeunits stored as a 256-bit bitmap, so membership costs one bit test
+	 * no matter how many units are in the set. Build it once, e.g. as a constexpr variable for literals.
+	 */
+	class codeunit_set
+	{
+	public:
+
+		constexpr codeunit_set() noexcept = default;
+
+		explicit constexpr codeunit_set(const char* units, const u64 size) noexcept
+		{
+			for(u64 i = 0; i < size; ++i)
+				this->add(units[i]);
+		}
+
+		/**
+		 * @param units Null terminated units.
+		 */
+		explicit constexpr codeunit_set(const char* units) noexcept
+		{
+			for(; *units != 0; ++units)
+				this->add(*units);
+		}
+
+		constexpr codeunit_set& add(const char codeunit) noexcept
+		{
+			const u8 unit = static_cast<u8>(codeunit);
+			this->bits_[unit >> 6] |= 1ull << (unit & 63);
+			return *this;
+		}
+
+		[[nodiscard]] constexpr bool contains(const char codeunit) const noexcept
+		{
+			const u8 unit = static_cast<u8>(codeunit);
+			return (this->bits_[unit >> 6] >> (unit & 63) & 1) != 0;
+		}
+
+		/**
+		 * @return A set with all codeunits not in this set.
+		 */
+		[[nodiscard]] constexpr codeunit_set complement() const noexcept
+		{
+			codeunit_set result;
+			for(u64 i = 0; i < this->bits_.size(); ++i)
+				result.bits_[i] = ~this->bits_[i];
+			return result;
+		}
+
+		/**
+		 * @return How many codeunits are in this set.
+		 */
+		[[nodiscard]] constexpr u64 size() const noexcept
+		{
+			u64 count = 0;
+			for(u64 word : this->bits_)
+				for(; word != 0; word &= word - 1)
+					++count;
+			return count;
+		}
+
+		[[nodiscard]] constexpr bool is_empty() const noexcept
+		{
+			return (this->bits_[0] | this->bits_[1] | this->bits_[2] | this->bits_[3]) == 0;
+		}
+
+		/**
+		 * @return Bit (unit & 63) of word (unit >> 6) tells whether unit is in this set.
+		 */
+		[[nodiscard]] constexpr const std::array<u64, 4>& get_bits() const noexcept
+		{
+			return this->bits_;
+		}
+
+		[[nodiscard]] constexpr bool operator==(const codeunit_set& rhs) const noexcept
+		{
+			for(u64 i = 0; i < this->bits_.size(); ++i)
+				if(this->bits_[i] != rhs.bits_[i])
+					return false;
+			return true;
+		}
+
+		[[nodiscard]] constexpr bool operator!=(const codeunit_set& rhs) const noexcept
+		{
+			return !this->operator==(rhs);
+		}
+
+	private:
+
+		std::array<u64, 4> bits_{ };
+	};
+}
@@ -1,7 +1,12 @@
 
 #pragma once
 #include <algorithm>
+#include <array>
 #include <math.h>
+#include "common/basic_types.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace ostr
 {
@@ -38,6 +43,34 @@ namespace ostr
 		return result;
 	}
 
+	/**
+	 * @return count of zero bits below the lowest set bit, value must not be 0
+	 */
+	[[nodiscard]] inline u64 count_trailing_zeros(const u64 value) noexcept
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#else
+		return static_cast<u64>(__builtin_ctzll(value));
+#endif
+	}
+
+	/**
+	 * @return count of zero bits above the highest set bit, value must not be 0
+	 */
+	[[nodiscard]] inline u64 count_leading_zeros(const u64 value) noexcept
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return 63 - index;
+#else
+		return static_cast<u64>(__builtin_clzll(value));
+#endif
+	}
+
 	template<class T>
 	constexpr std::enable_if_t<std::is_trivial_v<T>> bitwise_swap(T& a, T& b) noexcept
 	{
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <array>
+#include "common/basic_types.h"
+#include "common/codeunit_set.h"
+#include "common/definitions.h"
+
+// SSE2 is always available on x86-64, AVX2 is detected at runtime.
+#if defined(__x86_64__) || defined(_M_X64)
+#define OPEN_STRING_SIMD_X86 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define OPEN_STRING_SIMD_NEON 1
+#endif
+
+// Functions using AVX2 intrinsics must be marked with this, since the library is not compiled with -mavx2.
+// Every cpu with AVX2 has POPCNT as well.
+#if defined(OPEN_STRING_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define OPEN_STRING_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#else
+#define OPEN_STRING_TARGET_AVX2
+#endif
+
+// Vector kernels are not usable while constant evaluating,
+// so every constexpr api with a vectorized runtime path should be guarded with this.
+#ifndef OPEN_STRING_IS_CONSTANT_EVALUATED
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define OPEN_STRING_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+// Always fall back to constexpr path if the compiler can not tell.
+#define OPEN_STRING_IS_CONSTANT_EVALUATED() true
+#endif
+#endif
+
+namespace ostr::simd
+{
+	enum class instruction_set : u8
+	{
+		portable,	// SWAR, 8 bytes per step
+		sse2,
+		avx2,
+		neon,
+	};
+
+	/**
+	 * @return The instruction set which kernels are dispatched to currently.
+	 * It is detected at first call, and it is the best one supported by running cpu.
+	 */
+	[[nodiscard]] OPEN_STRING_API instruction_set get_instruction_set() noexcept;
+
+	/**
+	 * @return Whether kernels of specific instruction set could run on this cpu.
+	 */
+	[[nodiscard]] OPEN_STRING_API bool is_supported(instruction_set set) noexcept;
+
+	/**
+	 * \brief Force kernels to be dispatched to specific instruction set.
+	 * This is for tests and benchmarks, do not call it while other threads are using kernels.
+	 * \return Whether the instruction set is supported and switched.
+	 */
+	OPEN_STRING_API bool set_instruction_set(instruction_set set) noexcept;
+
+	// code-region-start: byte search
+
+	/**
+	 * @return index of the first codeunit in [data, data + size), return global_constant::INDEX_INVALID if not found
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 index_of(const char* data, u64 size, char codeunit) noexcept;
+
+	/**
+	 * @return index of the last codeunit in [data, data + size), return global_constant::INDEX_INVALID if not found
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 last_index_of(const char* data, u64 size, char codeunit) noexcept;
+
+	// code-region-end: byte search
+
+	// code-region-start: substring search
+
+	/**
+	 * \brief Candidates are filtered by first and last codeunits of pattern with vector compares,
+	 * long patterns fall back to two-way search on repetitive data, so worst case is linear.
+	 * @return index of the first pattern in [data, data + size), return global_constant::INDEX_INVALID if not found or pattern is empty
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 index_of(const char* data, u64 size, const char* pattern, u64 pattern_size) noexcept;
+
+	/**
+	 * @return index of the last pattern in [data, data + size), return global_constant::INDEX_INVALID if not found or pattern is empty
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 last_index_of(const char* data, u64 size, const char* pattern, u64 pattern_size) noexcept;
+
+	/**
+	 * \brief Data of a pattern prepared once to search it many times, see ostr::searcher.
+	 */
+	struct substring_table
+	{
+		// Offsets of the two codeunits compared by candidate filter, the rarest ones in pattern.
+		u64 filter_offset_0 = 0;
+		u64 filter_offset_1 = 0;
+		// Critical factorization for two-way search.
+		u64 critical_position = 0;
+		u64 period = 0;
+		u64 memory_reset = 0;
+		// Bad codeunit table: 1 + the last index of each codeunit in pattern, 0 for absent ones.
+		std::array<u64, 256> shift{ };
+	};
+
+	OPEN_STRING_API void prepare(substring_table& table, const char* pattern, u64 pattern_size) noexcept;
+
+	/**
+	 * @param table prepared from the same pattern
+	 * @return index of the first pattern in [data, data + size), return global_constant::INDEX_INVALID if not found or pattern is empty
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 index_of(const char* data, u64 size, const char* pattern, u64 pattern_size, const substring_table& table) noexcept;
+
+	// code-region-end: substring search
+
+	// code-region-start: codeunit set search
+
+	/**
+	 * @return index of the first codeunit in units, return global_constant::INDEX_INVALID if not found
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 index_of_any(const char* data, u64 size, const codeunit_set& units) noexcept;
+
+	/**
+	 * @return index of the last codeunit in units, return global_constant::INDEX_INVALID if not found
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 last_index_of_any(const char* data, u64 size, const codeunit_set& units) noexcept;
+
+	// code-region-end: codeunit set search
+
+	// code-region-start: utf-8 counting
+
+	// A codepoint starts at each codeunit which is not a continuation (10xxxxxx),
+	// which is the exact count for valid utf-8. Stray continuation codeunits are counted as part of the previous codepoint.
+
+	/**
+	 * @return How many codepoints start in [data, data + size).
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 count_codepoints(const char* data, u64 size) noexcept;
+
+	/**
+	 * @return How many utf-16 codeunits the codepoints starting in [data, data + size) take.
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 count_utf16(const char* data, u64 size) noexcept;
+
+	/**
+	 * @return index of the codeunit where the codepoint_index-th codepoint starts, return global_constant::INDEX_INVALID if there are not so many
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 index_of_codepoint(const char* data, u64 size, u64 codepoint_index) noexcept;
+
+	/**
+	 * @return Whether all codeunits in [data, data + size) are below 0x80,
+	 * then codepoint, codeunit and utf-16 indices are all the same.
+	 */
+	[[nodiscard]] OPEN_STRING_API bool is_ascii(const char* data, u64 size) noexcept;
+
+	// code-region-end: utf-8 counting
+
+	// code-region-start: utf-8 validation
+
+	/**
+	 * \brief Blocks are validated with lookup tables of codeunit nibbles, and ascii blocks are skipped.
+	 * @param codepoint_count count of codepoints before the returned index
+	 * @return index of the first codeunit which does not start a well-formed sequence, see unicode::parse_valid_utf8_length,
+	 * return global_constant::INDEX_INVALID if all codeunits are valid
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 first_invalid_utf8(const char* data, u64 size, u64& codepoint_count) noexcept;
+
+	// code-region-end: utf-8 validation
+
+	// code-region-start: utf-16 transcoding
+
+	/**
+	 * @return How many utf-8 codeunits [data, data + size) takes, where each lone surrogate is taken as U+FFFD.
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 count_utf8_of_utf16(const char16_t* data, u64 size) noexcept;
+
+	/**
+	 * \brief Transcode utf-16 to utf-8 in blocks, lone surrogates are replaced by U+FFFD.
+	 * @param destination at least count_utf8_of_utf16(data, size) codeunits
+	 * @return How many codeunits are written, which is count_utf8_of_utf16(data, size).
+	 */
+	OPEN_STRING_API u64 utf16_to_utf8(const char16_t* data, u64 size, char* destination) noexcept;
+
+	/**
+	 * \brief Transcode utf-8 to utf-16 in blocks. Each ill-formed sequence becomes a single U+FFFD,
+	 * and continuation codeunits which do not follow a lead are skipped, see count_codepoints.
+	 * @param destination at least count_utf16(data, size) codeunits
+	 * @return How many codeunits are written, which is count_utf16(data, size) if data is well-formed.
+	 */
+	OPEN_STRING_API u64 utf8_to_utf16(const char* data, u64 size, char16_t* destination) noexcept;
+
+	// code-region-end: utf-16 transcoding
+
+	// code-region-start: utf-32 transcoding
+
+	/**
+	 * @return How many utf-8 codeunits [data, data + size) takes, where each surrogate or value beyond U+10FFFF is taken as U+FFFD.
+	 */
+	[[nodiscard]] OPEN_STRING_API u64 count_utf8_of_utf32(const char32_t* data, u64 size) noexcept;
+
+	/**
+	 * \brief Encode utf-32 to utf-8 in blocks, surrogates and values beyond U+10FFFF are replaced by U+FFFD.
+	 * @param destination at least count_utf8_of_utf32(data, size) codeunits
+	 * @return How many codeunits are written, which is count_utf8_of_utf32(data, size).
+	 */
+	OPEN_STRING_API u64 utf32_to_utf8(const char32_t* data, u64 size, char* destination) noexcept;
+
+	/**
+	 * \brief Decode utf-8 to utf-32 in blocks, ill-formed sequences are handled the same way as utf8_to_utf16.
+	 * @param destination at least count_codepoints(data, size) codepoints
+	 * @return How many codepoints are written, which is count_codepoints(data, size) if data is well-formed.
+	 */
+	OPEN_STRING_API u64 utf8_to_utf32(const char* data, u64 size, char32_t* destination) noexcept;
+
+	// code-region-end: utf-32 transcoding
+
+	// code-region-start: hex and base64
+
+	/**
+	 * \brief Encode each byte as 2 hex digits, followed by separator except the last byte, unless separator is '\0'.
+	 * @param destination at least size * 2 codeunits, or size * 3 - 1 codeunits with separator
+	 * @return How many codeunits are written.
+	 */
+	OPEN_STRING_API u64 hex_encode(const byte* data, u64 size, char* destination, bool uppercase, char separator) noexcept;
+
+	/**
+	 * \brief Decode pairs of hex digits of either case, which are separated by separator, unless separator is '\0'.
+	 * @param destination at least size / 2 bytes
+	 * @return How many bytes are written, return global_constant::INDEX_INVALID if data is not such pairs,
+	 * then destination might be written partially.
+	 */
+	OPEN_STRING_API u64 hex_decode(const char* data, u64 size, byte* destination, char separator) noexcept;
+
+	enum class base64_alphabet : u8
+	{
+		standard,	// RFC 4648 section 4, with '+' and '/'
+		url,		// RFC 4648 section 5, with '-' and '_'
+	};
+
+	/**
+	 * @param destination at least (size + 2) / 3 * 4 codeunits with padding, or (size * 4 + 2) / 3 codeunits without
+	 * @return How many codeunits are written.
+	 */
+	OPEN_STRING_API u64 base64_encode(const byte* data, u64 size, char* destination, base64_alphabet alphabet, bool padding) noexcept;
+
+	/**
+	 * \brief Decode base64 of the alphabet, padding is optional, but it must make whole quantums of 4 codeunits if present.
+	 * Unused bits of the last quantum are ignored.
+	 * @param destination at least size / 4 * 3 + 2 bytes
+	 * @return How many bytes are written, return global_constant::INDEX_INVALID if data is not base64,
+	 * then destination might be written partially.
+	 */
+	OPEN_STRING_API u64 base64_decode(const char* data, u64 size, byte* destination, base64_alphabet alphabet) noexcept;
+
+	// code-region-end: hex and base64
+}
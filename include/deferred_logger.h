@@ -0,0 +1,285 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <tuple>
+
+#include "format.h"
+#include "text.h"
+
+namespace ostr
+{
+	/**
+	 * \brief What deferred_logger::log does when the queue is full.
+	 */
+	enum class log_overflow_policy : u8
+	{
+		// Wait until the consumer frees a slot, which slows producers down to the pace of output.
+		block,
+		// Drop the record, so producers never wait, see deferred_logger::get_dropped_count.
+		drop,
+	};
+
+	struct deferred_logger_settings
+	{
+		// How many records the queue holds, rounded up to a power of 2.
+		u64 capacity = 4096;
+		// How many bytes the mold and arguments of a record take at most, larger records are dropped.
+		u64 record_size = 256;
+		log_overflow_policy overflow_policy = log_overflow_policy::block;
+		// Formatted lines are output once they exceed this size, or once the queue is drained.
+		u64 batch_size = 64 * 1024;
+	};
+
+	namespace details
+	{
+		/**
+		 * \brief How an argument is copied into a record, and read back on the consumer thread.
+		 * Trivially copyable values are copied as they are.
+		 */
+		template<class T, typename = void>
+		struct deferred_argument
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable arguments and strings could be deferred!");
+
+			using replayed_type = T;
+
+			[[nodiscard]] static u64 get_size(const T&) noexcept
+			{
+				return sizeof(T);
+			}
+
+			static byte* capture(byte* destination, const T& value) noexcept
+			{
+				std::memcpy(destination, &value, sizeof(T));
+				return destination + sizeof(T);
+			}
+
+			[[nodiscard]] static T replay(const byte*& source) noexcept
+			{
+				T value;
+				std::memcpy(&value, source, sizeof(T));
+				source += sizeof(T);
+				return value;
+			}
+		};
+
+		/**
+		 * \brief Strings are copied as their size followed by their codeunits, and read back as views into the record.
+		 */
+		template<class T, class Replayed>
+		struct deferred_string_argument
+		{
+			using replayed_type = Replayed;
+
+			[[nodiscard]] static u64 get_size(const T& value) noexcept
+			{
+				return sizeof(u64) + view_sequence(value).size();
+			}
+
+			static byte* capture(byte* destination, const T& value) noexcept
+			{
+				const codeunit_sequence_view view = view_sequence(value);
+				const u64 size = view.size();
+				std::memcpy(destination, &size, sizeof(u64));
+				std::memcpy(destination + sizeof(u64), view.data(), size);
+				return destination + sizeof(u64) + size;
+			}
+
+			[[nodiscard]] static Replayed replay(const byte*& source) noexcept
+			{
+				u64 size;
+				std::memcpy(&size, source, sizeof(u64));
+				const codeunit_sequence_view view{ reinterpret_cast<const char*>(source + sizeof(u64)), size };
+				source += sizeof(u64) + size;
+				return Replayed{ view };
+			}
+		};
+
+		template<>
+		struct deferred_argument<const char*> : deferred_string_argument<const char*, codeunit_sequence_view> { };
+
+		template<>
+		struct deferred_argument<char*> : deferred_string_argument<const char*, codeunit_sequence_view> { };
+
+		template<size_t N>
+		struct deferred_argument<char[N]> : deferred_string_argument<char[N], codeunit_sequence_view> { };
+
+		template<>
+		struct deferred_argument<codeunit_sequence_view> : deferred_string_argument<codeunit_sequence_view, codeunit_sequence_view> { };
+
+		template<>
+		struct deferred_argument<codeunit_sequence> : deferred_string_argument<codeunit_sequence, codeunit_sequence_view> { };
+
+		template<>
+		struct deferred_argument<text_view> : deferred_string_argument<text_view, text_view> { };
+
+		template<>
+		struct deferred_argument<text> : deferred_string_argument<text, text_view> { };
+
+		/**
+		 * \brief How a format mold is kept in a record, molds are referred to instead of copied.
+		 */
+		template<class Format, typename = void>
+		struct deferred_mold
+		{
+			// codeunit_sequence_view itself is not trivially copyable.
+			struct stored_type
+			{
+				const char* data;
+				u64 size;
+			};
+
+			[[nodiscard]] static stored_type capture(const Format& format_mold) noexcept
+			{
+				const codeunit_sequence_view view = view_sequence(format_mold);
+				return { view.data(), view.size() };
+			}
+
+			[[nodiscard]] static codeunit_sequence_view replay(const stored_type& stored) noexcept
+			{
+				return { stored.data, stored.size };
+			}
+		};
+
+		template<class Format>
+		struct deferred_mold<Format, std::enable_if_t<is_compiled_format<Format>::value>>
+		{
+			using stored_type = Format;
+
+			[[nodiscard]] static stored_type capture(const Format& format_mold) noexcept
+			{
+				return format_mold;
+			}
+
+			[[nodiscard]] static const Format& replay(const stored_type& stored) noexcept
+			{
+				return stored;
+			}
+		};
+
+		template<>
+		struct deferred_mold<prepared_format>
+		{
+			using stored_type = const prepared_format*;
+
+			[[nodiscard]] static stored_type capture(const prepared_format& format_mold) noexcept
+			{
+				return &format_mold;
+			}
+
+			[[nodiscard]] static const prepared_format& replay(const stored_type& stored) noexcept
+			{
+				return *stored;
+			}
+		};
+
+		using deferred_replay_function_type = void(*)(format_sink& sink, const byte* payload);
+
+		template<class Format, class...Args>
+		void replay_deferred(format_sink& sink, const byte* payload)
+		{
+			using mold = deferred_mold<Format>;
+			typename mold::stored_type stored_mold;
+			std::memcpy(&stored_mold, payload, sizeof(stored_mold));
+			payload += sizeof(stored_mold);
+			// Elements of a braced list are initialized in order, so arguments are read back in the order they are captured.
+			const std::tuple<typename deferred_argument<Args>::replayed_type...> arguments{ deferred_argument<Args>::replay(payload)... };
+			std::apply([&sink, &stored_mold](const auto&...values)
+			{
+				format_to_sink(sink, mold::replay(stored_mold), values...);
+			}, arguments);
+		}
+	}
+
+	/**
+	 * \brief Logger which formats on a background thread, so producers only copy the mold and arguments.
+	 * Records are kept in a bounded lock-free queue of fixed-size slots, which any count of threads log into,
+	 * and the consumer thread formats them as lines into a batch, which is handed to output at once.
+	 * Trivially copyable arguments are copied as they are, and strings are copied into the record,
+	 * but molds are referred to, so they must outlive the logger, as string literals, compiled molds and long-lived prepared_formats do.
+	 */
+	class OPEN_STRING_API deferred_logger
+	{
+	public:
+		// Called on the consumer thread with formatted lines, each of which ends in '\n'.
+		using output_function_type = std::function<void(const codeunit_sequence_view& lines)>;
+
+		explicit deferred_logger(output_function_type output, const deferred_logger_settings& settings = { });
+		deferred_logger(const deferred_logger&) = delete;
+		deferred_logger(deferred_logger&&) noexcept = delete;
+		deferred_logger& operator=(const deferred_logger&) = delete;
+		deferred_logger& operator=(deferred_logger&&) noexcept = delete;
+
+		/**
+		 * \brief Output everything logged and stop the consumer, no thread could log meanwhile.
+		 */
+		~deferred_logger();
+
+		/**
+		 * \brief Nothing is allocated or formatted here.
+		 * @return Whether the record is queued, false if it is dropped.
+		 */
+		template<class Format, class...Args>
+		bool log(const Format& format_mold, const Args&...args);
+
+		/**
+		 * \brief Wait until everything logged before is output.
+		 */
+		void flush() const noexcept;
+
+		/**
+		 * @return How many records are dropped, by the drop policy or for being larger than a record.
+		 */
+		[[nodiscard]] u64 get_dropped_count() const noexcept;
+
+	private:
+
+		/**
+		 * @return Where to write the record, nullptr if it is dropped.
+		 */
+		[[nodiscard]] byte* claim(u64 size, u64& position) noexcept;
+		void publish(u64 position, details::deferred_replay_function_type replay) noexcept;
+		void consume();
+
+		struct slot
+		{
+			// position + 1 once published, position + capacity once consumed, where position is of the record in it.
+			std::atomic<u64> sequence;
+			details::deferred_replay_function_type replay;
+		};
+
+		output_function_type output_;
+		deferred_logger_settings settings_;
+		u64 mask_;
+		std::unique_ptr<slot[]> slots_;
+		std::unique_ptr<byte[]> payloads_;
+
+		// Producers, the consumer and flush contend on different cache lines.
+		alignas(64) std::atomic<u64> enqueue_position_{ 0 };
+		alignas(64) std::atomic<u64> output_position_{ 0 };
+		std::atomic<u64> dropped_count_{ 0 };
+		std::atomic<bool> stopping_{ false };
+		std::thread consumer_;
+	};
+
+	template<class Format, class...Args>
+	bool deferred_logger::log(const Format& format_mold, const Args&...args)
+	{
+		using mold = details::deferred_mold<Format>;
+		const typename mold::stored_type stored_mold = mold::capture(format_mold);
+		const u64 size = sizeof(stored_mold) + (u64{ 0 } + ... + details::deferred_argument<Args>::get_size(args));
+		u64 position;
+		byte* payload = this->claim(size, position);
+		if(!payload)
+			return false;
+		std::memcpy(payload, &stored_mold, sizeof(stored_mold));
+		[[maybe_unused]] byte* cursor = payload + sizeof(stored_mold);
+		((cursor = details::deferred_argument<Args>::capture(cursor, args)), ...);
+		this->publish(position, details::replay_deferred<Format, Args...>);
+		return true;
+	}
+}
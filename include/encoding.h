@@ -0,0 +1,71 @@
+#pragma once
+#include "common/definitions.h"
+
+#include <optional>
+#include "codeunit_sequence.h"
+#include "codeunit_sequence_view.h"
+
+namespace ostr
+{
+	using simd::base64_alphabet;
+
+	struct hex_format
+	{
+		// Written between bytes, nothing is written if it is '\0'.
+		char separator = '\0';
+		bool uppercase = false;
+	};
+
+	/**
+	 * @return How many codeunits encode_hex writes for byte_count bytes.
+	 */
+	[[nodiscard]] constexpr u64 get_hex_encoded_size(const u64 byte_count, const hex_format& format = { }) noexcept
+	{
+		if(format.separator == '\0')
+			return byte_count * 2;
+		return byte_count == 0 ? 0 : byte_count * 3 - 1;
+	}
+
+	/**
+	 * @return How many codeunits encode_base64 writes for byte_count bytes.
+	 */
+	[[nodiscard]] constexpr u64 get_base64_encoded_size(const u64 byte_count, const bool padding = true) noexcept
+	{
+		return padding ? (byte_count + 2) / 3 * 4 : (byte_count * 4 + 2) / 3;
+	}
+
+	/**
+	 * \brief Codeunits of bytes are encoded as hex digits, such as "de ad be ef" with ' ' as separator.
+	 * @param destination at least get_hex_encoded_size(bytes.size(), format) codeunits
+	 * @return How many codeunits are written.
+	 */
+	OPEN_STRING_API u64 encode_hex(const codeunit_sequence_view& bytes, char* destination, const hex_format& format = { }) noexcept;
+
+	[[nodiscard]] OPEN_STRING_API codeunit_sequence to_hex(const codeunit_sequence_view& bytes, const hex_format& format = { });
+
+	/**
+	 * \brief Decode pairs of hex digits of either case, which are separated by separator unless it is '\0'.
+	 * @param destination at least hex.size() / 2 bytes
+	 * @return How many bytes are written, return global_constant::INDEX_INVALID if hex is not such pairs.
+	 */
+	OPEN_STRING_API u64 decode_hex(const codeunit_sequence_view& hex, byte* destination, char separator = '\0') noexcept;
+
+	[[nodiscard]] OPEN_STRING_API std::optional<codeunit_sequence> from_hex(const codeunit_sequence_view& hex, char separator = '\0');
+
+	/**
+	 * @param destination at least get_base64_encoded_size(bytes.size(), padding) codeunits
+	 * @return How many codeunits are written.
+	 */
+	OPEN_STRING_API u64 encode_base64(const codeunit_sequence_view& bytes, char* destination, base64_alphabet alphabet = base64_alphabet::standard, bool padding = true) noexcept;
+
+	[[nodiscard]] OPEN_STRING_API codeunit_sequence to_base64(const codeunit_sequence_view& bytes, base64_alphabet alphabet = base64_alphabet::standard, bool padding = true);
+
+	/**
+	 * \brief Padding is optional, but it must complete the last quantum of 4 codeunits if present.
+	 * @param destination at least base64.size() / 4 * 3 + 2 bytes
+	 * @return How many bytes are written, return global_constant::INDEX_INVALID if base64 is not of the alphabet.
+	 */
+	OPEN_STRING_API u64 decode_base64(const codeunit_sequence_view& base64, byte* destination, base64_alphabet alphabet = base64_alphabet::standard) noexcept;
+
+	[[nodiscard]] OPEN_STRING_API std::optional<codeunit_sequence> from_base64(const codeunit_sequence_view& base64, base64_alphabet alphabet = base64_alphabet::standard);
+}
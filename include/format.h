@@ -1,353 +1,743 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <charconv>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "common/platforms.h"
 #include "common/definitions.h"
+#include "common/functions.h"
 #include "codeunit_sequence.h"
 
 namespace ostr
 {
+    /**
+     * \brief Destination which formatting appends codeunits to, such as a codeunit_sequence, a fixed buffer or an output iterator.
+     * Formatters append into it directly, instead of returning a new sequence for each argument.
+     * Appending is type-erased, so formatters could be compiled in source files.
+     */
+    class format_sink
+    {
+    public:
+        using append_function_type = void(*)(void* destination, const char* data, u64 size);
+
+        constexpr format_sink(void* destination, const append_function_type append_function) noexcept
+            : destination_(destination)
+            , append_function_(append_function)
+        { }
+
+        void append(const codeunit_sequence_view& view)
+        {
+            if(view.is_empty())
+                return;
+            this->append_function_(this->destination_, view.data(), view.size());
+            this->size_ += view.size();
+        }
+
+        void append(const char codeunit, const u64 count = 1)
+        {
+            if(count == 1)
+            {
+                this->append_function_(this->destination_, &codeunit, 1);
+                ++this->size_;
+                return;
+            }
+            std::array<char, 32> units;
+            units.fill(codeunit);
+            for(u64 remaining = count; remaining > 0;)
+            {
+                const u64 size = minimum(remaining, units.size());
+                this->append_function_(this->destination_, units.data(), size);
+                remaining -= size;
+            }
+            this->size_ += count;
+        }
+
+        /**
+         * @return How many codeunits are appended, including those which a fixed buffer could not hold.
+         */
+        [[nodiscard]] u64 size() const noexcept
+        {
+            return this->size_;
+        }
+
+    private:
+        void* destination_;
+        append_function_type append_function_;
+        u64 size_ = 0;
+    };
+
     namespace details
     {
-        codeunit_sequence OPEN_STRING_API format_integer(const u64& value, const codeunit_sequence_view& specification);
-        codeunit_sequence OPEN_STRING_API format_integer(const i64& value, const codeunit_sequence_view& specification);
-        codeunit_sequence OPEN_STRING_API format_float(const f64& value, const codeunit_sequence_view& specification);
+        inline void append_to_sequence(void* destination, const char* data, const u64 size)
+        {
+            static_cast<codeunit_sequence*>(destination)->append(codeunit_sequence_view{ data, size });
+        }
+
+        struct fixed_buffer
+        {
+            char* data;
+            u64 capacity;
+            u64 written;
+        };
+
+        inline void append_to_fixed_buffer(void* destination, const char* data, const u64 size)
+        {
+            fixed_buffer& buffer = *static_cast<fixed_buffer*>(destination);
+            const u64 taken = minimum(size, buffer.capacity - buffer.written);
+            std::copy_n(data, taken, buffer.data + buffer.written);
+            buffer.written += taken;
+        }
+
+        inline void append_to_nothing(void*, const char*, const u64)
+        { }
+
+        template<class OutputIt>
+        void append_to_iterator(void* destination, const char* data, const u64 size)
+        {
+            OutputIt& iterator = *static_cast<OutputIt*>(destination);
+            iterator = std::copy_n(data, size, iterator);
+        }
+
+        OPEN_STRING_API void format_integer(format_sink& sink, const u64& value, const codeunit_sequence_view& specification);
+        OPEN_STRING_API void format_integer(format_sink& sink, const i64& value, const codeunit_sequence_view& specification);
+        OPEN_STRING_API void format_float(format_sink& sink, const f32& value, const codeunit_sequence_view& specification);
+        OPEN_STRING_API void format_float(format_sink& sink, const f64& value, const codeunit_sequence_view& specification);
+        OPEN_STRING_API void format_raw_bytes(format_sink& sink, const byte* data, u64 size);
     }
     
     template<class Format, class...Args>
     [[nodiscard]] codeunit_sequence format(const Format& format_mold_literal, const Args&...args);
 
+    /**
+     * \brief Formatter of arguments of type T, specializations append value into sink by specification with
+     * static void produce(format_sink& sink, const T& value, const codeunit_sequence_view& specification);
+     * Formatters which return a codeunit_sequence instead are still supported:
+     * static codeunit_sequence produce(const T& value, const codeunit_sequence_view& specification);
+     */
     template<class T, typename=void>
     struct argument_formatter
     {
-        static codeunit_sequence produce(const T& value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const T& value, const codeunit_sequence_view& specification)
         {
-            constexpr u64 size = sizeof(T);
             const auto reader = reinterpret_cast<const byte*>(&value);
-            codeunit_sequence raw;
-            for(u64 i = 0; i < size; ++i)
+            if(specification == "r"_cuqv)   // output raw memory bytes
             {
-                if(!raw.is_empty())
-                    raw += " "_cuqv;
-                const byte memory = reader[i];
-                raw += details::format_integer(static_cast<u64>(memory), "02x"_cuqv);
+                details::format_raw_bytes(sink, reader, sizeof(T));
+                return;
             }
-    
-            if(specification == "r"_cuqv)   // output raw memory bytes
-                return raw;
 
+            codeunit_sequence raw;
+            format_sink raw_sink{ &raw, details::append_to_sequence };
+            details::format_raw_bytes(raw_sink, reader, sizeof(T));
             OPEN_STRING_CHECK(false, "Undefined format with raw memory bytes:{}!", raw);
-            return { };
         }
     };
 
     namespace details
     {
-        class format_mold_view
+        inline constexpr codeunit_set format_braces{ "{}" };
+
+        template<class T, typename=void>
+        struct is_sink_formatter : std::false_type { };
+
+        template<class T>
+        struct is_sink_formatter<T, std::void_t<decltype(argument_formatter<T>::produce(
+            std::declval<format_sink&>(), std::declval<const T&>(), std::declval<const codeunit_sequence_view&>()))>> : std::true_type { };
+
+        template<class T>
+        void produce_argument(format_sink& sink, const T& value, const codeunit_sequence_view& specification)
         {
-        public:
-            // code-region-start: constructors
+            if constexpr (is_sink_formatter<T>::value)
+            {
+                argument_formatter<T>::produce(sink, value, specification);
+            }
+            else
+            {
+                const codeunit_sequence& produced = argument_formatter<T>::produce(value, specification);
+                sink.append(produced.view());
+            }
+        }
 
-            explicit constexpr format_mold_view(codeunit_sequence_view format_mold) noexcept
-                : format_mold_(std::move(format_mold))
+        template <class T>
+        void format_argument_value(format_sink& sink, const void* value, const codeunit_sequence_view& specification)
+        {
+            produce_argument(sink, *static_cast<const T*>(value), specification);
+        }
+
+        struct argument_value_package
+        {
+            using argument_value_formatter_type = void(*)(format_sink& sink, const void* value, const codeunit_sequence_view& specification);
+
+            const void* value;
+            argument_value_formatter_type argument_value_formatter;
+
+            template<class T>
+            explicit constexpr argument_value_package(const T& v) noexcept
+                : value(static_cast<const void*>(&v))
+                , argument_value_formatter(format_argument_value<T>)
             { }
 
-            // code-region-end: constructors
+            void produce(format_sink& sink, const codeunit_sequence_view& specification) const
+            {
+                this->argument_value_formatter(sink, this->value, specification);
+            }
+        };
+    }
+
+    /**
+     * \brief Type-erased arguments of a format call, a view of packages made at the call site by make_format_args,
+     * so the mold is parsed and arguments are looked up by one function compiled in source,
+     * instead of a copy for each list of argument types.
+     */
+    class format_args
+    {
+    public:
+        constexpr format_args(const details::argument_value_package* packages, const u64 size) noexcept
+            : packages_(packages)
+            , size_(size)
+        { }
+
+        [[nodiscard]] constexpr u64 size() const noexcept
+        {
+            return this->size_;
+        }
+
+        [[nodiscard]] constexpr const details::argument_value_package& operator[](const u64 index) const noexcept
+        {
+            return this->packages_[index];
+        }
+
+    private:
+        const details::argument_value_package* packages_;
+        u64 size_;
+    };
 
-            // code-region-start: iterators
+    namespace details
+    {
+        template<u64 N>
+        struct format_argument_store
+        {
+            std::array<argument_value_package, N> packages;
 
-            enum class run_type : u8
+            // Only valid until the end of the full expression which the store is made in.
+            constexpr operator format_args() const noexcept
+            {
+                return { this->packages.data(), N };
+            }
+        };
+    }
+
+    /**
+     * \brief Pack arguments for vformat_to and vformat, arguments are referred to instead of copied.
+     */
+    template<class...Args>
+    [[nodiscard]] constexpr details::format_argument_store<sizeof...(Args)> make_format_args(const Args&...args) noexcept
+    {
+        return { {{ details::argument_value_package{ args } ... }} };
+    }
+
+    /**
+     * \brief Append formatted codeunits into sink, formatting stops at the first error of the mold.
+     */
+    OPEN_STRING_API void vformat_to(format_sink& sink, const codeunit_sequence_view& format_mold, const format_args& arguments);
+
+    /**
+     * \brief Same as format, with arguments packed by make_format_args.
+     */
+    [[nodiscard]] OPEN_STRING_API codeunit_sequence vformat(const codeunit_sequence_view& format_mold, const format_args& arguments);
+
+    namespace details
+    {
+        template<class Format, class...Args>
+        void format_to_sink(format_sink& sink, const Format& format_mold_literal, const Args&...args)
+        {
+            vformat_to(sink, view_sequence(format_mold_literal), make_format_args(args...));
+        }
+    }
+
+    // code-region-start: compiled format
+
+    namespace details
+    {
+        struct format_segment
+        {
+            enum class segment_type : u8
             {
                 plain_text,
-                escaped_brace,
-                formatter,
-                ending
+                argument,
             };
 
-            struct const_iterator
-            {
-                constexpr const_iterator() noexcept = default;
+            segment_type type = segment_type::plain_text;
+            // Range of plain text, or range of specification of an argument, in format mold.
+            u64 from = 0;
+            u64 size = 0;
+            u64 argument_index = 0;
+        };
 
-                explicit constexpr const_iterator(codeunit_sequence_view v) noexcept
-                    : format_mold(std::move(v))
-                { }
+        enum class format_mold_error : u8
+        {
+            none,
+            unclosed_left_brace,
+            unclosed_right_brace,
+            manual_index_mixing_with_automatic,
+            automatic_index_mixing_with_manual,
+            invalid_index,
+        };
 
-                constexpr const_iterator& initialize() noexcept
+        struct format_mold_parse_result
+        {
+            u64 segment_count = 0;
+            // 1 + the largest argument index.
+            u64 argument_count = 0;
+            format_mold_error error = format_mold_error::none;
+        };
+
+        /**
+         * \brief Split format mold into segments by the same rules as vformat_to.
+         * @param segments at least segment_count of the result, or nullptr to count segments only
+         * @param argument_names names which placeholders could refer to arguments by, see prepared_format
+         */
+        [[nodiscard]] constexpr format_mold_parse_result parse_format_mold(const codeunit_sequence_view& format_mold, format_segment* segments,
+            const codeunit_sequence_view* argument_names = nullptr, const u64 argument_name_count = 0) noexcept
+        {
+            format_mold_parse_result result;
+            const auto push = [&result, segments](const format_segment& segment)
+            {
+                if(segments)
+                    segments[result.segment_count] = segment;
+                ++result.segment_count;
+            };
+            bool automatic = false;
+            bool manual = false;
+            u64 next_index = 0;
+            const u64 size = format_mold.size();
+            u64 from = 0;
+            while(from < size)
+            {
+                const u64 index = format_mold.index_of_any(format_braces, from);
+                if(index == global_constant::INDEX_INVALID)
                 {
-                    const auto [ first_type, first_from, first_size ] = this->parse_run(0);
-                    this->type = first_type;
-                    this->from = first_from;
-                    this->size = first_size;
-                    return *this;
+                    push({ format_segment::segment_type::plain_text, from, size - from });
+                    break;
                 }
-
-                [[nodiscard]] constexpr std::tuple<run_type, codeunit_sequence_view> operator*() const noexcept
+                if(index != from)
                 {
-                    return { this->type, this->format_mold.subview(this->from, this->size) };
+                    push({ format_segment::segment_type::plain_text, from, index - from });
+                    from = index;
+                    continue;
                 }
-
-                constexpr const_iterator& operator++()
+                const char brace = format_mold.read_at(index);
+                if(index + 1 < size && format_mold.read_at(index + 1) == brace)
                 {
-                    if(this->from == global_constant::INDEX_INVALID)
-                    {
-                        this->type = run_type::ending;
-                        this->from = global_constant::INDEX_INVALID;
-                        this->size = SIZE_MAX;
-                        return *this;
-                    }
-                    const auto [ next_type, next_from, next_size ] = this->parse_run(this->from + this->size);
-                    this->type = next_type;
-                    this->from = next_from;
-                    this->size = next_size;
-                    return *this;
+                    push({ format_segment::segment_type::plain_text, index, 1 });
+                    from = index + 2;
+                    continue;
                 }
-
-                constexpr const_iterator operator++(int) noexcept
+                if(brace == '}')
                 {
-                    const_iterator tmp = *this;
-                    ++*this;
-                    return tmp;
+                    result.error = format_mold_error::unclosed_right_brace;
+                    return result;
                 }
-
-                [[nodiscard]] constexpr bool operator==(const const_iterator& rhs) const noexcept
+                const u64 index_close = format_mold.index_of_any(format_braces, index + 1);
+                if(index_close == global_constant::INDEX_INVALID || format_mold.read_at(index_close) == '{')
                 {
-                    return this->type == rhs.type && this->from == rhs.from && this->size == rhs.size;
+                    result.error = format_mold_error::unclosed_left_brace;
+                    return result;
                 }
-
-                [[nodiscard]] constexpr bool operator!=(const const_iterator& rhs) const noexcept
+                const codeunit_sequence_view inner = format_mold.subview(index + 1, index_close - index - 1);
+                const u64 colon = inner.index_of(':');
+                const u64 index_size = colon == global_constant::INDEX_INVALID ? inner.size() : colon;
+                u64 current_index = next_index;
+                if(index_size == 0)
                 {
-                    return !(*this == rhs);
+                    if(manual)
+                    {
+                        result.error = format_mold_error::manual_index_mixing_with_automatic;
+                        return result;
+                    }
+                    automatic = true;
+                    ++next_index;
                 }
-
-                struct result_parse_run
+                else if(const char first = inner.read_at(0); first < '0' || first > '9')
                 {
-                    run_type type = run_type::plain_text;
-                    u64 from = global_constant::INDEX_INVALID;
-                    u64 size = SIZE_MAX;
-                };
-                [[nodiscard]] constexpr result_parse_run parse_run(const u64 from_index) const
+                    // A name is not an index of either kind, so it mixes with both.
+                    const codeunit_sequence_view name = inner.subview(0, index_size);
+                    current_index = 0;
+                    while(current_index < argument_name_count && argument_names[current_index] != name)
+                        ++current_index;
+                    if(current_index == argument_name_count)
+                    {
+                        result.error = format_mold_error::invalid_index;
+                        return result;
+                    }
+                }
+                else
                 {
-                    const u64 index = this->format_mold.index_of_any("{}"_cuqv, from_index);
-                    if(index == global_constant::INDEX_INVALID)
+                    if(automatic)
                     {
-                        if(from_index == this->format_mold.size())
-                            return { run_type::ending };
-                        return { run_type::plain_text, from_index, this->format_mold.size() - from_index };
+                        result.error = format_mold_error::automatic_index_mixing_with_manual;
+                        return result;
+                    }
+                    manual = true;
+                    current_index = 0;
+                    for(u64 i = 0; i < index_size; ++i)
+                    {
+                        const char digit = inner.read_at(i);
+                        if(digit < '0' || digit > '9')
+                        {
+                            result.error = format_mold_error::invalid_index;
+                            return result;
+                        }
+                        current_index = current_index * 10 + static_cast<u64>(digit - '0');
                     }
-                    if(from_index != index)
-                        return { run_type::plain_text, from_index, index - from_index };
-                    if(format_mold.read_at(index) == format_mold.read_at(index + 1))
-                        return { run_type::escaped_brace, index, 2 };
-                    OPEN_STRING_CHECK(format_mold.read_at(index) != '}', "Unclosed right brace is not allowed!");
-                    const u64 index_next = this->format_mold.index_of_any("{}"_cuqv, index + 1);
-                    OPEN_STRING_CHECK(index_next != global_constant::INDEX_INVALID && format_mold.read_at(index_next) != '{', "Unclosed left brace is not allowed!");
-                    return { run_type::formatter, index, index_next - index + 1 };
                 }
-            
-                codeunit_sequence_view format_mold;
-                run_type type = run_type::ending;
-                u64 from = global_constant::INDEX_INVALID;
-                u64 size = SIZE_MAX;
-            };
-        
-            [[nodiscard]] constexpr const_iterator begin() const noexcept
-            {
-                return const_iterator{ this->format_mold_ }.initialize();
+                const u64 specification_from = colon == global_constant::INDEX_INVALID ? index_close : index + 1 + colon + 1;
+                push({ format_segment::segment_type::argument, specification_from, index_close - specification_from, current_index });
+                result.argument_count = maximum(result.argument_count, current_index + 1);
+                from = index_close + 1;
             }
+            return result;
+        }
 
-            [[nodiscard]] constexpr const_iterator end() const noexcept
-            {
-                return const_iterator{ this->format_mold_ };
-            }
+        template<u64 N>
+        struct compiled_format_mold
+        {
+            std::array<format_segment, N> segments{ };
+            format_mold_parse_result result{ };
+        };
 
-            [[nodiscard]] constexpr const_iterator cbegin() const noexcept
+        template<u64 N>
+        [[nodiscard]] constexpr compiled_format_mold<N> compile_format_mold(const codeunit_sequence_view& format_mold) noexcept
+        {
+            compiled_format_mold<N> compiled;
+            compiled.result = parse_format_mold(format_mold, compiled.segments.data());
+            return compiled;
+        }
+    }
+
+    /**
+     * \brief A format mold parsed at compile time, see OPEN_STRING_COMPILED_FORMAT.
+     * @tparam Holder type with a static constexpr get() which returns the format mold
+     */
+    template<class Holder>
+    struct compiled_format
+    {
+        static constexpr codeunit_sequence_view format_mold = Holder::get();
+        static constexpr u64 segment_count = details::parse_format_mold(format_mold, nullptr).segment_count;
+        static constexpr details::compiled_format_mold<segment_count> compiled = details::compile_format_mold<segment_count>(format_mold);
+    };
+
+    namespace details
+    {
+        template<class T>
+        struct is_compiled_format : std::false_type { };
+
+        template<class Holder>
+        struct is_compiled_format<compiled_format<Holder>> : std::true_type { };
+
+        template<class Mold, u64 SegmentIndex, class Arguments>
+        void produce_compiled_segment(format_sink& sink, const Arguments& arguments)
+        {
+            constexpr format_segment segment = Mold::compiled.segments[SegmentIndex];
+            constexpr codeunit_sequence_view run = Mold::format_mold.subview(segment.from, segment.size);
+            if constexpr (segment.type == format_segment::segment_type::plain_text)
             {
-                return this->begin();
+                sink.append(run);
             }
-
-            [[nodiscard]] constexpr const_iterator cend() const noexcept
+            else
             {
-                return this->end();
+                using argument_type = std::remove_cv_t<std::remove_reference_t<std::tuple_element_t<segment.argument_index, Arguments>>>;
+                produce_argument<argument_type>(sink, std::get<segment.argument_index>(arguments), run);
             }
+        }
 
-            // code-region-end: iterators
-    
-        private:
-            codeunit_sequence_view format_mold_{ };
-        };
-
-        template <class T>
-        codeunit_sequence format_argument_value(const void* value, const codeunit_sequence_view specification)
+        template<class Mold, class Arguments, u64...SegmentIndices>
+        void produce_compiled_format(format_sink& sink, const Arguments& arguments, std::index_sequence<SegmentIndices...>)
         {
-            return argument_formatter<T>::produce(*static_cast<const T*>(value), specification);
+            (produce_compiled_segment<Mold, SegmentIndices>(sink, arguments), ...);
         }
 
-        struct argument_value_package
+        /**
+         * \brief Format with a mold parsed at compile time, so errors of the mold are compile errors,
+         * and arguments are produced without looking up indices at runtime.
+         */
+        template<class Holder, class...Args>
+        void format_to_sink(format_sink& sink, const compiled_format<Holder>&, const Args&...args)
         {
-            using argument_value_formatter_type = codeunit_sequence(*)(const void* value, codeunit_sequence_view specification);
+            using mold = compiled_format<Holder>;
+            constexpr format_mold_parse_result parsed = mold::compiled.result;
+            static_assert(parsed.error != format_mold_error::unclosed_left_brace, "Unclosed left brace is not allowed!");
+            static_assert(parsed.error != format_mold_error::unclosed_right_brace, "Unclosed right brace is not allowed!");
+            static_assert(parsed.error != format_mold_error::manual_index_mixing_with_automatic, "Manual index is not allowed mixing with automatic index!");
+            static_assert(parsed.error != format_mold_error::automatic_index_mixing_with_manual, "Automatic index is not allowed mixing with manual index!");
+            static_assert(parsed.error != format_mold_error::invalid_index, "Invalid format index!");
+            static_assert(parsed.argument_count <= sizeof...(Args), "Invalid format index: Index should be less than count of argument!");
+            if constexpr (parsed.error == format_mold_error::none && parsed.argument_count <= sizeof...(Args))
+                produce_compiled_format<mold>(sink, std::forward_as_tuple(args...), std::make_index_sequence<mold::segment_count>{ });
+        }
+    }
 
-            const void* value;
-            argument_value_formatter_type argument_value_formatter;
+    // code-region-end: compiled format
 
-            template<class T>
-            explicit constexpr argument_value_package(const T& v) noexcept
-                : value(static_cast<const void*>(&v))
-                , argument_value_formatter(format_argument_value<T>)
-            { }
+    // code-region-start: prepared format
 
-            [[nodiscard]] codeunit_sequence produce(const codeunit_sequence_view& specification) const
-            {
-                return this->argument_value_formatter(this->value, specification);
-            }
-        };
+    /**
+     * \brief A format mold parsed once at runtime, for molds loaded from data such as localized texts, to be passed to ostr::format.
+     * Besides indices, a placeholder could refer to an argument by name, as {player} or {player:>8},
+     * which is the argument at the position of the name in argument_names.
+     * Plain texts are unescaped and merged at preparation, so formatting only appends runs and produces arguments.
+     * Formatting does not modify it, so one could be shared by threads.
+     */
+    class OPEN_STRING_API prepared_format
+    {
+    public:
+        explicit prepared_format(const codeunit_sequence_view& format_mold, const std::vector<codeunit_sequence_view>& argument_names = { });
+
+        [[nodiscard]] bool is_valid() const noexcept;
+        [[nodiscard]] details::format_mold_error get_error() const noexcept;
+
+        /**
+         * @return How many arguments formatting takes at least.
+         */
+        [[nodiscard]] u64 get_argument_count() const noexcept;
+
+        /**
+         * \brief Nothing is produced if the mold is invalid or there are not enough arguments.
+         */
+        void produce(format_sink& sink, const format_args& arguments) const;
+
+    private:
+        // Unescaped plain texts and specifications, which segments refer to.
+        codeunit_sequence text_;
+        std::vector<details::format_segment> segments_;
+        u64 argument_count_ = 0;
+        details::format_mold_error error_ = details::format_mold_error::none;
+    };
+
+    /**
+     * \brief Same as format, with arguments packed by make_format_args.
+     */
+    [[nodiscard]] OPEN_STRING_API codeunit_sequence vformat(const prepared_format& format_mold, const format_args& arguments);
 
+    namespace details
+    {
         template<class...Args>
-        codeunit_sequence produce_format(const format_mold_view& format_mold, const Args&...args)
+        void format_to_sink(format_sink& sink, const prepared_format& format_mold, const Args&...args)
         {
-            constexpr u64 argument_count = sizeof...(Args);
-            const std::array<argument_value_package, argument_count> arguments {{ argument_value_package{ args } ... }};
-
-            enum class indexing_type : u8
-            {
-                unknown,
-                manual,
-                automatic
-            };
-            indexing_type index_type = indexing_type::unknown;
-            u64 next_index = 0;
-            codeunit_sequence result;
-            for(const auto [ type, run ] : format_mold)
-            {
-                switch (type) 
-                {
-                case format_mold_view::run_type::plain_text:
-                    result += run;
-                    break;
-                case format_mold_view::run_type::escaped_brace:
-                    result += run.read_at(0);
-                    break;
-                case format_mold_view::run_type::formatter:
-                    {    
-                        const auto [ index_run, specification ] = run.subview(1, run.size() - 2).split(":"_cuqv);
-                        u64 current_index = next_index;
-                        if (index_run.is_empty())
-                        {
-                            OPEN_STRING_CHECK(index_type != indexing_type::manual, "Manual index is not allowed mixing with automatic index!");
-                            index_type = indexing_type::automatic;
-                            ++next_index;
-                        }
-                        else
-                        {
-                            OPEN_STRING_CHECK(index_type != indexing_type::automatic, "Automatic index is not allowed mixing with manual index!");
-                            index_type = indexing_type::manual;
-                            [[maybe_unused]] const auto [ last, error ] = 
-                                std::from_chars(index_run.data(), index_run.cend().data(), current_index);
-                            OPEN_STRING_CHECK(last == index_run.cend().data(), "Invalid format index [{}]!", index_run);
-                        }
-                        OPEN_STRING_CHECK(current_index < argument_count, "Invalid format index [{}]: Index should be less than count of argument [{}]!", current_index, argument_count);
-                        result += arguments[current_index].produce(specification);
-                    }
-                    break;
-                case format_mold_view::run_type::ending:
-                    // Unreachable
-                    break;
-                }
-            }
-            return result;
+            format_mold.produce(sink, make_format_args(args...));
         }
     }
 
+    // code-region-end: prepared format
+
+    // code-region-start: format entries
+
+    /**
+     * \brief Append formatted codeunits to the end of destination.
+     * @param format_mold_literal a string, a view, or a mold made by OPEN_STRING_COMPILED_FORMAT
+     */
+    template<class Format, class...Args>
+    void format_to(codeunit_sequence& destination, const Format& format_mold_literal, const Args&...args)
+    {
+        format_sink sink{ &destination, details::append_to_sequence };
+        details::format_to_sink(sink, format_mold_literal, args...);
+    }
+
+    struct format_to_result
+    {
+        // Past the last codeunit written.
+        char* last;
+        // How many codeunits the whole result takes, which is larger than the buffer if truncated.
+        u64 size;
+    };
+
+    /**
+     * \brief Write formatted codeunits into [buffer, buffer + size), the result is truncated if the buffer is not large enough,
+     * and is not terminated by '\0'.
+     */
+    template<class Format, class...Args>
+    format_to_result format_to(char* buffer, const u64 size, const Format& format_mold_literal, const Args&...args)
+    {
+        details::fixed_buffer destination{ buffer, size, 0 };
+        format_sink sink{ &destination, details::append_to_fixed_buffer };
+        details::format_to_sink(sink, format_mold_literal, args...);
+        return { buffer + destination.written, sink.size() };
+    }
+
+    /**
+     * \brief Write formatted codeunits through an output iterator of char, such as std::back_inserter.
+     * @return Past the last codeunit written.
+     */
+    template<class OutputIt, class Format, class...Args, 
+        typename = std::enable_if_t<!std::is_same_v<OutputIt, codeunit_sequence> && !std::is_integral_v<Format>>>
+    OutputIt format_to(OutputIt out, const Format& format_mold_literal, const Args&...args)
+    {
+        format_sink sink{ &out, details::append_to_iterator<OutputIt> };
+        details::format_to_sink(sink, format_mold_literal, args...);
+        return out;
+    }
+
+    /**
+     * @return How many codeunits the formatted result takes, nothing is written.
+     */
+    template<class Format, class...Args>
+    [[nodiscard]] u64 formatted_size(const Format& format_mold_literal, const Args&...args)
+    {
+        format_sink sink{ nullptr, details::append_to_nothing };
+        details::format_to_sink(sink, format_mold_literal, args...);
+        return sink.size();
+    }
+
+    namespace details
+    {
+        // Results up to this size are formatted only once.
+        inline constexpr u64 FORMAT_STACK_BUFFER_SIZE = 256;
+    }
+
+    /**
+     * \brief The result is allocated exactly once, or not at all if it is short enough.
+     * It is formatted into a stack buffer first, which measures it as well,
+     * then only results larger than the buffer are formatted again into the allocated sequence.
+     * Only compiled molds are formatted by code generated here, others go through vformat.
+     */
     template<class Format, class...Args>
     [[nodiscard]] codeunit_sequence format(const Format& format_mold_literal, const Args&...args)
     {
-        return details::produce_format(details::format_mold_view{ details::view_sequence(format_mold_literal) }, args...);
+        if constexpr (details::is_compiled_format<Format>::value)
+        {
+            std::array<char, details::FORMAT_STACK_BUFFER_SIZE> buffer;
+            const format_to_result fitted = format_to(buffer.data(), buffer.size(), format_mold_literal, args...);
+            if(fitted.size <= buffer.size())
+                return codeunit_sequence{ buffer.data(), fitted.size };
+            codeunit_sequence result(fitted.size);
+            format_to(result, format_mold_literal, args...);
+            return result;
+        }
+        else if constexpr (std::is_same_v<Format, prepared_format>)
+        {
+            return vformat(format_mold_literal, make_format_args(args...));
+        }
+        else
+        {
+            return vformat(details::view_sequence(format_mold_literal), make_format_args(args...));
+        }
     }
 
+    // code-region-end: format entries
+
     // code-region-start: formatter specializations for built-in types
 
     template<class T>
     struct argument_formatter<T, std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>>>
     {
-        static codeunit_sequence produce(const T& value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const T& value, const codeunit_sequence_view& specification)
         {
-            return details::format_integer(static_cast<i64>(value), specification);
+            details::format_integer(sink, static_cast<i64>(value), specification);
         }
     };
 
     template<class T>
     struct argument_formatter<T, std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T>>>
     {
-        static codeunit_sequence produce(const T& value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const T& value, const codeunit_sequence_view& specification)
         {
-            return details::format_integer(static_cast<u64>(value), specification);
+            details::format_integer(sink, static_cast<u64>(value), specification);
         }
     };
 
+    /**
+     * Specification is [.precision][a|e|f|g], and without a type a precision means digits after the dot.
+     * Without either, the shortest representation which reads back to the same value.
+     */
     template<class T> 
     struct argument_formatter<T, std::enable_if_t<std::is_floating_point_v<T>>>
     {
-        static codeunit_sequence produce(const T& value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const T& value, const codeunit_sequence_view& specification)
         {
-            return details::format_float(static_cast<f64>(value), specification);
+            // f32 is kept, so its shortest representation is not the one of the widened f64.
+            if constexpr (std::is_same_v<T, f32>)
+                details::format_float(sink, value, specification);
+            else
+                details::format_float(sink, static_cast<f64>(value), specification);
         }
     };
 
     template<> 
     struct argument_formatter<const char*>
     {
-        static codeunit_sequence produce(const char* value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const char* value, const codeunit_sequence_view& specification)
         {
-            return codeunit_sequence{value};
+            sink.append(codeunit_sequence_view{ value });
         }
     };
 
     template<size_t N> 
     struct argument_formatter<char[N]>
     {
-        static codeunit_sequence produce(const char (&value)[N], const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const char (&value)[N], const codeunit_sequence_view& specification)
         {
-            return codeunit_sequence{value};
+            sink.append(codeunit_sequence_view{ value });
         }
     };
 
     template<> 
     struct argument_formatter<codeunit_sequence_view>
     {
-        static codeunit_sequence produce(const codeunit_sequence_view& value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const codeunit_sequence_view& value, const codeunit_sequence_view& specification)
         {
-            return codeunit_sequence{value};
+            sink.append(value);
         }
     };
 
     template<> 
     struct argument_formatter<codeunit_sequence>
     {
-        static const codeunit_sequence& produce(const codeunit_sequence& value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const codeunit_sequence& value, const codeunit_sequence_view& specification)
         {
-            return value;
+            sink.append(value.view());
         }
     };
 
     template<>
     struct argument_formatter<std::nullptr_t>
     {
-        static codeunit_sequence produce(std::nullptr_t, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, std::nullptr_t, const codeunit_sequence_view& specification)
         {
-            return codeunit_sequence{"nullptr"_cuqv};
+            sink.append("nullptr"_cuqv);
         }
     };
 
     template<class T> 
     struct argument_formatter<T*>
     {
-        static codeunit_sequence produce(const T* value, const codeunit_sequence_view& specification)
+        static void produce(format_sink& sink, const T* value, const codeunit_sequence_view& specification)
         {
-            return details::format_integer(reinterpret_cast<i64>(value), "#016x"_cuqv);
+            details::format_integer(sink, reinterpret_cast<i64>(value), "#016x"_cuqv);
         }
     };
 
     // code-region-end: formatter specializations for built-in types
 }
+
+/**
+ * \brief Make a format mold parsed at compile time from a string literal, to be passed to ostr::format.
+ * e.g. ostr::format(OPEN_STRING_COMPILED_FORMAT("{} + {} = {}"), 1, 2, 3)
+ */
+#define OPEN_STRING_COMPILED_FORMAT(format_mold_literal)	\
+	[]	\
+	{	\
+		struct format_mold_holder	\
+		{	\
+			[[nodiscard]] static constexpr ::ostr::codeunit_sequence_view get() noexcept	\
+			{	\
+				return ::ostr::codeunit_sequence_view{ format_mold_literal };	\
+			}	\
+		};	\
+		return ::ostr::compiled_format<format_mold_holder>{ };	\
+	}()
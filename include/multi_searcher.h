@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "codeunit_sequence.h"
+
+namespace ostr
+{
+	/**
+	 * \brief Aho-Corasick automaton searching many patterns in one pass over codeunits.
+	 * Failure links are resolved at construction, so every codeunit costs exactly one table lookup.
+	 * Codeunits not used by any pattern share one column of the table, which keeps rows short.
+	 */
+	class OPEN_STRING_API multi_searcher
+	{
+	public:
+
+		struct match
+		{
+			u64 index;		// index of the first codeunit of match
+			u64 size;
+			u32 pattern;	// index of pattern in the list given at construction
+
+			[[nodiscard]] bool operator==(const match& rhs) const noexcept
+			{
+				return this->index == rhs.index && this->size == rhs.size && this->pattern == rhs.pattern;
+			}
+		};
+
+		/**
+		 * @param patterns Patterns to search, empty ones are ignored.
+		 * A pattern equal to an earlier one is always reported as the earlier one.
+		 * @param ignore_case Whether ASCII letters match regardless of case, other codeunits are always matched exactly.
+		 */
+		explicit multi_searcher(const std::vector<codeunit_sequence_view>& patterns, bool ignore_case = false);
+
+		/**
+		 * \brief Collect all matches including overlapping ones, ordered by where they end,
+		 * and longer ones first among those ending at the same codeunit.
+		 * @return How many matches are found.
+		 */
+		u64 find_all(const codeunit_sequence_view& text, std::vector<match>& matches) const;
+
+		/**
+		 * @return Whether any pattern is in text, stops at the first match.
+		 */
+		[[nodiscard]] bool contains_any(const codeunit_sequence_view& text) const noexcept;
+
+		/**
+		 * \brief Overwrite every codeunit covered by any match with mask, the size of target is kept.
+		 * @return How many matches are found.
+		 */
+		u64 replace_all(codeunit_sequence& target, char mask = '*') const noexcept;
+
+	private:
+
+		static constexpr u32 STATE_INVALID = std::numeric_limits<u32>::max();
+
+		// Input class of each codeunit, which is the column in transition table.
+		std::array<u16, 256> classes_{ };
+		u32 stride_ = 1;
+		// Transitions are stored as offsets of target rows, namely state * stride_.
+		std::vector<u32> transitions_;
+		u32 start_ = 0;
+		// States are numbered so that those with any output come last, offsets not less than this have output.
+		u32 first_output_offset_ = 0;
+		// Indexed by state, the pattern ending at state, or STATE_INVALID.
+		std::vector<u32> state_patterns_;
+		// Indexed by state, the next state along failure links which has a pattern, or STATE_INVALID.
+		std::vector<u32> output_links_;
+		std::vector<u64> pattern_sizes_;
+	};
+}
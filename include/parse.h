@@ -0,0 +1,81 @@
+#pragma once
+#include "common/definitions.h"
+
+#include <limits>
+#include <type_traits>
+#include "codeunit_sequence_view.h"
+
+namespace ostr
+{
+	enum class parse_error : u8
+	{
+		none,
+		// No number at the beginning.
+		invalid,
+		// The number does not fit in the type, all of its codeunits are consumed anyway.
+		out_of_range,
+	};
+
+	template<class T>
+	struct parse_result
+	{
+		T value{ };
+		// How many codeunits the number takes from the beginning, 0 if invalid.
+		u64 size = 0;
+		parse_error error = parse_error::invalid;
+
+		[[nodiscard]] constexpr bool is_valid() const noexcept
+		{
+			return this->error == parse_error::none;
+		}
+	};
+
+	namespace details
+	{
+		OPEN_STRING_API parse_result<u64> parse_unsigned(const char* data, u64 size, u32 base, u64 maximum) noexcept;
+		OPEN_STRING_API parse_result<i64> parse_signed(const char* data, u64 size, u32 base, i64 minimum, i64 maximum) noexcept;
+		OPEN_STRING_API parse_result<f32> parse_f32(const char* data, u64 size) noexcept;
+		OPEN_STRING_API parse_result<f64> parse_f64(const char* data, u64 size) noexcept;
+	}
+
+	/**
+	 * \brief Parse an integer at the beginning of view, as [+|-]digits, where '-' is only for signed types.
+	 * Decimal digits are converted eight at a time, and overflow is detected exactly.
+	 * Example: parse<u8>("255,256"_cuqv) == { 255, 3 }
+	 * @param base 2 to 36, digits beyond 9 are letters of either case, no prefix is consumed, other bases are invalid
+	 */
+	template<class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+	[[nodiscard]] parse_result<T> parse(const codeunit_sequence_view& view, const u32 base = 10) noexcept
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			const parse_result<i64> result = details::parse_signed(view.data(), view.size(), base, std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+			return { static_cast<T>(result.value), result.size, result.error };
+		}
+		else
+		{
+			const parse_result<u64> result = details::parse_unsigned(view.data(), view.size(), base, std::numeric_limits<T>::max());
+			return { static_cast<T>(result.value), result.size, result.error };
+		}
+	}
+
+	/**
+	 * \brief Parse a decimal floating point number at the beginning of view, as [+|-]digits[.digits][(e|E)[+|-]digits],
+	 * or inf, infinity and nan of any case. The result is correctly rounded by Eisel-Lemire algorithm,
+	 * and by comparing big integers when more than 19 significant digits decide the rounding.
+	 * Values beyond the type are out of range, and they are parsed as infinity or zero.
+	 */
+	template<class T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+	[[nodiscard]] parse_result<T> parse(const codeunit_sequence_view& view) noexcept
+	{
+		if constexpr (std::is_same_v<T, f32>)
+		{
+			return details::parse_f32(view.data(), view.size());
+		}
+		else
+		{
+			const parse_result<f64> result = details::parse_f64(view.data(), view.size());
+			return { static_cast<T>(result.value), result.size, result.error };
+		}
+	}
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "format.h"
+
+namespace ostr
+{
+	/**
+	 * \brief Buffer which formatted codeunits are appended to, and written out to a file descriptor or a FILE* once it is full,
+	 * so lines are batched into few writes, and the buffer is reused instead of allocating a sequence for each line.
+	 * Appending more than the buffer holds writes the buffer and the rest at once, without copying the rest.
+	 * Whatever is left is written on destruction.
+	 */
+	class OPEN_STRING_API buffered_writer
+	{
+	public:
+		static constexpr u64 DEFAULT_CAPACITY = 16 * 1024;
+
+		/**
+		 * \brief The buffer is allocated once here.
+		 */
+		explicit buffered_writer(int file_descriptor, u64 capacity = DEFAULT_CAPACITY);
+		explicit buffered_writer(std::FILE* file, u64 capacity = DEFAULT_CAPACITY);
+
+		/**
+		 * \brief Nothing is allocated, buffer must outlive the writer.
+		 */
+		buffered_writer(int file_descriptor, char* buffer, u64 capacity) noexcept;
+		buffered_writer(std::FILE* file, char* buffer, u64 capacity) noexcept;
+
+		buffered_writer(const buffered_writer&) = delete;
+		buffered_writer(buffered_writer&&) noexcept = delete;
+		buffered_writer& operator=(const buffered_writer&) = delete;
+		buffered_writer& operator=(buffered_writer&&) noexcept = delete;
+		~buffered_writer();
+
+		void append(const codeunit_sequence_view& view)
+		{
+			append_to_writer(this, view.data(), view.size());
+		}
+
+		/**
+		 * \brief Write out what is buffered, for a FILE* it is handed over to the buffer of the file, which is not flushed.
+		 * @return Whether everything appended so far is written.
+		 */
+		bool flush();
+
+		/**
+		 * @return Whether any write has failed, what failed to be written is discarded.
+		 */
+		[[nodiscard]] bool has_failed() const noexcept;
+
+		[[nodiscard]] u64 size() const noexcept;
+		[[nodiscard]] u64 capacity() const noexcept;
+
+		[[nodiscard]] format_sink get_sink() noexcept
+		{
+			return { this, append_to_writer };
+		}
+
+	private:
+		static void append_to_writer(void* destination, const char* data, const u64 size)
+		{
+			buffered_writer& writer = *static_cast<buffered_writer*>(destination);
+			if(size <= writer.capacity_ - writer.size_)
+			{
+				std::memcpy(writer.buffer_ + writer.size_, data, size);
+				writer.size_ += size;
+				return;
+			}
+			writer.spill(data, size);
+		}
+
+		/**
+		 * \brief Append what the buffer could not hold.
+		 */
+		void spill(const char* data, u64 size);
+
+		/**
+		 * \brief Write the buffer followed by data.
+		 */
+		bool write(const char* data, u64 size);
+
+		std::unique_ptr<char[]> storage_;
+		char* buffer_;
+		u64 capacity_;
+		u64 size_ = 0;
+		std::FILE* file_ = nullptr;
+		int file_descriptor_ = -1;
+		bool failed_ = false;
+	};
+
+	namespace details
+	{
+		// Lines up to this size are written by one call of print.
+		inline constexpr u64 PRINT_STACK_BUFFER_SIZE = 1024;
+
+		template<class Destination, class Format, class...Args>
+		bool print_through_stack_buffer(Destination destination, const bool new_line, const Format& format_mold_literal, const Args&...args)
+		{
+			std::array<char, PRINT_STACK_BUFFER_SIZE> buffer;
+			buffered_writer writer{ destination, buffer.data(), buffer.size() };
+			format_sink sink = writer.get_sink();
+			format_to_sink(sink, format_mold_literal, args...);
+			if(new_line)
+				sink.append('\n');
+			return writer.flush();
+		}
+	}
+
+	/**
+	 * \brief Append formatted codeunits to writer, which writes them out in batches.
+	 * @param format_mold_literal a string, a view, a prepared_format, or a mold made by OPEN_STRING_COMPILED_FORMAT
+	 */
+	template<class Format, class...Args>
+	void print(buffered_writer& writer, const Format& format_mold_literal, const Args&...args)
+	{
+		format_sink sink = writer.get_sink();
+		details::format_to_sink(sink, format_mold_literal, args...);
+	}
+
+	template<class Format, class...Args>
+	void println(buffered_writer& writer, const Format& format_mold_literal, const Args&...args)
+	{
+		format_sink sink = writer.get_sink();
+		details::format_to_sink(sink, format_mold_literal, args...);
+		sink.append('\n');
+	}
+
+	/**
+	 * \brief Format into a stack buffer and write it out, nothing is allocated.
+	 * Results which fit in the buffer are written by one call, so they are not interleaved with prints of other threads.
+	 * @return Whether everything is written.
+	 */
+	template<class Format, class...Args>
+	bool print(const int file_descriptor, const Format& format_mold_literal, const Args&...args)
+	{
+		return details::print_through_stack_buffer(file_descriptor, false, format_mold_literal, args...);
+	}
+
+	template<class Format, class...Args>
+	bool println(const int file_descriptor, const Format& format_mold_literal, const Args&...args)
+	{
+		return details::print_through_stack_buffer(file_descriptor, true, format_mold_literal, args...);
+	}
+
+	template<class Format, class...Args>
+	bool print(std::FILE* file, const Format& format_mold_literal, const Args&...args)
+	{
+		return details::print_through_stack_buffer(file, false, format_mold_literal, args...);
+	}
+
+	template<class Format, class...Args>
+	bool println(std::FILE* file, const Format& format_mold_literal, const Args&...args)
+	{
+		return details::print_through_stack_buffer(file, true, format_mold_literal, args...);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "codeunit_sequence.h"
+#include "common/simd.h"
+
+namespace ostr
+{
+	/**
+	 * \brief A pattern prepared once, to be searched in many haystacks.
+	 * Preparing picks the rarest codeunits of pattern for the vector filter,
+	 * and builds the bad codeunit table and factorization of two-way search,
+	 * which codeunit_sequence_view::index_of has to skip or redo on each call.
+	 */
+	class OPEN_STRING_API searcher
+	{
+	public:
+
+		explicit searcher(const codeunit_sequence_view& pattern) noexcept;
+
+		[[nodiscard]] codeunit_sequence_view pattern() const noexcept;
+
+		/**
+		 * @param haystack where to search
+		 * @param from start index to search
+		 * @return index of the first pattern in haystack, return global_constant::INDEX_INVALID if not found or pattern is empty
+		 */
+		[[nodiscard]] u64 find(const codeunit_sequence_view& haystack, u64 from = 0) const noexcept;
+
+		/**
+		 * \brief Collect indices of non-overlapping patterns in haystack, from the first one.
+		 * @return How many patterns are found.
+		 */
+		u64 find_all(const codeunit_sequence_view& haystack, std::vector<u64>& indices) const;
+
+		/**
+		 * @return How many non-overlapping patterns are in haystack.
+		 */
+		[[nodiscard]] u64 count(const codeunit_sequence_view& haystack) const noexcept;
+
+		/**
+		 * \brief Replace all patterns in target with destination.
+		 * Unlike codeunit_sequence::replace, target is searched only once.
+		 * @return ref of target
+		 */
+		codeunit_sequence& replace(codeunit_sequence& target, const codeunit_sequence_view& destination) const;
+
+	private:
+
+		/**
+		 * \brief Same as find, with view of pattern_ fetched by caller, which is not free for a codeunit_sequence.
+		 */
+		[[nodiscard]] u64 find_prepared(const codeunit_sequence_view& pattern, const codeunit_sequence_view& haystack, u64 from) const noexcept;
+
+		codeunit_sequence pattern_;
+		simd::substring_table table_;
+	};
+}
@@ -1,7 +1,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <optional>
 #include "text_view.h"
+#include "codepoint_index.h"
 #include "codeunit_sequence.h"
 #include "common/sequence.h"
 
@@ -24,6 +27,17 @@ namespace ostr
 		text(const codeunit_sequence_view& sequence) noexcept;
 
 		static text from_utf8(const char* string_utf8) noexcept;
+
+		/**
+		 * \brief Validate untrusted input, and count its codepoints in the same pass.
+		 * @return Nothing if string_utf8 is not well-formed utf-8, see text_view::first_invalid_offset.
+		 */
+		static std::optional<text> from_utf8_checked(const codeunit_sequence_view& string_utf8) noexcept;
+
+		/**
+		 * \brief Replace each maximal subpart of ill-formed sequences in string_utf8 with U+FFFD, see unicode::parse_invalid_utf8_length.
+		 */
+		static text from_utf8_repaired(const codeunit_sequence_view& string_utf8) noexcept;
 		static text from_utf16(const char16_t* string_utf16) noexcept;
 		static text from_utf32(const char32_t* string_utf32) noexcept;
 		static text from_wide(const wchar_t* wide_string) noexcept;
@@ -88,15 +102,40 @@ namespace ostr
 
 		// code-region-end: iterator
 
+		/**
+		 * \brief Cached codepoint index is dropped here,
+		 * so do not keep the returned reference across calls of other methods of this text.
+		 */
 		[[nodiscard]] codeunit_sequence& raw() & noexcept;
 		[[nodiscard]] const codeunit_sequence& raw() const& noexcept;
 		[[nodiscard]] codeunit_sequence raw() && noexcept;
 	
 		[[nodiscard]] text_view view() const noexcept;
 
+		/**
+		 * @return Count of codepoints, which is cached and kept up to date by mutations.
+		 */
 		[[nodiscard]] u64 size() const noexcept;
 		[[nodiscard]] bool is_empty() const noexcept;
 
+		/**
+		 * @return Whether all codeunits are ascii, which is cached like size.
+		 */
+		[[nodiscard]] bool is_ascii() const noexcept;
+
+		// code-region-start: index conversions
+
+		// All indices are the same in ascii texts, so they are converted directly.
+		// Otherwise long texts build a codepoint_index at the first call of any codepoint indexed method,
+		// which is dropped by any mutation. See codepoint_index.
+
+		[[nodiscard]] u64 get_codepoint_index(u64 codeunit_index) const noexcept;
+		[[nodiscard]] u64 get_codeunit_index(u64 codepoint_index) const noexcept;
+		[[nodiscard]] u64 get_utf16_index(u64 codepoint_index) const noexcept;
+		[[nodiscard]] u64 get_codepoint_index_from_utf16(u64 utf16_index) const noexcept;
+
+		// code-region-end: index conversions
+
 		[[nodiscard]] bool operator==(const text_view& rhs) const noexcept;
 		[[nodiscard]] bool operator==(const text& rhs) const noexcept;
 		[[nodiscard]] bool operator==(const char* rhs) const noexcept;
@@ -104,6 +143,24 @@ namespace ostr
 		[[nodiscard]] bool operator!=(const text& rhs) const noexcept;
 		[[nodiscard]] bool operator!=(const char* rhs) const noexcept;
 
+		/**
+		 * @return Negative if this is ordered before rhs, positive if after, 0 if they are equal.
+		 * See text_view::compare.
+		 */
+		[[nodiscard]] i32 compare(const text_view& rhs) const noexcept;
+		[[nodiscard]] bool operator<(const text_view& rhs) const noexcept;
+		[[nodiscard]] bool operator<(const text& rhs) const noexcept;
+		[[nodiscard]] bool operator<(const char* rhs) const noexcept;
+		[[nodiscard]] bool operator<=(const text_view& rhs) const noexcept;
+		[[nodiscard]] bool operator<=(const text& rhs) const noexcept;
+		[[nodiscard]] bool operator<=(const char* rhs) const noexcept;
+		[[nodiscard]] bool operator>(const text_view& rhs) const noexcept;
+		[[nodiscard]] bool operator>(const text& rhs) const noexcept;
+		[[nodiscard]] bool operator>(const char* rhs) const noexcept;
+		[[nodiscard]] bool operator>=(const text_view& rhs) const noexcept;
+		[[nodiscard]] bool operator>=(const text& rhs) const noexcept;
+		[[nodiscard]] bool operator>=(const char* rhs) const noexcept;
+
 		text& append(const text_view& rhs) noexcept;
 		text& append(const text& rhs) noexcept;
 		text& append(const codepoint& cp) noexcept;
@@ -167,7 +224,35 @@ namespace ostr
 
 	private:
 
+		text(codeunit_sequence sequence, u64 metadata) noexcept;
+
+		/**
+		 * @return Index of sequence_ built at the first call, or nullptr if sequence_ is too short to be worth it.
+		 */
+		[[nodiscard]] const codepoint_index* get_index() const noexcept;
+		void reset_index() noexcept;
+
+		/**
+		 * @return Metadata of sequence_, which is computed again here if it is unknown.
+		 */
+		[[nodiscard]] u64 get_metadata() const noexcept;
+
+		/**
+		 * \brief Update metadata once a range of sequence_ is replaced.
+		 * @param previous metadata of sequence_ before the replacement
+		 * @param removed metadata of the removed codeunits
+		 * @param inserted metadata of the inserted codeunits
+		 */
+		void update_metadata(u64 previous, u64 removed, u64 inserted) noexcept;
+
+		void get_codeunit_range(u64& from, u64& size) const noexcept;
+
 		codeunit_sequence sequence_{ };
+		// Built by const methods, so it is published atomically for concurrent readers.
+		mutable std::atomic<codepoint_index*> index_{ nullptr };
+		// Count of codepoints with the highest bit set if all codeunits are ascii, or SIZE_INVALID if unknown.
+		// Every mutation updates it, except raw() & which leaves it unknown until the next query.
+		mutable std::atomic<u64> metadata_{ global_constant::SIZE_INVALID };
 	
 	};
 
@@ -198,22 +283,26 @@ namespace ostr
 	}
 
 	OPEN_STRING_API [[nodiscard]] bool operator==(const text_view& lhs, const text& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator<(const text_view& lhs, const text& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator<=(const text_view& lhs, const text& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator>(const text_view& lhs, const text& rhs) noexcept;
+	OPEN_STRING_API [[nodiscard]] bool operator>=(const text_view& lhs, const text& rhs) noexcept;
 
 	template<> 
 	struct argument_formatter<text_view>
 	{
-		static codeunit_sequence produce(const text_view& value, const codeunit_sequence_view& specification)
+		static void produce(format_sink& sink, const text_view& value, const codeunit_sequence_view& specification)
 		{
-			return codeunit_sequence{ value.raw() };
+			sink.append(value.raw());
 		}
 	};
 
 	template<> 
 	struct argument_formatter<text>
 	{
-		static codeunit_sequence produce(const text& value, const codeunit_sequence_view& specification)
+		static void produce(format_sink& sink, const text& value, const codeunit_sequence_view& specification)
 		{
-			return value.raw();
+			sink.append(value.view().raw());
 		}
 	};
 }
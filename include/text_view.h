@@ -4,6 +4,7 @@
 
 #include <optional>
 #include "codeunit_sequence_view.h"
+#include "parse.h"
 
 namespace ostr
 {
@@ -217,6 +218,55 @@ namespace ostr
 			return this->view_ != rhs;
 		}
 
+		/**
+		 * @return Negative if this is ordered before rhs, positive if after, 0 if they are equal.
+		 * Codeunits are compared as unsigned bytes, which orders valid utf-8 by codepoints.
+		 */
+		[[nodiscard]] constexpr i32 compare(const text_view& rhs) const noexcept
+		{
+			return this->view_.compare(rhs.view_);
+		}
+
+		[[nodiscard]] constexpr bool operator<(const text_view& rhs) const noexcept
+		{
+			return this->view_ < rhs.view_;
+		}
+
+		[[nodiscard]] constexpr bool operator<(const char* rhs) const noexcept
+		{
+			return this->view_ < rhs;
+		}
+
+		[[nodiscard]] constexpr bool operator<=(const text_view& rhs) const noexcept
+		{
+			return this->view_ <= rhs.view_;
+		}
+
+		[[nodiscard]] constexpr bool operator<=(const char* rhs) const noexcept
+		{
+			return this->view_ <= rhs;
+		}
+
+		[[nodiscard]] constexpr bool operator>(const text_view& rhs) const noexcept
+		{
+			return this->view_ > rhs.view_;
+		}
+
+		[[nodiscard]] constexpr bool operator>(const char* rhs) const noexcept
+		{
+			return this->view_ > rhs;
+		}
+
+		[[nodiscard]] constexpr bool operator>=(const text_view& rhs) const noexcept
+		{
+			return this->view_ >= rhs.view_;
+		}
+
+		[[nodiscard]] constexpr bool operator>=(const char* rhs) const noexcept
+		{
+			return this->view_ >= rhs;
+		}
+
 		[[nodiscard]] constexpr u64 size() const noexcept
 		{
 			return this->get_codepoint_index( this->view_.size() );
@@ -363,33 +413,106 @@ namespace ostr
 			return this->trim_start(text_set).trim_end(text_set);
 		}
 
+		/**
+		 * @return Count of codepoints which start before codeunit_index.
+		 */
 		[[nodiscard]] constexpr u64 get_codepoint_index(const u64 codeunit_index) const noexcept
+		{
+			const u64 end = minimum(codeunit_index, this->view_.size());
+			if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+				return simd::count_codepoints(this->view_.data(), end);
+			u64 index = 0;
+			for(u64 i = 0; i < end; ++i)
+				if(!unicode::is_utf8_continuation(this->view_.read_at(i)))
+					++index;
+			return index;
+		}
+
+		/**
+		 * @return Index of the first codeunit of the codepoint, or size of the view if codepoint_index is out of range.
+		 */
+		[[nodiscard]] constexpr u64 get_codeunit_index(const u64 codepoint_index) const noexcept
 		{
 			const u64 view_size = this->view_.size();
+			if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+			{
+				const u64 found = simd::index_of_codepoint(this->view_.data(), view_size, codepoint_index);
+				return found == global_constant::INDEX_INVALID ? view_size : found;
+			}
 			u64 index = 0;
-			u64 offset = 0;
-			while(offset < codeunit_index && offset < view_size)
+			for(u64 i = 0; i < view_size; ++i)
 			{
-				const u8 sequence_length = unicode::parse_utf8_length(this->view_.read_at(offset));
-				const u8 offset_delta = sequence_length == 0 ? 1 : sequence_length;
-				offset += offset_delta;
+				if(unicode::is_utf8_continuation(this->view_.read_at(i)))
+					continue;
+				if(index == codepoint_index)
+					return i;
 				++index;
 			}
-			return index;
+			return view_size;
 		}
 
-		[[nodiscard]] constexpr u64 get_codeunit_index(const u64 codepoint_index) const noexcept
+		/**
+		 * @return Index of the codepoint in utf-16, where codepoints beyond BMP take two codeunits.
+		 */
+		[[nodiscard]] constexpr u64 get_utf16_index(const u64 codepoint_index) const noexcept
+		{
+			const u64 end = this->get_codeunit_index(codepoint_index);
+			if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+				return simd::count_utf16(this->view_.data(), end);
+			u64 utf16_index = 0;
+			for(u64 i = 0; i < end; ++i)
+				if(const char c = this->view_.read_at(i); !unicode::is_utf8_continuation(c))
+					utf16_index += static_cast<u8>(c) >= 0xF0 ? 2 : 1;
+			return utf16_index;
+		}
+
+		/**
+		 * @return Count of codepoints which start before utf16_index in utf-16.
+		 */
+		[[nodiscard]] constexpr u64 get_codepoint_index_from_utf16(const u64 utf16_index) const noexcept
 		{
 			const u64 view_size = this->view_.size();
 			u64 index = 0;
-			u64 offset = 0;
-			while(index < codepoint_index && offset < view_size)
+			u64 utf16_offset = 0;
+			for(u64 i = 0; i < view_size && utf16_offset < utf16_index; ++i)
 			{
-				const u8 sequence_length = unicode::parse_utf8_length(this->view_.read_at(offset));
-				offset += sequence_length;
-				++index;
+				if(const char c = this->view_.read_at(i); !unicode::is_utf8_continuation(c))
+				{
+					utf16_offset += static_cast<u8>(c) >= 0xF0 ? 2 : 1;
+					++index;
+				}
+			}
+			return index;
+		}
+
+		/**
+		 * @return Index of the first codeunit which does not start a well-formed utf-8 sequence,
+		 * return global_constant::INDEX_INVALID if the whole view is valid.
+		 */
+		[[nodiscard]] constexpr u64 first_invalid_offset() const noexcept
+		{
+			const u64 view_size = this->view_.size();
+			if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
+			{
+				u64 codepoint_count = 0;
+				return simd::first_invalid_utf8(this->view_.data(), view_size, codepoint_count);
 			}
-			return offset;
+			for(u64 i = 0; i < view_size;)
+			{
+				const u8 length = unicode::parse_valid_utf8_length(this->view_.cbegin().data() + i, view_size - i);
+				if(length == 0)
+					return i;
+				i += length;
+			}
+			return global_constant::INDEX_INVALID;
+		}
+
+		/**
+		 * @return Whether this is well-formed utf-8, which should be checked before iterating untrusted input.
+		 */
+		[[nodiscard]] constexpr bool is_valid() const noexcept
+		{
+			return this->first_invalid_offset() == global_constant::INDEX_INVALID;
 		}
 
 		constexpr void get_codeunit_range(u64& from, u64& size) const noexcept
@@ -401,31 +524,48 @@ namespace ostr
 			size = last - from;
 		}
 
-		// todo: a better conversion approach
+		/**
+		 * @return The integer which is the whole view, empty if it is not or it overflows, see ostr::parse.
+		 */
 		[[nodiscard]] constexpr std::optional<i32> try_as_integer() const
 		{
 			if(this->is_empty())
 				return { };
-			i32 result = 0;
-			i32 signal = 1;
-			codeunit_sequence_view raw_view = this->raw();
-			if(raw_view.starts_with("+"_cuqv))
+			if(!OPEN_STRING_IS_CONSTANT_EVALUATED())
 			{
-				raw_view = raw_view.subview(1);
+				const parse_result<i32> result = parse<i32>(this->view_);
+				if(!result.is_valid() || result.size != this->view_.size())
+					return { };
+				return result.value;
 			}
-			if(raw_view.starts_with("-"_cuqv))
+			// Same grammar as ostr::parse: one optional sign, then at least one digit.
+			// Accumulate toward the negative side so that i32 minimum is representable.
+			codeunit_sequence_view raw_view = this->raw();
+			bool negative = false;
+			const char sign = raw_view.read_at(0);
+			if(sign == '+' || sign == '-')
 			{
+				negative = sign == '-';
 				raw_view = raw_view.subview(1);
-				signal = -1;
 			}
+			if(raw_view.is_empty())
+				return { };
+			constexpr i32 minimum_value = std::numeric_limits<i32>::min();
+			i32 result = 0;
 			for(const char c : raw_view)
 			{
 				if(c < '0' || c > '9')
 					return { };
-				result *= 10;
-				result += (c - '0');
+				const i32 digit = c - '0';
+				if(result < minimum_value / 10 || result * 10 < minimum_value + digit)
+					return { };
+				result = result * 10 - digit;
 			}
-			return result * signal;
+			if(negative)
+				return result;
+			if(result == minimum_value)
+				return { };
+			return -result;
 		}
 	
 	private:
@@ -435,6 +575,21 @@ namespace ostr
 	};
 }
 
+namespace ostr
+{
+	template<class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+	[[nodiscard]] parse_result<T> parse(const text_view& view, const u32 base = 10) noexcept
+	{
+		return parse<T>(view.raw(), base);
+	}
+
+	template<class T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+	[[nodiscard]] parse_result<T> parse(const text_view& view) noexcept
+	{
+		return parse<T>(view.raw());
+	}
+}
+
 inline namespace literal
 {
 	[[nodiscard]] constexpr ostr::text_view operator""_txtv(const char* str, const size_t len) noexcept
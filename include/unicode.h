@@ -34,6 +34,8 @@ namespace ostr
 			static constexpr char32_t TRAILING_SURROGATE_MAXIMUM = 0xDFFF;
 			static constexpr char32_t SURROGATE_MASK = 0x03FF;
 			static constexpr char32_t SINGLE_UNIT_MAXIMUM_VALUE = 0xFFFF;
+			// Surrogate pairs encode codepoints beyond BMP minus this.
+			static constexpr char32_t SURROGATE_CODEPOINT_OFFSET = 0x10000;
 			
 			[[nodiscard]] constexpr bool is_leading_surrogate(const char16_t c) noexcept
 			{
@@ -96,6 +98,85 @@ namespace ostr
 			return size > 1 ? size : 1 - size;
 		}
 
+		/**
+		 * @return Whether c is a following codeunit (10xxxxxx) of an utf-8 sequence, which does not start a codepoint.
+		 */
+		[[nodiscard]] constexpr bool is_utf8_continuation(const char c) noexcept
+		{
+			return (static_cast<u8>(c) & 0xC0) == 0x80;
+		}
+
+		static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+		/**
+		 * @return How many codeunits from utf8 match the well-formed sequence which utf8[0] leads, at most the length of that sequence,
+		 * return 0 if utf8[0] can not lead any well-formed sequence.
+		 * Overlong encodings, surrogates and codepoints beyond U+10FFFF are not well-formed.
+		 */
+		[[nodiscard]] constexpr u8 match_utf8_sequence(const char* const utf8, const u64 size) noexcept
+		{
+			if (size == 0)
+				return 0;
+			const u8 lead = static_cast<u8>(utf8[0]);
+			if (lead < 0x80)
+				return 1;
+			// Only the second codeunit has a range narrower than 10xxxxxx, which depends on the lead.
+			u8 length = 0;
+			u8 second_minimum = 0x80;
+			u8 second_maximum = 0xBF;
+			if (lead < 0xC2)
+				return 0;
+			if (lead < 0xE0)
+				length = 2;
+			else if (lead < 0xF0)
+			{
+				length = 3;
+				if (lead == 0xE0)
+					second_minimum = 0xA0;
+				else if (lead == 0xED)
+					second_maximum = 0x9F;
+			}
+			else if (lead < 0xF5)
+			{
+				length = 4;
+				if (lead == 0xF0)
+					second_minimum = 0x90;
+				else if (lead == 0xF4)
+					second_maximum = 0x8F;
+			}
+			else
+				return 0;
+			u8 matched = 1;
+			for (; matched < length && matched < size; ++matched)
+			{
+				const u8 c = static_cast<u8>(utf8[matched]);
+				const u8 minimum = matched == 1 ? second_minimum : 0x80;
+				const u8 maximum = matched == 1 ? second_maximum : 0xBF;
+				if (c < minimum || c > maximum)
+					break;
+			}
+			return matched;
+		}
+
+		/**
+		 * @return length of the well-formed utf-8 sequence at utf8, return 0 if it is ill-formed or truncated
+		 */
+		[[nodiscard]] constexpr u8 parse_valid_utf8_length(const char* const utf8, const u64 size) noexcept
+		{
+			const u8 matched = match_utf8_sequence(utf8, size);
+			return matched != 0 && matched == parse_utf8_length(utf8[0]) ? matched : 0;
+		}
+
+		/**
+		 * @return length of the maximal subpart of the ill-formed sequence at utf8,
+		 * which is replaced by a single U+FFFD as unicode recommends.
+		 */
+		[[nodiscard]] constexpr u8 parse_invalid_utf8_length(const char* const utf8, const u64 size) noexcept
+		{
+			const u8 matched = match_utf8_sequence(utf8, size);
+			return matched != 0 ? matched : 1;
+		}
+
 		[[nodiscard]] constexpr u64 parse_utf8_length(const char16_t utf16) noexcept
 		{
 			if (utf16 <= get_utf8_maximum_codepoint(1))
@@ -173,7 +254,7 @@ namespace ostr
 			//         |||||||||| ||||||||||
 			// [110110]9876543210 |||||||||| high surrogate
 			//            [110111]9876543210 low  surrogate
-			return length == 1 ? utf16[0] : ((utf16[0] & utf16::SURROGATE_MASK) << 10) + (utf16[1] & utf16::SURROGATE_MASK);
+			return length == 1 ? utf16[0] : (((utf16[0] & utf16::SURROGATE_MASK) << 10) | (utf16[1] & utf16::SURROGATE_MASK)) + utf16::SURROGATE_CODEPOINT_OFFSET;
 		}
 		
 		[[nodiscard]] constexpr std::array<char16_t, utf16::SEQUENCE_MAXIMUM_LENGTH> utf32_to_utf16(char32_t const utf32) noexcept
@@ -181,7 +262,7 @@ namespace ostr
 			return utf32 <= utf16::SINGLE_UNIT_MAXIMUM_VALUE ? 
 				std::array<char16_t, utf16::SEQUENCE_MAXIMUM_LENGTH>{ static_cast<char16_t>(utf32) } :
 				std::array<char16_t, utf16::SEQUENCE_MAXIMUM_LENGTH>{
-					static_cast<char16_t>((utf32 >> 10) + utf16::LEADING_SURROGATE_HEADER),
+					static_cast<char16_t>(((utf32 - utf16::SURROGATE_CODEPOINT_OFFSET) >> 10) + utf16::LEADING_SURROGATE_HEADER),
 					static_cast<char16_t>((utf32 & utf16::SURROGATE_MASK) + utf16::TRAILING_SURROGATE_HEADER) };
 		}
 
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+
+#include "codeunit_sequence.h"
+#include "text_view.h"
+
+namespace ostr
+{
+	/**
+	 * \brief Decoder of utf-8 which arrives in chunks, such as from sockets or files,
+	 * where a codepoint could be split by the end of a chunk.
+	 * Runs of well-formed codepoints are handed back as views into the chunk without copy,
+	 * and an incomplete sequence at the end of a chunk is kept until the next chunk completes it.
+	 * Ill-formed sequences are decoded as U+FFFD for each maximal subpart, the same as text::from_utf8_repaired,
+	 * so decoding any split of a sequence gives the same result as decoding it in a whole.
+	 */
+	class OPEN_STRING_API utf8_decoder
+	{
+	public:
+
+		/**
+		 * \brief Take the next run from chunk, and move chunk past it.
+		 * The run is a view into chunk or into this decoder, which is valid until the next call.
+		 * @param run well-formed codepoints, or a single U+FFFD for an ill-formed sequence
+		 * @return Whether a run is taken, false if chunk is used up, then its incomplete sequence is kept in this decoder.
+		 */
+		[[nodiscard]] bool next(codeunit_sequence_view& chunk, text_view& run) noexcept;
+
+		/**
+		 * \brief Take what is left when the input ends.
+		 * @param run a single U+FFFD if an incomplete sequence is kept
+		 * @return Whether a run is taken.
+		 */
+		[[nodiscard]] bool finish(text_view& run) noexcept;
+
+		/**
+		 * @return Whether an incomplete sequence is kept, waiting for the next chunk.
+		 */
+		[[nodiscard]] bool is_pending() const noexcept;
+
+		void reset() noexcept;
+
+		/**
+		 * \brief Call on_run with each run of chunk, see next.
+		 */
+		template<class F>
+		void decode(codeunit_sequence_view chunk, F&& on_run)
+		{
+			text_view run;
+			while(this->next(chunk, run))
+				on_run(run);
+		}
+
+		/**
+		 * \brief Call on_codepoint with each codepoint of chunk.
+		 */
+		template<class F>
+		void decode_codepoints(const codeunit_sequence_view& chunk, F&& on_codepoint)
+		{
+			this->decode(chunk, [&on_codepoint](const text_view& run)
+			{
+				for(const codepoint cp : run)
+					on_codepoint(cp);
+			});
+		}
+
+		/**
+		 * \brief Append repaired utf-8 of chunk to destination.
+		 */
+		void decode(const codeunit_sequence_view& chunk, codeunit_sequence& destination) noexcept;
+		void finish(codeunit_sequence& destination) noexcept;
+
+		/**
+		 * @return How many utf-16 or utf-32 codeunits decoding a chunk or finishing could write at most.
+		 */
+		[[nodiscard]] static constexpr u64 get_maximum_decoded_size(const u64 chunk_size) noexcept
+		{
+			// The kept sequence is completed by at least one codeunit of chunk, into at most two utf-16 codeunits.
+			return chunk_size + 1;
+		}
+
+		/**
+		 * @param destination at least get_maximum_decoded_size(chunk.size()) codeunits
+		 * @return How many codeunits are written.
+		 */
+		u64 decode(const codeunit_sequence_view& chunk, char16_t* destination) noexcept;
+		u64 finish(char16_t* destination) noexcept;
+
+		/**
+		 * @param destination at least get_maximum_decoded_size(chunk.size()) codepoints
+		 * @return How many codepoints are written.
+		 */
+		u64 decode(const codeunit_sequence_view& chunk, char32_t* destination) noexcept;
+		u64 finish(char32_t* destination) noexcept;
+
+	private:
+
+		// Leading codeunits of a well-formed sequence which the chunk ends in.
+		std::array<char, unicode::UTF8_SEQUENCE_MAXIMUM_LENGTH> pending_{ };
+		u8 pending_size_ = 0;
+	};
+}
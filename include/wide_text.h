@@ -24,29 +24,29 @@ namespace ostr
 	template<> 
 	struct argument_formatter<wide_text>
 	{
-		static codeunit_sequence produce(const wide_text& value, const codeunit_sequence_view& specification)
+		static void produce(format_sink& sink, const wide_text& value, const codeunit_sequence_view& specification)
 		{
 			codeunit_sequence result;
 			value.decode(result);
-			return result;
+			sink.append(result.view());
 		}
 	};
 
 	template<> 
 	struct argument_formatter<const wchar_t*>
 	{
-		static codeunit_sequence produce(const wchar_t* value, const codeunit_sequence_view& specification)
+		static void produce(format_sink& sink, const wchar_t* value, const codeunit_sequence_view& specification)
 		{
-			return argument_formatter<wide_text>::produce(wide_text{ value }, specification);
+			argument_formatter<wide_text>::produce(sink, wide_text{ value }, specification);
 		}
 	};
 
 	template<size_t N> 
 	struct argument_formatter<wchar_t[N]>
 	{
-		static codeunit_sequence produce(const wchar_t (&value)[N], const codeunit_sequence_view& specification)
+		static void produce(format_sink& sink, const wchar_t (&value)[N], const codeunit_sequence_view& specification)
 		{
-			return argument_formatter<wide_text>::produce(wide_text{ value }, specification);
+			argument_formatter<wide_text>::produce(sink, wide_text{ value }, specification);
 		}
 	};
 }
@@ -0,0 +1,86 @@
+#include "codepoint_index.h"
+
+#include <algorithm>
+#include "common/simd.h"
+
+namespace ostr
+{
+	codepoint_index::codepoint_index(const codeunit_sequence_view& sequence)
+	{
+		this->build(sequence);
+	}
+
+	void codepoint_index::build(const codeunit_sequence_view& sequence)
+	{
+		const char* data = sequence.data();
+		const u64 sequence_size = sequence.size();
+		this->checkpoints_.clear();
+		this->checkpoints_.push_back({ 0, 0 });
+		u64 offset = 0;
+		u64 utf16_offset = 0;
+		while(true)
+		{
+			// Start of the STRIDE-th codepoint from the checkpoint, which starts the 0th one.
+			const u64 next = simd::index_of_codepoint(data + offset, sequence_size - offset, STRIDE);
+			if(next == global_constant::INDEX_INVALID)
+				break;
+			utf16_offset += simd::count_utf16(data + offset, next);
+			offset += next;
+			this->checkpoints_.push_back({ offset, utf16_offset });
+		}
+		const u64 rest_size = sequence_size - offset;
+		this->size_ = (this->checkpoints_.size() - 1) * STRIDE + simd::count_codepoints(data + offset, rest_size);
+		this->utf16_size_ = utf16_offset + simd::count_utf16(data + offset, rest_size);
+	}
+
+	u64 codepoint_index::size() const noexcept
+	{
+		return this->size_;
+	}
+
+	u64 codepoint_index::utf16_size() const noexcept
+	{
+		return this->utf16_size_;
+	}
+
+	u64 codepoint_index::get_codepoint_index(const codeunit_sequence_view& sequence, const u64 codeunit_index) const noexcept
+	{
+		if(codeunit_index >= sequence.size())
+			return this->size_;
+		// The last checkpoint which starts at or before codeunit_index.
+		const auto found = std::upper_bound(this->checkpoints_.begin(), this->checkpoints_.end(), codeunit_index,
+			[](const u64 index, const checkpoint& point) { return index < point.codeunit_index; });
+		const u64 checkpoint_index = static_cast<u64>(found - this->checkpoints_.begin()) - 1;
+		const u64 offset = this->checkpoints_[checkpoint_index].codeunit_index;
+		return checkpoint_index * STRIDE + simd::count_codepoints(sequence.data() + offset, codeunit_index - offset);
+	}
+
+	u64 codepoint_index::get_codeunit_index(const codeunit_sequence_view& sequence, const u64 codepoint_index) const noexcept
+	{
+		if(codepoint_index >= this->size_)
+			return sequence.size();
+		const u64 offset = this->checkpoints_[codepoint_index / STRIDE].codeunit_index;
+		return offset + simd::index_of_codepoint(sequence.data() + offset, sequence.size() - offset, codepoint_index % STRIDE);
+	}
+
+	u64 codepoint_index::get_utf16_index(const codeunit_sequence_view& sequence, const u64 codepoint_index) const noexcept
+	{
+		if(codepoint_index >= this->size_)
+			return this->utf16_size_;
+		const checkpoint& point = this->checkpoints_[codepoint_index / STRIDE];
+		const u64 end = this->get_codeunit_index(sequence, codepoint_index);
+		return point.utf16_index + simd::count_utf16(sequence.data() + point.codeunit_index, end - point.codeunit_index);
+	}
+
+	u64 codepoint_index::get_codepoint_index_from_utf16(const codeunit_sequence_view& sequence, const u64 utf16_index) const noexcept
+	{
+		if(utf16_index >= this->utf16_size_)
+			return this->size_;
+		const auto found = std::upper_bound(this->checkpoints_.begin(), this->checkpoints_.end(), utf16_index,
+			[](const u64 index, const checkpoint& point) { return index < point.utf16_index; });
+		const u64 checkpoint_index = static_cast<u64>(found - this->checkpoints_.begin()) - 1;
+		const u64 offset = this->checkpoints_[checkpoint_index].codeunit_index;
+		const text_view rest{ sequence.subview(offset) };
+		return checkpoint_index * STRIDE + rest.get_codepoint_index_from_utf16(utf16_index - this->checkpoints_[checkpoint_index].utf16_index);
+	}
+}
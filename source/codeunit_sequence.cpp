@@ -9,20 +9,30 @@ namespace ostr
 {
 	namespace details
 	{
-		[[nodiscard]] constexpr u64 get_capacity(const u64 v) noexcept
+		/**
+		 * @return exponent of the minimum power of two which is not less than v
+		 */
+		[[nodiscard]] constexpr u8 get_capacity_exponent(const u64 v) noexcept
 		{
 			u8 bit_pos = 0;
-			u64 value = v;
+			u64 value = v - 1;
 			while(value != 0)
 			{
 				value >>= 1;
 				++bit_pos;
 			}
-			u64 ans = 1ull << bit_pos;
-			if(ans == (v << 1))
-				ans >>= 1;
-			return ans;
+			return bit_pos;
+		}
+
+		[[nodiscard]] constexpr u64 get_capacity(const u64 v) noexcept
+		{
+			return 1ull << get_capacity_exponent(v);
 		}
+
+		static_assert(get_capacity(16) == 16);
+		static_assert(get_capacity(17) == 32);
+		static_assert(get_capacity(33) == 64);
+		static_assert(get_capacity((1ull << 32) + 1) == (1ull << 33));
 	}
 
 	// code-region-start: iterators
@@ -195,15 +205,7 @@ namespace ostr
 	codeunit_sequence::codeunit_sequence(const u64 size) noexcept
 	{
 		if(size > SSO_SIZE_MAX)
-		{
-			const u64 memory_capacity = details::get_capacity(size + 1);
-			char* data = allocator<char>::allocate_array(memory_capacity);
-			data[0] = '\0';
-			this->as_norm().alloc = true;
-			this->as_norm().size = 0;
-			this->as_norm().data = data;
-			this->as_norm().capacity = static_cast<u32>(memory_capacity - 1);
-		}
+			this->allocate(size);
 	}
 
 	codeunit_sequence::codeunit_sequence(const codeunit_sequence& other) noexcept
@@ -306,6 +308,71 @@ namespace ostr
 		return this->view() != codeunit_sequence_view(rhs);
 	}
 
+	i32 codeunit_sequence::compare(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->view().compare(rhs);
+	}
+
+	bool codeunit_sequence::operator<(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->view().compare(rhs) < 0;
+	}
+
+	bool codeunit_sequence::operator<(const codeunit_sequence& rhs) const noexcept
+	{
+		return this->view().compare(rhs.view()) < 0;
+	}
+
+	bool codeunit_sequence::operator<(const char* rhs) const noexcept
+	{
+		return this->view().compare(codeunit_sequence_view(rhs)) < 0;
+	}
+
+	bool codeunit_sequence::operator<=(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->view().compare(rhs) <= 0;
+	}
+
+	bool codeunit_sequence::operator<=(const codeunit_sequence& rhs) const noexcept
+	{
+		return this->view().compare(rhs.view()) <= 0;
+	}
+
+	bool codeunit_sequence::operator<=(const char* rhs) const noexcept
+	{
+		return this->view().compare(codeunit_sequence_view(rhs)) <= 0;
+	}
+
+	bool codeunit_sequence::operator>(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->view().compare(rhs) > 0;
+	}
+
+	bool codeunit_sequence::operator>(const codeunit_sequence& rhs) const noexcept
+	{
+		return this->view().compare(rhs.view()) > 0;
+	}
+
+	bool codeunit_sequence::operator>(const char* rhs) const noexcept
+	{
+		return this->view().compare(codeunit_sequence_view(rhs)) > 0;
+	}
+
+	bool codeunit_sequence::operator>=(const codeunit_sequence_view& rhs) const noexcept
+	{
+		return this->view().compare(rhs) >= 0;
+	}
+
+	bool codeunit_sequence::operator>=(const codeunit_sequence& rhs) const noexcept
+	{
+		return this->view().compare(rhs.view()) >= 0;
+	}
+
+	bool codeunit_sequence::operator>=(const char* rhs) const noexcept
+	{
+		return this->view().compare(codeunit_sequence_view(rhs)) >= 0;
+	}
+
 	codeunit_sequence& codeunit_sequence::append(const codeunit_sequence_view& rhs) noexcept
 	{
 		if(rhs.is_empty())
@@ -408,6 +475,7 @@ namespace ostr
 		const u64 count = view.count(source);
 		if(count == 0)
 			return *this;
+		const u64 search_end = from + view.size();
 		const u64 old_size = this->size();
 		const u64 src_size = source.size();
 		const u64 dest_size = destination.size();
@@ -426,7 +494,7 @@ namespace ostr
 					break;
 				std::copy_n(destination.data(), destination.size(), this->data() + index);
 				search_from = index + dest_size;
-				search_size = from + size - search_from;
+				search_size = search_end - search_from;
 			}
 		}
 		else if(per_delta < 0)
@@ -442,7 +510,7 @@ namespace ostr
 				read_index += src_size;
 				write_index += dest_size;
 				search_from = found_index + src_size;
-				search_size -= (search_from - from);
+				search_size = search_end - search_from;
 				found_index = this->index_of(source, search_from, search_size);
 				if(found_index == global_constant::INDEX_INVALID)
 					break;
@@ -472,7 +540,7 @@ namespace ostr
 				read_index += src_size;
 				write_index += dest_size;
 				search_from = found_index + src_size;
-				search_size -= (search_from - from);
+				search_size = search_end - search_from;
 				found_index = this->index_of(source, search_from, search_size);
 				if(found_index == global_constant::INDEX_INVALID)
 					break;
@@ -583,12 +651,7 @@ namespace ostr
 		else
 		{
 			this->deallocate();
-			const u64 memory_capacity = details::get_capacity(size + 1);
-			this->as_norm().alloc = true;
-			this->as_norm().size = 0;
-			this->as_norm().data = allocator<char>::allocate_array(memory_capacity);
-			this->as_norm().data[0] = '\0';
-			this->as_norm().capacity = static_cast<u32>( memory_capacity - 1 );
+			this->allocate(size);
 		}
 	}
 
@@ -671,10 +734,9 @@ namespace ostr
 	{
 		if(this->is_empty())
 			return *this;
-		const u64 size = this->size();
-		for(u64 i = 0; i < size; ++i)
-			if(!characters.contains(this->read_at(i)))
-				return this->subsequence(i);
+		const u64 first = this->view().index_of_any(codeunit_set{ characters.data(), characters.size() }.complement());
+		if(first != global_constant::INDEX_INVALID)
+			return this->subsequence(first);
 		this->empty();
 		return *this;
 	}
@@ -683,10 +745,9 @@ namespace ostr
 	{
 		if(this->is_empty())
 			return *this;
-		const u64 size = this->size();
-		for(u64 i = size; i > 0; --i)
-			if(!characters.contains(this->view().read_at(i - 1)))
-				return this->subsequence(0, i);
+		const u64 last = this->view().last_index_of_any(codeunit_set{ characters.data(), characters.size() }.complement());
+		if(last != global_constant::INDEX_INVALID)
+			return this->subsequence(0, last + 1);
 		this->empty();
 		return *this;
 	}
@@ -760,7 +821,18 @@ namespace ostr
 
 	u64 codeunit_sequence::get_capacity() const
 	{
-		return this->is_short() ? SSO_SIZE_MAX : this->as_norm().capacity;
+		return this->is_short() ? SSO_SIZE_MAX : (1ull << this->as_norm().capacity_exponent) - 1;
+	}
+
+	void codeunit_sequence::allocate(const u64 size)
+	{
+		const u8 capacity_exponent = details::get_capacity_exponent(size + 1);
+		char* data = allocator<char>::allocate_array(1ull << capacity_exponent);
+		data[0] = '\0';
+		this->as_norm().alloc = true;
+		this->as_norm().size = 0;
+		this->as_norm().capacity_exponent = capacity_exponent;
+		this->as_norm().data = data;
 	}
 
 	char* codeunit_sequence::last()
@@ -784,7 +856,7 @@ namespace ostr
 		if(this->is_short())
 			this->as_sso().size = static_cast<u8>(size);
 		else
-			this->as_norm().size = static_cast<u32>(size);
+			this->as_norm().size = size;
 	}
 
 	void codeunit_sequence::transfer_data(codeunit_sequence& other)
@@ -797,4 +869,24 @@ namespace ostr
 	{
 		return rhs == lhs;
 	}
+
+	bool operator<(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept
+	{
+		return lhs.compare(rhs.view()) < 0;
+	}
+
+	bool operator<=(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept
+	{
+		return lhs.compare(rhs.view()) <= 0;
+	}
+
+	bool operator>(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept
+	{
+		return lhs.compare(rhs.view()) > 0;
+	}
+
+	bool operator>=(const codeunit_sequence_view& lhs, const codeunit_sequence& rhs) noexcept
+	{
+		return lhs.compare(rhs.view()) >= 0;
+	}
 }
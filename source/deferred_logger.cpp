@@ -0,0 +1,135 @@
+#include "deferred_logger.h"
+
+#include <chrono>
+
+namespace ostr
+{
+	namespace
+	{
+		[[nodiscard]] u64 round_up_to_power_of_2(const u64 value) noexcept
+		{
+			u64 result = 1;
+			while(result < value)
+				result <<= 1;
+			return result;
+		}
+
+		// The consumer yields this many times in a row before it sleeps on an empty queue.
+		constexpr u64 IDLE_YIELD_COUNT = 64;
+		constexpr std::chrono::microseconds IDLE_SLEEP_DURATION{ 200 };
+	}
+
+	deferred_logger::deferred_logger(output_function_type output, const deferred_logger_settings& settings)
+		: output_{ std::move(output) }
+		, settings_{ settings }
+		, mask_{ round_up_to_power_of_2(settings.capacity) - 1 }
+		, slots_{ new slot[this->mask_ + 1] }
+		, payloads_{ new byte[(this->mask_ + 1) * settings.record_size] }
+	{
+		for(u64 i = 0; i <= this->mask_; ++i)
+			this->slots_[i].sequence.store(i, std::memory_order_relaxed);
+		this->consumer_ = std::thread{ [this] { this->consume(); } };
+	}
+
+	deferred_logger::~deferred_logger()
+	{
+		this->stopping_.store(true, std::memory_order_release);
+		this->consumer_.join();
+	}
+
+	void deferred_logger::flush() const noexcept
+	{
+		const u64 target = this->enqueue_position_.load(std::memory_order_acquire);
+		while(this->output_position_.load(std::memory_order_acquire) < target)
+			std::this_thread::yield();
+	}
+
+	u64 deferred_logger::get_dropped_count() const noexcept
+	{
+		return this->dropped_count_.load(std::memory_order_relaxed);
+	}
+
+	byte* deferred_logger::claim(const u64 size, u64& position) noexcept
+	{
+		if(size > this->settings_.record_size)
+		{
+			this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		position = this->enqueue_position_.load(std::memory_order_relaxed);
+		while(true)
+		{
+			const slot& claimed = this->slots_[position & this->mask_];
+			const u64 sequence = claimed.sequence.load(std::memory_order_acquire);
+			const i64 difference = static_cast<i64>(sequence - position);
+			if(difference == 0)
+			{
+				// The slot is free for this position, take the position unless another producer has taken it.
+				if(this->enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					return this->payloads_.get() + (position & this->mask_) * this->settings_.record_size;
+			}
+			else if(difference < 0)
+			{
+				// The slot still holds the record of the previous round, so the queue is full.
+				if(this->settings_.overflow_policy == log_overflow_policy::drop)
+				{
+					this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+					return nullptr;
+				}
+				std::this_thread::yield();
+				position = this->enqueue_position_.load(std::memory_order_relaxed);
+			}
+			else
+			{
+				position = this->enqueue_position_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void deferred_logger::publish(const u64 position, const details::deferred_replay_function_type replay) noexcept
+	{
+		slot& published = this->slots_[position & this->mask_];
+		published.replay = replay;
+		published.sequence.store(position + 1, std::memory_order_release);
+	}
+
+	void deferred_logger::consume()
+	{
+		codeunit_sequence lines;
+		lines.reserve(this->settings_.batch_size + this->settings_.record_size);
+		format_sink sink{ &lines, details::append_to_sequence };
+		const auto output = [this, &lines](const u64 position)
+		{
+			if(!lines.is_empty())
+			{
+				this->output_(lines.view());
+				lines.empty();
+			}
+			this->output_position_.store(position, std::memory_order_release);
+		};
+		u64 position = 0;
+		u64 idle_count = 0;
+		while(true)
+		{
+			slot& consumed = this->slots_[position & this->mask_];
+			if(consumed.sequence.load(std::memory_order_acquire) == position + 1)
+			{
+				consumed.replay(sink, this->payloads_.get() + (position & this->mask_) * this->settings_.record_size);
+				sink.append('\n');
+				consumed.sequence.store(position + this->mask_ + 1, std::memory_order_release);
+				++position;
+				if(lines.size() >= this->settings_.batch_size)
+					output(position);
+				idle_count = 0;
+				continue;
+			}
+			output(position);
+			if(this->stopping_.load(std::memory_order_acquire) && this->enqueue_position_.load(std::memory_order_acquire) == position)
+				break;
+			if(++idle_count < IDLE_YIELD_COUNT)
+				std::this_thread::yield();
+			else
+				std::this_thread::sleep_for(IDLE_SLEEP_DURATION);
+		}
+	}
+}
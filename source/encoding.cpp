@@ -0,0 +1,82 @@
+#include "encoding.h"
+
+namespace ostr
+{
+	namespace
+	{
+		[[nodiscard]] const byte* as_bytes(const codeunit_sequence_view& view) noexcept
+		{
+			return reinterpret_cast<const byte*>(view.data());
+		}
+
+		/**
+		 * \brief Decode into a sequence sized once by expected_size, which is the size of the result if input is valid.
+		 */
+		template<class F>
+		[[nodiscard]] std::optional<codeunit_sequence> decode_to_sequence(const u64 expected_size, F&& decode)
+		{
+			codeunit_sequence result;
+			result.append('\0', expected_size);
+			if(decode(reinterpret_cast<byte*>(result.data())) != expected_size)
+				return std::nullopt;
+			return result;
+		}
+	}
+
+	u64 encode_hex(const codeunit_sequence_view& bytes, char* destination, const hex_format& format) noexcept
+	{
+		return simd::hex_encode(as_bytes(bytes), bytes.size(), destination, format.uppercase, format.separator);
+	}
+
+	codeunit_sequence to_hex(const codeunit_sequence_view& bytes, const hex_format& format)
+	{
+		codeunit_sequence result;
+		result.append('\0', get_hex_encoded_size(bytes.size(), format));
+		encode_hex(bytes, result.data(), format);
+		return result;
+	}
+
+	u64 decode_hex(const codeunit_sequence_view& hex, byte* destination, const char separator) noexcept
+	{
+		return simd::hex_decode(hex.data(), hex.size(), destination, separator);
+	}
+
+	std::optional<codeunit_sequence> from_hex(const codeunit_sequence_view& hex, const char separator)
+	{
+		const u64 expected_size = separator == '\0' ? hex.size() / 2 : (hex.size() + 1) / 3;
+		return decode_to_sequence(expected_size, [&hex, separator](byte* destination)
+		{
+			return decode_hex(hex, destination, separator);
+		});
+	}
+
+	u64 encode_base64(const codeunit_sequence_view& bytes, char* destination, const base64_alphabet alphabet, const bool padding) noexcept
+	{
+		return simd::base64_encode(as_bytes(bytes), bytes.size(), destination, alphabet, padding);
+	}
+
+	codeunit_sequence to_base64(const codeunit_sequence_view& bytes, const base64_alphabet alphabet, const bool padding)
+	{
+		codeunit_sequence result;
+		result.append('\0', get_base64_encoded_size(bytes.size(), padding));
+		encode_base64(bytes, result.data(), alphabet, padding);
+		return result;
+	}
+
+	u64 decode_base64(const codeunit_sequence_view& base64, byte* destination, const base64_alphabet alphabet) noexcept
+	{
+		return simd::base64_decode(base64.data(), base64.size(), destination, alphabet);
+	}
+
+	std::optional<codeunit_sequence> from_base64(const codeunit_sequence_view& base64, const base64_alphabet alphabet)
+	{
+		u64 size = base64.size();
+		if(size >= 4 && size % 4 == 0 && base64.read_at(size - 1) == '=')
+			size -= base64.read_at(size - 2) == '=' ? 2 : 1;
+		const u64 expected_size = size / 4 * 3 + (size % 4 > 1 ? size % 4 - 1 : 0);
+		return decode_to_sequence(expected_size, [&base64, alphabet](byte* destination)
+		{
+			return decode_base64(base64, destination, alphabet);
+		});
+	}
+}
@@ -3,45 +3,129 @@
 #include "format.h"
 #include "text.h"
 
+#include <charconv>
+#include <limits>
+#include <memory>
+
 namespace ostr
 {
     namespace details
     {
-        [[nodiscard]] constexpr u64 get_integer_digit_count(const i64 value, const i64 base)
+        [[nodiscard]] constexpr char from_digit(const u64 digit)
+        {
+            constexpr char digits[] = "0123456789abcdef";
+            return digits[digit];
+        }
+
+        // Enough for 64 binary digits.
+        inline constexpr u64 INTEGER_DIGIT_CAPACITY = 64;
+
+        // Two digits of each value below base * base, so digits are written two at a time.
+        template<u64 Base>
+        inline constexpr std::array<char, Base * Base * 2> DIGIT_PAIRS = []()
         {
-            if(value == 0)
-                return 1;
-            i64 remaining = value;
-            u64 count = 0;
-            while(remaining != 0)
+            std::array<char, Base * Base * 2> pairs{ };
+            for(u64 i = 0; i < Base * Base; ++i)
             {
-                remaining /= base;
-                ++count;
+                pairs[i * 2] = from_digit(i / Base);
+                pairs[i * 2 + 1] = from_digit(i % Base);
             }
-            return count;
+            return pairs;
+        }();
+
+        inline constexpr std::array<u64, 20> POWERS_OF_10 = []()
+        {
+            std::array<u64, 20> powers{ };
+            for(u64 i = 0; i < powers.size(); ++i)
+                powers[i] = power(10, i);
+            return powers;
+        }();
+
+        [[nodiscard]] u64 get_bit_width(const u64 value) noexcept
+        {
+            return 64 - count_leading_zeros(value | 1);
         }
-        
-        [[nodiscard]] constexpr u64 get_integer_digit_count(const u64 value, const u64 base)
+
+        [[nodiscard]] u64 count_decimal_digits(const u64 value) noexcept
+        {
+            // log10 is approximated by log2 * 1233 / 4096, which is at most 1 greater, then corrected by a single compare.
+            // value | 1 keeps 0 as a single digit, and compares the same as value against even powers.
+            const u64 approximate = get_bit_width(value) * 1233 >> 12;
+            return approximate + 1 - ((value | 1) < POWERS_OF_10[approximate]);
+        }
+
+        [[nodiscard]] u64 count_integer_digits(const u64 value, const u64 base) noexcept
         {
-            if(value == 0)
-                return 1;
-            u64 remaining = value;
-            u64 count = 0;
-            while(remaining != 0)
+            switch(base)
             {
-                remaining /= base;
-                ++count;
+            case 2:
+                return get_bit_width(value);
+            case 8:
+                return (get_bit_width(value) + 2) / 3;
+            case 16:
+                return (get_bit_width(value) + 3) / 4;
+            default:
+                return count_decimal_digits(value);
             }
-            return count;
         }
 
-        [[nodiscard]] constexpr char from_digit(const u64 digit)
+        template<u64 Base>
+        void write_digit_pairs(char* last, u64 value) noexcept
         {
-            constexpr char digits[] = "0123456789abcdef";
-            return digits[digit];
+            constexpr u64 base_square = Base * Base;
+            while(value >= base_square)
+            {
+                const u64 pair = value % base_square * 2;
+                value /= base_square;
+                last -= 2;
+                last[0] = DIGIT_PAIRS<Base>[pair];
+                last[1] = DIGIT_PAIRS<Base>[pair + 1];
+            }
+            if(value >= Base)
+            {
+                last[-2] = DIGIT_PAIRS<Base>[value * 2];
+                last[-1] = DIGIT_PAIRS<Base>[value * 2 + 1];
+            }
+            else
+            {
+                last[-1] = from_digit(value);
+            }
+        }
+
+        template<u64 Shift>
+        void write_power_of_2_digits(char* last, u64 value, const u64 digit_count) noexcept
+        {
+            constexpr u64 mask = (1ull << Shift) - 1;
+            for(u64 i = 0; i < digit_count; ++i)
+            {
+                *--last = static_cast<char>('0' + (value & mask));
+                value >>= Shift;
+            }
+        }
+
+        /**
+         * \brief Write digit_count digits of value backward, ending at last, divisions by constants only.
+         */
+        void write_integer_digits(char* last, const u64 value, const u64 base, const u64 digit_count) noexcept
+        {
+            switch(base)
+            {
+            case 2:
+                write_power_of_2_digits<1>(last, value, digit_count);
+                break;
+            case 8:
+                write_power_of_2_digits<3>(last, value, digit_count);
+                break;
+            case 16:
+                write_digit_pairs<16>(last, value);
+                break;
+            default:
+                write_digit_pairs<10>(last, value);
+                break;
+            }
         }
     
-        codeunit_sequence format_integer(const u64& value, const codeunit_sequence_view& specification)
+        void format_integer(format_sink& sink, const u64& value, const codeunit_sequence_view& specification)
         {
             char type = 'd';
             char holder = '0';
@@ -88,9 +172,8 @@ namespace ostr
                 break;
             case 'c':
                 {
-                    codeunit_sequence result;
-                    result.append(static_cast<char>(value));
-                    return result;
+                    sink.append(static_cast<char>(value));
+                    return;
                 }
             case 'd':
                 break;
@@ -112,25 +195,17 @@ namespace ostr
             if(!with_prefix)
                 prefix = ""_cuqv;
         
-            const u64 digit_count = get_integer_digit_count(value, base);
+            char digits[INTEGER_DIGIT_CAPACITY];
+            const u64 digit_count = count_integer_digits(value, base);
+            write_integer_digits(digits + digit_count, value, base, digit_count);
             const u64 preserve = holding == global_constant::SIZE_INVALID ? digit_count : maximum(holding, digit_count);
             const u64 holder_count = preserve - digit_count;
-            codeunit_sequence result( prefix.size() + preserve );
-            result
-            .append(prefix)
-            .append(holder, holder_count);
-            u64 remaining = value;
-            for(u64 i = 0; i < digit_count; ++i)
-            {
-                const char digit = from_digit(remaining % base); 
-                remaining /= base;
-                result.append(digit);
-            }
-            result.reverse();
-            return result;
+            sink.append(prefix);
+            sink.append(holder, holder_count);
+            sink.append({ digits, digit_count });
         }
 
-        codeunit_sequence format_integer(const i64& value, const codeunit_sequence_view& specification)
+        void format_integer(format_sink& sink, const i64& value, const codeunit_sequence_view& specification)
         {
             char type = 'd';
             u64 holding = global_constant::SIZE_INVALID;
@@ -163,7 +238,7 @@ namespace ostr
                 }
                 OPEN_STRING_CHECK(parsing.is_empty(), "Invalid format specification [{}]!", specification);
             }
-            i64 base = 10;
+            u64 base = 10;
             codeunit_sequence_view prefix;
             switch (type)
             {
@@ -175,9 +250,8 @@ namespace ostr
                 break;
             case 'c':
                 {
-                    codeunit_sequence result;
-                    result.append(static_cast<char>(value));
-                    return result;
+                    sink.append(static_cast<char>(value));
+                    return;
                 }
             case 'd':
                 break;
@@ -200,40 +274,67 @@ namespace ostr
                 prefix = ""_cuqv;
         
             const codeunit_sequence_view sign = (value < 0) ? "-"_cuqv : ""_cuqv;
-            const u64 digit_count = get_integer_digit_count(value, base);
+            // Negating in unsigned, since -INT64_MIN overflows.
+            const u64 magnitude = value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+            char digits[INTEGER_DIGIT_CAPACITY];
+            const u64 digit_count = count_integer_digits(magnitude, base);
+            write_integer_digits(digits + digit_count, magnitude, base, digit_count);
             const u64 preserve = holding == global_constant::SIZE_INVALID ? digit_count : maximum(holding, digit_count);
             const u64 zero_count = preserve - digit_count;
-            codeunit_sequence result( sign.size() + prefix.size() + preserve );
-            result
-            .append(sign)
-            .append(prefix)
-            .append('0', zero_count);
-            const u64 digits_start = result.size();
-            i64 remaining = value >= 0 ? value : -value;
-            for(u64 i = 0; i < digit_count; ++i)
+            sink.append(sign);
+            sink.append(prefix);
+            sink.append('0', zero_count);
+            sink.append({ digits, digit_count });
+        }
+
+        // Enough for the shortest round-trip of any double, and for most precisions.
+        inline constexpr u64 FLOAT_STACK_BUFFER_SIZE = 128;
+        // Sign, integer digits of the largest double, dot and exponent, besides digits of precision.
+        inline constexpr u64 FLOAT_MAXIMUM_SIZE_BESIDES_PRECISION = 320;
+
+        template<class T>
+        std::to_chars_result write_floating_point(char* first, char* last, const T value, const char type, const u64 precision)
+        {
+            const bool has_precision = precision != global_constant::SIZE_INVALID;
+            const int digits = has_precision ? static_cast<int>(precision) : 6;
+            switch(type)
             {
-                const char digit = from_digit(remaining % base); 
-                remaining /= base;
-                result.append(digit);
+            case 'a':
+                return has_precision ? std::to_chars(first, last, value, std::chars_format::hex, digits) : std::to_chars(first, last, value, std::chars_format::hex);
+            case 'e':
+                return std::to_chars(first, last, value, std::chars_format::scientific, digits);
+            case 'f':
+                return std::to_chars(first, last, value, std::chars_format::fixed, digits);
+            case 'g':
+                return std::to_chars(first, last, value, std::chars_format::general, digits);
+            default:
+                // A bare precision keeps meaning digits after the dot, as it did before the notations were supported.
+                // Without one, the shortest representation which reads back to the same value.
+                return has_precision ? std::to_chars(first, last, value, std::chars_format::fixed, digits) : std::to_chars(first, last, value);
             }
-            result.reverse(digits_start);
-            return result;
         }
 
-        codeunit_sequence format_float(const f64& value, const codeunit_sequence_view& specification)
+        template<class T>
+        void format_floating_point(format_sink& sink, const T value, const codeunit_sequence_view& specification)
         {
             if (std::isinf(value))
-                return codeunit_sequence{ value < 0 ? "-inf"_cuqv : "inf"_cuqv };
+            {
+                sink.append(value < 0 ? "-inf"_cuqv : "inf"_cuqv);
+                return;
+            }
             if (std::isnan(value))
-                return codeunit_sequence{ "nan"_cuqv };
+            {
+                sink.append("nan"_cuqv);
+                return;
+            }
             u64 precision = global_constant::SIZE_INVALID;
-            // char type = 'g';
+            char type = '\0';
             if (!specification.is_empty())
             {
                 codeunit_sequence_view parsing = specification;
                 if("aefg"_cuqv.contains( parsing.read_from_last(0) ))
                 {    
-                    // type = parsing.read_from_last(0);
+                    type = parsing.read_from_last(0);
                     parsing = parsing.subview(0, parsing.size() - 1);
                 }
                 if(!parsing.is_empty())
@@ -248,92 +349,192 @@ namespace ostr
                 }
                 OPEN_STRING_CHECK(parsing.is_empty(), "Invalid format specification [{}]!", specification);
             }
-            // switch (type) 
-            // {
-            // case 'a':
-            //     break;
-            // case 'e':
-            //     break;
-            // case 'f':
-            //     break;
-            // case 'g':
-            //     break;
-            // default:
-            //     break;
-            // }
-            static constexpr u64 max_precision = 9;
+            static constexpr u64 max_precision = static_cast<u64>(std::numeric_limits<i32>::max()) - FLOAT_MAXIMUM_SIZE_BESIDES_PRECISION;
             OPEN_STRING_CHECK(precision == global_constant::SIZE_INVALID || precision <= max_precision, "Too high precision for float type [{}]!", precision);
-            codeunit_sequence result;
-            const bool negative = value < 0;
-            if(negative)
-                result.append("-");
-            f64 remaining = negative ? -value : value;
-            const u64 decimal = static_cast<u64>(remaining);
-            remaining -= static_cast<f64>(decimal);
-            if(precision == global_constant::SIZE_INVALID)
+            if(precision != global_constant::SIZE_INVALID)
+                precision = minimum(precision, max_precision);
+
+            char buffer[FLOAT_STACK_BUFFER_SIZE];
+            if(const auto [ last, error ] = write_floating_point(buffer, buffer + FLOAT_STACK_BUFFER_SIZE, value, type, precision); error == std::errc{ })
             {
-                static constexpr u64 max_floating = power(10, max_precision + 1);
-                u64 floating = 1;
-                u64 count_nine = 0;
-                while(floating <= max_floating)
-                {
-                    remaining *= 10;
-                    floating *= 10;
-                    const u64 ones = static_cast<u64>(remaining);
-                    floating += ones;
-                    remaining -= static_cast<f64>(ones);
-                    if(ones == 9)
-                    {
-                        ++count_nine;
-                        if(count_nine == global_constant::TOLERANCE_EXPONENT)
-                        {
-                            floating += 1;
-                            floating = floating / power(10, global_constant::TOLERANCE_EXPONENT);
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        count_nine = 0;
-                    }
-                    if(remaining < global_constant::TOLERANCE)
-                        break;
-                }
-                if(floating > 10)
-                {
-                    const codeunit_sequence decimal_part = format_integer(decimal, { });
-                    const u64 dot_position = result.size() + decimal_part.size();
-                    const codeunit_sequence floating_part = format_integer(floating, { });
-                    result.reserve(dot_position + floating_part.size());
-                    result  .append(decimal_part)
-                            .append(floating_part)
-                            .write_at(dot_position, '.');
-                }
-                if(floating == 2)
-                {
-                    result.append(format_integer(decimal + 1, { }));
-                }
+                sink.append({ buffer, static_cast<u64>(last - buffer) });
+                return;
             }
-            else 
+            // Only long precisions, or huge values in fixed notation, take more than the stack buffer.
+            const u64 size = FLOAT_MAXIMUM_SIZE_BESIDES_PRECISION + precision;
+            const std::unique_ptr<char[]> heap_buffer{ new char[size] };
+            const auto [ last, error ] = write_floating_point(heap_buffer.get(), heap_buffer.get() + size, value, type, precision);
+            sink.append({ heap_buffer.get(), static_cast<u64>(last - heap_buffer.get()) });
+        }
+
+        void format_float(format_sink& sink, const f32& value, const codeunit_sequence_view& specification)
+        {
+            format_floating_point(sink, value, specification);
+        }
+
+        void format_float(format_sink& sink, const f64& value, const codeunit_sequence_view& specification)
+        {
+            format_floating_point(sink, value, specification);
+        }
+
+        void format_raw_bytes(format_sink& sink, const byte* data, const u64 size)
+        {
+            // Bytes are encoded by chunks into a stack buffer, so large objects are not appended per byte.
+            constexpr u64 chunk_size = 128;
+            std::array<char, chunk_size * 3> buffer;
+            for(u64 i = 0; i < size; i += chunk_size)
             {
-                u64 floating = 1;
-                for(u64 i = 0; i < precision; ++i)
-                {
-                    remaining *= 10;
-                    floating *= 10;
-                    const u64 ones = static_cast<u64>(remaining);
-                    floating += ones;
-                    remaining -= static_cast<f64>(ones);
-                }
-                const codeunit_sequence decimal_part = format_integer(decimal, { });
-                const u64 dot_position = result.size() + decimal_part.size();
-                const codeunit_sequence floating_part = format_integer(floating, { });
-                result.reserve(dot_position + floating_part.size());
-                result  .append(decimal_part)
-                        .append(floating_part)
-                        .write_at(dot_position, '.');
+                if(i > 0)
+                    sink.append(' ');
+                const u64 written = simd::hex_encode(data + i, minimum(chunk_size, size - i), buffer.data(), false, ' ');
+                sink.append(codeunit_sequence_view{ buffer.data(), written });
+            }
+        }
+    }
+
+    prepared_format::prepared_format(const codeunit_sequence_view& format_mold, const std::vector<codeunit_sequence_view>& argument_names)
+    {
+        const details::format_mold_parse_result counted = details::parse_format_mold(format_mold, nullptr, argument_names.data(), argument_names.size());
+        this->error_ = counted.error;
+        if(counted.error != details::format_mold_error::none)
+            return;
+        this->argument_count_ = counted.argument_count;
+        std::vector<details::format_segment> parsed(counted.segment_count);
+        [[maybe_unused]] const details::format_mold_parse_result parsed_result = details::parse_format_mold(format_mold, parsed.data(), argument_names.data(), argument_names.size());
+        this->text_.reserve(format_mold.size());
+        this->segments_.reserve(parsed.size());
+        for(const details::format_segment& segment : parsed)
+        {
+            const u64 from = this->text_.size();
+            this->text_.append(format_mold.subview(segment.from, segment.size));
+            // Runs around escaped braces are adjacent in text, so they are merged into one.
+            if(segment.type == details::format_segment::segment_type::plain_text && !this->segments_.empty()
+                && this->segments_.back().type == details::format_segment::segment_type::plain_text)
+                this->segments_.back().size += segment.size;
+            else
+                this->segments_.push_back({ segment.type, from, segment.size, segment.argument_index });
+        }
+    }
+
+    bool prepared_format::is_valid() const noexcept
+    {
+        return this->error_ == details::format_mold_error::none;
+    }
+
+    details::format_mold_error prepared_format::get_error() const noexcept
+    {
+        return this->error_;
+    }
+
+    u64 prepared_format::get_argument_count() const noexcept
+    {
+        return this->argument_count_;
+    }
+
+    void prepared_format::produce(format_sink& sink, const format_args& arguments) const
+    {
+        OPEN_STRING_CHECK_OR(return, this->is_valid(), "Invalid format mold!");
+        OPEN_STRING_CHECK_OR(return, this->argument_count_ <= arguments.size(), "Invalid format index: Index should be less than count of argument [{}]!", arguments.size());
+        const char* text = this->text_.data();
+        for(const details::format_segment& segment : this->segments_)
+        {
+            const codeunit_sequence_view run{ text + segment.from, segment.size };
+            if(segment.type == details::format_segment::segment_type::plain_text)
+                sink.append(run);
+            else
+                arguments[segment.argument_index].produce(sink, run);
+        }
+    }
+
+    void vformat_to(format_sink& sink, const codeunit_sequence_view& format_mold, const format_args& arguments)
+    {
+        enum class indexing_type : u8
+        {
+            unknown,
+            manual,
+            automatic
+        };
+        indexing_type index_type = indexing_type::unknown;
+        u64 next_index = 0;
+        const u64 size = format_mold.size();
+        u64 from = 0;
+        while(from < size)
+        {
+            const u64 index = format_mold.index_of_any(details::format_braces, from);
+            if(index == global_constant::INDEX_INVALID)
+            {
+                sink.append(format_mold.subview(from));
+                return;
+            }
+            const char brace = format_mold.read_at(index);
+            if(index + 1 < size && format_mold.read_at(index + 1) == brace)
+            {
+                // Plain text before an escaped brace is appended together with the brace.
+                sink.append(format_mold.subview(from, index + 1 - from));
+                from = index + 2;
+                continue;
+            }
+            if(index != from)
+                sink.append(format_mold.subview(from, index - from));
+            OPEN_STRING_CHECK_OR(return, brace != '}', "Unclosed right brace is not allowed!");
+            const u64 index_close = format_mold.index_of_any(details::format_braces, index + 1);
+            OPEN_STRING_CHECK_OR(return, index_close != global_constant::INDEX_INVALID && format_mold.read_at(index_close) != '{', "Unclosed left brace is not allowed!");
+            const auto [ index_run, specification ] = format_mold.subview(index + 1, index_close - index - 1).split(":"_cuqv);
+            u64 current_index = next_index;
+            if(index_run.is_empty())
+            {
+                OPEN_STRING_CHECK_OR(return, index_type != indexing_type::manual, "Manual index is not allowed mixing with automatic index!");
+                index_type = indexing_type::automatic;
+                ++next_index;
+            }
+            else
+            {
+                OPEN_STRING_CHECK_OR(return, index_type != indexing_type::automatic, "Automatic index is not allowed mixing with manual index!");
+                index_type = indexing_type::manual;
+                const auto [ last, error ] = std::from_chars(index_run.data(), index_run.cend().data(), current_index);
+                OPEN_STRING_CHECK_OR(return, error == std::errc{ } && last == index_run.cend().data(), "Invalid format index [{}]!", index_run);
             }
+            OPEN_STRING_CHECK_OR(return, current_index < arguments.size(), "Invalid format index [{}]: Index should be less than count of argument [{}]!", current_index, arguments.size());
+            arguments[current_index].produce(sink, specification);
+            from = index_close + 1;
+        }
+    }
+
+    namespace
+    {
+        /**
+         * \brief Format into a stack buffer, then again into an allocated sequence only if the buffer is not large enough, see format.
+         * @param produce called with a sink once or twice
+         */
+        template<class F>
+        codeunit_sequence format_allocating_once(const F& produce)
+        {
+            std::array<char, details::FORMAT_STACK_BUFFER_SIZE> buffer;
+            details::fixed_buffer destination{ buffer.data(), buffer.size(), 0 };
+            format_sink sink{ &destination, details::append_to_fixed_buffer };
+            produce(sink);
+            if(sink.size() <= buffer.size())
+                return codeunit_sequence{ buffer.data(), sink.size() };
+            codeunit_sequence result(sink.size());
+            format_sink result_sink{ &result, details::append_to_sequence };
+            produce(result_sink);
             return result;
         }
     }
+
+    codeunit_sequence vformat(const codeunit_sequence_view& format_mold, const format_args& arguments)
+    {
+        return format_allocating_once([&format_mold, &arguments](format_sink& sink)
+        {
+            vformat_to(sink, format_mold, arguments);
+        });
+    }
+
+    codeunit_sequence vformat(const prepared_format& format_mold, const format_args& arguments)
+    {
+        return format_allocating_once([&format_mold, &arguments](format_sink& sink)
+        {
+            format_mold.produce(sink, arguments);
+        });
+    }
 }
@@ -0,0 +1,187 @@
+
+#include "multi_searcher.h"
+#include <algorithm>
+#include <deque>
+#include "common/constants.h"
+
+namespace ostr
+{
+	namespace details
+	{
+		[[nodiscard]] constexpr u8 fold_ascii_case(const u8 codeunit) noexcept
+		{
+			return codeunit >= 'A' && codeunit <= 'Z' ? static_cast<u8>(codeunit - 'A' + 'a') : codeunit;
+		}
+	}
+
+	multi_searcher::multi_searcher(const std::vector<codeunit_sequence_view>& patterns, const bool ignore_case)
+	{
+		const auto fold = [ignore_case](const char codeunit) -> u8
+		{
+			return ignore_case ? details::fold_ascii_case(static_cast<u8>(codeunit)) : static_cast<u8>(codeunit);
+		};
+
+		// Class 0 is for codeunits not in any pattern.
+		std::array<bool, 256> used{ };
+		for(const codeunit_sequence_view& pattern : patterns)
+			for(const char codeunit : pattern)
+				used[fold(codeunit)] = true;
+		u16 class_count = 1;
+		for(u32 codeunit = 0; codeunit < 256; ++codeunit)
+			if(used[codeunit])
+				this->classes_[codeunit] = class_count++;
+		if(ignore_case)
+			for(u8 codeunit = 'A'; codeunit <= 'Z'; ++codeunit)
+				this->classes_[codeunit] = this->classes_[details::fold_ascii_case(codeunit)];
+		this->stride_ = class_count;
+		const u32 stride = this->stride_;
+
+		// Build trie with state indices, 0 is root and also stands for no child before failure links are resolved.
+		std::vector<u32> transitions(stride);
+		std::vector<u32> state_patterns{ STATE_INVALID };
+		for(u32 pattern_index = 0; pattern_index < patterns.size(); ++pattern_index)
+		{
+			const codeunit_sequence_view& pattern = patterns[pattern_index];
+			this->pattern_sizes_.push_back(pattern.size());
+			if(pattern.is_empty())
+				continue;
+			u32 state = 0;
+			for(const char codeunit : pattern)
+			{
+				u32& next = transitions[state * stride + this->classes_[static_cast<u8>(codeunit)]];
+				if(next == 0)
+				{
+					next = static_cast<u32>(state_patterns.size());
+					state_patterns.push_back(STATE_INVALID);
+					transitions.resize(transitions.size() + stride);
+				}
+				state = transitions[state * stride + this->classes_[static_cast<u8>(codeunit)]];
+			}
+			if(state_patterns[state] == STATE_INVALID)
+				state_patterns[state] = pattern_index;
+		}
+		const u32 state_count = static_cast<u32>(state_patterns.size());
+
+		// Resolve failure links in breadth first order, turning trie into a complete automaton.
+		std::vector<u32> failures(state_count, 0);
+		std::vector<u32> output_links(state_count, STATE_INVALID);
+		std::deque<u32> queue;
+		for(u32 c = 0; c < stride; ++c)
+			if(const u32 child = transitions[c]; child != 0)
+				queue.push_back(child);
+		while(!queue.empty())
+		{
+			const u32 state = queue.front();
+			queue.pop_front();
+			const u32 failure = failures[state];
+			output_links[state] = state_patterns[failure] != STATE_INVALID ? failure : output_links[failure];
+			for(u32 c = 0; c < stride; ++c)
+			{
+				u32& next = transitions[state * stride + c];
+				if(next != 0)
+				{
+					failures[next] = transitions[failure * stride + c];
+					queue.push_back(next);
+				}
+				else
+					next = transitions[failure * stride + c];
+			}
+		}
+
+		// Renumber states so that states with output come last, then a match is detected by one comparison.
+		std::vector<u32> order(state_count);
+		u32 output_state_count = 0;
+		for(u32 state = 0; state < state_count; ++state)
+			if(state_patterns[state] != STATE_INVALID || output_links[state] != STATE_INVALID)
+				++output_state_count;
+		u32 next_plain = 0;
+		u32 next_output = state_count - output_state_count;
+		for(u32 state = 0; state < state_count; ++state)
+			order[state] = state_patterns[state] != STATE_INVALID || output_links[state] != STATE_INVALID ? next_output++ : next_plain++;
+
+		this->transitions_.resize(transitions.size());
+		this->state_patterns_.resize(state_count);
+		this->output_links_.resize(state_count);
+		for(u32 state = 0; state < state_count; ++state)
+		{
+			const u32 renumbered = order[state];
+			for(u32 c = 0; c < stride; ++c)
+				this->transitions_[renumbered * stride + c] = order[transitions[state * stride + c]] * stride;
+			this->state_patterns_[renumbered] = state_patterns[state];
+			this->output_links_[renumbered] = output_links[state] == STATE_INVALID ? STATE_INVALID : order[output_links[state]];
+		}
+		this->start_ = order[0] * stride;
+		this->first_output_offset_ = (state_count - output_state_count) * stride;
+	}
+
+	u64 multi_searcher::find_all(const codeunit_sequence_view& text, std::vector<match>& matches) const
+	{
+		const u32* transitions = this->transitions_.data();
+		const u64 size = text.size();
+		const char* data = text.data();
+		u64 count = 0;
+		u32 offset = this->start_;
+		for(u64 i = 0; i < size; ++i)
+		{
+			offset = transitions[offset + this->classes_[static_cast<u8>(data[i])]];
+			if(offset < this->first_output_offset_)
+				continue;
+			u32 state = offset / this->stride_;
+			if(this->state_patterns_[state] == STATE_INVALID)
+				state = this->output_links_[state];
+			while(state != STATE_INVALID)
+			{
+				const u32 pattern = this->state_patterns_[state];
+				const u64 pattern_size = this->pattern_sizes_[pattern];
+				matches.push_back({ i + 1 - pattern_size, pattern_size, pattern });
+				++count;
+				state = this->output_links_[state];
+			}
+		}
+		return count;
+	}
+
+	bool multi_searcher::contains_any(const codeunit_sequence_view& text) const noexcept
+	{
+		const u32* transitions = this->transitions_.data();
+		const u64 size = text.size();
+		const char* data = text.data();
+		u32 offset = this->start_;
+		for(u64 i = 0; i < size; ++i)
+		{
+			offset = transitions[offset + this->classes_[static_cast<u8>(data[i])]];
+			if(offset >= this->first_output_offset_)
+				return true;
+		}
+		return false;
+	}
+
+	u64 multi_searcher::replace_all(codeunit_sequence& target, const char mask) const noexcept
+	{
+		const u32* transitions = this->transitions_.data();
+		const u64 size = target.size();
+		char* data = target.data();
+		u64 count = 0;
+		// Codeunits before this are masked already, so overlapping matches do not write twice.
+		u64 masked_until = 0;
+		u32 offset = this->start_;
+		for(u64 i = 0; i < size; ++i)
+		{
+			// Masking only writes codeunits before i, which are consumed already.
+			offset = transitions[offset + this->classes_[static_cast<u8>(data[i])]];
+			if(offset < this->first_output_offset_)
+				continue;
+			u32 state = offset / this->stride_;
+			if(this->state_patterns_[state] == STATE_INVALID)
+				state = this->output_links_[state];
+			// The first output is the longest one ending here.
+			const u64 longest = this->pattern_sizes_[this->state_patterns_[state]];
+			const u64 from = maximum(i + 1 - longest, masked_until);
+			std::fill(data + from, data + i + 1, mask);
+			masked_until = i + 1;
+			for(; state != STATE_INVALID; state = this->output_links_[state])
+				++count;
+		}
+		return count;
+	}
+}
@@ -0,0 +1,155 @@
+#include "print.h"
+
+#if _WIN64
+#include <climits>
+#include <io.h>
+#else
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace ostr
+{
+	namespace
+	{
+#if _WIN64
+		[[nodiscard]] bool write_all(const int file_descriptor, const char* data, u64 size) noexcept
+		{
+			while(size > 0)
+			{
+				const int written = _write(file_descriptor, data, static_cast<unsigned>(minimum(size, u64{ INT_MAX })));
+				if(written <= 0)
+					return false;
+				data += written;
+				size -= static_cast<u64>(written);
+			}
+			return true;
+		}
+#endif
+
+		/**
+		 * \brief Write two pieces in order, by one call unless it is interrupted or partially written.
+		 */
+		[[nodiscard]] bool write_all(const int file_descriptor, const char* first, const u64 first_size, const char* second, const u64 second_size) noexcept
+		{
+#if _WIN64
+			return write_all(file_descriptor, first, first_size) && write_all(file_descriptor, second, second_size);
+#else
+			iovec pieces[2] = { { const_cast<char*>(first), first_size }, { const_cast<char*>(second), second_size } };
+			iovec* remaining = pieces;
+			int remaining_count = 2;
+			while(remaining_count > 0)
+			{
+				if(remaining->iov_len == 0)
+				{
+					++remaining;
+					--remaining_count;
+					continue;
+				}
+				const ssize_t written = ::writev(file_descriptor, remaining, remaining_count);
+				if(written < 0 && errno == EINTR)
+					continue;
+				if(written <= 0)
+					return false;
+				u64 skipped = static_cast<u64>(written);
+				while(remaining_count > 0 && skipped >= remaining->iov_len)
+				{
+					skipped -= remaining->iov_len;
+					++remaining;
+					--remaining_count;
+				}
+				if(remaining_count > 0)
+				{
+					remaining->iov_base = static_cast<char*>(remaining->iov_base) + skipped;
+					remaining->iov_len -= skipped;
+				}
+			}
+			return true;
+#endif
+		}
+
+		[[nodiscard]] bool write_all(std::FILE* file, const char* first, const u64 first_size, const char* second, const u64 second_size) noexcept
+		{
+			return (first_size == 0 || std::fwrite(first, 1, first_size, file) == first_size)
+				&& (second_size == 0 || std::fwrite(second, 1, second_size, file) == second_size);
+		}
+	}
+
+	buffered_writer::buffered_writer(const int file_descriptor, const u64 capacity)
+		: storage_{ new char[capacity] }
+		, buffer_{ this->storage_.get() }
+		, capacity_{ capacity }
+		, file_descriptor_{ file_descriptor }
+	{ }
+
+	buffered_writer::buffered_writer(std::FILE* file, const u64 capacity)
+		: storage_{ new char[capacity] }
+		, buffer_{ this->storage_.get() }
+		, capacity_{ capacity }
+		, file_{ file }
+	{ }
+
+	buffered_writer::buffered_writer(const int file_descriptor, char* buffer, const u64 capacity) noexcept
+		: buffer_{ buffer }
+		, capacity_{ capacity }
+		, file_descriptor_{ file_descriptor }
+	{ }
+
+	buffered_writer::buffered_writer(std::FILE* file, char* buffer, const u64 capacity) noexcept
+		: buffer_{ buffer }
+		, capacity_{ capacity }
+		, file_{ file }
+	{ }
+
+	buffered_writer::~buffered_writer()
+	{
+		this->flush();
+	}
+
+	bool buffered_writer::flush()
+	{
+		if(this->size_ > 0)
+			this->write(nullptr, 0);
+		return !this->failed_;
+	}
+
+	bool buffered_writer::has_failed() const noexcept
+	{
+		return this->failed_;
+	}
+
+	u64 buffered_writer::size() const noexcept
+	{
+		return this->size_;
+	}
+
+	u64 buffered_writer::capacity() const noexcept
+	{
+		return this->capacity_;
+	}
+
+	void buffered_writer::spill(const char* data, const u64 size)
+	{
+		// Large pieces are written along with the buffer, instead of being copied through it.
+		if(size >= this->capacity_)
+		{
+			this->write(data, size);
+			return;
+		}
+		this->write(nullptr, 0);
+		std::memcpy(this->buffer_, data, size);
+		this->size_ = size;
+	}
+
+	bool buffered_writer::write(const char* data, const u64 size)
+	{
+		const bool written = this->file_
+			? write_all(this->file_, this->buffer_, this->size_, data, size)
+			: write_all(this->file_descriptor_, this->buffer_, this->size_, data, size);
+		this->size_ = 0;
+		if(!written)
+			this->failed_ = true;
+		return written;
+	}
+}
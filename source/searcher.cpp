@@ -0,0 +1,106 @@
+
+#include "searcher.h"
+#include <algorithm>
+#include "common/constants.h"
+
+namespace ostr
+{
+	searcher::searcher(const codeunit_sequence_view& pattern) noexcept
+		: pattern_{ pattern }
+	{
+		simd::prepare(this->table_, this->pattern_.data(), this->pattern_.size());
+	}
+
+	codeunit_sequence_view searcher::pattern() const noexcept
+	{
+		return this->pattern_.view();
+	}
+
+	u64 searcher::find(const codeunit_sequence_view& haystack, const u64 from) const noexcept
+	{
+		return this->find_prepared(this->pattern_.view(), haystack, from);
+	}
+
+	u64 searcher::find_all(const codeunit_sequence_view& haystack, std::vector<u64>& indices) const
+	{
+		const codeunit_sequence_view pattern = this->pattern_.view();
+		u64 count = 0;
+		u64 from = 0;
+		while(true)
+		{
+			const u64 index = this->find_prepared(pattern, haystack, from);
+			if(index == global_constant::INDEX_INVALID)
+				break;
+			indices.push_back(index);
+			++count;
+			from = index + pattern.size();
+		}
+		return count;
+	}
+
+	u64 searcher::count(const codeunit_sequence_view& haystack) const noexcept
+	{
+		const codeunit_sequence_view pattern = this->pattern_.view();
+		u64 count = 0;
+		u64 from = 0;
+		while(true)
+		{
+			const u64 index = this->find_prepared(pattern, haystack, from);
+			if(index == global_constant::INDEX_INVALID)
+				break;
+			++count;
+			from = index + pattern.size();
+		}
+		return count;
+	}
+
+	codeunit_sequence& searcher::replace(codeunit_sequence& target, const codeunit_sequence_view& destination) const
+	{
+		const codeunit_sequence_view pattern = this->pattern_.view();
+		const u64 source_size = pattern.size();
+		const u64 destination_size = destination.size();
+		u64 found_index = this->find_prepared(pattern, target.view(), 0);
+		if(found_index == global_constant::INDEX_INVALID)
+			return target;
+
+		if(destination_size <= source_size)
+		{
+			// Writing never overtakes reading, so everything is done in place.
+			char* data = target.data();
+			u64 read_index = found_index;
+			u64 write_index = found_index;
+			while(found_index != global_constant::INDEX_INVALID)
+			{
+				std::copy(data + read_index, data + found_index, data + write_index);
+				write_index += found_index - read_index;
+				std::copy_n(destination.data(), destination_size, data + write_index);
+				write_index += destination_size;
+				read_index = found_index + source_size;
+				found_index = this->find_prepared(pattern, target.view(), read_index);
+			}
+			std::copy(data + read_index, data + target.size(), data + write_index);
+			write_index += target.size() - read_index;
+			return target.subsequence(0, write_index);
+		}
+
+		codeunit_sequence result(target.size() + destination_size - source_size);
+		u64 read_index = 0;
+		while(found_index != global_constant::INDEX_INVALID)
+		{
+			result.append(target.subview(read_index, found_index - read_index));
+			result.append(destination);
+			read_index = found_index + source_size;
+			found_index = this->find_prepared(pattern, target.view(), read_index);
+		}
+		result.append(target.subview(read_index));
+		target = std::move(result);
+		return target;
+	}
+
+	u64 searcher::find_prepared(const codeunit_sequence_view& pattern, const codeunit_sequence_view& haystack, const u64 from) const noexcept
+	{
+		const codeunit_sequence_view view = haystack.subview(from);
+		const u64 found = simd::index_of(view.data(), view.size(), pattern.data(), pattern.size(), this->table_);
+		return found == global_constant::INDEX_INVALID ? found : found + from;
+	}
+}
@@ -0,0 +1,3502 @@
+
+#include "common/simd.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include "common/constants.h"
+#include "common/functions.h"
+#include "unicode.h"
+
+#if OPEN_STRING_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif OPEN_STRING_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace ostr::simd
+{
+	namespace details
+	{
+		[[nodiscard]] instruction_set detect_instruction_set() noexcept
+		{
+#if OPEN_STRING_SIMD_X86
+#if defined(_MSC_VER)
+			int info[4] = { };
+			__cpuid(info, 1);
+			const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+			__cpuidex(info, 7, 0);
+			const bool has_avx2 = (info[1] & (1 << 5)) != 0;
+			return os_saves_ymm && has_avx2 ? instruction_set::avx2 : instruction_set::sse2;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") ? instruction_set::avx2 : instruction_set::sse2;
+#endif
+#elif OPEN_STRING_SIMD_NEON
+			return instruction_set::neon;
+#else
+			return instruction_set::portable;
+#endif
+		}
+
+		[[nodiscard]] instruction_set get_best_instruction_set() noexcept
+		{
+			static const instruction_set best = detect_instruction_set();
+			return best;
+		}
+
+		[[nodiscard]] std::atomic<instruction_set>& get_active_instruction_set() noexcept
+		{
+			static std::atomic<instruction_set> active{ get_best_instruction_set() };
+			return active;
+		}
+
+		// code-region-start: SWAR helpers
+
+		static constexpr u64 SWAR_LOW_BITS = 0x0101010101010101ull;
+		static constexpr u64 SWAR_LOW_7_BITS = 0x7F7F7F7F7F7F7F7Full;
+
+		[[nodiscard]] constexpr u64 broadcast(const char codeunit) noexcept
+		{
+			return SWAR_LOW_BITS * static_cast<u8>(codeunit);
+		}
+
+		/**
+		 * @return 8 bytes from p, the first byte is always the lowest one.
+		 */
+		[[nodiscard]] inline u64 load_word(const char* p) noexcept
+		{
+			u64 word;
+			std::memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			word = __builtin_bswap64(word);
+#endif
+			return word;
+		}
+
+		/**
+		 * @return a word with the high bit of each zero byte in word set, and all other bits clear.
+		 * Unlike the famous (v - 0x01..) & ~v & 0x80.. trick, this has no false positive,
+		 * so it is usable for searching in both directions.
+		 */
+		[[nodiscard]] constexpr u64 mark_zero_bytes(const u64 word) noexcept
+		{
+			const u64 t = ((word & SWAR_LOW_7_BITS) + SWAR_LOW_7_BITS) | word;
+			return ~(t | SWAR_LOW_7_BITS);
+		}
+
+		[[nodiscard]] inline u64 first_marked_byte(const u64 marks) noexcept
+		{
+			return count_trailing_zeros(marks) / 8;
+		}
+
+		[[nodiscard]] inline u64 last_marked_byte(const u64 marks) noexcept
+		{
+			return 7 - count_leading_zeros(marks) / 8;
+		}
+
+		[[nodiscard]] inline u64 count_bits(const u64 value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<u64>(__builtin_popcountll(value));
+#else
+			// __popcnt64 of msvc requires popcnt instruction, which is not in baseline x86-64.
+			u64 v = value - ((value >> 1) & 0x5555555555555555ull);
+			v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+			v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return (v * SWAR_LOW_BITS) >> 56;
+#endif
+		}
+
+		/**
+		 * @return value with its lowest count set bits cleared.
+		 */
+		[[nodiscard]] inline u64 clear_lowest_bits(u64 value, const u64 count) noexcept
+		{
+			for(u64 i = 0; i < count; ++i)
+				value &= value - 1;
+			return value;
+		}
+
+		// code-region-end: SWAR helpers
+
+		// code-region-start: byte search kernels
+
+		[[nodiscard]] u64 index_of_scalar(const char* data, const u64 from, const u64 size, const char codeunit) noexcept
+		{
+			for(u64 i = from; i < size; ++i)
+				if(data[i] == codeunit)
+					return i;
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] u64 last_index_of_scalar(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			for(u64 i = size; i > 0; --i)
+				if(data[i - 1] == codeunit)
+					return i - 1;
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] u64 index_of_portable(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const u64 pattern = broadcast(codeunit);
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+				if(const u64 marks = mark_zero_bytes(load_word(data + i) ^ pattern); marks != 0)
+					return i + first_marked_byte(marks);
+			return index_of_scalar(data, i, size, codeunit);
+		}
+
+		[[nodiscard]] u64 last_index_of_portable(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const u64 pattern = broadcast(codeunit);
+			u64 i = size;
+			for(; i >= 8; i -= 8)
+				if(const u64 marks = mark_zero_bytes(load_word(data + i - 8) ^ pattern); marks != 0)
+					return i - 8 + last_marked_byte(marks);
+			return last_index_of_scalar(data, i, codeunit);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		[[nodiscard]] u64 index_of_sse2(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const __m128i pattern = _mm_set1_epi8(codeunit);
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern))); mask != 0)
+					return i + count_trailing_zeros(mask);
+			}
+			return index_of_scalar(data, i, size, codeunit);
+		}
+
+		[[nodiscard]] u64 last_index_of_sse2(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const __m128i pattern = _mm_set1_epi8(codeunit);
+			u64 i = size;
+			for(; i >= 16; i -= 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern))); mask != 0)
+					return i - 16 + (63 - count_leading_zeros(mask));
+			}
+			return last_index_of_scalar(data, i, codeunit);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 index_of_avx2(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const __m256i pattern = _mm256_set1_epi8(codeunit);
+			u64 i = 0;
+			// Two blocks per step to hide latency of movemask on long inputs.
+			for(; i + 64 <= size; i += 64)
+			{
+				const __m256i block_0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				const __m256i block_1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+				const __m256i equal_0 = _mm256_cmpeq_epi8(block_0, pattern);
+				const __m256i equal_1 = _mm256_cmpeq_epi8(block_1, pattern);
+				if(_mm256_testz_si256(_mm256_or_si256(equal_0, equal_1), _mm256_or_si256(equal_0, equal_1)))
+					continue;
+				const u64 mask = static_cast<u32>(_mm256_movemask_epi8(equal_0)) | (static_cast<u64>(static_cast<u32>(_mm256_movemask_epi8(equal_1))) << 32);
+				return i + count_trailing_zeros(mask);
+			}
+			for(; i + 32 <= size; i += 32)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				if(const u32 mask = static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern))); mask != 0)
+					return i + count_trailing_zeros(mask);
+			}
+			// Tail is handled here instead of calling sse2 kernel, to avoid transition between VEX and legacy SSE encoding.
+			const __m128i pattern_half = _mm256_castsi256_si128(pattern);
+			for(; i + 16 <= size; i += 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern_half))); mask != 0)
+					return i + count_trailing_zeros(mask);
+			}
+			return index_of_scalar(data, i, size, codeunit);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 last_index_of_avx2(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const __m256i pattern = _mm256_set1_epi8(codeunit);
+			u64 i = size;
+			for(; i >= 64; i -= 64)
+			{
+				const __m256i block_0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 64));
+				const __m256i block_1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32));
+				const __m256i equal_0 = _mm256_cmpeq_epi8(block_0, pattern);
+				const __m256i equal_1 = _mm256_cmpeq_epi8(block_1, pattern);
+				if(_mm256_testz_si256(_mm256_or_si256(equal_0, equal_1), _mm256_or_si256(equal_0, equal_1)))
+					continue;
+				const u64 mask = static_cast<u32>(_mm256_movemask_epi8(equal_0)) | (static_cast<u64>(static_cast<u32>(_mm256_movemask_epi8(equal_1))) << 32);
+				return i - 64 + (63 - count_leading_zeros(mask));
+			}
+			for(; i >= 32; i -= 32)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32));
+				if(const u32 mask = static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern))); mask != 0)
+					return i - 32 + (63 - count_leading_zeros(mask));
+			}
+			const __m128i pattern_half = _mm256_castsi256_si128(pattern);
+			for(; i >= 16; i -= 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern_half))); mask != 0)
+					return i - 16 + (63 - count_leading_zeros(mask));
+			}
+			return last_index_of_scalar(data, i, codeunit);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		/**
+		 * @return 4 bits for each byte of a comparison result, since neon has no movemask.
+		 */
+		[[nodiscard]] inline u64 get_neon_mask(const uint8x16_t equal) noexcept
+		{
+			const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(equal), 4);
+			return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+		}
+
+		[[nodiscard]] u64 index_of_neon(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const uint8x16_t pattern = vdupq_n_u8(static_cast<u8>(codeunit));
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+			{
+				const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i));
+				if(const u64 mask = get_neon_mask(vceqq_u8(block, pattern)); mask != 0)
+					return i + count_trailing_zeros(mask) / 4;
+			}
+			return index_of_scalar(data, i, size, codeunit);
+		}
+
+		[[nodiscard]] u64 last_index_of_neon(const char* data, const u64 size, const char codeunit) noexcept
+		{
+			const uint8x16_t pattern = vdupq_n_u8(static_cast<u8>(codeunit));
+			u64 i = size;
+			for(; i >= 16; i -= 16)
+			{
+				const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i - 16));
+				if(const u64 mask = get_neon_mask(vceqq_u8(block, pattern)); mask != 0)
+					return i - 16 + (63 - count_leading_zeros(mask)) / 4;
+			}
+			return last_index_of_scalar(data, i, codeunit);
+		}
+#endif
+
+		// code-region-end: byte search kernels
+
+		// code-region-start: substring search kernels
+
+		// Substring search checks a block of candidates at once by comparing two codeunits of pattern,
+		// and verifies the whole pattern only for candidates passing the filter.
+		// See http://0x80.pl/articles/simd-strfind.html for details.
+		// Bit n of a filter mask stands for candidate (block + n / lane_bits), where lane_bits is 1 for x86,
+		// 4 for neon and 8 for SWAR.
+
+		/**
+		 * Patterns shorter than this are always searched with candidate filter, since verifying is cheap.
+		 * Longer patterns may fall back to two-way search, which is linear in the worst case.
+		 */
+		static constexpr u64 TWO_WAY_MINIMUM_PATTERN_SIZE = 32;
+
+		/**
+		 * \brief Candidate filter gives up once verifying costs far more than scanning,
+		 * which only happens on highly repetitive data, then two-way search continues from resume.
+		 * Forward search resumes at candidate resume, backward search resumes with candidates [0, resume).
+		 */
+		struct pair_search_state
+		{
+			u64 index = global_constant::INDEX_INVALID;
+			u64 resume = global_constant::INDEX_INVALID;
+
+			[[nodiscard]] bool is_finished() const noexcept
+			{
+				return this->index != global_constant::INDEX_INVALID || this->resume != global_constant::INDEX_INVALID;
+			}
+		};
+
+		class verify_budget
+		{
+		public:
+			explicit verify_budget(const u64 pattern_size) noexcept
+				: pattern_size_{ pattern_size }
+				, limited_{ pattern_size >= TWO_WAY_MINIMUM_PATTERN_SIZE }
+			{ }
+
+			/**
+			 * \brief Account a failed verification.
+			 * @param scanned count of candidates passed through the filter so far
+			 * @return Whether the filter should keep going.
+			 */
+			[[nodiscard]] bool consume(const u64 scanned) noexcept
+			{
+				if(!this->limited_)
+					return true;
+				this->spent_ += this->pattern_size_;
+				return this->spent_ <= 8 * (scanned + 8 * this->pattern_size_);
+			}
+
+		private:
+			u64 pattern_size_;
+			bool limited_;
+			u64 spent_ = 0;
+		};
+
+		/**
+		 * \brief Pattern with offsets of the two codeunits compared by candidate filter.
+		 * They are the first and the last ones by default, and the rarest ones when pattern is prepared.
+		 */
+		struct pair_pattern
+		{
+			const char* data;
+			u64 size;
+			u64 offset_0;
+			u64 offset_1;
+		};
+
+		[[nodiscard]] inline bool verify_candidate(const char* candidate, const pair_pattern& pattern) noexcept
+		{
+			return std::memcmp(candidate, pattern.data, pattern.size) == 0;
+		}
+
+		[[nodiscard]] pair_search_state verify_forward(const char* data, const u64 block, u64 mask, const u64 lane_shift, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			while(mask != 0)
+			{
+				const u64 candidate = block + (count_trailing_zeros(mask) >> lane_shift);
+				if(verify_candidate(data + candidate, pattern))
+					return { candidate };
+				if(!budget.consume(block))
+					return { global_constant::INDEX_INVALID, candidate + 1 };
+				mask &= mask - 1;
+			}
+			return { };
+		}
+
+		[[nodiscard]] pair_search_state verify_backward(const char* data, const u64 block, u64 mask, const u64 lane_shift, const u64 scanned, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			while(mask != 0)
+			{
+				const u64 bit = 63 - count_leading_zeros(mask);
+				const u64 candidate = block + (bit >> lane_shift);
+				if(verify_candidate(data + candidate, pattern))
+					return { candidate };
+				if(!budget.consume(scanned))
+					return { global_constant::INDEX_INVALID, candidate };
+				mask &= ~(1ull << bit);
+			}
+			return { };
+		}
+
+		/**
+		 * \brief Check candidates [from, candidates) one by one.
+		 */
+		[[nodiscard]] pair_search_state index_of_pair_scalar(const char* data, const u64 from, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const char first = pattern.data[pattern.offset_0];
+			const char last = pattern.data[pattern.offset_1];
+			for(u64 i = from; i < candidates; ++i)
+			{
+				if(data[i + pattern.offset_0] != first || data[i + pattern.offset_1] != last)
+					continue;
+				if(verify_candidate(data + i, pattern))
+					return { i };
+				if(!budget.consume(i))
+					return { global_constant::INDEX_INVALID, i + 1 };
+			}
+			return { };
+		}
+
+		/**
+		 * \brief Check candidates [0, until) one by one, from the last one.
+		 */
+		[[nodiscard]] pair_search_state last_index_of_pair_scalar(const char* data, const u64 until, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const char first = pattern.data[pattern.offset_0];
+			const char last = pattern.data[pattern.offset_1];
+			for(u64 i = until; i > 0; --i)
+			{
+				const u64 candidate = i - 1;
+				if(data[candidate + pattern.offset_0] != first || data[candidate + pattern.offset_1] != last)
+					continue;
+				if(verify_candidate(data + candidate, pattern))
+					return { candidate };
+				if(!budget.consume(candidates - candidate))
+					return { global_constant::INDEX_INVALID, candidate };
+			}
+			return { };
+		}
+
+		[[nodiscard]] pair_search_state index_of_pair_portable(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const u64 first = broadcast(pattern.data[pattern.offset_0]);
+			const u64 last = broadcast(pattern.data[pattern.offset_1]);
+			u64 i = 0;
+			for(; i + 8 <= candidates; i += 8)
+			{
+				const u64 differences = (load_word(data + i + pattern.offset_0) ^ first) | (load_word(data + i + pattern.offset_1) ^ last);
+				if(const u64 marks = mark_zero_bytes(differences); marks != 0)
+					if(const pair_search_state state = verify_forward(data, i, marks, 3, pattern, budget); state.is_finished())
+						return state;
+			}
+			return index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+
+		[[nodiscard]] pair_search_state last_index_of_pair_portable(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const u64 first = broadcast(pattern.data[pattern.offset_0]);
+			const u64 last = broadcast(pattern.data[pattern.offset_1]);
+			u64 i = candidates;
+			for(; i >= 8; i -= 8)
+			{
+				const u64 differences = (load_word(data + i - 8 + pattern.offset_0) ^ first) | (load_word(data + i - 8 + pattern.offset_1) ^ last);
+				if(const u64 marks = mark_zero_bytes(differences); marks != 0)
+					if(const pair_search_state state = verify_backward(data, i - 8, marks, 3, candidates - i, pattern, budget); state.is_finished())
+						return state;
+			}
+			return last_index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		[[nodiscard]] pair_search_state index_of_pair_sse2(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const __m128i first = _mm_set1_epi8(pattern.data[pattern.offset_0]);
+			const __m128i last = _mm_set1_epi8(pattern.data[pattern.offset_1]);
+			u64 i = 0;
+			for(; i + 16 <= candidates; i += 16)
+			{
+				const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern.offset_0));
+				const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern.offset_1));
+				const __m128i equal = _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(equal)); mask != 0)
+					if(const pair_search_state state = verify_forward(data, i, mask, 0, pattern, budget); state.is_finished())
+						return state;
+			}
+			return index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+
+		[[nodiscard]] pair_search_state last_index_of_pair_sse2(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const __m128i first = _mm_set1_epi8(pattern.data[pattern.offset_0]);
+			const __m128i last = _mm_set1_epi8(pattern.data[pattern.offset_1]);
+			u64 i = candidates;
+			for(; i >= 16; i -= 16)
+			{
+				const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16 + pattern.offset_0));
+				const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16 + pattern.offset_1));
+				const __m128i equal = _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(equal)); mask != 0)
+					if(const pair_search_state state = verify_backward(data, i - 16, mask, 0, candidates - i, pattern, budget); state.is_finished())
+						return state;
+			}
+			return last_index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 pair_search_state index_of_pair_avx2(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const __m256i first = _mm256_set1_epi8(pattern.data[pattern.offset_0]);
+			const __m256i last = _mm256_set1_epi8(pattern.data[pattern.offset_1]);
+			u64 i = 0;
+			for(; i + 32 <= candidates; i += 32)
+			{
+				const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + pattern.offset_0));
+				const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + pattern.offset_1));
+				const __m256i equal = _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last));
+				if(const u32 mask = static_cast<u32>(_mm256_movemask_epi8(equal)); mask != 0)
+					if(const pair_search_state state = verify_forward(data, i, mask, 0, pattern, budget); state.is_finished())
+						return state;
+			}
+			// Tail is handled here instead of calling sse2 kernel, to avoid transition between VEX and legacy SSE encoding.
+			const __m128i first_half = _mm256_castsi256_si128(first);
+			const __m128i last_half = _mm256_castsi256_si128(last);
+			for(; i + 16 <= candidates; i += 16)
+			{
+				const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern.offset_0));
+				const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern.offset_1));
+				const __m128i equal = _mm_and_si128(_mm_cmpeq_epi8(block_first, first_half), _mm_cmpeq_epi8(block_last, last_half));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(equal)); mask != 0)
+					if(const pair_search_state state = verify_forward(data, i, mask, 0, pattern, budget); state.is_finished())
+						return state;
+			}
+			return index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 pair_search_state last_index_of_pair_avx2(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const __m256i first = _mm256_set1_epi8(pattern.data[pattern.offset_0]);
+			const __m256i last = _mm256_set1_epi8(pattern.data[pattern.offset_1]);
+			u64 i = candidates;
+			for(; i >= 32; i -= 32)
+			{
+				const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32 + pattern.offset_0));
+				const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32 + pattern.offset_1));
+				const __m256i equal = _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last));
+				if(const u32 mask = static_cast<u32>(_mm256_movemask_epi8(equal)); mask != 0)
+					if(const pair_search_state state = verify_backward(data, i - 32, mask, 0, candidates - i, pattern, budget); state.is_finished())
+						return state;
+			}
+			const __m128i first_half = _mm256_castsi256_si128(first);
+			const __m128i last_half = _mm256_castsi256_si128(last);
+			for(; i >= 16; i -= 16)
+			{
+				const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16 + pattern.offset_0));
+				const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16 + pattern.offset_1));
+				const __m128i equal = _mm_and_si128(_mm_cmpeq_epi8(block_first, first_half), _mm_cmpeq_epi8(block_last, last_half));
+				if(const u32 mask = static_cast<u32>(_mm_movemask_epi8(equal)); mask != 0)
+					if(const pair_search_state state = verify_backward(data, i - 16, mask, 0, candidates - i, pattern, budget); state.is_finished())
+						return state;
+			}
+			return last_index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		// Only the highest bit of each 4 bits is kept, so that one candidate stands for one bit.
+		static constexpr u64 NEON_LANE_HIGH_BITS = 0x8888888888888888ull;
+
+		[[nodiscard]] pair_search_state index_of_pair_neon(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const uint8x16_t first = vdupq_n_u8(static_cast<u8>(pattern.data[pattern.offset_0]));
+			const uint8x16_t last = vdupq_n_u8(static_cast<u8>(pattern.data[pattern.offset_1]));
+			u64 i = 0;
+			for(; i + 16 <= candidates; i += 16)
+			{
+				const uint8x16_t block_first = vld1q_u8(reinterpret_cast<const u8*>(data + i + pattern.offset_0));
+				const uint8x16_t block_last = vld1q_u8(reinterpret_cast<const u8*>(data + i + pattern.offset_1));
+				const uint8x16_t equal = vandq_u8(vceqq_u8(block_first, first), vceqq_u8(block_last, last));
+				if(const u64 mask = get_neon_mask(equal) & NEON_LANE_HIGH_BITS; mask != 0)
+					if(const pair_search_state state = verify_forward(data, i, mask, 2, pattern, budget); state.is_finished())
+						return state;
+			}
+			return index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+
+		[[nodiscard]] pair_search_state last_index_of_pair_neon(const char* data, const u64 candidates, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const uint8x16_t first = vdupq_n_u8(static_cast<u8>(pattern.data[pattern.offset_0]));
+			const uint8x16_t last = vdupq_n_u8(static_cast<u8>(pattern.data[pattern.offset_1]));
+			u64 i = candidates;
+			for(; i >= 16; i -= 16)
+			{
+				const uint8x16_t block_first = vld1q_u8(reinterpret_cast<const u8*>(data + i - 16 + pattern.offset_0));
+				const uint8x16_t block_last = vld1q_u8(reinterpret_cast<const u8*>(data + i - 16 + pattern.offset_1));
+				const uint8x16_t equal = vandq_u8(vceqq_u8(block_first, first), vceqq_u8(block_last, last));
+				if(const u64 mask = get_neon_mask(equal) & NEON_LANE_HIGH_BITS; mask != 0)
+					if(const pair_search_state state = verify_backward(data, i - 16, mask, 2, candidates - i, pattern, budget); state.is_finished())
+						return state;
+			}
+			return last_index_of_pair_scalar(data, i, candidates, pattern, budget);
+		}
+#endif
+
+		/**
+		 * \brief Reads a range of codeunits forward, or backward as if the range is reversed,
+		 * so that one two-way implementation serves both directions.
+		 */
+		template<bool Reverse>
+		struct codeunit_reader
+		{
+			const char* data;
+			u64 size;
+
+			[[nodiscard]] u8 operator[](const u64 index) const noexcept
+			{
+				if constexpr (Reverse)
+					return static_cast<u8>(this->data[this->size - 1 - index]);
+				else
+					return static_cast<u8>(this->data[index]);
+			}
+		};
+
+		/**
+		 * \brief Fill shift table and critical factorization of needle for two-way search.
+		 */
+		template<bool Reverse>
+		void prepare_two_way(const codeunit_reader<Reverse> needle, substring_table& table) noexcept
+		{
+			const u64 m = needle.size;
+			table.shift.fill(0);
+			for(u64 i = 0; i < m; ++i)
+				table.shift[needle[i]] = i + 1;
+
+			// Critical factorization via maximal suffixes under both orders, indices wrap from u64(-1).
+			const auto maximal_suffix = [&needle, m](const bool greater, u64& period) noexcept -> u64
+			{
+				u64 ip = global_constant::INDEX_INVALID;
+				u64 jp = 0;
+				u64 k = 1;
+				period = 1;
+				while(jp + k < m)
+				{
+					const u8 a = needle[ip + k];
+					const u8 b = needle[jp + k];
+					if(a == b)
+					{
+						if(k == period)
+						{
+							jp += period;
+							k = 1;
+						}
+						else
+							++k;
+					}
+					else if(greater ? a > b : a < b)
+					{
+						jp += k;
+						k = 1;
+						period = jp - ip;
+					}
+					else
+					{
+						ip = jp++;
+						k = period = 1;
+					}
+				}
+				return ip;
+			};
+			u64 period_greater = 0;
+			u64 period_less = 0;
+			const u64 suffix_greater = maximal_suffix(true, period_greater);
+			const u64 suffix_less = maximal_suffix(false, period_less);
+			const bool use_less = suffix_less + 1 > suffix_greater + 1;
+			const u64 ms = use_less ? suffix_less : suffix_greater;
+			const u64 period = use_less ? period_less : period_greater;
+			table.critical_position = ms + 1;
+
+			bool periodic = true;
+			for(u64 i = 0; i < table.critical_position; ++i)
+			{
+				if(needle[i] != needle[i + period])
+				{
+					periodic = false;
+					break;
+				}
+			}
+			if(periodic)
+			{
+				table.period = period;
+				table.memory_reset = m - period;
+			}
+			else
+			{
+				table.period = maximum(ms, m - ms - 1) + 1;
+				table.memory_reset = 0;
+			}
+		}
+
+		/**
+		 * \brief Two-way string matching by Crochemore and Perrin, with a last codeunit shift table.
+		 * It runs in O(size + pattern_size) time and O(1) extra space besides the table.
+		 * @return index of the first occurrence in the read order, return global_constant::INDEX_INVALID if not found
+		 */
+		template<bool Reverse>
+		[[nodiscard]] u64 two_way(const codeunit_reader<Reverse> haystack, const codeunit_reader<Reverse> needle, const substring_table& table) noexcept
+		{
+			const u64 n = haystack.size;
+			const u64 m = needle.size;
+			if(m > n)
+				return global_constant::INDEX_INVALID;
+			const u64 critical = table.critical_position;
+
+			u64 memory = 0;
+			u64 h = 0;
+			while(n - h >= m)
+			{
+				if(const u64 k = m - table.shift[haystack[h + m - 1]]; k != 0)
+				{
+					h += maximum(k, memory);
+					memory = 0;
+					continue;
+				}
+				u64 k = maximum(critical, memory);
+				while(k < m && needle[k] == haystack[h + k])
+					++k;
+				if(k < m)
+				{
+					h += k + 1 - critical;
+					memory = 0;
+					continue;
+				}
+				k = critical;
+				while(k > memory && needle[k - 1] == haystack[h + k - 1])
+					--k;
+				if(k <= memory)
+					return h;
+				h += table.period;
+				memory = table.memory_reset;
+			}
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] pair_search_state index_of_pair(const char* data, const u64 size, const pair_pattern& pattern, verify_budget& budget) noexcept
+		{
+			const u64 candidates = size - pattern.size + 1;
+			switch(get_instruction_set())
+			{
+#if OPEN_STRING_SIMD_X86
+			case instruction_set::avx2:
+				return index_of_pair_avx2(data, candidates, pattern, budget);
+			case instruction_set::sse2:
+				return index_of_pair_sse2(data, candidates, pattern, budget);
+#elif OPEN_STRING_SIMD_NEON
+			case instruction_set::neon:
+				return index_of_pair_neon(data, candidates, pattern, budget);
+#endif
+			default:
+				return index_of_pair_portable(data, candidates, pattern, budget);
+			}
+		}
+
+		// Rough frequency of each codeunit in text and source code, higher is more common.
+		[[nodiscard]] constexpr u8 get_codeunit_frequency_rank(const u8 codeunit) noexcept
+		{
+			constexpr const char* letters_by_frequency = "etaoinshrdlcumwfgypbvkjxqz";
+			if(codeunit == ' ')
+				return 255;
+			if(codeunit >= 'a' && codeunit <= 'z')
+			{
+				u8 rank = 250;
+				for(const char* letter = letters_by_frequency; *letter != static_cast<char>(codeunit); ++letter)
+					rank -= 2;
+				return rank;
+			}
+			if(codeunit >= '0' && codeunit <= '9')
+				return 190;
+			if(codeunit >= 'A' && codeunit <= 'Z')
+				return 160;
+			if(codeunit == '\n' || codeunit == '\t')
+				return 150;
+			if(codeunit >= 0x80 && codeunit < 0xC0)
+				return 140;	// utf-8 continuation codeunits
+			if(codeunit > ' ' && codeunit < 0x7F)
+				return 130;	// punctuations
+			if(codeunit >= 0xC0)
+				return 60;	// utf-8 leading codeunits
+			return 0;
+		}
+
+		// code-region-end: substring search kernels
+
+		// code-region-start: codeunit set kernels
+
+		// A set with at most this many codeunits, or at most this many codeunits absent,
+		// is searched by comparing with each member. Other sets use nibble table lookup where shuffle is available.
+		static constexpr u64 SMALL_SET_SIZE_MAX = 4;
+
+		struct small_set
+		{
+			// Padded by repeating the first member.
+			std::array<char, SMALL_SET_SIZE_MAX> units;
+			// Whether units are the absent ones, so matches should be inverted.
+			bool negate;
+		};
+
+		/**
+		 * \brief A codeunit (hi << 4 | lo) is in set if bit (hi & 7) of rows[hi >> 3][lo] is set.
+		 * See http://0x80.pl/articles/simd-byte-lookup.html for details.
+		 */
+		struct nibble_table
+		{
+			std::array<std::array<u8, 16>, 2> rows;
+			// Whether rows stand for the absent codeunits, so matches should be inverted.
+			bool negate;
+		};
+
+		/**
+		 * @return Members of set or its complement, whichever is smaller.
+		 */
+		[[nodiscard]] codeunit_set get_smaller_members(const codeunit_set& set, bool& negate) noexcept
+		{
+			negate = set.size() > 128;
+			return negate ? set.complement() : set;
+		}
+
+		template<class F>
+		void for_each_member(const codeunit_set& set, F&& function) noexcept
+		{
+			const std::array<u64, 4>& bits = set.get_bits();
+			for(u64 i = 0; i < bits.size(); ++i)
+				for(u64 word = bits[i]; word != 0; word &= word - 1)
+					function(static_cast<u8>(i * 64 + count_trailing_zeros(word)));
+		}
+
+		/**
+		 * @return Whether set is small enough to be searched by comparing with each member.
+		 */
+		[[nodiscard]] bool make_small_set(const codeunit_set& set, small_set& result) noexcept
+		{
+			const codeunit_set members = get_smaller_members(set, result.negate);
+			const u64 size = members.size();
+			if(size == 0 || size > SMALL_SET_SIZE_MAX)
+				return false;
+			u64 count = 0;
+			for_each_member(members, [&result, &count](const u8 unit) { result.units[count++] = static_cast<char>(unit); });
+			for(; count < SMALL_SET_SIZE_MAX; ++count)
+				result.units[count] = result.units[0];
+			return true;
+		}
+
+		[[nodiscard]] nibble_table make_nibble_table(const codeunit_set& set) noexcept
+		{
+			nibble_table result{ };
+			const codeunit_set members = get_smaller_members(set, result.negate);
+			for_each_member(members, [&result](const u8 unit)
+			{
+				result.rows[unit >> 7][unit & 0x0F] |= static_cast<u8>(1u << ((unit >> 4) & 7));
+			});
+			return result;
+		}
+
+		[[nodiscard]] u64 index_of_any_scalar(const char* data, const u64 from, const u64 size, const codeunit_set& set) noexcept
+		{
+			for(u64 i = from; i < size; ++i)
+				if(set.contains(data[i]))
+					return i;
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] u64 last_index_of_any_scalar(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			for(u64 i = size; i > 0; --i)
+				if(set.contains(data[i - 1]))
+					return i - 1;
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] inline u64 mark_small_set_portable(const u64 word, const std::array<u64, SMALL_SET_SIZE_MAX>& patterns, const u64 negate) noexcept
+		{
+			u64 marks = 0;
+			for(const u64 pattern : patterns)
+				marks |= mark_zero_bytes(word ^ pattern);
+			return marks ^ negate;
+		}
+
+		[[nodiscard]] u64 index_of_any_portable(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			small_set small;
+			if(!make_small_set(set, small))
+				return index_of_any_scalar(data, 0, size, set);
+			std::array<u64, SMALL_SET_SIZE_MAX> patterns;
+			for(u64 i = 0; i < SMALL_SET_SIZE_MAX; ++i)
+				patterns[i] = broadcast(small.units[i]);
+			const u64 negate = small.negate ? ~SWAR_LOW_7_BITS : 0;
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+				if(const u64 marks = mark_small_set_portable(load_word(data + i), patterns, negate); marks != 0)
+					return i + first_marked_byte(marks);
+			return index_of_any_scalar(data, i, size, set);
+		}
+
+		[[nodiscard]] u64 last_index_of_any_portable(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			small_set small;
+			if(!make_small_set(set, small))
+				return last_index_of_any_scalar(data, size, set);
+			std::array<u64, SMALL_SET_SIZE_MAX> patterns;
+			for(u64 i = 0; i < SMALL_SET_SIZE_MAX; ++i)
+				patterns[i] = broadcast(small.units[i]);
+			const u64 negate = small.negate ? ~SWAR_LOW_7_BITS : 0;
+			u64 i = size;
+			for(; i >= 8; i -= 8)
+				if(const u64 marks = mark_small_set_portable(load_word(data + i - 8), patterns, negate); marks != 0)
+					return i - 8 + last_marked_byte(marks);
+			return last_index_of_any_scalar(data, i, set);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		struct small_set_sse2
+		{
+			__m128i units[SMALL_SET_SIZE_MAX];
+			u32 negate;
+		};
+
+		[[nodiscard]] inline small_set_sse2 load_small_set_sse2(const small_set& small) noexcept
+		{
+			small_set_sse2 result;
+			for(u64 i = 0; i < SMALL_SET_SIZE_MAX; ++i)
+				result.units[i] = _mm_set1_epi8(small.units[i]);
+			result.negate = small.negate ? 0xFFFF : 0;
+			return result;
+		}
+
+		[[nodiscard]] inline u32 mask_small_set_sse2(const __m128i block, const small_set_sse2& set) noexcept
+		{
+			const __m128i equal = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, set.units[0]), _mm_cmpeq_epi8(block, set.units[1])),
+				_mm_or_si128(_mm_cmpeq_epi8(block, set.units[2]), _mm_cmpeq_epi8(block, set.units[3])));
+			return static_cast<u32>(_mm_movemask_epi8(equal)) ^ set.negate;
+		}
+
+		[[nodiscard]] u64 index_of_any_sse2(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			small_set small;
+			if(!make_small_set(set, small))
+				return index_of_any_scalar(data, 0, size, set);
+			const small_set_sse2 units = load_small_set_sse2(small);
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+				if(const u32 mask = mask_small_set_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), units); mask != 0)
+					return i + count_trailing_zeros(mask);
+			return index_of_any_scalar(data, i, size, set);
+		}
+
+		[[nodiscard]] u64 last_index_of_any_sse2(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			small_set small;
+			if(!make_small_set(set, small))
+				return last_index_of_any_scalar(data, size, set);
+			const small_set_sse2 units = load_small_set_sse2(small);
+			u64 i = size;
+			for(; i >= 16; i -= 16)
+				if(const u32 mask = mask_small_set_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16)), units); mask != 0)
+					return i - 16 + (63 - count_leading_zeros(mask));
+			return last_index_of_any_scalar(data, i, set);
+		}
+
+		/**
+		 * \brief Nibble table lookup of 32 codeunits, both tables and bits are broadcast to the two lanes.
+		 */
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 inline u32 mask_nibble_table_avx2(const __m256i block, const __m256i row_0, const __m256i row_1, const __m256i bits, const u32 negate) noexcept
+		{
+			const __m256i low = _mm256_and_si256(block, _mm256_set1_epi8(0x0F));
+			const __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), _mm256_set1_epi8(0x0F));
+			// vpshufb only looks at the low 4 bits of indices when the highest bit is clear.
+			const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(row_0, low), _mm256_shuffle_epi8(row_1, low), block);
+			const __m256i bit = _mm256_shuffle_epi8(bits, high);
+			const __m256i absent = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256());
+			return ~static_cast<u32>(_mm256_movemask_epi8(absent)) ^ negate;
+		}
+
+		struct nibble_table_avx2
+		{
+			__m256i row_0;
+			__m256i row_1;
+			__m256i bits;
+			u32 negate;
+		};
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 inline nibble_table_avx2 load_nibble_table_avx2(const codeunit_set& set) noexcept
+		{
+			const nibble_table table = make_nibble_table(set);
+			const __m128i row_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.rows[0].data()));
+			const __m128i row_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.rows[1].data()));
+			const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			return { _mm256_broadcastsi128_si256(row_0), _mm256_broadcastsi128_si256(row_1), _mm256_broadcastsi128_si256(bits), table.negate ? 0xFFFFFFFFu : 0u };
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 index_of_any_avx2(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			if(size < 32)
+				return index_of_any_scalar(data, 0, size, set);
+			const nibble_table_avx2 table = load_nibble_table_avx2(set);
+			u64 i = 0;
+			for(; i + 32 <= size; i += 32)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				if(const u32 mask = mask_nibble_table_avx2(block, table.row_0, table.row_1, table.bits, table.negate); mask != 0)
+					return i + count_trailing_zeros(mask);
+			}
+			if(i == size)
+				return global_constant::INDEX_INVALID;
+			// The last block overlaps with checked codeunits, which are known to be absent.
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + size - 32));
+			if(const u32 mask = mask_nibble_table_avx2(block, table.row_0, table.row_1, table.bits, table.negate); mask != 0)
+				return size - 32 + count_trailing_zeros(mask);
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 last_index_of_any_avx2(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			if(size < 32)
+				return last_index_of_any_scalar(data, size, set);
+			const nibble_table_avx2 table = load_nibble_table_avx2(set);
+			u64 i = size;
+			for(; i >= 32; i -= 32)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32));
+				if(const u32 mask = mask_nibble_table_avx2(block, table.row_0, table.row_1, table.bits, table.negate); mask != 0)
+					return i - 32 + (63 - count_leading_zeros(mask));
+			}
+			if(i == 0)
+				return global_constant::INDEX_INVALID;
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+			if(const u32 mask = mask_nibble_table_avx2(block, table.row_0, table.row_1, table.bits, table.negate); mask != 0)
+				return 63 - count_leading_zeros(mask);
+			return global_constant::INDEX_INVALID;
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		[[nodiscard]] inline u64 mask_nibble_table_neon(const uint8x16_t block, const uint8x16x2_t rows, const uint8x16_t bits, const u64 negate) noexcept
+		{
+			// Index of vqtbl2q_u8 is (hi >> 3) << 4 | lo, namely the highest bit of codeunit followed by the low nibble.
+			const uint8x16_t index = vorrq_u8(vandq_u8(block, vdupq_n_u8(0x0F)), vandq_u8(vshrq_n_u8(block, 3), vdupq_n_u8(0x10)));
+			const uint8x16_t row = vqtbl2q_u8(rows, index);
+			const uint8x16_t bit = vqtbl1q_u8(bits, vandq_u8(vshrq_n_u8(block, 4), vdupq_n_u8(0x07)));
+			return get_neon_mask(vtstq_u8(row, bit)) ^ negate;
+		}
+
+		struct nibble_table_neon
+		{
+			uint8x16x2_t rows;
+			uint8x16_t bits;
+			u64 negate;
+		};
+
+		[[nodiscard]] inline nibble_table_neon load_nibble_table_neon(const codeunit_set& set) noexcept
+		{
+			const nibble_table table = make_nibble_table(set);
+			static constexpr u8 bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+			return { { vld1q_u8(table.rows[0].data()), vld1q_u8(table.rows[1].data()) }, vld1q_u8(bits), table.negate ? ~0ull : 0 };
+		}
+
+		[[nodiscard]] u64 index_of_any_neon(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			if(size < 16)
+				return index_of_any_scalar(data, 0, size, set);
+			const nibble_table_neon table = load_nibble_table_neon(set);
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+				if(const u64 mask = mask_nibble_table_neon(vld1q_u8(reinterpret_cast<const u8*>(data + i)), table.rows, table.bits, table.negate); mask != 0)
+					return i + count_trailing_zeros(mask) / 4;
+			return index_of_any_scalar(data, i, size, set);
+		}
+
+		[[nodiscard]] u64 last_index_of_any_neon(const char* data, const u64 size, const codeunit_set& set) noexcept
+		{
+			if(size < 16)
+				return last_index_of_any_scalar(data, size, set);
+			const nibble_table_neon table = load_nibble_table_neon(set);
+			u64 i = size;
+			for(; i >= 16; i -= 16)
+				if(const u64 mask = mask_nibble_table_neon(vld1q_u8(reinterpret_cast<const u8*>(data + i - 16)), table.rows, table.bits, table.negate); mask != 0)
+					return i - 16 + (63 - count_leading_zeros(mask)) / 4;
+			return last_index_of_any_scalar(data, i, set);
+		}
+#endif
+
+		// code-region-end: codeunit set kernels
+
+		// code-region-start: utf-8 counting kernels
+
+		// A codepoint starts at each codeunit which is not 10xxxxxx,
+		// and it takes two utf-16 codeunits if it starts with 11110xxx.
+
+		[[nodiscard]] constexpr bool is_four_byte_lead(const char codeunit) noexcept
+		{
+			return static_cast<u8>(codeunit) >= 0xF0;
+		}
+
+		template<bool Utf16>
+		[[nodiscard]] u64 count_scalar(const char* data, const u64 from, const u64 size) noexcept
+		{
+			u64 count = 0;
+			for(u64 i = from; i < size; ++i)
+			{
+				count += !unicode::is_utf8_continuation(data[i]);
+				if constexpr (Utf16)
+					count += is_four_byte_lead(data[i]);
+			}
+			return count;
+		}
+
+		[[nodiscard]] u64 index_of_codepoint_scalar(const char* data, const u64 from, const u64 size, u64 n) noexcept
+		{
+			for(u64 i = from; i < size; ++i)
+			{
+				if(unicode::is_utf8_continuation(data[i]))
+					continue;
+				if(n == 0)
+					return i;
+				--n;
+			}
+			return global_constant::INDEX_INVALID;
+		}
+
+		static constexpr u64 SWAR_HIGH_BITS = 0x8080808080808080ull;
+
+		[[nodiscard]] constexpr u64 mark_codepoint_starts(const u64 word) noexcept
+		{
+			// Bit 6 of each byte is shifted to bit 7, then the high bit is set unless the byte is 10xxxxxx.
+			return (~word | (word << 1)) & SWAR_HIGH_BITS;
+		}
+
+		[[nodiscard]] constexpr u64 mark_four_byte_leads(const u64 word) noexcept
+		{
+			return word & (word << 1) & (word << 2) & (word << 3) & SWAR_HIGH_BITS;
+		}
+
+		/**
+		 * @return How many bytes are marked in marks, where only high bits of bytes may be set.
+		 */
+		[[nodiscard]] constexpr u64 count_marked_bytes(const u64 marks) noexcept
+		{
+			return ((marks >> 7) * SWAR_LOW_BITS) >> 56;
+		}
+
+		template<bool Utf16>
+		[[nodiscard]] u64 count_portable(const char* data, const u64 size) noexcept
+		{
+			u64 count = 0;
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const u64 word = load_word(data + i);
+				count += count_marked_bytes(mark_codepoint_starts(word));
+				if constexpr (Utf16)
+					count += count_marked_bytes(mark_four_byte_leads(word));
+			}
+			return count + count_scalar<Utf16>(data, i, size);
+		}
+
+		[[nodiscard]] u64 index_of_codepoint_portable(const char* data, const u64 size, u64 n) noexcept
+		{
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const u64 marks = mark_codepoint_starts(load_word(data + i));
+				const u64 count = count_marked_bytes(marks);
+				if(n < count)
+					return i + first_marked_byte(clear_lowest_bits(marks, n));
+				n -= count;
+			}
+			return index_of_codepoint_scalar(data, i, size, n);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		// Counts are accumulated in bytes, each block adds at most 2 to a byte, so they are summed up every this many blocks.
+		static constexpr u64 ACCUMULATED_BLOCK_COUNT_MAX = 127;
+
+		template<bool Utf16>
+		[[nodiscard]] u64 count_sse2(const char* data, const u64 size) noexcept
+		{
+			const __m128i continuation_max = _mm_set1_epi8(static_cast<char>(0xBF));
+			const __m128i four_byte_lead_min = _mm_set1_epi8(static_cast<char>(0xF0));
+			u64 count = 0;
+			u64 i = 0;
+			while(i + 16 <= size)
+			{
+				const u64 batch_end = i + minimum((size - i) / 16, ACCUMULATED_BLOCK_COUNT_MAX) * 16;
+				__m128i accumulated = _mm_setzero_si128();
+				for(; i < batch_end; i += 16)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					// Signed comparison, continuation bytes are the smallest ones.
+					accumulated = _mm_sub_epi8(accumulated, _mm_cmpgt_epi8(block, continuation_max));
+					if constexpr (Utf16)
+						accumulated = _mm_sub_epi8(accumulated, _mm_cmpeq_epi8(_mm_max_epu8(block, four_byte_lead_min), block));
+				}
+				const __m128i sums = _mm_sad_epu8(accumulated, _mm_setzero_si128());
+				count += static_cast<u64>(_mm_cvtsi128_si64(sums)) + static_cast<u64>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+			}
+			return count + count_scalar<Utf16>(data, i, size);
+		}
+
+		[[nodiscard]] u64 index_of_codepoint_sse2(const char* data, const u64 size, u64 n) noexcept
+		{
+			const __m128i continuation_max = _mm_set1_epi8(static_cast<char>(0xBF));
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				const u64 mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpgt_epi8(block, continuation_max)));
+				const u64 count = count_bits(mask);
+				if(n < count)
+					return i + count_trailing_zeros(clear_lowest_bits(mask, n));
+				n -= count;
+			}
+			return index_of_codepoint_scalar(data, i, size, n);
+		}
+
+		template<bool Utf16>
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 count_avx2(const char* data, const u64 size) noexcept
+		{
+			const __m256i continuation_max = _mm256_set1_epi8(static_cast<char>(0xBF));
+			const __m256i four_byte_lead_min = _mm256_set1_epi8(static_cast<char>(0xF0));
+			u64 count = 0;
+			u64 i = 0;
+			while(i + 32 <= size)
+			{
+				const u64 batch_end = i + minimum((size - i) / 32, ACCUMULATED_BLOCK_COUNT_MAX) * 32;
+				__m256i accumulated = _mm256_setzero_si256();
+				for(; i < batch_end; i += 32)
+				{
+					const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					accumulated = _mm256_sub_epi8(accumulated, _mm256_cmpgt_epi8(block, continuation_max));
+					if constexpr (Utf16)
+						accumulated = _mm256_sub_epi8(accumulated, _mm256_cmpeq_epi8(_mm256_max_epu8(block, four_byte_lead_min), block));
+				}
+				const __m256i sums = _mm256_sad_epu8(accumulated, _mm256_setzero_si256());
+				const __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+				count += static_cast<u64>(_mm_cvtsi128_si64(halves)) + static_cast<u64>(_mm_extract_epi64(halves, 1));
+			}
+			if(i + 16 <= size)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				count += count_bits(static_cast<u32>(_mm_movemask_epi8(_mm_cmpgt_epi8(block, _mm256_castsi256_si128(continuation_max)))));
+				if constexpr (Utf16)
+					count += count_bits(static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, _mm256_castsi256_si128(four_byte_lead_min)), block))));
+				i += 16;
+			}
+			return count + count_scalar<Utf16>(data, i, size);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 index_of_codepoint_avx2(const char* data, const u64 size, u64 n) noexcept
+		{
+			const __m256i continuation_max = _mm256_set1_epi8(static_cast<char>(0xBF));
+			u64 i = 0;
+			for(; i + 32 <= size; i += 32)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				const u64 mask = static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, continuation_max)));
+				const u64 count = count_bits(mask);
+				if(n < count)
+					return i + count_trailing_zeros(clear_lowest_bits(mask, n));
+				n -= count;
+			}
+			return index_of_codepoint_scalar(data, i, size, n);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		static constexpr u64 ACCUMULATED_BLOCK_COUNT_MAX = 127;
+
+		template<bool Utf16>
+		[[nodiscard]] u64 count_neon(const char* data, const u64 size) noexcept
+		{
+			const int8x16_t continuation_max = vdupq_n_s8(static_cast<i8>(0xBF));
+			const uint8x16_t four_byte_lead_min = vdupq_n_u8(0xF0);
+			u64 count = 0;
+			u64 i = 0;
+			while(i + 16 <= size)
+			{
+				const u64 batch_end = i + minimum((size - i) / 16, ACCUMULATED_BLOCK_COUNT_MAX) * 16;
+				uint8x16_t accumulated = vdupq_n_u8(0);
+				for(; i < batch_end; i += 16)
+				{
+					const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i));
+					accumulated = vsubq_u8(accumulated, vcgtq_s8(vreinterpretq_s8_u8(block), continuation_max));
+					if constexpr (Utf16)
+						accumulated = vsubq_u8(accumulated, vcgeq_u8(block, four_byte_lead_min));
+				}
+				count += vaddlvq_u8(accumulated);
+			}
+			return count + count_scalar<Utf16>(data, i, size);
+		}
+
+		[[nodiscard]] u64 index_of_codepoint_neon(const char* data, const u64 size, u64 n) noexcept
+		{
+			const int8x16_t continuation_max = vdupq_n_s8(static_cast<i8>(0xBF));
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+			{
+				const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i));
+				const uint8x16_t starts = vcgtq_s8(vreinterpretq_s8_u8(block), continuation_max);
+				const u64 count = vaddvq_u8(vshrq_n_u8(starts, 7));
+				if(n < count)
+					return i + count_trailing_zeros(clear_lowest_bits(get_neon_mask(starts) & NEON_LANE_HIGH_BITS, n)) / 4;
+				n -= count;
+			}
+			return index_of_codepoint_scalar(data, i, size, n);
+		}
+#endif
+
+		[[nodiscard]] bool is_ascii_scalar(const char* data, const u64 from, const u64 size) noexcept
+		{
+			u8 bits = 0;
+			for(u64 i = from; i < size; ++i)
+				bits |= static_cast<u8>(data[i]);
+			return bits < 0x80;
+		}
+
+		[[nodiscard]] bool is_ascii_portable(const char* data, const u64 size) noexcept
+		{
+			u64 i = 0;
+			for(; i + 32 <= size; i += 32)
+			{
+				const u64 bits = load_word(data + i) | load_word(data + i + 8) | load_word(data + i + 16) | load_word(data + i + 24);
+				if((bits & SWAR_HIGH_BITS) != 0)
+					return false;
+			}
+			for(; i + 8 <= size; i += 8)
+				if((load_word(data + i) & SWAR_HIGH_BITS) != 0)
+					return false;
+			return is_ascii_scalar(data, i, size);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		[[nodiscard]] bool is_ascii_sse2(const char* data, const u64 size) noexcept
+		{
+			u64 i = 0;
+			for(; i + 64 <= size; i += 64)
+			{
+				const __m128i bits = _mm_or_si128(
+					_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16))),
+					_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48))));
+				if(_mm_movemask_epi8(bits) != 0)
+					return false;
+			}
+			for(; i + 16 <= size; i += 16)
+				if(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))) != 0)
+					return false;
+			return is_ascii_scalar(data, i, size);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 bool is_ascii_avx2(const char* data, const u64 size) noexcept
+		{
+			u64 i = 0;
+			for(; i + 64 <= size; i += 64)
+			{
+				const __m256i bits = _mm256_or_si256(
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)),
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32)));
+				if(_mm256_movemask_epi8(bits) != 0)
+					return false;
+			}
+			for(; i + 16 <= size; i += 16)
+				if(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))) != 0)
+					return false;
+			return is_ascii_scalar(data, i, size);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		[[nodiscard]] bool is_ascii_neon(const char* data, const u64 size) noexcept
+		{
+			u64 i = 0;
+			for(; i + 64 <= size; i += 64)
+			{
+				const u8* p = reinterpret_cast<const u8*>(data + i);
+				const uint8x16_t bits = vorrq_u8(vorrq_u8(vld1q_u8(p), vld1q_u8(p + 16)), vorrq_u8(vld1q_u8(p + 32), vld1q_u8(p + 48)));
+				if(vmaxvq_u8(bits) >= 0x80)
+					return false;
+			}
+			for(; i + 16 <= size; i += 16)
+				if(vmaxvq_u8(vld1q_u8(reinterpret_cast<const u8*>(data + i))) >= 0x80)
+					return false;
+			return is_ascii_scalar(data, i, size);
+		}
+#endif
+
+		// code-region-end: utf-8 counting kernels
+
+		// code-region-start: utf-8 validation kernels
+
+		[[nodiscard]] u64 first_invalid_utf8_scalar(const char* data, u64 from, const u64 size, u64& codepoint_count) noexcept
+		{
+			while(from < size)
+			{
+				const u8 length = unicode::parse_valid_utf8_length(data + from, size - from);
+				if(length == 0)
+					return from;
+				++codepoint_count;
+				from += length;
+			}
+			return global_constant::INDEX_INVALID;
+		}
+
+		/**
+		 * \brief Sequences before validated are all well-formed, except those starting in its last 3 codeunits,
+		 * which may be truncated. Validation resumes from the first of them in scalar.
+		 * @param codepoint_count count of codepoints before validated
+		 */
+		[[nodiscard]] u64 resume_first_invalid_utf8(const char* data, const u64 validated, const u64 size, u64& codepoint_count) noexcept
+		{
+			u64 from = validated < unicode::UTF8_SEQUENCE_MAXIMUM_LENGTH - 1 ? 0 : validated - (unicode::UTF8_SEQUENCE_MAXIMUM_LENGTH - 1);
+			while(from < validated && unicode::is_utf8_continuation(data[from]))
+				++from;
+			codepoint_count -= count_scalar<false>(data, from, validated);
+			return first_invalid_utf8_scalar(data, from, size, codepoint_count);
+		}
+
+		[[nodiscard]] u64 first_invalid_utf8_portable(const char* data, const u64 size, u64& codepoint_count) noexcept
+		{
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 8 <= size && (load_word(data + i) & SWAR_HIGH_BITS) == 0)
+				{
+					codepoint_count += 8;
+					i += 8;
+					continue;
+				}
+				const u8 length = unicode::parse_valid_utf8_length(data + i, size - i);
+				if(length == 0)
+					return i;
+				++codepoint_count;
+				i += length;
+			}
+			return global_constant::INDEX_INVALID;
+		}
+
+		// Lookup tables of the validation by Keiser and Lemire, each error of two adjacent codeunits is a bit,
+		// which is set in all three tables indexed by high and low nibbles of the first codeunit and high nibble of the second one.
+		static constexpr u8 UTF8_TOO_SHORT = 1 << 0;		// 11______ 0_______, 11______ 11______
+		static constexpr u8 UTF8_TOO_LONG = 1 << 1;			// 0_______ 10______
+		static constexpr u8 UTF8_OVERLONG_3 = 1 << 2;		// 11100000 100_____
+		static constexpr u8 UTF8_TOO_LARGE = 1 << 3;		// 11110100 1001____, 11110100 101_____, 11110101 1001____ ...
+		static constexpr u8 UTF8_SURROGATE = 1 << 4;		// 11101101 101_____
+		static constexpr u8 UTF8_OVERLONG_2 = 1 << 5;		// 1100000_ 10______
+		static constexpr u8 UTF8_TOO_LARGE_1000 = 1 << 6;	// 11110101 1000____ ...
+		static constexpr u8 UTF8_OVERLONG_4 = 1 << 6;		// 11110000 1000____
+		// 10______ 10______, which is an error unless they are the third or fourth codeunits.
+		static constexpr u8 UTF8_TWO_CONTINUATIONS = 1 << 7;
+		static constexpr u8 UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTINUATIONS;
+
+		static constexpr std::array<u8, 16> UTF8_FIRST_HIGH_NIBBLE_ERRORS
+		{
+			// 0_______ ________
+			UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+			UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+			// 10______ ________
+			UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS,
+			// 1100____ ________
+			UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+			// 1101____ ________
+			UTF8_TOO_SHORT,
+			// 1110____ ________
+			UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+			// 1111____ ________
+			UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+		};
+
+		static constexpr std::array<u8, 16> UTF8_FIRST_LOW_NIBBLE_ERRORS
+		{
+			// ____0000 ________
+			UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+			// ____0001 ________
+			UTF8_CARRY | UTF8_OVERLONG_2,
+			// ____001_ ________
+			UTF8_CARRY,
+			UTF8_CARRY,
+			// ____0100 ________
+			UTF8_CARRY | UTF8_TOO_LARGE,
+			// ____0101 ________ and above
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			// ____1101 ________
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		};
+
+		static constexpr std::array<u8, 16> UTF8_SECOND_HIGH_NIBBLE_ERRORS
+		{
+			// ________ 0_______
+			UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+			UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+			// ________ 1000____
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+			// ________ 1001____
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+			// ________ 101_____
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+			// ________ 11______
+			UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+		};
+
+		// A block is incomplete if any of its last 3 codeunits leads a sequence longer than the rest of the block,
+		// which are those greater than these maximums.
+		static constexpr std::array<u8, 16> UTF8_COMPLETE_MAXIMUMS
+		{
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+		};
+
+#if OPEN_STRING_SIMD_X86
+		// Without pshufb, sse2 only skips ascii blocks.
+		[[nodiscard]] u64 first_invalid_utf8_sse2(const char* data, const u64 size, u64& codepoint_count) noexcept
+		{
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 16 <= size && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))) == 0)
+				{
+					codepoint_count += 16;
+					i += 16;
+					continue;
+				}
+				const u8 length = unicode::parse_valid_utf8_length(data + i, size - i);
+				if(length == 0)
+					return i;
+				++codepoint_count;
+				i += length;
+			}
+			return global_constant::INDEX_INVALID;
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 __m256i broadcast_table_avx2(const std::array<u8, 16>& table) noexcept
+		{
+			return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data())));
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 first_invalid_utf8_avx2(const char* data, const u64 size, u64& codepoint_count) noexcept
+		{
+			const __m256i first_high_nibble_errors = broadcast_table_avx2(UTF8_FIRST_HIGH_NIBBLE_ERRORS);
+			const __m256i first_low_nibble_errors = broadcast_table_avx2(UTF8_FIRST_LOW_NIBBLE_ERRORS);
+			const __m256i second_high_nibble_errors = broadcast_table_avx2(UTF8_SECOND_HIGH_NIBBLE_ERRORS);
+			const __m256i complete_maximums = _mm256_inserti128_si256(_mm256_set1_epi8(static_cast<char>(0xFF)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(UTF8_COMPLETE_MAXIMUMS.data())), 1);
+			const __m256i low_nibble_mask = _mm256_set1_epi8(0x0F);
+			const __m256i continuation_max = _mm256_set1_epi8(static_cast<char>(0xBF));
+			__m256i previous = _mm256_setzero_si256();
+			__m256i previous_incomplete = _mm256_setzero_si256();
+			u64 i = 0;
+			for(; i + 32 <= size; i += 32)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				if(_mm256_movemask_epi8(block) == 0)
+				{
+					// A sequence truncated by ascii codeunits.
+					if(!_mm256_testz_si256(previous_incomplete, previous_incomplete))
+						break;
+					codepoint_count += 32;
+				}
+				else
+				{
+					// Codeunits 1, 2 and 3 before each one of block.
+					const __m256i carried = _mm256_permute2x128_si256(previous, block, 0x21);
+					const __m256i previous_1 = _mm256_alignr_epi8(block, carried, 15);
+					const __m256i previous_2 = _mm256_alignr_epi8(block, carried, 14);
+					const __m256i previous_3 = _mm256_alignr_epi8(block, carried, 13);
+					const __m256i errors = _mm256_and_si256(_mm256_and_si256(
+						_mm256_shuffle_epi8(first_high_nibble_errors, _mm256_and_si256(_mm256_srli_epi16(previous_1, 4), low_nibble_mask)),
+						_mm256_shuffle_epi8(first_low_nibble_errors, _mm256_and_si256(previous_1, low_nibble_mask))),
+						_mm256_shuffle_epi8(second_high_nibble_errors, _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibble_mask)));
+					// Only 111_____ and 1111____ are left with high bits, whose next 2 and 3 codeunits must be continuations.
+					const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(
+						_mm256_subs_epu8(previous_2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80))),
+						_mm256_subs_epu8(previous_3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)))),
+						_mm256_set1_epi8(static_cast<char>(0x80)));
+					const __m256i error = _mm256_xor_si256(must_be_continuation, errors);
+					if(!_mm256_testz_si256(error, error))
+						break;
+					codepoint_count += count_bits(static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, continuation_max))));
+				}
+				previous_incomplete = _mm256_subs_epu8(block, complete_maximums);
+				previous = block;
+			}
+			// The invalid block or the rest.
+			return resume_first_invalid_utf8(data, i, size, codepoint_count);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		[[nodiscard]] u64 first_invalid_utf8_neon(const char* data, const u64 size, u64& codepoint_count) noexcept
+		{
+			const uint8x16_t first_high_nibble_errors = vld1q_u8(UTF8_FIRST_HIGH_NIBBLE_ERRORS.data());
+			const uint8x16_t first_low_nibble_errors = vld1q_u8(UTF8_FIRST_LOW_NIBBLE_ERRORS.data());
+			const uint8x16_t second_high_nibble_errors = vld1q_u8(UTF8_SECOND_HIGH_NIBBLE_ERRORS.data());
+			const uint8x16_t complete_maximums = vld1q_u8(UTF8_COMPLETE_MAXIMUMS.data());
+			const uint8x16_t low_nibble_mask = vdupq_n_u8(0x0F);
+			const int8x16_t continuation_max = vdupq_n_s8(static_cast<i8>(0xBF));
+			uint8x16_t previous = vdupq_n_u8(0);
+			uint8x16_t previous_incomplete = vdupq_n_u8(0);
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+			{
+				const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i));
+				if(vmaxvq_u8(block) < 0x80)
+				{
+					if(vmaxvq_u8(previous_incomplete) != 0)
+						break;
+					codepoint_count += 16;
+				}
+				else
+				{
+					const uint8x16_t previous_1 = vextq_u8(previous, block, 15);
+					const uint8x16_t previous_2 = vextq_u8(previous, block, 14);
+					const uint8x16_t previous_3 = vextq_u8(previous, block, 13);
+					const uint8x16_t errors = vandq_u8(vandq_u8(
+						vqtbl1q_u8(first_high_nibble_errors, vshrq_n_u8(previous_1, 4)),
+						vqtbl1q_u8(first_low_nibble_errors, vandq_u8(previous_1, low_nibble_mask))),
+						vqtbl1q_u8(second_high_nibble_errors, vshrq_n_u8(block, 4)));
+					const uint8x16_t must_be_continuation = vandq_u8(vorrq_u8(
+						vqsubq_u8(previous_2, vdupq_n_u8(0xE0 - 0x80)),
+						vqsubq_u8(previous_3, vdupq_n_u8(0xF0 - 0x80))),
+						vdupq_n_u8(0x80));
+					if(vmaxvq_u8(veorq_u8(must_be_continuation, errors)) != 0)
+						break;
+					codepoint_count += vaddvq_u8(vshrq_n_u8(vcgtq_s8(vreinterpretq_s8_u8(block), continuation_max), 7));
+				}
+				previous_incomplete = vqsubq_u8(block, complete_maximums);
+				previous = block;
+			}
+			return resume_first_invalid_utf8(data, i, size, codepoint_count);
+		}
+#endif
+
+		// code-region-end: utf-8 validation kernels
+
+		// code-region-start: utf-16 transcoding kernels
+
+		[[nodiscard]] constexpr bool is_surrogate_pair(const char16_t* data, const u64 i, const u64 size) noexcept
+		{
+			return unicode::utf16::is_leading_surrogate(data[i]) && i + 1 < size && unicode::utf16::is_trailing_surrogate(data[i + 1]);
+		}
+
+		// Scalar steps handle a single codepoint at i, then move i past it.
+
+		[[nodiscard]] inline u64 count_utf8_of_utf16_step(const char16_t* data, u64& i, const u64 size) noexcept
+		{
+			const char16_t c = data[i];
+			if(c < 0x80)
+			{
+				++i;
+				return 1;
+			}
+			if(c < 0x800)
+			{
+				++i;
+				return 2;
+			}
+			if(is_surrogate_pair(data, i, size))
+			{
+				i += 2;
+				return 4;
+			}
+			++i;
+			return 3;
+		}
+
+		// cp should be a scalar value, which is not a surrogate or beyond U+10FFFF.
+		inline char* encode_utf8(const char32_t cp, char* destination) noexcept
+		{
+			if(cp < 0x80)
+			{
+				destination[0] = static_cast<char>(cp);
+				return destination + 1;
+			}
+			if(cp < 0x800)
+			{
+				destination[0] = static_cast<char>(0xC0 | cp >> 6);
+				destination[1] = static_cast<char>(0x80 | (cp & 0x3F));
+				return destination + 2;
+			}
+			if(cp < 0x10000)
+			{
+				destination[0] = static_cast<char>(0xE0 | cp >> 12);
+				destination[1] = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+				destination[2] = static_cast<char>(0x80 | (cp & 0x3F));
+				return destination + 3;
+			}
+			destination[0] = static_cast<char>(0xF0 | cp >> 18);
+			destination[1] = static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+			destination[2] = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+			destination[3] = static_cast<char>(0x80 | (cp & 0x3F));
+			return destination + 4;
+		}
+
+		inline char* utf16_to_utf8_step(const char16_t* data, u64& i, const u64 size, char* destination) noexcept
+		{
+			const char32_t c = data[i];
+			if(c < 0x80)
+			{
+				destination[0] = static_cast<char>(c);
+				++i;
+				return destination + 1;
+			}
+			if(is_surrogate_pair(data, i, size))
+			{
+				const char32_t cp = (((c & unicode::utf16::SURROGATE_MASK) << 10) | (data[i + 1] & unicode::utf16::SURROGATE_MASK)) + unicode::utf16::SURROGATE_CODEPOINT_OFFSET;
+				i += 2;
+				return encode_utf8(cp, destination);
+			}
+			++i;
+			return encode_utf8(unicode::utf16::is_surrogate(static_cast<char16_t>(c)) ? unicode::REPLACEMENT_CHARACTER : c, destination);
+		}
+
+		/**
+		 * \brief Decode the codepoint at i, then move i past it.
+		 * Ill-formed sequences are decoded as U+FFFD, see utf8_to_utf16.
+		 * @return Whether a codepoint is decoded, false if a stray continuation codeunit is skipped.
+		 */
+		[[nodiscard]] inline bool decode_utf8_step(const char* data, u64& i, const u64 size, char32_t& cp) noexcept
+		{
+			const u8 lead = static_cast<u8>(data[i]);
+			if(lead < 0x80)
+			{
+				cp = lead;
+				++i;
+				return true;
+			}
+			if(unicode::is_utf8_continuation(static_cast<char>(lead)))
+			{
+				++i;
+				return false;
+			}
+			const u8 length = unicode::parse_valid_utf8_length(data + i, size - i);
+			if(length == 0)
+			{
+				cp = unicode::REPLACEMENT_CHARACTER;
+				i += unicode::parse_invalid_utf8_length(data + i, size - i);
+				return true;
+			}
+			// The sequence is well-formed, only payload bits are left to extract.
+			cp = lead & (0x7F >> length);
+			for(u64 j = 1; j < length; ++j)
+				cp = (cp << 6) | (static_cast<u8>(data[i + j]) & 0x3F);
+			i += length;
+			return true;
+		}
+
+		inline char16_t* utf8_to_utf16_step(const char* data, u64& i, const u64 size, char16_t* destination) noexcept
+		{
+			char32_t cp;
+			if(!decode_utf8_step(data, i, size, cp))
+				return destination;
+			if(cp <= unicode::utf16::SINGLE_UNIT_MAXIMUM_VALUE)
+			{
+				*destination = static_cast<char16_t>(cp);
+				return destination + 1;
+			}
+			cp -= unicode::utf16::SURROGATE_CODEPOINT_OFFSET;
+			destination[0] = static_cast<char16_t>((cp >> 10) + unicode::utf16::LEADING_SURROGATE_HEADER);
+			destination[1] = static_cast<char16_t>((cp & unicode::utf16::SURROGATE_MASK) + unicode::utf16::TRAILING_SURROGATE_HEADER);
+			return destination + 2;
+		}
+
+		// 4 utf-16 codeunits in a word.
+		static constexpr u64 SWAR_UTF16_NON_ASCII_BITS = 0xFF80FF80FF80FF80ull;
+
+		[[nodiscard]] u64 count_utf8_of_utf16_portable(const char16_t* data, const u64 size) noexcept
+		{
+			u64 count = 0;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 4 <= size)
+				{
+					u64 word;
+					std::memcpy(&word, data + i, sizeof(word));
+					if((word & SWAR_UTF16_NON_ASCII_BITS) == 0)
+					{
+						count += 4;
+						i += 4;
+						continue;
+					}
+				}
+				count += count_utf8_of_utf16_step(data, i, size);
+			}
+			return count;
+		}
+
+		[[nodiscard]] u64 utf16_to_utf8_portable(const char16_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 4 <= size)
+				{
+					u64 word;
+					std::memcpy(&word, data + i, sizeof(word));
+					if((word & SWAR_UTF16_NON_ASCII_BITS) == 0)
+					{
+						for(u64 j = 0; j < 4; ++j)
+							written[j] = static_cast<char>(data[i + j]);
+						written += 4;
+						i += 4;
+						continue;
+					}
+				}
+				written = utf16_to_utf8_step(data, i, size, written);
+			}
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] u64 utf8_to_utf16_portable(const char* data, const u64 size, char16_t* destination) noexcept
+		{
+			char16_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 8 <= size && (load_word(data + i) & SWAR_HIGH_BITS) == 0)
+				{
+					for(u64 j = 0; j < 8; ++j)
+						written[j] = static_cast<char16_t>(data[i + j]);
+					written += 8;
+					i += 8;
+					continue;
+				}
+				written = utf8_to_utf16_step(data, i, size, written);
+			}
+			return static_cast<u64>(written - destination);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		// Each codeunit takes 3 utf-8 codeunits minus one if it is below 0x800, minus another one if it is below 0x80.
+		[[nodiscard]] u64 count_utf8_of_utf16_sse2(const char16_t* data, const u64 size) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<i16>(0xFF80));
+			const __m128i non_two_byte_bits = _mm_set1_epi16(static_cast<i16>(0xF800));
+			const __m128i surrogate_header = _mm_set1_epi16(static_cast<i16>(0xD800));
+			u64 count = 0;
+			u64 i = 0;
+			while(i + 8 <= size)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				const __m128i high_5_bits = _mm_and_si128(block, non_two_byte_bits);
+				if(_mm_movemask_epi8(_mm_cmpeq_epi16(high_5_bits, surrogate_header)) != 0)
+				{
+					for(const u64 block_end = i + 8; i < block_end;)
+						count += count_utf8_of_utf16_step(data, i, size);
+					continue;
+				}
+				// Masks of epi16 comparisons have 2 bits for each codeunit.
+				const u64 ascii_count = count_bits(static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, non_ascii_bits), zero)))) / 2;
+				const u64 two_byte_count = count_bits(static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi16(high_5_bits, zero)))) / 2;
+				count += 8 * 3 - ascii_count - two_byte_count;
+				i += 8;
+			}
+			while(i < size)
+				count += count_utf8_of_utf16_step(data, i, size);
+			return count;
+		}
+
+		/**
+		 * \brief Encode 8 codeunits of BMP if they are all ascii, or all take two utf-8 codeunits.
+		 * @return End of written codeunits, return nullptr if the block is not handled.
+		 */
+		[[nodiscard]] inline char* encode_bmp_block_sse2(const __m128i block, char* destination) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const u32 ascii_mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, _mm_set1_epi16(static_cast<i16>(0xFF80))), zero)));
+			if(ascii_mask == 0xFFFF)
+			{
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(block, block));
+				return destination + 8;
+			}
+			const u32 two_byte_mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, _mm_set1_epi16(static_cast<i16>(0xF800))), zero)));
+			if(ascii_mask == 0 && two_byte_mask == 0xFFFF)
+			{
+				// 110xxxxx 10xxxxxx of each codeunit, little endian words.
+				const __m128i lead = _mm_or_si128(_mm_srli_epi16(block, 6), _mm_set1_epi16(0xC0));
+				const __m128i trail = _mm_or_si128(_mm_and_si128(block, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_or_si128(lead, _mm_slli_epi16(trail, 8)));
+				return destination + 16;
+			}
+			return nullptr;
+		}
+
+		[[nodiscard]] u64 utf16_to_utf8_sse2(const char16_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			u64 i = 0;
+			while(i + 8 <= size)
+			{
+				if(char* block_end = encode_bmp_block_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), written))
+				{
+					written = block_end;
+					i += 8;
+					continue;
+				}
+				for(const u64 block_end = i + 8; i < block_end;)
+					written = utf16_to_utf8_step(data, i, size, written);
+			}
+			while(i < size)
+				written = utf16_to_utf8_step(data, i, size, written);
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] u64 utf8_to_utf16_sse2(const char* data, const u64 size, char16_t* destination) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			char16_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 16 <= size)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					if(_mm_movemask_epi8(block) == 0)
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(written), _mm_unpacklo_epi8(block, zero));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(written + 8), _mm_unpackhi_epi8(block, zero));
+						written += 16;
+						i += 16;
+						continue;
+					}
+				}
+				written = utf8_to_utf16_step(data, i, size, written);
+			}
+			return static_cast<u64>(written - destination);
+		}
+
+		/**
+		 * @return Shuffle indices to interleave 8 three-byte sequences into 24 bytes, the low 16 or the high 8 of them.
+		 * Leads and second codeunits are taken from words of the first vector, and the last codeunits are taken from bytes of the second one.
+		 */
+		template<bool High, bool Second>
+		[[nodiscard]] constexpr std::array<u8, 16> make_three_byte_shuffle() noexcept
+		{
+			std::array<u8, 16> indices{ };
+			for(u64 i = 0; i < 16; ++i)
+			{
+				const u64 output = High ? i + 16 : i;
+				const u64 unit = output / 3;
+				const u64 part = output % 3;
+				if(output >= 24 || (part == 2) != Second)
+					indices[i] = 0x80;
+				else
+					indices[i] = static_cast<u8>(Second ? unit : unit * 2 + part);
+			}
+			return indices;
+		}
+
+		static constexpr std::array<u8, 16> THREE_BYTE_SHUFFLE_LOW_FIRST = make_three_byte_shuffle<false, false>();
+		static constexpr std::array<u8, 16> THREE_BYTE_SHUFFLE_LOW_SECOND = make_three_byte_shuffle<false, true>();
+		static constexpr std::array<u8, 16> THREE_BYTE_SHUFFLE_HIGH_FIRST = make_three_byte_shuffle<true, false>();
+		static constexpr std::array<u8, 16> THREE_BYTE_SHUFFLE_HIGH_SECOND = make_three_byte_shuffle<true, true>();
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 count_utf8_of_utf16_avx2(const char16_t* data, const u64 size) noexcept
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i non_ascii_bits = _mm256_set1_epi16(static_cast<i16>(0xFF80));
+			const __m256i non_two_byte_bits = _mm256_set1_epi16(static_cast<i16>(0xF800));
+			const __m256i surrogate_header = _mm256_set1_epi16(static_cast<i16>(0xD800));
+			u64 count = 0;
+			u64 i = 0;
+			while(i + 16 <= size)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				const __m256i high_5_bits = _mm256_and_si256(block, non_two_byte_bits);
+				if(_mm256_movemask_epi8(_mm256_cmpeq_epi16(high_5_bits, surrogate_header)) != 0)
+				{
+					for(const u64 block_end = i + 16; i < block_end;)
+						count += count_utf8_of_utf16_step(data, i, size);
+					continue;
+				}
+				const u64 ascii_count = count_bits(static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(block, non_ascii_bits), zero)))) / 2;
+				const u64 two_byte_count = count_bits(static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(high_5_bits, zero)))) / 2;
+				count += 16 * 3 - ascii_count - two_byte_count;
+				i += 16;
+			}
+			while(i < size)
+				count += count_utf8_of_utf16_step(data, i, size);
+			return count;
+		}
+
+		/**
+		 * \brief Same as encode_bmp_block_sse2, and blocks which all take three utf-8 codeunits are encoded as well.
+		 */
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 inline char* encode_bmp_block_avx2(const __m128i block, char* destination) noexcept
+		{
+			if(char* block_end = encode_bmp_block_sse2(block, destination))
+				return block_end;
+			const __m128i high_5_bits = _mm_and_si128(block, _mm_set1_epi16(static_cast<i16>(0xF800)));
+			const __m128i below_three_bytes_or_surrogate = _mm_or_si128(_mm_cmpeq_epi16(high_5_bits, _mm_setzero_si128()),
+				_mm_cmpeq_epi16(high_5_bits, _mm_set1_epi16(static_cast<i16>(0xD800))));
+			if(_mm_movemask_epi8(below_three_bytes_or_surrogate) != 0)
+				return nullptr;
+			// 1110xxxx 10xxxxxx 10xxxxxx of each codeunit.
+			const __m128i low_6_bits = _mm_set1_epi16(0x3F);
+			const __m128i continuation_header = _mm_set1_epi16(0x80);
+			const __m128i lead = _mm_or_si128(_mm_srli_epi16(block, 12), _mm_set1_epi16(0xE0));
+			const __m128i middle = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(block, 6), low_6_bits), continuation_header);
+			const __m128i trail = _mm_or_si128(_mm_and_si128(block, low_6_bits), continuation_header);
+			const __m128i first = _mm_or_si128(lead, _mm_slli_epi16(middle, 8));
+			const __m128i second = _mm_packus_epi16(trail, trail);
+			const __m128i low = _mm_or_si128(_mm_shuffle_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_SHUFFLE_LOW_FIRST.data()))),
+				_mm_shuffle_epi8(second, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_SHUFFLE_LOW_SECOND.data()))));
+			const __m128i high = _mm_or_si128(_mm_shuffle_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_SHUFFLE_HIGH_FIRST.data()))),
+				_mm_shuffle_epi8(second, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_SHUFFLE_HIGH_SECOND.data()))));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), low);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + 16), high);
+			return destination + 24;
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 utf16_to_utf8_avx2(const char16_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			u64 i = 0;
+			while(i + 8 <= size)
+			{
+				if(i + 16 <= size)
+				{
+					const __m256i wide_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					if(_mm256_testz_si256(wide_block, _mm256_set1_epi16(static_cast<i16>(0xFF80))))
+					{
+						const __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(wide_block), _mm256_extracti128_si256(wide_block, 1));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(written), packed);
+						written += 16;
+						i += 16;
+						continue;
+					}
+				}
+				if(char* block_end = encode_bmp_block_avx2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), written))
+				{
+					written = block_end;
+					i += 8;
+					continue;
+				}
+				for(const u64 block_end = i + 8; i < block_end;)
+					written = utf16_to_utf8_step(data, i, size, written);
+			}
+			while(i < size)
+				written = utf16_to_utf8_step(data, i, size, written);
+			return static_cast<u64>(written - destination);
+		}
+
+		/**
+		 * @return Shuffle indices to move a codeunit of each of 5 three-byte sequences into the low byte of a word.
+		 */
+		[[nodiscard]] constexpr std::array<u8, 16> make_three_byte_gather(const u8 part) noexcept
+		{
+			std::array<u8, 16> indices{ };
+			for(u64 i = 0; i < 16; ++i)
+				indices[i] = i % 2 == 0 && i / 2 < 5 ? static_cast<u8>(i / 2 * 3 + part) : 0x80;
+			return indices;
+		}
+
+		static constexpr std::array<u8, 16> THREE_BYTE_GATHER_LEAD = make_three_byte_gather(0);
+		static constexpr std::array<u8, 16> THREE_BYTE_GATHER_MIDDLE = make_three_byte_gather(1);
+		static constexpr std::array<u8, 16> THREE_BYTE_GATHER_TRAIL = make_three_byte_gather(2);
+
+		/**
+		 * \brief Decode 5 three-byte sequences at the start of block into the low 5 words of codepoints,
+		 * which is common in cjk text.
+		 * @return Whether they are all well-formed.
+		 */
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 inline bool decode_three_byte_block_avx2(const __m128i block, __m128i& codepoints) noexcept
+		{
+			const __m128i lead = _mm_shuffle_epi8(block, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_GATHER_LEAD.data())));
+			const __m128i middle = _mm_shuffle_epi8(block, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_GATHER_MIDDLE.data())));
+			const __m128i trail = _mm_shuffle_epi8(block, _mm_loadu_si128(reinterpret_cast<const __m128i*>(THREE_BYTE_GATHER_TRAIL.data())));
+			const __m128i continuation_payload = _mm_set1_epi16(0x3F);
+			codepoints = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_and_si128(lead, _mm_set1_epi16(0x0F)), 12),
+				_mm_slli_epi16(_mm_and_si128(middle, continuation_payload), 6)), _mm_and_si128(trail, continuation_payload));
+			const __m128i well_formed = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(lead, _mm_set1_epi16(0xF0)), _mm_set1_epi16(0xE0)),
+				_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(middle, _mm_slli_epi16(trail, 8)), _mm_set1_epi16(static_cast<i16>(0xC0C0))), _mm_set1_epi16(static_cast<i16>(0x8080))));
+			// Overlong ones are below 0x800.
+			const __m128i high_5_bits = _mm_and_si128(codepoints, _mm_set1_epi16(static_cast<i16>(0xF800)));
+			const __m128i ill_formed = _mm_or_si128(_mm_cmpeq_epi16(high_5_bits, _mm_setzero_si128()), _mm_cmpeq_epi16(high_5_bits, _mm_set1_epi16(static_cast<i16>(0xD800))));
+			return (_mm_movemask_epi8(_mm_andnot_si128(ill_formed, well_formed)) & 0x3FF) == 0x3FF;
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 utf8_to_utf16_avx2(const char* data, const u64 size, char16_t* destination) noexcept
+		{
+			char16_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 32 <= size)
+				{
+					const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					if(_mm256_movemask_epi8(block) == 0)
+					{
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(written), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(block)));
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(written + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(block, 1)));
+						written += 32;
+						i += 32;
+						continue;
+					}
+				}
+				if(i + 16 <= size)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					if(_mm_movemask_epi8(block) == 0)
+					{
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(written), _mm256_cvtepu8_epi16(block));
+						written += 16;
+						i += 16;
+						continue;
+					}
+					if(__m128i codepoints; decode_three_byte_block_avx2(block, codepoints))
+					{
+						_mm_storel_epi64(reinterpret_cast<__m128i*>(written), codepoints);
+						written[4] = static_cast<char16_t>(_mm_extract_epi16(codepoints, 4));
+						written += 5;
+						i += 15;
+						continue;
+					}
+				}
+				written = utf8_to_utf16_step(data, i, size, written);
+			}
+			return static_cast<u64>(written - destination);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		[[nodiscard]] u64 count_utf8_of_utf16_neon(const char16_t* data, const u64 size) noexcept
+		{
+			const uint16x8_t non_two_byte_bits = vdupq_n_u16(0xF800);
+			u64 count = 0;
+			u64 i = 0;
+			while(i + 8 <= size)
+			{
+				const uint16x8_t block = vld1q_u16(reinterpret_cast<const u16*>(data + i));
+				const uint16x8_t high_5_bits = vandq_u16(block, non_two_byte_bits);
+				if(vmaxvq_u16(vceqq_u16(high_5_bits, vdupq_n_u16(0xD800))) != 0)
+				{
+					for(const u64 block_end = i + 8; i < block_end;)
+						count += count_utf8_of_utf16_step(data, i, size);
+					continue;
+				}
+				const uint16x8_t non_ascii = vshrq_n_u16(vcgeq_u16(block, vdupq_n_u16(0x80)), 15);
+				const uint16x8_t non_two_byte = vshrq_n_u16(vtstq_u16(block, non_two_byte_bits), 15);
+				count += 8 + vaddvq_u16(vaddq_u16(non_ascii, non_two_byte));
+				i += 8;
+			}
+			while(i < size)
+				count += count_utf8_of_utf16_step(data, i, size);
+			return count;
+		}
+
+		/**
+		 * \brief Encode 8 codeunits of BMP if they all take the same count of utf-8 codeunits.
+		 * @return End of written codeunits, return nullptr if the block is not handled.
+		 */
+		[[nodiscard]] inline char* encode_bmp_block_neon(const uint16x8_t block, char* destination) noexcept
+		{
+			const uint16x8_t low_6_bits = vdupq_n_u16(0x3F);
+			const uint16x8_t continuation_header = vdupq_n_u16(0x80);
+			const u16 maximum = vmaxvq_u16(block);
+			const u16 minimum = vminvq_u16(block);
+			u8* output = reinterpret_cast<u8*>(destination);
+			if(maximum < 0x80)
+			{
+				vst1_u8(output, vmovn_u16(block));
+				return destination + 8;
+			}
+			const uint16x8_t trail = vorrq_u16(vandq_u16(block, low_6_bits), continuation_header);
+			if(minimum >= 0x80 && maximum < 0x800)
+			{
+				const uint16x8_t lead = vorrq_u16(vshrq_n_u16(block, 6), vdupq_n_u16(0xC0));
+				vst2_u8(output, uint8x8x2_t{ { vmovn_u16(lead), vmovn_u16(trail) } });
+				return destination + 16;
+			}
+			if(minimum >= 0x800 && vmaxvq_u16(vceqq_u16(vandq_u16(block, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800))) == 0)
+			{
+				const uint16x8_t lead = vorrq_u16(vshrq_n_u16(block, 12), vdupq_n_u16(0xE0));
+				const uint16x8_t middle = vorrq_u16(vandq_u16(vshrq_n_u16(block, 6), low_6_bits), continuation_header);
+				vst3_u8(output, uint8x8x3_t{ { vmovn_u16(lead), vmovn_u16(middle), vmovn_u16(trail) } });
+				return destination + 24;
+			}
+			return nullptr;
+		}
+
+		[[nodiscard]] u64 utf16_to_utf8_neon(const char16_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			u64 i = 0;
+			while(i + 8 <= size)
+			{
+				if(char* block_end = encode_bmp_block_neon(vld1q_u16(reinterpret_cast<const u16*>(data + i)), written))
+				{
+					written = block_end;
+					i += 8;
+					continue;
+				}
+				for(const u64 block_end = i + 8; i < block_end;)
+					written = utf16_to_utf8_step(data, i, size, written);
+			}
+			while(i < size)
+				written = utf16_to_utf8_step(data, i, size, written);
+			return static_cast<u64>(written - destination);
+		}
+
+		/**
+		 * \brief Decode 8 three-byte sequences from 24 codeunits, which is common in cjk text.
+		 * @return Whether they are all well-formed.
+		 */
+		[[nodiscard]] inline bool decode_three_byte_block_neon(const char* data, uint16x8_t& codepoints) noexcept
+		{
+			const uint8x8x3_t parts = vld3_u8(reinterpret_cast<const u8*>(data));
+			codepoints = vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vand_u8(parts.val[0], vdup_n_u8(0x0F))), 12),
+				vshlq_n_u16(vmovl_u8(vand_u8(parts.val[1], vdup_n_u8(0x3F))), 6)), vmovl_u8(vand_u8(parts.val[2], vdup_n_u8(0x3F))));
+			const uint8x8_t lead_ok = vceq_u8(vand_u8(parts.val[0], vdup_n_u8(0xF0)), vdup_n_u8(0xE0));
+			const uint8x8_t continuations_ok = vand_u8(vceq_u8(vand_u8(parts.val[1], vdup_n_u8(0xC0)), vdup_n_u8(0x80)),
+				vceq_u8(vand_u8(parts.val[2], vdup_n_u8(0xC0)), vdup_n_u8(0x80)));
+			// Overlong ones are below 0x800.
+			const uint16x8_t high_5_bits = vandq_u16(codepoints, vdupq_n_u16(0xF800));
+			const uint16x8_t codepoints_ok = vbicq_u16(vtstq_u16(high_5_bits, high_5_bits), vceqq_u16(high_5_bits, vdupq_n_u16(0xD800)));
+			return vminv_u8(vand_u8(lead_ok, continuations_ok)) != 0 && vminvq_u16(codepoints_ok) != 0;
+		}
+
+		[[nodiscard]] u64 utf8_to_utf16_neon(const char* data, const u64 size, char16_t* destination) noexcept
+		{
+			char16_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 16 <= size)
+				{
+					const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i));
+					if(vmaxvq_u8(block) < 0x80)
+					{
+						u16* output = reinterpret_cast<u16*>(written);
+						vst1q_u16(output, vmovl_u8(vget_low_u8(block)));
+						vst1q_u16(output + 8, vmovl_u8(vget_high_u8(block)));
+						written += 16;
+						i += 16;
+						continue;
+					}
+				}
+				if(uint16x8_t codepoints; i + 24 <= size && decode_three_byte_block_neon(data + i, codepoints))
+				{
+					vst1q_u16(reinterpret_cast<u16*>(written), codepoints);
+					written += 8;
+					i += 24;
+					continue;
+				}
+				written = utf8_to_utf16_step(data, i, size, written);
+			}
+			return static_cast<u64>(written - destination);
+		}
+#endif
+
+		// code-region-end: utf-16 transcoding kernels
+
+		// code-region-start: utf-32 transcoding kernels
+
+		[[nodiscard]] constexpr char32_t replace_invalid_utf32(const char32_t c) noexcept
+		{
+			return c > 0x10FFFF || (c >= unicode::utf16::LEADING_SURROGATE_MINIMUM && c <= unicode::utf16::TRAILING_SURROGATE_MAXIMUM) ? unicode::REPLACEMENT_CHARACTER : c;
+		}
+
+		[[nodiscard]] constexpr u64 count_utf8_of_utf32_step(const char32_t c) noexcept
+		{
+			const char32_t cp = replace_invalid_utf32(c);
+			return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+		}
+
+		[[nodiscard]] u64 count_utf8_of_utf32_portable(const char32_t* data, const u64 size) noexcept
+		{
+			u64 count = 0;
+			for(u64 i = 0; i < size; ++i)
+				count += count_utf8_of_utf32_step(data[i]);
+			return count;
+		}
+
+		[[nodiscard]] u64 utf32_to_utf8_portable(const char32_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			for(u64 i = 0; i < size; ++i)
+				written = encode_utf8(replace_invalid_utf32(data[i]), written);
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] u64 utf8_to_utf32_portable(const char* data, const u64 size, char32_t* destination) noexcept
+		{
+			char32_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 8 <= size && (load_word(data + i) & SWAR_HIGH_BITS) == 0)
+				{
+					for(u64 j = 0; j < 8; ++j)
+						written[j] = static_cast<char32_t>(data[i + j]);
+					written += 8;
+					i += 8;
+					continue;
+				}
+				if(decode_utf8_step(data, i, size, *written))
+					++written;
+			}
+			return static_cast<u64>(written - destination);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		// Each codepoint takes 1 utf-8 codeunit plus one for each of 0x80, 0x800 and 0x10000 it reaches.
+		[[nodiscard]] u64 count_utf8_of_utf32_sse2(const char32_t* data, const u64 size) noexcept
+		{
+			// Comparison results are -1, so lanes of steps count down, and they are flushed before wrapping around.
+			__m128i steps = _mm_setzero_si128();
+			u64 pending_blocks = 0;
+			const auto flush = [&steps, &pending_blocks]
+			{
+				alignas(16) std::array<i32, 4> lanes;
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes.data()), steps);
+				steps = _mm_setzero_si128();
+				pending_blocks = 0;
+				return static_cast<u64>(-(static_cast<i64>(lanes[0]) + lanes[1] + lanes[2] + lanes[3]));
+			};
+			u64 count = 0;
+			u64 i = 0;
+			for(; i + 4 <= size; i += 4)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				// Values are compared as signed, which is fine once none of them is beyond U+10FFFF.
+				const __m128i invalid = _mm_or_si128(_mm_cmpgt_epi32(_mm_srli_epi32(block, 16), _mm_set1_epi32(0x10)),
+					_mm_cmpeq_epi32(_mm_and_si128(block, _mm_set1_epi32(static_cast<i32>(0xFFFFF800))), _mm_set1_epi32(0xD800)));
+				if(_mm_movemask_epi8(invalid) != 0)
+				{
+					for(u64 j = 0; j < 4; ++j)
+						count += count_utf8_of_utf32_step(data[i + j]);
+					continue;
+				}
+				steps = _mm_add_epi32(steps, _mm_add_epi32(_mm_add_epi32(_mm_cmpgt_epi32(block, _mm_set1_epi32(0x7F)), _mm_cmpgt_epi32(block, _mm_set1_epi32(0x7FF))),
+					_mm_cmpgt_epi32(block, _mm_set1_epi32(0xFFFF))));
+				count += 4;
+				if(++pending_blocks == 1 << 24)
+					count += flush();
+			}
+			count += flush();
+			for(; i < size; ++i)
+				count += count_utf8_of_utf32_step(data[i]);
+			return count;
+		}
+
+		[[nodiscard]] u64 utf32_to_utf8_sse2(const char32_t* data, const u64 size, char* destination) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			char* written = destination;
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4));
+				if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi32(static_cast<i32>(0xFFFF0000))), zero)) == 0xFFFF)
+				{
+					// SSE2 has only signed saturation, so BMP values are biased into the range of i16 to be narrowed.
+					const __m128i bias = _mm_set1_epi32(0x8000);
+					const __m128i narrowed = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(low, bias), _mm_sub_epi32(high, bias)), _mm_set1_epi16(static_cast<i16>(0x8000)));
+					if(char* block_end = encode_bmp_block_sse2(narrowed, written))
+					{
+						written = block_end;
+						continue;
+					}
+				}
+				for(u64 j = 0; j < 8; ++j)
+					written = encode_utf8(replace_invalid_utf32(data[i + j]), written);
+			}
+			for(; i < size; ++i)
+				written = encode_utf8(replace_invalid_utf32(data[i]), written);
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] u64 utf8_to_utf32_sse2(const char* data, const u64 size, char32_t* destination) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			char32_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 16 <= size)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					if(_mm_movemask_epi8(block) == 0)
+					{
+						const __m128i low = _mm_unpacklo_epi8(block, zero);
+						const __m128i high = _mm_unpackhi_epi8(block, zero);
+						__m128i* output = reinterpret_cast<__m128i*>(written);
+						_mm_storeu_si128(output, _mm_unpacklo_epi16(low, zero));
+						_mm_storeu_si128(output + 1, _mm_unpackhi_epi16(low, zero));
+						_mm_storeu_si128(output + 2, _mm_unpacklo_epi16(high, zero));
+						_mm_storeu_si128(output + 3, _mm_unpackhi_epi16(high, zero));
+						written += 16;
+						i += 16;
+						continue;
+					}
+				}
+				if(decode_utf8_step(data, i, size, *written))
+					++written;
+			}
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 count_utf8_of_utf32_avx2(const char32_t* data, const u64 size) noexcept
+		{
+			u64 count = 0;
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				const __m256i invalid = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_srli_epi32(block, 16), _mm256_set1_epi32(0x10)),
+					_mm256_cmpeq_epi32(_mm256_and_si256(block, _mm256_set1_epi32(static_cast<i32>(0xFFFFF800))), _mm256_set1_epi32(0xD800)));
+				if(_mm256_movemask_epi8(invalid) != 0)
+				{
+					for(u64 j = 0; j < 8; ++j)
+						count += count_utf8_of_utf32_step(data[i + j]);
+					continue;
+				}
+				const u64 two_bytes = count_bits(static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(block, _mm256_set1_epi32(0x7F)))));
+				const u64 three_bytes = count_bits(static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(block, _mm256_set1_epi32(0x7FF)))));
+				const u64 four_bytes = count_bits(static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(block, _mm256_set1_epi32(0xFFFF)))));
+				count += 8 + (two_bytes + three_bytes + four_bytes) / 4;
+			}
+			for(; i < size; ++i)
+				count += count_utf8_of_utf32_step(data[i]);
+			return count;
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 utf32_to_utf8_avx2(const char32_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				if(_mm256_testz_si256(block, _mm256_set1_epi32(static_cast<i32>(0xFFFF0000))))
+				{
+					const __m128i narrowed = _mm_packus_epi32(_mm256_castsi256_si128(block), _mm256_extracti128_si256(block, 1));
+					if(char* block_end = encode_bmp_block_avx2(narrowed, written))
+					{
+						written = block_end;
+						continue;
+					}
+				}
+				for(u64 j = 0; j < 8; ++j)
+					written = encode_utf8(replace_invalid_utf32(data[i + j]), written);
+			}
+			for(; i < size; ++i)
+				written = encode_utf8(replace_invalid_utf32(data[i]), written);
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 utf8_to_utf32_avx2(const char* data, const u64 size, char32_t* destination) noexcept
+		{
+			char32_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 32 <= size)
+				{
+					const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					if(_mm256_movemask_epi8(block) == 0)
+					{
+						const __m128i low = _mm256_castsi256_si128(block);
+						const __m128i high = _mm256_extracti128_si256(block, 1);
+						__m256i* output = reinterpret_cast<__m256i*>(written);
+						_mm256_storeu_si256(output, _mm256_cvtepu8_epi32(low));
+						_mm256_storeu_si256(output + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+						_mm256_storeu_si256(output + 2, _mm256_cvtepu8_epi32(high));
+						_mm256_storeu_si256(output + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+						written += 32;
+						i += 32;
+						continue;
+					}
+				}
+				if(i + 16 <= size)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					if(_mm_movemask_epi8(block) == 0)
+					{
+						__m256i* output = reinterpret_cast<__m256i*>(written);
+						_mm256_storeu_si256(output, _mm256_cvtepu8_epi32(block));
+						_mm256_storeu_si256(output + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(block, 8)));
+						written += 16;
+						i += 16;
+						continue;
+					}
+					if(__m128i codepoints; decode_three_byte_block_avx2(block, codepoints))
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(written), _mm_cvtepu16_epi32(codepoints));
+						written[4] = static_cast<char32_t>(_mm_extract_epi16(codepoints, 4));
+						written += 5;
+						i += 15;
+						continue;
+					}
+				}
+				if(decode_utf8_step(data, i, size, *written))
+					++written;
+			}
+			return static_cast<u64>(written - destination);
+		}
+#endif
+
+#if OPEN_STRING_SIMD_NEON
+		[[nodiscard]] u64 count_utf8_of_utf32_neon(const char32_t* data, const u64 size) noexcept
+		{
+			u64 count = 0;
+			u64 i = 0;
+			for(; i + 4 <= size; i += 4)
+			{
+				const uint32x4_t block = vld1q_u32(reinterpret_cast<const u32*>(data + i));
+				const uint32x4_t invalid = vorrq_u32(vcgtq_u32(block, vdupq_n_u32(0x10FFFF)),
+					vceqq_u32(vandq_u32(block, vdupq_n_u32(0xFFFFF800)), vdupq_n_u32(0xD800)));
+				if(vmaxvq_u32(invalid) != 0)
+				{
+					for(u64 j = 0; j < 4; ++j)
+						count += count_utf8_of_utf32_step(data[i + j]);
+					continue;
+				}
+				const uint32x4_t steps = vaddq_u32(vaddq_u32(vshrq_n_u32(vcgtq_u32(block, vdupq_n_u32(0x7F)), 31),
+					vshrq_n_u32(vcgtq_u32(block, vdupq_n_u32(0x7FF)), 31)), vshrq_n_u32(vcgtq_u32(block, vdupq_n_u32(0xFFFF)), 31));
+				count += 4 + vaddvq_u32(steps);
+			}
+			for(; i < size; ++i)
+				count += count_utf8_of_utf32_step(data[i]);
+			return count;
+		}
+
+		[[nodiscard]] u64 utf32_to_utf8_neon(const char32_t* data, const u64 size, char* destination) noexcept
+		{
+			char* written = destination;
+			u64 i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const uint32x4_t low = vld1q_u32(reinterpret_cast<const u32*>(data + i));
+				const uint32x4_t high = vld1q_u32(reinterpret_cast<const u32*>(data + i + 4));
+				if(vmaxvq_u32(vorrq_u32(low, high)) <= 0xFFFF)
+				{
+					if(char* block_end = encode_bmp_block_neon(vcombine_u16(vmovn_u32(low), vmovn_u32(high)), written))
+					{
+						written = block_end;
+						continue;
+					}
+				}
+				for(u64 j = 0; j < 8; ++j)
+					written = encode_utf8(replace_invalid_utf32(data[i + j]), written);
+			}
+			for(; i < size; ++i)
+				written = encode_utf8(replace_invalid_utf32(data[i]), written);
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] u64 utf8_to_utf32_neon(const char* data, const u64 size, char32_t* destination) noexcept
+		{
+			char32_t* written = destination;
+			u64 i = 0;
+			while(i < size)
+			{
+				if(i + 16 <= size)
+				{
+					const uint8x16_t block = vld1q_u8(reinterpret_cast<const u8*>(data + i));
+					if(vmaxvq_u8(block) < 0x80)
+					{
+						const uint16x8_t low = vmovl_u8(vget_low_u8(block));
+						const uint16x8_t high = vmovl_u8(vget_high_u8(block));
+						u32* output = reinterpret_cast<u32*>(written);
+						vst1q_u32(output, vmovl_u16(vget_low_u16(low)));
+						vst1q_u32(output + 4, vmovl_u16(vget_high_u16(low)));
+						vst1q_u32(output + 8, vmovl_u16(vget_low_u16(high)));
+						vst1q_u32(output + 12, vmovl_u16(vget_high_u16(high)));
+						written += 16;
+						i += 16;
+						continue;
+					}
+				}
+				if(uint16x8_t codepoints; i + 24 <= size && decode_three_byte_block_neon(data + i, codepoints))
+				{
+					u32* output = reinterpret_cast<u32*>(written);
+					vst1q_u32(output, vmovl_u16(vget_low_u16(codepoints)));
+					vst1q_u32(output + 4, vmovl_u16(vget_high_u16(codepoints)));
+					written += 8;
+					i += 24;
+					continue;
+				}
+				if(decode_utf8_step(data, i, size, *written))
+					++written;
+			}
+			return static_cast<u64>(written - destination);
+		}
+#endif
+
+		// code-region-end: utf-32 transcoding kernels
+
+		// code-region-start: hex and base64 kernels
+
+		inline constexpr char LOWER_HEX_DIGITS[] = "0123456789abcdef";
+		inline constexpr char UPPER_HEX_DIGITS[] = "0123456789ABCDEF";
+
+		// Both digits of each byte, so a byte is encoded by one lookup.
+		using hex_pair_table = std::array<char, 512>;
+
+		[[nodiscard]] constexpr hex_pair_table make_hex_pair_table(const char* digits) noexcept
+		{
+			hex_pair_table pairs{ };
+			for(u64 i = 0; i < 256; ++i)
+			{
+				pairs[i * 2] = digits[i >> 4];
+				pairs[i * 2 + 1] = digits[i & 0xF];
+			}
+			return pairs;
+		}
+
+		inline constexpr hex_pair_table LOWER_HEX_PAIRS = make_hex_pair_table(LOWER_HEX_DIGITS);
+		inline constexpr hex_pair_table UPPER_HEX_PAIRS = make_hex_pair_table(UPPER_HEX_DIGITS);
+
+		// Value of each hex digit, 0xFF for other codeunits.
+		inline constexpr std::array<u8, 256> HEX_DIGIT_VALUES = []()
+		{
+			std::array<u8, 256> values{ };
+			for(u64 i = 0; i < values.size(); ++i)
+			{
+				if(i >= '0' && i <= '9')
+					values[i] = static_cast<u8>(i - '0');
+				else if(i >= 'a' && i <= 'f')
+					values[i] = static_cast<u8>(i - 'a' + 10);
+				else if(i >= 'A' && i <= 'F')
+					values[i] = static_cast<u8>(i - 'A' + 10);
+				else
+					values[i] = 0xFF;
+			}
+			return values;
+		}();
+
+		[[nodiscard]] constexpr const char* get_base64_digits(const base64_alphabet alphabet) noexcept
+		{
+			return alphabet == base64_alphabet::url
+				? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+				: "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		}
+
+		// Value of each base64 digit, 0xFF for other codeunits.
+		using base64_value_table = std::array<u8, 256>;
+
+		[[nodiscard]] constexpr base64_value_table make_base64_value_table(const base64_alphabet alphabet) noexcept
+		{
+			base64_value_table values{ };
+			for(u8& value : values)
+				value = 0xFF;
+			const char* digits = get_base64_digits(alphabet);
+			for(u64 i = 0; i < 64; ++i)
+				values[static_cast<u8>(digits[i])] = static_cast<u8>(i);
+			return values;
+		}
+
+		inline constexpr base64_value_table STANDARD_BASE64_VALUES = make_base64_value_table(base64_alphabet::standard);
+		inline constexpr base64_value_table URL_BASE64_VALUES = make_base64_value_table(base64_alphabet::url);
+
+		/**
+		 * @return size without padding, or global_constant::INDEX_INVALID if no size of base64 is such.
+		 */
+		[[nodiscard]] u64 strip_base64_padding(const char* data, u64 size) noexcept
+		{
+			if(size >= 4 && size % 4 == 0 && data[size - 1] == '=')
+			{
+				--size;
+				if(data[size - 1] == '=')
+					--size;
+			}
+			return size % 4 == 1 ? global_constant::INDEX_INVALID : size;
+		}
+
+		[[nodiscard]] u64 hex_encode_portable(const byte* data, const u64 size, char* destination, const bool uppercase, const char separator) noexcept
+		{
+			const char* pairs = (uppercase ? UPPER_HEX_PAIRS : LOWER_HEX_PAIRS).data();
+			if(separator == '\0')
+			{
+				for(u64 i = 0; i < size; ++i)
+					std::memcpy(destination + i * 2, pairs + data[i] * 2, 2);
+				return size * 2;
+			}
+			if(size == 0)
+				return 0;
+			for(u64 i = 0; i + 1 < size; ++i)
+			{
+				std::memcpy(destination + i * 3, pairs + data[i] * 2, 2);
+				destination[i * 3 + 2] = separator;
+			}
+			std::memcpy(destination + (size - 1) * 3, pairs + data[size - 1] * 2, 2);
+			return size * 3 - 1;
+		}
+
+		[[nodiscard]] u64 hex_decode_portable(const char* data, const u64 size, byte* destination, const char separator) noexcept
+		{
+			if(size == 0)
+				return 0;
+			const u64 stride = separator == '\0' ? 2 : 3;
+			// Separators are between pairs, not after the last one.
+			if((size + stride - 2) % stride != 0)
+				return global_constant::INDEX_INVALID;
+			const u64 count = (size + stride - 2) / stride;
+			u8 invalid = 0;
+			for(u64 i = 0; i < count; ++i)
+			{
+				const char* pair = data + i * stride;
+				const u8 high = HEX_DIGIT_VALUES[static_cast<u8>(pair[0])];
+				const u8 low = HEX_DIGIT_VALUES[static_cast<u8>(pair[1])];
+				invalid |= high | low;
+				if(stride == 3 && i + 1 < count && pair[2] != separator)
+					invalid = 0xFF;
+				destination[i] = static_cast<byte>(high << 4 | low);
+			}
+			return (invalid & 0xF0) != 0 ? global_constant::INDEX_INVALID : count;
+		}
+
+		[[nodiscard]] u64 base64_encode_portable(const byte* data, const u64 size, char* destination, const base64_alphabet alphabet, const bool padding) noexcept
+		{
+			const char* digits = get_base64_digits(alphabet);
+			char* written = destination;
+			u64 i = 0;
+			for(; i + 3 <= size; i += 3)
+			{
+				const u32 triple = static_cast<u32>(data[i]) << 16 | static_cast<u32>(data[i + 1]) << 8 | data[i + 2];
+				written[0] = digits[triple >> 18];
+				written[1] = digits[triple >> 12 & 0x3F];
+				written[2] = digits[triple >> 6 & 0x3F];
+				written[3] = digits[triple & 0x3F];
+				written += 4;
+			}
+			const u64 rest = size - i;
+			if(rest > 0)
+			{
+				const u32 triple = static_cast<u32>(data[i]) << 16 | (rest == 2 ? static_cast<u32>(data[i + 1]) << 8 : 0);
+				written[0] = digits[triple >> 18];
+				written[1] = digits[triple >> 12 & 0x3F];
+				if(rest == 2)
+					written[2] = digits[triple >> 6 & 0x3F];
+				written += rest + 1;
+				if(padding)
+				{
+					for(u64 j = rest; j < 3; ++j)
+						*written++ = '=';
+				}
+			}
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] u64 base64_decode_portable(const char* data, u64 size, byte* destination, const base64_alphabet alphabet) noexcept
+		{
+			size = strip_base64_padding(data, size);
+			if(size == global_constant::INDEX_INVALID)
+				return global_constant::INDEX_INVALID;
+			const u8* values = (alphabet == base64_alphabet::url ? URL_BASE64_VALUES : STANDARD_BASE64_VALUES).data();
+			byte* written = destination;
+			u8 invalid = 0;
+			u64 i = 0;
+			for(; i + 4 <= size; i += 4)
+			{
+				const u8 a = values[static_cast<u8>(data[i])];
+				const u8 b = values[static_cast<u8>(data[i + 1])];
+				const u8 c = values[static_cast<u8>(data[i + 2])];
+				const u8 d = values[static_cast<u8>(data[i + 3])];
+				invalid |= a | b | c | d;
+				const u32 quad = static_cast<u32>(a) << 18 | static_cast<u32>(b) << 12 | static_cast<u32>(c) << 6 | d;
+				written[0] = static_cast<byte>(quad >> 16);
+				written[1] = static_cast<byte>(quad >> 8);
+				written[2] = static_cast<byte>(quad);
+				written += 3;
+			}
+			const u64 rest = size - i;
+			if(rest > 0)
+			{
+				const u8 a = values[static_cast<u8>(data[i])];
+				const u8 b = values[static_cast<u8>(data[i + 1])];
+				const u8 c = rest == 3 ? values[static_cast<u8>(data[i + 2])] : 0;
+				invalid |= a | b | c;
+				const u32 quad = static_cast<u32>(a) << 18 | static_cast<u32>(b) << 12 | static_cast<u32>(c) << 6;
+				written[0] = static_cast<byte>(quad >> 16);
+				if(rest == 3)
+					written[1] = static_cast<byte>(quad >> 8);
+				written += rest - 1;
+			}
+			return (invalid & 0xC0) != 0 ? global_constant::INDEX_INVALID : static_cast<u64>(written - destination);
+		}
+
+#if OPEN_STRING_SIMD_X86
+		/**
+		 * @param nibbles 0 to 15 in each byte
+		 */
+		[[nodiscard]] inline __m128i to_hex_digits_sse2(const __m128i nibbles, const __m128i letter_offset) noexcept
+		{
+			const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), letter_offset);
+			return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+		}
+
+		/**
+		 * @param errors nonzero bytes are or-ed into it for codeunits which are not hex digits
+		 * @return Value of each hex digit.
+		 */
+		[[nodiscard]] inline __m128i from_hex_digits_sse2(const __m128i block, __m128i& errors) noexcept
+		{
+			// Unsigned comparisons are done by min, as SSE2 has only signed ones.
+			const __m128i digits = _mm_sub_epi8(block, _mm_set1_epi8('0'));
+			const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+			// Letters are folded to lower case.
+			const __m128i letters = _mm_sub_epi8(_mm_or_si128(block, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+			const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+			errors = _mm_or_si128(errors, _mm_andnot_si128(_mm_or_si128(is_digit, is_letter), _mm_set1_epi8(-1)));
+			return _mm_or_si128(_mm_and_si128(is_digit, digits), _mm_andnot_si128(is_digit, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+		}
+
+		/**
+		 * @return high * 16 + low of each 16-bit lane of high and low digit values, which is at most 0xFF.
+		 */
+		[[nodiscard]] inline __m128i combine_hex_pairs_sse2(const __m128i values) noexcept
+		{
+			return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0xFF)), 4), _mm_srli_epi16(values, 8));
+		}
+
+		[[nodiscard]] u64 hex_encode_sse2(const byte* data, const u64 size, char* destination, const bool uppercase, const char separator) noexcept
+		{
+			if(separator != '\0')
+				return hex_encode_portable(data, size, destination, uppercase, separator);
+			const __m128i letter_offset = _mm_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10);
+			const __m128i low_mask = _mm_set1_epi8(0x0F);
+			u64 i = 0;
+			for(; i + 16 <= size; i += 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				const __m128i high = _mm_and_si128(_mm_srli_epi16(block, 4), low_mask);
+				const __m128i low = _mm_and_si128(block, low_mask);
+				__m128i* output = reinterpret_cast<__m128i*>(destination + i * 2);
+				_mm_storeu_si128(output, to_hex_digits_sse2(_mm_unpacklo_epi8(high, low), letter_offset));
+				_mm_storeu_si128(output + 1, to_hex_digits_sse2(_mm_unpackhi_epi8(high, low), letter_offset));
+			}
+			return i * 2 + hex_encode_portable(data + i, size - i, destination + i * 2, uppercase, separator);
+		}
+
+		[[nodiscard]] u64 hex_decode_sse2(const char* data, const u64 size, byte* destination, const char separator) noexcept
+		{
+			if(separator != '\0' || size % 2 != 0)
+				return hex_decode_portable(data, size, destination, separator);
+			__m128i errors = _mm_setzero_si128();
+			u64 i = 0;
+			for(; i + 32 <= size; i += 32)
+			{
+				const __m128i low = from_hex_digits_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), errors);
+				const __m128i high = from_hex_digits_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16)), errors);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i / 2), _mm_packus_epi16(combine_hex_pairs_sse2(low), combine_hex_pairs_sse2(high)));
+			}
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) != 0xFFFF)
+				return global_constant::INDEX_INVALID;
+			const u64 rest = hex_decode_portable(data + i, size - i, destination + i / 2, separator);
+			return rest == global_constant::INDEX_INVALID ? rest : i / 2 + rest;
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 hex_encode_avx2(const byte* data, const u64 size, char* destination, const bool uppercase, const char separator) noexcept
+		{
+			const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uppercase ? UPPER_HEX_DIGITS : LOWER_HEX_DIGITS));
+			u64 i = 0;
+			if(separator == '\0')
+			{
+				const __m256i wide_digits = _mm256_broadcastsi128_si256(digits);
+				for(; i + 16 <= size; i += 16)
+				{
+					// The high nibble of each byte goes to the lower byte of its 16-bit lane, which is stored first.
+					const __m256i widened = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+					const __m256i nibbles = _mm256_or_si256(_mm256_srli_epi16(widened, 4), _mm256_slli_epi16(_mm256_and_si256(widened, _mm256_set1_epi16(0x0F)), 8));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 2), _mm256_shuffle_epi8(wide_digits, nibbles));
+				}
+				return i * 2 + hex_encode_portable(data + i, size - i, destination + i * 2, uppercase, separator);
+			}
+			// Pairs are spread to every 3 codeunits, and separators fill the gaps which shuffles leave zero.
+			const __m128i head_indices = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+			const __m128i tail_indices = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+			const __m128i head_separators = _mm_and_si128(_mm_cmpeq_epi8(head_indices, _mm_set1_epi8(-1)), _mm_set1_epi8(separator));
+			const __m128i tail_separators = _mm_and_si128(_mm_cmpeq_epi8(tail_indices, _mm_set1_epi8(-1)), _mm_set1_epi8(separator));
+			// The separator after the last byte of a block is written, so the last block is left to the portable kernel.
+			for(; i + 8 < size; i += 8)
+			{
+				const __m128i widened = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i)));
+				const __m128i nibbles = _mm_or_si128(_mm_srli_epi16(widened, 4), _mm_slli_epi16(_mm_and_si128(widened, _mm_set1_epi16(0x0F)), 8));
+				const __m128i pairs = _mm_shuffle_epi8(digits, nibbles);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 3), _mm_or_si128(_mm_shuffle_epi8(pairs, head_indices), head_separators));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i * 3 + 16), _mm_or_si128(_mm_shuffle_epi8(pairs, tail_indices), tail_separators));
+			}
+			return i * 3 + hex_encode_portable(data + i, size - i, destination + i * 3, uppercase, separator);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 hex_decode_avx2(const char* data, const u64 size, byte* destination, const char separator) noexcept
+		{
+			if(separator == '\0' ? size % 2 != 0 : (size + 1) % 3 != 0)
+				return hex_decode_portable(data, size, destination, separator);
+			u64 i = 0;
+			u64 written = 0;
+			if(separator == '\0')
+			{
+				__m256i errors = _mm256_setzero_si256();
+				for(; i + 32 <= size; i += 32)
+				{
+					const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					const __m256i digits = _mm256_sub_epi8(block, _mm256_set1_epi8('0'));
+					const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+					const __m256i letters = _mm256_sub_epi8(_mm256_or_si256(block, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+					const __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letters, _mm256_set1_epi8(5)), letters);
+					errors = _mm256_or_si256(errors, _mm256_andnot_si256(_mm256_or_si256(is_digit, is_letter), _mm256_set1_epi8(-1)));
+					const __m256i values = _mm256_blendv_epi8(_mm256_add_epi8(letters, _mm256_set1_epi8(10)), digits, is_digit);
+					// high * 16 + low in each 16-bit lane.
+					const __m256i combined = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i / 2), _mm_packus_epi16(_mm256_castsi256_si128(combined), _mm256_extracti128_si256(combined, 1)));
+				}
+				if(!_mm256_testz_si256(errors, errors))
+					return global_constant::INDEX_INVALID;
+				written = i / 2;
+			}
+			else
+			{
+				// 8 pairs and their separators are gathered from 24 codeunits, the last block is left to the portable kernel.
+				const __m128i head_digit_indices = _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, -1, -1, -1, -1, -1);
+				const __m128i tail_digit_indices = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 2, 3, 5, 6);
+				const __m128i head_separator_indices = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+				const __m128i tail_separator_indices = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+				const __m128i separators = _mm_setr_epi8(separator, separator, separator, separator, separator, separator, separator, separator, 0, 0, 0, 0, 0, 0, 0, 0);
+				__m128i errors = _mm_setzero_si128();
+				for(; i + 24 < size; i += 24)
+				{
+					const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					const __m128i tail = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i + 16));
+					const __m128i gathered_separators = _mm_or_si128(_mm_shuffle_epi8(head, head_separator_indices), _mm_shuffle_epi8(tail, tail_separator_indices));
+					errors = _mm_or_si128(errors, _mm_xor_si128(gathered_separators, separators));
+					const __m128i digits = _mm_or_si128(_mm_shuffle_epi8(head, head_digit_indices), _mm_shuffle_epi8(tail, tail_digit_indices));
+					const __m128i combined = _mm_maddubs_epi16(from_hex_digits_sse2(digits, errors), _mm_set1_epi16(0x0110));
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i / 3), _mm_packus_epi16(combined, combined));
+				}
+				if(!_mm_testz_si128(errors, errors))
+					return global_constant::INDEX_INVALID;
+				written = i / 3;
+			}
+			const u64 rest = hex_decode_portable(data + i, size - i, destination + written, separator);
+			return rest == global_constant::INDEX_INVALID ? rest : written + rest;
+		}
+
+		/**
+		 * @param indices 0 to 63 in each byte
+		 */
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 __m256i to_base64_digits_avx2(const __m256i indices, const __m256i digit_62, const __m256i digit_63) noexcept
+		{
+			// 'A' + index, then 'a' - 'A' - 26 more from 26, and '0' - 'a' - 26 more from 52.
+			__m256i digits = _mm256_add_epi8(indices, _mm256_set1_epi8('A'));
+			digits = _mm256_add_epi8(digits, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)), _mm256_set1_epi8('a' - 'A' - 26)));
+			digits = _mm256_add_epi8(digits, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(51)), _mm256_set1_epi8('0' - 'a' - 26)));
+			digits = _mm256_blendv_epi8(digits, digit_62, _mm256_cmpeq_epi8(indices, _mm256_set1_epi8(62)));
+			return _mm256_blendv_epi8(digits, digit_63, _mm256_cmpeq_epi8(indices, _mm256_set1_epi8(63)));
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 __m256i is_in_range_avx2(const __m256i block, const char first, const char last) noexcept
+		{
+			// Codeunits beyond 0x7F are negative, so they are in no range of ascii.
+			return _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8(static_cast<char>(first - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(last + 1)), block));
+		}
+
+		/**
+		 * @param errors nonzero bytes are or-ed into it for codeunits which are not base64 digits
+		 * @return Value of each base64 digit.
+		 */
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 __m256i from_base64_digits_avx2(const __m256i block, const __m256i digit_62, const __m256i digit_63, __m256i& errors) noexcept
+		{
+			const __m256i is_upper = is_in_range_avx2(block, 'A', 'Z');
+			const __m256i is_lower = is_in_range_avx2(block, 'a', 'z');
+			const __m256i is_digit = is_in_range_avx2(block, '0', '9');
+			const __m256i is_62 = _mm256_cmpeq_epi8(block, digit_62);
+			const __m256i is_63 = _mm256_cmpeq_epi8(block, digit_63);
+			const __m256i is_valid = _mm256_or_si256(_mm256_or_si256(is_upper, is_lower), _mm256_or_si256(is_digit, _mm256_or_si256(is_62, is_63)));
+			errors = _mm256_or_si256(errors, _mm256_andnot_si256(is_valid, _mm256_set1_epi8(-1)));
+			// Classes are exclusive, so their offsets are merged by or.
+			const __m256i offsets = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(is_upper, _mm256_set1_epi8(-'A')), _mm256_and_si256(is_lower, _mm256_set1_epi8(26 - 'a'))),
+				_mm256_and_si256(is_digit, _mm256_set1_epi8(52 - '0')));
+			const __m256i values = _mm256_blendv_epi8(_mm256_add_epi8(block, offsets), _mm256_set1_epi8(62), is_62);
+			return _mm256_blendv_epi8(values, _mm256_set1_epi8(63), is_63);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 base64_encode_avx2(const byte* data, const u64 size, char* destination, const base64_alphabet alphabet, const bool padding) noexcept
+		{
+			const char* alphabet_digits = get_base64_digits(alphabet);
+			const __m256i digit_62 = _mm256_set1_epi8(alphabet_digits[62]);
+			const __m256i digit_63 = _mm256_set1_epi8(alphabet_digits[63]);
+			// Each 3 bytes a, b, c go to a 32-bit lane as b, a, c, b, so the sextets are moved in place by multiplies.
+			const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+			u64 i = 0;
+			char* written = destination;
+			// 12 bytes of each half are encoded, and 16 bytes are loaded for each.
+			for(; i + 28 <= size; i += 24)
+			{
+				const __m256i block = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 12)), 1);
+				const __m256i spread_block = _mm256_shuffle_epi8(block, spread);
+				const __m256i first_and_third = _mm256_mulhi_epu16(_mm256_and_si256(spread_block, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+				const __m256i second_and_fourth = _mm256_mullo_epi16(_mm256_and_si256(spread_block, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(written), to_base64_digits_avx2(_mm256_or_si256(first_and_third, second_and_fourth), digit_62, digit_63));
+				written += 32;
+			}
+			written += base64_encode_portable(data + i, size - i, written, alphabet, padding);
+			return static_cast<u64>(written - destination);
+		}
+
+		[[nodiscard]] OPEN_STRING_TARGET_AVX2 u64 base64_decode_avx2(const char* data, u64 size, byte* destination, const base64_alphabet alphabet) noexcept
+		{
+			size = strip_base64_padding(data, size);
+			if(size == global_constant::INDEX_INVALID)
+				return global_constant::INDEX_INVALID;
+			const char* alphabet_digits = get_base64_digits(alphabet);
+			const __m256i digit_62 = _mm256_set1_epi8(alphabet_digits[62]);
+			const __m256i digit_63 = _mm256_set1_epi8(alphabet_digits[63]);
+			// Bytes of each 32-bit lane are reversed, and the 4th one is dropped.
+			const __m256i gather = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+			__m256i errors = _mm256_setzero_si256();
+			byte* written = destination;
+			u64 i = 0;
+			for(; i + 32 <= size; i += 32)
+			{
+				const __m256i values = from_base64_digits_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), digit_62, digit_63, errors);
+				// 4 sextets to 24 bits in each 32-bit lane: a << 6 | b and c << 6 | d, then the first one << 12 | the second one.
+				const __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+				const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, gather), _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(written), _mm256_castsi256_si128(packed));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(written + 16), _mm256_extracti128_si256(packed, 1));
+				written += 24;
+			}
+			if(!_mm256_testz_si256(errors, errors))
+				return global_constant::INDEX_INVALID;
+			const u64 rest = base64_decode_portable(data + i, size - i, written, alphabet);
+			return rest == global_constant::INDEX_INVALID ? rest : static_cast<u64>(written - destination) + rest;
+		}
+#endif
+
+		// code-region-end: hex and base64 kernels
+	}
+
+	instruction_set get_instruction_set() noexcept
+	{
+		return details::get_active_instruction_set().load(std::memory_order_relaxed);
+	}
+
+	bool is_supported(const instruction_set set) noexcept
+	{
+		switch(set)
+		{
+		case instruction_set::portable:
+			return true;
+		case instruction_set::sse2:
+#if OPEN_STRING_SIMD_X86
+			return true;
+#else
+			return false;
+#endif
+		case instruction_set::avx2:
+			return details::get_best_instruction_set() == instruction_set::avx2;
+		case instruction_set::neon:
+			return details::get_best_instruction_set() == instruction_set::neon;
+		}
+		return false;
+	}
+
+	bool set_instruction_set(const instruction_set set) noexcept
+	{
+		if(!is_supported(set))
+			return false;
+		details::get_active_instruction_set().store(set, std::memory_order_relaxed);
+		return true;
+	}
+
+	u64 index_of(const char* data, const u64 size, const char codeunit) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::index_of_avx2(data, size, codeunit);
+		case instruction_set::sse2:
+			return details::index_of_sse2(data, size, codeunit);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::index_of_neon(data, size, codeunit);
+#endif
+		default:
+			return details::index_of_portable(data, size, codeunit);
+		}
+	}
+
+	u64 last_index_of(const char* data, const u64 size, const char codeunit) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::last_index_of_avx2(data, size, codeunit);
+		case instruction_set::sse2:
+			return details::last_index_of_sse2(data, size, codeunit);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::last_index_of_neon(data, size, codeunit);
+#endif
+		default:
+			return details::last_index_of_portable(data, size, codeunit);
+		}
+	}
+
+	u64 index_of(const char* data, const u64 size, const char* pattern, const u64 pattern_size) noexcept
+	{
+		if(pattern_size == 0 || pattern_size > size)
+			return global_constant::INDEX_INVALID;
+		if(pattern_size == 1)
+			return index_of(data, size, pattern[0]);
+		details::verify_budget budget{ pattern_size };
+		const details::pair_search_state state = details::index_of_pair(data, size, { pattern, pattern_size, 0, pattern_size - 1 }, budget);
+		if(state.resume == global_constant::INDEX_INVALID)
+			return state.index;
+		substring_table table;
+		details::prepare_two_way<false>({ pattern, pattern_size }, table);
+		const u64 found = details::two_way<false>({ data + state.resume, size - state.resume }, { pattern, pattern_size }, table);
+		return found == global_constant::INDEX_INVALID ? found : found + state.resume;
+	}
+
+	u64 last_index_of(const char* data, const u64 size, const char* pattern, const u64 pattern_size) noexcept
+	{
+		if(pattern_size == 0 || pattern_size > size)
+			return global_constant::INDEX_INVALID;
+		if(pattern_size == 1)
+			return last_index_of(data, size, pattern[0]);
+		const u64 candidates = size - pattern_size + 1;
+		const details::pair_pattern pair{ pattern, pattern_size, 0, pattern_size - 1 };
+		details::verify_budget budget{ pattern_size };
+		details::pair_search_state state;
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			state = details::last_index_of_pair_avx2(data, candidates, pair, budget);
+			break;
+		case instruction_set::sse2:
+			state = details::last_index_of_pair_sse2(data, candidates, pair, budget);
+			break;
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			state = details::last_index_of_pair_neon(data, candidates, pair, budget);
+			break;
+#endif
+		default:
+			state = details::last_index_of_pair_portable(data, candidates, pair, budget);
+			break;
+		}
+		if(state.resume == global_constant::INDEX_INVALID)
+			return state.index;
+		// Search the remaining candidates [0, resume) as reversed strings.
+		const u64 remaining_size = state.resume + pattern_size - 1;
+		substring_table table;
+		details::prepare_two_way<true>({ pattern, pattern_size }, table);
+		const u64 found = details::two_way<true>({ data, remaining_size }, { pattern, pattern_size }, table);
+		return found == global_constant::INDEX_INVALID ? found : remaining_size - pattern_size - found;
+	}
+
+	void prepare(substring_table& table, const char* pattern, const u64 pattern_size) noexcept
+	{
+		table.filter_offset_0 = 0;
+		table.filter_offset_1 = pattern_size == 0 ? 0 : pattern_size - 1;
+		details::prepare_two_way<false>({ pattern, pattern_size }, table);
+		if(pattern_size < 2)
+			return;
+
+		// Filter with the rarest codeunit, and the rarest one among those different from it.
+		const auto rank = [pattern](const u64 offset) { return details::get_codeunit_frequency_rank(static_cast<u8>(pattern[offset])); };
+		u64 rarest = pattern_size - 1;
+		for(u64 i = pattern_size - 1; i > 0; --i)
+			if(rank(i - 1) < rank(rarest))
+				rarest = i - 1;
+		u64 second = global_constant::INDEX_INVALID;
+		for(u64 i = 0; i < pattern_size; ++i)
+			if(pattern[i] != pattern[rarest] && (second == global_constant::INDEX_INVALID || rank(i) < rank(second)))
+				second = i;
+		if(second == global_constant::INDEX_INVALID)
+			return;
+		table.filter_offset_0 = second;
+		table.filter_offset_1 = rarest;
+	}
+
+	u64 index_of(const char* data, const u64 size, const char* pattern, const u64 pattern_size, const substring_table& table) noexcept
+	{
+		if(pattern_size == 0 || pattern_size > size)
+			return global_constant::INDEX_INVALID;
+		if(pattern_size == 1)
+			return index_of(data, size, pattern[0]);
+		details::verify_budget budget{ pattern_size };
+		const details::pair_search_state state = details::index_of_pair(data, size, { pattern, pattern_size, table.filter_offset_0, table.filter_offset_1 }, budget);
+		if(state.resume == global_constant::INDEX_INVALID)
+			return state.index;
+		const u64 found = details::two_way<false>({ data + state.resume, size - state.resume }, { pattern, pattern_size }, table);
+		return found == global_constant::INDEX_INVALID ? found : found + state.resume;
+	}
+
+	u64 index_of_any(const char* data, const u64 size, const codeunit_set& units) noexcept
+	{
+		if(units.is_empty())
+			return global_constant::INDEX_INVALID;
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::index_of_any_avx2(data, size, units);
+		case instruction_set::sse2:
+			return details::index_of_any_sse2(data, size, units);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::index_of_any_neon(data, size, units);
+#endif
+		default:
+			return details::index_of_any_portable(data, size, units);
+		}
+	}
+
+	u64 last_index_of_any(const char* data, const u64 size, const codeunit_set& units) noexcept
+	{
+		if(units.is_empty())
+			return global_constant::INDEX_INVALID;
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::last_index_of_any_avx2(data, size, units);
+		case instruction_set::sse2:
+			return details::last_index_of_any_sse2(data, size, units);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::last_index_of_any_neon(data, size, units);
+#endif
+		default:
+			return details::last_index_of_any_portable(data, size, units);
+		}
+	}
+
+	u64 count_codepoints(const char* data, const u64 size) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::count_avx2<false>(data, size);
+		case instruction_set::sse2:
+			return details::count_sse2<false>(data, size);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::count_neon<false>(data, size);
+#endif
+		default:
+			return details::count_portable<false>(data, size);
+		}
+	}
+
+	u64 count_utf16(const char* data, const u64 size) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::count_avx2<true>(data, size);
+		case instruction_set::sse2:
+			return details::count_sse2<true>(data, size);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::count_neon<true>(data, size);
+#endif
+		default:
+			return details::count_portable<true>(data, size);
+		}
+	}
+
+	u64 index_of_codepoint(const char* data, const u64 size, const u64 codepoint_index) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::index_of_codepoint_avx2(data, size, codepoint_index);
+		case instruction_set::sse2:
+			return details::index_of_codepoint_sse2(data, size, codepoint_index);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::index_of_codepoint_neon(data, size, codepoint_index);
+#endif
+		default:
+			return details::index_of_codepoint_portable(data, size, codepoint_index);
+		}
+	}
+
+	bool is_ascii(const char* data, const u64 size) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::is_ascii_avx2(data, size);
+		case instruction_set::sse2:
+			return details::is_ascii_sse2(data, size);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::is_ascii_neon(data, size);
+#endif
+		default:
+			return details::is_ascii_portable(data, size);
+		}
+	}
+
+	u64 first_invalid_utf8(const char* data, const u64 size, u64& codepoint_count) noexcept
+	{
+		codepoint_count = 0;
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::first_invalid_utf8_avx2(data, size, codepoint_count);
+		case instruction_set::sse2:
+			return details::first_invalid_utf8_sse2(data, size, codepoint_count);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::first_invalid_utf8_neon(data, size, codepoint_count);
+#endif
+		default:
+			return details::first_invalid_utf8_portable(data, size, codepoint_count);
+		}
+	}
+
+	u64 count_utf8_of_utf16(const char16_t* data, const u64 size) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::count_utf8_of_utf16_avx2(data, size);
+		case instruction_set::sse2:
+			return details::count_utf8_of_utf16_sse2(data, size);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::count_utf8_of_utf16_neon(data, size);
+#endif
+		default:
+			return details::count_utf8_of_utf16_portable(data, size);
+		}
+	}
+
+	u64 utf16_to_utf8(const char16_t* data, const u64 size, char* destination) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::utf16_to_utf8_avx2(data, size, destination);
+		case instruction_set::sse2:
+			return details::utf16_to_utf8_sse2(data, size, destination);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::utf16_to_utf8_neon(data, size, destination);
+#endif
+		default:
+			return details::utf16_to_utf8_portable(data, size, destination);
+		}
+	}
+
+	u64 utf8_to_utf16(const char* data, const u64 size, char16_t* destination) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::utf8_to_utf16_avx2(data, size, destination);
+		case instruction_set::sse2:
+			return details::utf8_to_utf16_sse2(data, size, destination);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::utf8_to_utf16_neon(data, size, destination);
+#endif
+		default:
+			return details::utf8_to_utf16_portable(data, size, destination);
+		}
+	}
+
+	u64 count_utf8_of_utf32(const char32_t* data, const u64 size) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::count_utf8_of_utf32_avx2(data, size);
+		case instruction_set::sse2:
+			return details::count_utf8_of_utf32_sse2(data, size);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::count_utf8_of_utf32_neon(data, size);
+#endif
+		default:
+			return details::count_utf8_of_utf32_portable(data, size);
+		}
+	}
+
+	u64 utf32_to_utf8(const char32_t* data, const u64 size, char* destination) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::utf32_to_utf8_avx2(data, size, destination);
+		case instruction_set::sse2:
+			return details::utf32_to_utf8_sse2(data, size, destination);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::utf32_to_utf8_neon(data, size, destination);
+#endif
+		default:
+			return details::utf32_to_utf8_portable(data, size, destination);
+		}
+	}
+
+	u64 utf8_to_utf32(const char* data, const u64 size, char32_t* destination) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::utf8_to_utf32_avx2(data, size, destination);
+		case instruction_set::sse2:
+			return details::utf8_to_utf32_sse2(data, size, destination);
+#elif OPEN_STRING_SIMD_NEON
+		case instruction_set::neon:
+			return details::utf8_to_utf32_neon(data, size, destination);
+#endif
+		default:
+			return details::utf8_to_utf32_portable(data, size, destination);
+		}
+	}
+
+	u64 hex_encode(const byte* data, const u64 size, char* destination, const bool uppercase, const char separator) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::hex_encode_avx2(data, size, destination, uppercase, separator);
+		case instruction_set::sse2:
+			return details::hex_encode_sse2(data, size, destination, uppercase, separator);
+#endif
+		default:
+			return details::hex_encode_portable(data, size, destination, uppercase, separator);
+		}
+	}
+
+	u64 hex_decode(const char* data, const u64 size, byte* destination, const char separator) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::hex_decode_avx2(data, size, destination, separator);
+		case instruction_set::sse2:
+			return details::hex_decode_sse2(data, size, destination, separator);
+#endif
+		default:
+			return details::hex_decode_portable(data, size, destination, separator);
+		}
+	}
+
+	u64 base64_encode(const byte* data, const u64 size, char* destination, const base64_alphabet alphabet, const bool padding) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::base64_encode_avx2(data, size, destination, alphabet, padding);
+#endif
+		default:
+			return details::base64_encode_portable(data, size, destination, alphabet, padding);
+		}
+	}
+
+	u64 base64_decode(const char* data, const u64 size, byte* destination, const base64_alphabet alphabet) noexcept
+	{
+		switch(get_instruction_set())
+		{
+#if OPEN_STRING_SIMD_X86
+		case instruction_set::avx2:
+			return details::base64_decode_avx2(data, size, destination, alphabet);
+#endif
+		default:
+			return details::base64_decode_portable(data, size, destination, alphabet);
+		}
+	}
+}
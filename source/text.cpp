@@ -3,31 +3,108 @@
 
 #include <algorithm>
 #include "common/functions.h"
+#include "common/simd.h"
 #include "wide_text.h"
 
 namespace ostr
 {
+	namespace
+	{
+		// Walking through shorter texts costs less than building an index.
+		constexpr u64 INDEX_CODEUNIT_COUNT_MIN = codepoint_index::STRIDE * 4;
+
+		// Metadata of a sequence is its codepoint count, with this bit set if all codeunits are ascii.
+		constexpr u64 METADATA_ASCII = 1ull << 63;
+		constexpr u64 METADATA_UNKNOWN = global_constant::SIZE_INVALID;
+		constexpr u64 METADATA_EMPTY = METADATA_ASCII;
+
+		[[nodiscard]] constexpr u64 get_metadata_count(const u64 metadata) noexcept
+		{
+			return metadata & ~METADATA_ASCII;
+		}
+
+		[[nodiscard]] constexpr bool is_metadata_ascii(const u64 metadata) noexcept
+		{
+			return (metadata & METADATA_ASCII) != 0;
+		}
+
+		[[nodiscard]] u64 make_metadata(const codeunit_sequence_view& sequence) noexcept
+		{
+			if(simd::is_ascii(sequence.data(), sequence.size()))
+				return sequence.size() | METADATA_ASCII;
+			return simd::count_codepoints(sequence.data(), sequence.size());
+		}
+
+		[[nodiscard]] u64 make_metadata(const char codeunit, const u64 count) noexcept
+		{
+			if(static_cast<u8>(codeunit) < 0x80)
+				return count | METADATA_ASCII;
+			return unicode::is_utf8_continuation(codeunit) ? 0 : count;
+		}
+	}
+
 	text::text() noexcept = default;
-	text::text(const text&) noexcept = default;
-	text::text(text&&) noexcept = default;
-	text& text::operator=(const text&) noexcept = default;
-	text& text::operator=(text&&) noexcept = default;
-	text::~text() = default;
+
+	text::text(const text& other) noexcept
+		: sequence_{ other.sequence_ }
+		, metadata_{ other.metadata_.load(std::memory_order_relaxed) }
+	{ }
+
+	text::text(text&& other) noexcept
+		: sequence_{ std::move(other.sequence_) }
+		, index_{ other.index_.exchange(nullptr, std::memory_order_relaxed) }
+		, metadata_{ other.metadata_.exchange(METADATA_UNKNOWN, std::memory_order_relaxed) }
+	{ }
+
+	text& text::operator=(const text& other) noexcept
+	{
+		if(this == &other)
+			return *this;
+		this->sequence_ = other.sequence_;
+		this->reset_index();
+		this->metadata_.store(other.metadata_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	text& text::operator=(text&& other) noexcept
+	{
+		if(this == &other)
+			return *this;
+		this->sequence_ = std::move(other.sequence_);
+		this->reset_index();
+		this->index_.store(other.index_.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+		this->metadata_.store(other.metadata_.exchange(METADATA_UNKNOWN, std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	text::~text()
+	{
+		this->reset_index();
+	}
 
 	text::text(const char* str) noexcept
 		: sequence_{ str }
+		, metadata_{ make_metadata(this->sequence_.view()) }
 	{ }
 
 	text::text(const text_view& view) noexcept
 		: sequence_{ view.raw() }
+		, metadata_{ make_metadata(this->sequence_.view()) }
 	{ }
 
 	text::text(codeunit_sequence sequence) noexcept
 		: sequence_{ std::move(sequence) }
+		, metadata_{ make_metadata(this->sequence_.view()) }
 	{ }
 
 	text::text(const codeunit_sequence_view& sequence) noexcept
 		: sequence_{ sequence }
+		, metadata_{ make_metadata(this->sequence_.view()) }
+	{ }
+
+	text::text(codeunit_sequence sequence, const u64 metadata) noexcept
+		: sequence_{ std::move(sequence) }
+		, metadata_{ metadata }
 	{ }
 
 	text text::from_utf8(const char* string_utf8) noexcept
@@ -35,42 +112,63 @@ namespace ostr
 		return text{ codeunit_sequence_view{ string_utf8 } };
 	}
 
-	text text::from_utf16(const char16_t* string_utf16) noexcept
+	std::optional<text> text::from_utf8_checked(const codeunit_sequence_view& string_utf8) noexcept
 	{
-		const char16_t* p = string_utf16;
-		u64 size = 0;
-		while(*p != 0)
-		{
-			size += unicode::parse_utf8_length(*p);
-			++p;
-		}
-		codeunit_sequence sequence{ size + 1 };
-		p = string_utf16;
-		while(*p != 0)
+		u64 codepoint_count = 0;
+		if(simd::first_invalid_utf8(string_utf8.data(), string_utf8.size(), codepoint_count) != global_constant::INDEX_INVALID)
+			return { };
+		// Each codepoint of valid utf-8 is a single codeunit only if it is ascii.
+		const u64 metadata = codepoint_count == string_utf8.size() ? codepoint_count | METADATA_ASCII : codepoint_count;
+		return text{ codeunit_sequence{ string_utf8 }, metadata };
+	}
+
+	text text::from_utf8_repaired(const codeunit_sequence_view& string_utf8) noexcept
+	{
+		const codepoint replacement{ unicode::REPLACEMENT_CHARACTER };
+		const char* data = string_utf8.data();
+		const u64 size = string_utf8.size();
+		codeunit_sequence repaired{ size };
+		u64 codepoint_count = 0;
+		u64 offset = 0;
+		while(true)
 		{
-			const u64 surrogate_sequence_length = unicode::utf16::parse_utf16_length(*p);
-			sequence.append(codepoint{ p });
-			p += surrogate_sequence_length;
+			u64 valid_codepoint_count = 0;
+			const u64 invalid = simd::first_invalid_utf8(data + offset, size - offset, valid_codepoint_count);
+			codepoint_count += valid_codepoint_count;
+			if(invalid == global_constant::INDEX_INVALID)
+			{
+				repaired.append(codeunit_sequence_view{ data + offset, size - offset });
+				break;
+			}
+			repaired.append(codeunit_sequence_view{ data + offset, invalid });
+			repaired.append(replacement);
+			++codepoint_count;
+			offset += invalid;
+			offset += unicode::parse_invalid_utf8_length(data + offset, size - offset);
 		}
+		const u64 metadata = codepoint_count == repaired.size() ? codepoint_count | METADATA_ASCII : codepoint_count;
+		return text{ std::move(repaired), metadata };
+	}
+
+	text text::from_utf16(const char16_t* string_utf16) noexcept
+	{
+		u64 size = 0;
+		while(string_utf16[size] != 0)
+			++size;
+		codeunit_sequence sequence;
+		sequence.append('\0', simd::count_utf8_of_utf16(string_utf16, size));
+		simd::utf16_to_utf8(string_utf16, size, sequence.data());
 		return text{ std::move(sequence) };
 	}
 
 	text text::from_utf32(const char32_t* string_utf32) noexcept
 	{
-		const char32_t* p = string_utf32;
 		u64 size = 0;
-		while(*p != 0)
-		{
-			size += unicode::parse_utf8_length(*p);
-			++p;
-		}
-		codeunit_sequence sequence{ size };
-		p = string_utf32;
-		while(*p != 0)
-		{
-			sequence.append(codepoint{ *p });
-			++p;
-		}
+		while(string_utf32[size] != 0)
+			++size;
+		codeunit_sequence sequence;
+		sequence.append('\0', simd::count_utf8_of_utf32(string_utf32, size));
+		simd::utf32_to_utf8(string_utf32, size, sequence.data());
 		return text{ std::move(sequence) };
 	}
 
@@ -133,7 +231,13 @@ namespace ostr
 	{
 		if(this->it_.is_valid())
 		{
-			this->it_.owner->sequence_.replace(sequence_view, it_.from, it_.size);
+			text& owner = *this->it_.owner;
+			const u64 previous = owner.get_metadata();
+			const u64 removed = make_metadata(owner.sequence_.subview(it_.from, it_.size));
+			const u64 inserted = make_metadata(sequence_view);
+			owner.reset_index();
+			owner.sequence_.replace(sequence_view, it_.from, it_.size);
+			owner.update_metadata(previous, removed, inserted);
 			this->it_.size = sequence_view.size();
 		}
 	}
@@ -251,6 +355,8 @@ namespace ostr
 
 	codeunit_sequence& text::raw() & noexcept
 	{
+		this->reset_index();
+		this->metadata_.store(METADATA_UNKNOWN, std::memory_order_relaxed);
 		return this->sequence_;
 	}
 
@@ -261,6 +367,8 @@ namespace ostr
 
 	codeunit_sequence text::raw() && noexcept
 	{
+		this->reset_index();
+		this->metadata_.store(METADATA_UNKNOWN, std::memory_order_relaxed);
 		return std::forward<codeunit_sequence>(this->sequence_);
 	}
 
@@ -271,7 +379,7 @@ namespace ostr
 
 	u64 text::size() const noexcept
 	{
-		return this->view().size();
+		return get_metadata_count(this->get_metadata());
 	}
 
 	bool text::is_empty() const noexcept
@@ -279,6 +387,47 @@ namespace ostr
 		return this->sequence_.is_empty();
 	}
 
+	bool text::is_ascii() const noexcept
+	{
+		return is_metadata_ascii(this->get_metadata());
+	}
+
+	u64 text::get_codepoint_index(const u64 codeunit_index) const noexcept
+	{
+		if(this->is_ascii())
+			return minimum(codeunit_index, this->sequence_.size());
+		if(const codepoint_index* index = this->get_index())
+			return index->get_codepoint_index(this->sequence_.view(), codeunit_index);
+		return this->view().get_codepoint_index(codeunit_index);
+	}
+
+	u64 text::get_codeunit_index(const u64 codepoint_index) const noexcept
+	{
+		if(this->is_ascii())
+			return minimum(codepoint_index, this->sequence_.size());
+		if(const ostr::codepoint_index* index = this->get_index())
+			return index->get_codeunit_index(this->sequence_.view(), codepoint_index);
+		return this->view().get_codeunit_index(codepoint_index);
+	}
+
+	u64 text::get_utf16_index(const u64 codepoint_index) const noexcept
+	{
+		if(this->is_ascii())
+			return minimum(codepoint_index, this->sequence_.size());
+		if(const ostr::codepoint_index* index = this->get_index())
+			return index->get_utf16_index(this->sequence_.view(), codepoint_index);
+		return this->view().get_utf16_index(codepoint_index);
+	}
+
+	u64 text::get_codepoint_index_from_utf16(const u64 utf16_index) const noexcept
+	{
+		if(this->is_ascii())
+			return minimum(utf16_index, this->sequence_.size());
+		if(const codepoint_index* index = this->get_index())
+			return index->get_codepoint_index_from_utf16(this->sequence_.view(), utf16_index);
+		return this->view().get_codepoint_index_from_utf16(utf16_index);
+	}
+
 	bool text::operator==(const text_view& rhs) const noexcept
 	{
 		return this->view() == rhs;
@@ -309,32 +458,112 @@ namespace ostr
 		return this->view() != rhs;
 	}
 
+	i32 text::compare(const text_view& rhs) const noexcept
+	{
+		return this->view().compare(rhs);
+	}
+
+	bool text::operator<(const text_view& rhs) const noexcept
+	{
+		return this->view() < rhs;
+	}
+
+	bool text::operator<(const text& rhs) const noexcept
+	{
+		return this->view() < rhs.view();
+	}
+
+	bool text::operator<(const char* rhs) const noexcept
+	{
+		return this->view() < rhs;
+	}
+
+	bool text::operator<=(const text_view& rhs) const noexcept
+	{
+		return this->view() <= rhs;
+	}
+
+	bool text::operator<=(const text& rhs) const noexcept
+	{
+		return this->view() <= rhs.view();
+	}
+
+	bool text::operator<=(const char* rhs) const noexcept
+	{
+		return this->view() <= rhs;
+	}
+
+	bool text::operator>(const text_view& rhs) const noexcept
+	{
+		return this->view() > rhs;
+	}
+
+	bool text::operator>(const text& rhs) const noexcept
+	{
+		return this->view() > rhs.view();
+	}
+
+	bool text::operator>(const char* rhs) const noexcept
+	{
+		return this->view() > rhs;
+	}
+
+	bool text::operator>=(const text_view& rhs) const noexcept
+	{
+		return this->view() >= rhs;
+	}
+
+	bool text::operator>=(const text& rhs) const noexcept
+	{
+		return this->view() >= rhs.view();
+	}
+
+	bool text::operator>=(const char* rhs) const noexcept
+	{
+		return this->view() >= rhs;
+	}
+
 	text& text::append(const text_view& rhs) noexcept
 	{
+		const u64 previous = this->get_metadata();
+		const u64 inserted = make_metadata(rhs.raw());
+		this->reset_index();
 		this->sequence_.append(rhs.raw());
+		this->update_metadata(previous, METADATA_EMPTY, inserted);
 		return *this;
 	}
 
 	text& text::append(const text& rhs) noexcept
 	{
-		return this->append(rhs.view());
+		const u64 previous = this->get_metadata();
+		const u64 inserted = rhs.get_metadata();
+		this->reset_index();
+		this->sequence_.append(rhs.sequence_);
+		this->update_metadata(previous, METADATA_EMPTY, inserted);
+		return *this;
 	}
 
 	text& text::append(const codepoint& cp) noexcept
 	{
+		const u64 previous = this->get_metadata();
+		const u64 inserted = make_metadata(codeunit_sequence_view{ cp });
+		this->reset_index();
 		this->sequence_.append(cp);
+		this->update_metadata(previous, METADATA_EMPTY, inserted);
 		return *this;
 	}
 
 	text& text::append(const char* rhs) noexcept
 	{
-		this->sequence_.append(rhs);
-		return *this;
+		return this->append(text_view{ rhs });
 	}
 
 	text& text::append(const char codeunit, const u64 count) noexcept
 	{
+		const u64 previous = this->get_metadata();
+		this->reset_index();
 		this->sequence_.append(codeunit, count);
+		this->update_metadata(previous, METADATA_EMPTY, make_metadata(codeunit, count));
 		return *this;
 	}
 
@@ -365,35 +594,56 @@ namespace ostr
 
 	text_view text::subview(const u64 from, const u64 size) const noexcept
 	{
-		return this->view().subview(from, size);
+		u64 raw_from = from;
+		u64 raw_size = size;
+		this->get_codeunit_range(raw_from, raw_size);
+		return { this->sequence_.view().subview(raw_from, raw_size) };
 	}
 
 	text& text::subtext(const u64 from, const u64 size) noexcept
 	{
-		const u64 self_size = this->size();
-		if(from >= self_size || size == 0)
+		u64 raw_from = from;
+		u64 raw_size = size;
+		this->get_codeunit_range(raw_from, raw_size);
+		if(raw_size == 0)
 		{
 			this->empty();
 			return *this;
 		}
-		if(from == 0 && size >= self_size)
+		if(raw_size == this->sequence_.size())
 			// Do nothing
 			return *this;
-		const u64 actual_size = minimum({ size, self_size - from });
-		const u64 lower_bound = this->view().get_codepoint_index( from );
-		const u64 upper_bound = this->view().get_codepoint_index( from + actual_size );
-		this->sequence_.subsequence(lower_bound, upper_bound - lower_bound);
+		const bool ascii = this->is_ascii();
+		this->reset_index();
+		this->sequence_.subsequence(raw_from, raw_size);
+		this->metadata_.store(ascii ? raw_size | METADATA_ASCII : make_metadata(this->sequence_.view()), std::memory_order_relaxed);
 		return *this;
 	}
 
 	u64 text::index_of(const text_view& pattern, const u64 from, const u64 size) const noexcept
 	{
-		return this->view().index_of(pattern, from, size);
+		if(pattern.is_empty())
+			return global_constant::INDEX_INVALID;
+		u64 raw_from = from;
+		u64 raw_size = size;
+		this->get_codeunit_range(raw_from, raw_size);
+		const u64 found_raw_index = this->sequence_.view().index_of(pattern.raw(), raw_from, raw_size);
+		if(found_raw_index == global_constant::INDEX_INVALID)
+			return global_constant::INDEX_INVALID;
+		return this->get_codepoint_index(found_raw_index);
 	}
 
 	u64 text::last_index_of(const text_view& pattern, const u64 from, const u64 size) const noexcept
 	{
-		return this->view().last_index_of(pattern, from, size);
+		if(pattern.is_empty())
+			return global_constant::INDEX_INVALID;
+		u64 raw_from = from;
+		u64 raw_size = size;
+		this->get_codeunit_range(raw_from, raw_size);
+		const u64 found_raw_index = this->sequence_.view().last_index_of(pattern.raw(), raw_from, raw_size);
+		if(found_raw_index == global_constant::INDEX_INVALID)
+			return global_constant::INDEX_INVALID;
+		return this->get_codepoint_index(found_raw_index);
 	}
 
 	u64 text::count(const text_view& pattern, const u64 from, const u64 size) const noexcept
@@ -413,7 +663,9 @@ namespace ostr
 
 	void text::empty() noexcept
 	{
+		this->reset_index();
 		this->sequence_.empty();
+		this->metadata_.store(METADATA_EMPTY, std::memory_order_relaxed);
 	}
 
 	text& text::write_at(const u64 index, const codepoint cp) noexcept
@@ -424,23 +676,31 @@ namespace ostr
 
 	codepoint text::read_at(const u64 index) const noexcept
 	{
-		return this->view().read_at(index);
+		return codepoint{ &this->sequence_.read_at(this->get_codeunit_index(index)) };
 	}
 
 	codepoint text::operator[](const u64 index) const noexcept
 	{
-		return this->view().read_at(index);
+		return this->read_at(index);
 	}
 
 	text& text::reverse(const u64 from, const u64 size) noexcept
 	{
 		u64 raw_from = from;
 		u64 raw_size = size;
-		this->view().get_codeunit_range(raw_from, raw_size);
+		this->get_codeunit_range(raw_from, raw_size);
+		const u64 previous = this->get_metadata();
+		this->reset_index();
 		this->sequence_.reverse(raw_from, raw_size);
+		// Codepoints of ascii texts are single codeunits, which need no fix.
+		if(is_metadata_ascii(previous))
+			return *this;
+		const u64 removed = make_metadata(this->sequence_.subview(raw_from, raw_size));
 		for(u64 i = 0; i < raw_size; ++i)
 			if(const u8 code_size = unicode::parse_utf8_length( this->sequence_.read_at(raw_from + i) ); code_size != 0)
 				this->sequence_.reverse(raw_from + i + 1 - code_size, code_size);
+		// Codeunits of invalid sequences may be reordered into other codepoints.
+		this->update_metadata(previous, removed, make_metadata(this->sequence_.subview(raw_from, raw_size)));
 		return *this;
 	}
 
@@ -465,8 +725,14 @@ namespace ostr
 	{
 		u64 raw_from = from;
 		u64 raw_size = size;
-		this->view().get_codeunit_range(raw_from, raw_size);
+		this->get_codeunit_range(raw_from, raw_size);
+		const u64 previous = this->get_metadata();
+		const u64 removed = make_metadata(this->sequence_.subview(raw_from, raw_size));
+		const u64 previous_codeunit_count = this->sequence_.size();
+		this->reset_index();
 		this->sequence_.replace(destination.raw(), source.raw(), raw_from, raw_size);
+		const u64 replaced_size = raw_size + this->sequence_.size() - previous_codeunit_count;
+		this->update_metadata(previous, removed, make_metadata(this->sequence_.subview(raw_from, replaced_size)));
 		return *this;
 	}
 
@@ -474,20 +740,37 @@ namespace ostr
 	{
 		u64 raw_from = from;
 		u64 raw_size = size;
-		this->view().get_codeunit_range(raw_from, raw_size);
+		this->get_codeunit_range(raw_from, raw_size);
+		const u64 previous = this->get_metadata();
+		const u64 removed = make_metadata(this->sequence_.subview(raw_from, raw_size));
+		const u64 inserted = make_metadata(destination.raw());
+		this->reset_index();
 		this->sequence_.replace(destination.raw(), raw_from, raw_size);
+		this->update_metadata(previous, removed, inserted);
 		return *this;
 	}
 
 	text& text::self_remove_prefix(const text_view& prefix) noexcept
 	{
+		if(!this->starts_with(prefix))
+			return *this;
+		const u64 previous = this->get_metadata();
+		const u64 removed = make_metadata(prefix.raw());
+		this->reset_index();
 		this->sequence_.self_remove_prefix(prefix.raw());
+		this->update_metadata(previous, removed, METADATA_EMPTY);
 		return *this;
 	}
 
 	text& text::self_remove_suffix(const text_view& suffix) noexcept
 	{
+		if(!this->ends_with(suffix))
+			return *this;
+		const u64 previous = this->get_metadata();
+		const u64 removed = make_metadata(suffix.raw());
+		this->reset_index();
 		this->sequence_.self_remove_suffix(suffix.raw());
+		this->update_metadata(previous, removed, METADATA_EMPTY);
 		return *this;
 	}
 
@@ -512,7 +795,11 @@ namespace ostr
 				break;
 			codeunit_index += it.raw_size();
 		}
+		const u64 previous = this->get_metadata();
+		const u64 removed = make_metadata(this->sequence_.subview(0, codeunit_index));
+		this->reset_index();
 		this->sequence_.subsequence(codeunit_index);
+		this->update_metadata(previous, removed, METADATA_EMPTY);
 		return *this;
 	}
 
@@ -520,7 +807,7 @@ namespace ostr
 	{
 		if(this->is_empty())
 			return *this;
-		u64 codeunit_index = this->raw().size();
+		u64 codeunit_index = this->sequence_.size();
 		auto it = this->cend();
 		while(true)
 		{
@@ -531,7 +818,11 @@ namespace ostr
 			if(it == this->cbegin())
 				break;
 		}
+		const u64 previous = this->get_metadata();
+		const u64 removed = make_metadata(this->sequence_.subview(codeunit_index));
+		this->reset_index();
 		this->sequence_.subsequence(0, codeunit_index);
+		this->update_metadata(previous, removed, METADATA_EMPTY);
 		return *this;
 	}
 
@@ -560,9 +851,88 @@ namespace ostr
 		return this->sequence_.c_str();
 	}
 
+	const codepoint_index* text::get_index() const noexcept
+	{
+		if(this->sequence_.size() < INDEX_CODEUNIT_COUNT_MIN)
+			return nullptr;
+		codepoint_index* index = this->index_.load(std::memory_order_acquire);
+		if(index != nullptr)
+			return index;
+		codepoint_index* built = allocator<codepoint_index>::allocate_single();
+		built->build(this->sequence_.view());
+		// Another reader may have published its index first, then keep that one.
+		if(this->index_.compare_exchange_strong(index, built, std::memory_order_acq_rel, std::memory_order_acquire))
+			return built;
+		allocator<codepoint_index>::deallocate_single(built);
+		return index;
+	}
+
+	void text::reset_index() noexcept
+	{
+		allocator<codepoint_index>::deallocate_single(this->index_.exchange(nullptr, std::memory_order_relaxed));
+	}
+
+	u64 text::get_metadata() const noexcept
+	{
+		u64 metadata = this->metadata_.load(std::memory_order_relaxed);
+		if(metadata == METADATA_UNKNOWN)
+		{
+			// Concurrent readers compute the same value, so it does not matter which one is stored.
+			metadata = make_metadata(this->sequence_.view());
+			this->metadata_.store(metadata, std::memory_order_relaxed);
+		}
+		return metadata;
+	}
+
+	void text::update_metadata(const u64 previous, const u64 removed, const u64 inserted) noexcept
+	{
+		// Codepoints are counted by their first codeunits, so counts of ranges are simply added up.
+		const u64 count = get_metadata_count(previous) - get_metadata_count(removed) + get_metadata_count(inserted);
+		bool ascii = is_metadata_ascii(previous) && is_metadata_ascii(inserted);
+		// Non-ascii codeunits may be all removed, which can only be told by checking the whole sequence again.
+		if(!is_metadata_ascii(previous) && !is_metadata_ascii(removed) && is_metadata_ascii(inserted))
+			ascii = simd::is_ascii(this->sequence_.data(), this->sequence_.size());
+		this->metadata_.store(ascii ? count | METADATA_ASCII : count, std::memory_order_relaxed);
+	}
+
+	void text::get_codeunit_range(u64& from, u64& size) const noexcept
+	{
+		const u64 self_size = this->size();
+		if(from >= self_size)
+		{
+			from = this->sequence_.size();
+			size = 0;
+			return;
+		}
+		const u64 actual_size = minimum(size, self_size - from);
+		const u64 last = this->get_codeunit_index(from + actual_size);
+		from = this->get_codeunit_index(from);
+		size = last - from;
+	}
+
 	bool operator==(const text_view& lhs, const text& rhs) noexcept
 	{
 		return rhs == lhs;
 	}
+
+	bool operator<(const text_view& lhs, const text& rhs) noexcept
+	{
+		return lhs < rhs.view();
+	}
+
+	bool operator<=(const text_view& lhs, const text& rhs) noexcept
+	{
+		return lhs <= rhs.view();
+	}
+
+	bool operator>(const text_view& lhs, const text& rhs) noexcept
+	{
+		return lhs > rhs.view();
+	}
+
+	bool operator>=(const text_view& lhs, const text& rhs) noexcept
+	{
+		return lhs >= rhs.view();
+	}
 }
 
@@ -0,0 +1,140 @@
+#include "utf8_decoder.h"
+
+#include <algorithm>
+#include "common/functions.h"
+#include "common/simd.h"
+
+namespace ostr
+{
+	namespace
+	{
+		constexpr text_view REPLACEMENT{ "\xEF\xBF\xBD" };
+	}
+
+	bool utf8_decoder::next(codeunit_sequence_view& chunk, text_view& run) noexcept
+	{
+		if(chunk.is_empty())
+			return false;
+		if(this->pending_size_ > 0)
+		{
+			const u64 length = unicode::parse_utf8_length(this->pending_[0]);
+			const u64 taken = minimum(length - this->pending_size_, chunk.size());
+			std::copy_n(chunk.data(), taken, this->pending_.data() + this->pending_size_);
+			const u64 available = this->pending_size_ + taken;
+			const u8 matched = unicode::match_utf8_sequence(this->pending_.data(), available);
+			if(matched == available && available < length)
+			{
+				// Still incomplete, chunk is used up.
+				this->pending_size_ = static_cast<u8>(available);
+				chunk = chunk.subview(taken);
+				return false;
+			}
+			// Kept codeunits always match, so the sequence ends in chunk, either completed or ill-formed.
+			chunk = chunk.subview(matched - this->pending_size_);
+			this->pending_size_ = 0;
+			run = matched == length ? text_view{ this->pending_.data(), length } : REPLACEMENT;
+			return true;
+		}
+		u64 codepoint_count = 0;
+		const u64 invalid = simd::first_invalid_utf8(chunk.data(), chunk.size(), codepoint_count);
+		if(invalid == global_constant::INDEX_INVALID)
+		{
+			run = chunk;
+			chunk = chunk.subview(chunk.size());
+			return true;
+		}
+		if(invalid > 0)
+		{
+			run = chunk.subview(0, invalid);
+			chunk = chunk.subview(invalid);
+			return true;
+		}
+		const u8 matched = unicode::match_utf8_sequence(chunk.data(), chunk.size());
+		if(matched == chunk.size())
+		{
+			// A well-formed sequence is split by the end of chunk.
+			std::copy_n(chunk.data(), matched, this->pending_.data());
+			this->pending_size_ = matched;
+			chunk = chunk.subview(matched);
+			return false;
+		}
+		chunk = chunk.subview(unicode::parse_invalid_utf8_length(chunk.data(), chunk.size()));
+		run = REPLACEMENT;
+		return true;
+	}
+
+	bool utf8_decoder::finish(text_view& run) noexcept
+	{
+		if(this->pending_size_ == 0)
+			return false;
+		this->pending_size_ = 0;
+		run = REPLACEMENT;
+		return true;
+	}
+
+	bool utf8_decoder::is_pending() const noexcept
+	{
+		return this->pending_size_ > 0;
+	}
+
+	void utf8_decoder::reset() noexcept
+	{
+		this->pending_size_ = 0;
+	}
+
+	void utf8_decoder::decode(const codeunit_sequence_view& chunk, codeunit_sequence& destination) noexcept
+	{
+		this->decode(chunk, [&destination](const text_view& run)
+		{
+			destination.append(run.raw());
+		});
+	}
+
+	void utf8_decoder::finish(codeunit_sequence& destination) noexcept
+	{
+		if(text_view run; this->finish(run))
+			destination.append(run.raw());
+	}
+
+	u64 utf8_decoder::decode(const codeunit_sequence_view& chunk, char16_t* destination) noexcept
+	{
+		u64 written = 0;
+		this->decode(chunk, [destination, &written](const text_view& run)
+		{
+			const codeunit_sequence_view raw = run.raw();
+			written += simd::utf8_to_utf16(raw.data(), raw.size(), destination + written);
+		});
+		return written;
+	}
+
+	u64 utf8_decoder::finish(char16_t* destination) noexcept
+	{
+		if(text_view run; this->finish(run))
+		{
+			*destination = static_cast<char16_t>(unicode::REPLACEMENT_CHARACTER);
+			return 1;
+		}
+		return 0;
+	}
+
+	u64 utf8_decoder::decode(const codeunit_sequence_view& chunk, char32_t* destination) noexcept
+	{
+		u64 written = 0;
+		this->decode(chunk, [destination, &written](const text_view& run)
+		{
+			const codeunit_sequence_view raw = run.raw();
+			written += simd::utf8_to_utf32(raw.data(), raw.size(), destination + written);
+		});
+		return written;
+	}
+
+	u64 utf8_decoder::finish(char32_t* destination) noexcept
+	{
+		if(text_view run; this->finish(run))
+		{
+			*destination = unicode::REPLACEMENT_CHARACTER;
+			return 1;
+		}
+		return 0;
+	}
+}
@@ -1,6 +1,7 @@
 
 #include "wide_text.h"
 
+#include "common/simd.h"
 #include "text.h"
 #include "text_view.h"
 
@@ -38,21 +39,17 @@ namespace ostr
 
 	wide_text& wide_text::operator=(const codeunit_sequence_view& view) noexcept
 	{
-		const text_view tv{ view };
-		this->sequence_.empty();
-		this->sequence_.reserve(tv.size() + 1);
-		for(const codepoint cp : tv)
-		{
 #if _WIN64
-			const auto utf16_pair = unicode::utf32_to_utf16(cp.get_codepoint());
-			this->sequence_.push_back(utf16_pair.at(0));
-			if(utf16_pair.at(1) != 0)
-				this->sequence_.push_back(utf16_pair.at(1));
+		this->sequence_.resize_uninitialized(simd::count_utf16(view.data(), view.size()) + 1);
+		const u64 written = simd::utf8_to_utf16(view.data(), view.size(), reinterpret_cast<char16_t*>(this->sequence_.data()));
+		this->sequence_.resize_uninitialized(written + 1);
+		this->sequence_.data()[written] = L'\0';
 #elif __linux__ || __MACH__
-			this->sequence_.push_back(cp.get_codepoint());
+		this->sequence_.resize_uninitialized(simd::count_codepoints(view.data(), view.size()) + 1);
+		const u64 written = simd::utf8_to_utf32(view.data(), view.size(), reinterpret_cast<char32_t*>(this->sequence_.data()));
+		this->sequence_.resize_uninitialized(written + 1);
+		this->sequence_.data()[written] = L'\0';
 #endif
-		}
-		this->sequence_.push_back(L'\0');
 		return *this;
 	}
 
@@ -0,0 +1,53 @@
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// Counted per thread, so that threads of other tests do not disturb the counting.
+	thread_local ostr::u64 allocation_count = 0;
+
+	void* counted_allocate(const std::size_t size)
+	{
+		++allocation_count;
+		if(void* ptr = std::malloc(size == 0 ? 1 : size))
+			return ptr;
+		throw std::bad_alloc{ };
+	}
+}
+
+ostr::u64 ostr::test::get_allocation_count() noexcept
+{
+	return allocation_count;
+}
+
+void* operator new(const std::size_t size)
+{
+	return counted_allocate(size);
+}
+
+void* operator new[](const std::size_t size)
+{
+	return counted_allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
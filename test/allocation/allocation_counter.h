@@ -0,0 +1,20 @@
+#pragma once
+
+#include "common/basic_types.h"
+
+namespace ostr::test
+{
+	/**
+	 * @return How many times operator new or operator new[] have been called on this thread.
+	 * Only this executable replaces them, so that the allocation behaviour of other tests is untouched.
+	 */
+	[[nodiscard]] u64 get_allocation_count() noexcept;
+
+	template<class F>
+	[[nodiscard]] u64 count_allocations(F&& f)
+	{
+		const u64 count = get_allocation_count();
+		f();
+		return get_allocation_count() - count;
+	}
+}
@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "allocation_counter.h"
+
+#include "format.h"
+
+using namespace ostr;
+using ostr::test::count_allocations;
+
+TEST(format_allocation, formatted_size)
+{
+	const codeunit_sequence long_argument{ "0123456789abcdef" };
+	codeunit_sequence long_text;
+	for(u64 i = 0; i < 64; ++i)
+		long_text += long_argument;
+
+	// Nothing is allocated for measuring.
+	EXPECT_EQ(count_allocations([&long_text]
+	{
+		EXPECT_EQ(formatted_size("[{}] {}"_cuqv, 42, long_text), 1029);
+	}), 0);
+}
+
+TEST(format_allocation, format)
+{
+	const codeunit_sequence long_argument{ "0123456789abcdef" };
+	codeunit_sequence long_text;
+	for(u64 i = 0; i < 64; ++i)
+		long_text += long_argument;
+
+	// Short results stay in sso, others are allocated exactly once, however long they are.
+	EXPECT_EQ(count_allocations([]
+	{
+		EXPECT_EQ(format("{}+{}"_cuqv, 1, 2), "1+2"_cuqv);
+	}), 0);
+	EXPECT_EQ(count_allocations([]
+	{
+		const codeunit_sequence result = format("Player {} joined at {}:{}, health {:.1f}, flags {:x}."_cuqv, "繁星明"_cuqv, 12, 34, 98.5, 0xBEEF);
+		EXPECT_EQ(result, "Player 繁星明 joined at 12:34, health 98.5, flags beef."_cuqv);
+	}), 1);
+	EXPECT_EQ(count_allocations([&long_text]
+	{
+		const codeunit_sequence result = format("[{}] {}"_cuqv, 42, long_text);
+		EXPECT_EQ(result.size(), 1029);
+		EXPECT_TRUE(result.ends_with(long_text.view()));
+	}), 1);
+	EXPECT_EQ(count_allocations([]
+	{
+		const codeunit_sequence result = format(OPEN_STRING_COMPILED_FORMAT("{} {} {} {}"), 1.5, -7, "compiled", nullptr);
+		EXPECT_EQ(result, "1.5 -7 compiled nullptr"_cuqv);
+	}), 1);
+}
@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "allocation_counter.h"
+
+#include "print.h"
+
+#include <string>
+
+using namespace ostr;
+using ostr::test::count_allocations;
+
+// Lines which fit in the stack buffer are formatted and written without any heap allocation.
+TEST(print_allocation, steady_state)
+{
+	std::FILE* file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+#if _WIN64
+	const int file_descriptor = _fileno(file);
+#else
+	const int file_descriptor = fileno(file);
+#endif
+	const codeunit_sequence_view name = "繁星明"_cuqv;
+	const std::string padding(details::PRINT_STACK_BUFFER_SIZE - 100, '.');
+	const codeunit_sequence_view long_argument{ padding.data(), padding.size() };
+
+	{
+		buffered_writer writer{ file_descriptor };
+		EXPECT_EQ(count_allocations([&]
+		{
+			for(i32 i = 0; i < 10000; ++i)
+				println(writer, "Player {} joined at {}:{:02}, health {:.1f}, flags {:x}."_cuqv, name, 12, i % 60, 98.5, i);
+			println(writer, "{} {}"_cuqv, long_argument, 0);
+			EXPECT_TRUE(writer.flush());
+		}), 0);
+	}
+
+	EXPECT_EQ(count_allocations([&]
+	{
+		for(i32 i = 0; i < 1000; ++i)
+			EXPECT_TRUE(println(file_descriptor, "[{}] {} {}"_cuqv, i, name, 1.25));
+		EXPECT_TRUE(println(file_descriptor, "{} {}"_cuqv, long_argument, 0));
+	}), 0);
+
+	// The first write allocates the stdio buffer of the file once.
+	EXPECT_TRUE(println(file, "warm up"_cuqv));
+	EXPECT_EQ(count_allocations([&]
+	{
+		for(i32 i = 0; i < 10000; ++i)
+			EXPECT_TRUE(println(file, OPEN_STRING_COMPILED_FORMAT("[{}] {} {}"), i, name, -0.5f));
+		EXPECT_TRUE(println(file, "{} {}"_cuqv, long_argument, 0));
+	}), 0);
+
+	std::fclose(file);
+}
@@ -0,0 +1,57 @@
+// ReSharper disable StringLiteralTypo
+#include "pch.h"
+
+#include "codepoint_index.h"
+#include "text_view.h"
+
+using namespace ostr;
+
+TEST(codepoint_index, conversions)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		// Codepoints of every length, and invalid codeunits which count as one codepoint each.
+		std::string data;
+		for(u64 i = 0; i < 100; ++i)
+		{
+			data += "a你😀\xC3\xA9";
+			if(i % 7 == 0)
+				data += "\x80";
+		}
+		data += "\xE4";
+		const codeunit_sequence_view sequence{ data.data(), data.size() };
+		const text_view view{ sequence };
+		const codepoint_index index{ sequence };
+
+		EXPECT_EQ(index.size(), view.size());
+		EXPECT_EQ(index.utf16_size(), view.get_utf16_index(SIZE_MAX));
+		for(u64 i = 0; i <= index.size() + 1; ++i)
+		{
+			EXPECT_EQ(index.get_codeunit_index(sequence, i), view.get_codeunit_index(i));
+			EXPECT_EQ(index.get_utf16_index(sequence, i), view.get_utf16_index(i));
+		}
+		for(u64 i = 0; i <= sequence.size() + 1; ++i)
+			EXPECT_EQ(index.get_codepoint_index(sequence, i), view.get_codepoint_index(i));
+		for(u64 i = 0; i <= index.utf16_size() + 1; ++i)
+			EXPECT_EQ(index.get_codepoint_index_from_utf16(sequence, i), view.get_codepoint_index_from_utf16(i));
+	}
+	{
+		const codepoint_index index{ ""_cuqv };
+		EXPECT_EQ(index.size(), 0);
+		EXPECT_EQ(index.get_codeunit_index(""_cuqv, 3), 0);
+		EXPECT_EQ(index.get_codepoint_index(""_cuqv, 3), 0);
+		EXPECT_EQ(index.get_utf16_index(""_cuqv, 3), 0);
+		EXPECT_EQ(index.get_codepoint_index_from_utf16(""_cuqv, 3), 0);
+	}
+	{
+		// Exactly one stride.
+		const std::string data(codepoint_index::STRIDE, 'x');
+		const codeunit_sequence_view sequence{ data.data(), data.size() };
+		codepoint_index index;
+		index.build(sequence);
+		EXPECT_EQ(index.size(), codepoint_index::STRIDE);
+		EXPECT_EQ(index.get_codeunit_index(sequence, codepoint_index::STRIDE - 1), codepoint_index::STRIDE - 1);
+		EXPECT_EQ(index.get_codeunit_index(sequence, codepoint_index::STRIDE), codepoint_index::STRIDE);
+		EXPECT_EQ(index.get_codepoint_index(sequence, codepoint_index::STRIDE), codepoint_index::STRIDE);
+	}
+}
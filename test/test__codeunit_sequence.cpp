@@ -1,6 +1,7 @@
 
 // ReSharper disable StringLiteralTypo
 #include "pch.h"
+#include <algorithm>
 
 using namespace ostr;
 
@@ -19,10 +20,15 @@ struct codeunit_sequence_accessor
 
 	struct norm
 	{
-		u32 alloc : 1;
-		u32 size : 15;
-		u32 capacity;
+		u64 alloc : 1;
+		u64 size : 57;
+		u64 capacity_exponent : 6;
 		char* data;
+
+		[[nodiscard]] u64 capacity() const
+		{
+			return (1ull << capacity_exponent) - 1;
+		}
 	};
 
 	[[nodiscard]] sso& as_sso()
@@ -80,6 +86,37 @@ TEST(codeunit_sequence, concatenate)
 	}
 }
 
+TEST(codeunit_sequence, compare)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const codeunit_sequence short_sequence("short key");
+		const codeunit_sequence long_sequence("a key which is longer than sso");
+		EXPECT_GT(short_sequence.compare(long_sequence.view()), 0);
+		EXPECT_EQ(short_sequence.compare("short key"_cuqv), 0);
+		EXPECT_LT(long_sequence, short_sequence);
+		EXPECT_LE(long_sequence, "a key which is longer than sso");
+		EXPECT_GT(short_sequence, "short");
+		EXPECT_GE(short_sequence, "short key"_cuqv);
+		EXPECT_LT("short"_cuqv, short_sequence);
+		EXPECT_GE("short key"_cuqv, short_sequence);
+		EXPECT_GT("z"_cuqv, long_sequence);
+		EXPECT_LE("a"_cuqv, long_sequence);
+	}
+	{
+		std::vector<codeunit_sequence> names;
+		names.emplace_back("delta");
+		names.emplace_back("alpha");
+		names.emplace_back("charlie is longer than sso");
+		names.emplace_back("bravo");
+		std::sort(names.begin(), names.end());
+		EXPECT_EQ(names[0], "alpha");
+		EXPECT_EQ(names[1], "bravo");
+		EXPECT_EQ(names[2], "charlie is longer than sso");
+		EXPECT_EQ(names[3], "delta");
+	}
+}
+
 TEST(codeunit_sequence, split)
 {
 	SCOPED_DETECT_MEMORY_LEAK()
@@ -196,7 +233,7 @@ TEST(codeunit_sequence, empty)
 		const codeunit_sequence_accessor* accessor = ACCESS(cuq);
 		EXPECT_TRUE(!accessor->is_short());
 		EXPECT_EQ(0, accessor->as_norm().size);
-		EXPECT_EQ(63, accessor->as_norm().capacity);
+		EXPECT_EQ(63, accessor->as_norm().capacity());
 	}
 	{
 		codeunit_sequence cuq("This is a sentence with 33 words."_cuqv);
@@ -204,11 +241,11 @@ TEST(codeunit_sequence, empty)
 		cuq.empty(100);
 		EXPECT_TRUE(!accessor->is_short());
 		EXPECT_EQ(0, cuq.size());
-		EXPECT_EQ(127, accessor->as_norm().capacity);
+		EXPECT_EQ(127, accessor->as_norm().capacity());
 		cuq.empty(20);		// Do not reallocate
 		EXPECT_TRUE(!accessor->is_short());
 		EXPECT_EQ(0, accessor->as_norm().size);
-		EXPECT_EQ(127, accessor->as_norm().capacity);
+		EXPECT_EQ(127, accessor->as_norm().capacity());
 		cuq.empty(10);		// Do not reallocate
 		EXPECT_TRUE(!accessor->is_short());
 		EXPECT_EQ(0, accessor->as_sso().size);
@@ -228,7 +265,7 @@ TEST(codeunit_sequence, reserve)
 		cuq.reserve(50);
 		EXPECT_TRUE(!accessor->is_short());
 		EXPECT_EQ(5, accessor->as_norm().size);
-		EXPECT_EQ(63, accessor->as_norm().capacity);
+		EXPECT_EQ(63, accessor->as_norm().capacity());
 	}
 	{
 		codeunit_sequence cuq("This is a sentence with 33 words."_cuqv);
@@ -236,11 +273,11 @@ TEST(codeunit_sequence, reserve)
 		cuq.reserve(10);		// Do nothing
 		EXPECT_TRUE(!accessor->is_short());
 		EXPECT_EQ(33, accessor->as_norm().size);
-		EXPECT_EQ(63, accessor->as_norm().capacity);
+		EXPECT_EQ(63, accessor->as_norm().capacity());
 		EXPECT_EQ("This is a sentence with 33 words."_cuqv, cuq);
 		cuq.reserve(100);
 		EXPECT_EQ(33, accessor->as_norm().size);
-		EXPECT_EQ(127, accessor->as_norm().capacity);
+		EXPECT_EQ(127, accessor->as_norm().capacity());
 		EXPECT_EQ("This is a sentence with 33 words."_cuqv, cuq);
 	}
 }
@@ -314,6 +351,21 @@ TEST(codeunit_sequence, replace)
 			}
 		}
 	}
+	// more than two occurrences in range
+	{
+		{
+			codeunit_sequence cuq("aaaaaaaa");
+			EXPECT_EQ(cuq.replace("b"_cuqv, "a"_cuqv, 1, 6), "abbbbbba"_cuqv);
+		}
+		{
+			codeunit_sequence cuq("abababab");
+			EXPECT_EQ(cuq.replace(""_cuqv, "a"_cuqv, 0, 8), "bbbb"_cuqv);
+		}
+		{
+			codeunit_sequence cuq("abababab");
+			EXPECT_EQ(cuq.replace("cc"_cuqv, "b"_cuqv, 0, 8), "accaccaccacc"_cuqv);
+		}
+	}
 }
 
 TEST(codeunit_sequence, join)
@@ -327,3 +379,46 @@ TEST(codeunit_sequence, join)
 		EXPECT_EQ(joined_2, "Thisisaveryverylongtext"_cuqv);
 	}
 }
+
+TEST(codeunit_sequence, large)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		constexpr u64 size = 1ull << 20;
+		codeunit_sequence cuq;
+		const codeunit_sequence_accessor* accessor = ACCESS(cuq);
+		for(u64 i = 0; i < size / 8; ++i)
+			cuq.append("abcdefg "_cuqv);
+		EXPECT_TRUE(!accessor->is_short());
+		EXPECT_EQ(size, cuq.size());
+		EXPECT_EQ(size, accessor->as_norm().size);
+		EXPECT_EQ(size * 2 - 1, accessor->as_norm().capacity());
+		EXPECT_EQ('\0', cuq.c_str()[size]);
+		EXPECT_EQ(size - 8, cuq.last_index_of("abcdefg "_cuqv));
+		EXPECT_EQ(size / 8, cuq.count(" "_cuqv));
+
+		cuq.replace("_"_cuqv, " "_cuqv);
+		EXPECT_EQ(size, cuq.size());
+		EXPECT_EQ(0, cuq.count(" "_cuqv));
+		cuq.replace(""_cuqv, "_"_cuqv);
+		EXPECT_EQ(size / 8 * 7, cuq.size());
+		EXPECT_TRUE(cuq.ends_with("abcdefgabcdefg"_cuqv));
+		cuq.replace("0123456789"_cuqv, "abcdefg"_cuqv);
+		EXPECT_EQ(size / 8 * 10, cuq.size());
+		EXPECT_EQ(size / 8, cuq.count("0123456789"_cuqv));
+		EXPECT_EQ('\0', cuq.c_str()[cuq.size()]);
+	}
+	{
+		constexpr u64 size = (1ull << 24) + 1;
+		codeunit_sequence cuq;
+		cuq.append('x', size);
+		EXPECT_EQ(size, cuq.size());
+		const codeunit_sequence copied = cuq;
+		EXPECT_EQ(copied, cuq);
+		cuq.subsequence(size - 3);
+		EXPECT_EQ(cuq, "xxx"_cuqv);
+		codeunit_sequence moved = std::move(cuq);
+		EXPECT_EQ(moved, "xxx"_cuqv);
+		EXPECT_TRUE(cuq.is_empty());
+	}
+}
@@ -1,5 +1,6 @@
 
 #include "pch.h"
+#include <algorithm>
 
 using namespace ostr;
 
@@ -54,6 +55,24 @@ TEST(codeunit_sequence_view, index_of)
 		EXPECT_EQ(view.index_of("\xAA"_cuqv), 11);
 		EXPECT_EQ(view.index_of("\xA5"_cuqv), 4);
 		EXPECT_EQ(view.last_index_of("\xA5"_cuqv), 13);
+		EXPECT_EQ(view.index_of(""_cuqv), global_constant::INDEX_INVALID);
+		EXPECT_EQ(view.last_index_of(""_cuqv), global_constant::INDEX_INVALID);
+	}
+	{
+		constexpr auto view = "long long ago long"_cuqv;
+		constexpr u64 index_1 = view.index_of('g');
+		constexpr u64 index_2 = view.last_index_of('g');
+		EXPECT_EQ(index_1, 3);
+		EXPECT_EQ(index_2, 17);
+		EXPECT_EQ(view.index_of('g'), 3);
+		EXPECT_EQ(view.index_of('g', 4), 8);
+		EXPECT_EQ(view.index_of('g', 4, 4), global_constant::INDEX_INVALID);
+		EXPECT_EQ(view.last_index_of('g'), 17);
+		EXPECT_EQ(view.last_index_of('g', 0, 17), 11);
+		EXPECT_EQ(view.last_index_of('l', 5, 4), 5);
+		EXPECT_EQ(view.last_index_of('?'), global_constant::INDEX_INVALID);
+		EXPECT_TRUE(view.contains('a'));
+		EXPECT_FALSE(view.contains('z'));
 	}
 }
 
@@ -95,6 +114,15 @@ TEST(codeunit_sequence_view, count)
 		EXPECT_EQ(view.count("aa"_cuqv, 3), 3);
 		EXPECT_EQ(view.count("aa"_cuqv, 3, 3), 1);
 	}
+	{
+		constexpr auto view = "2022-01-01 [info] loading; 2022-01-01 [warn] slow; 2022-01-01 [info] loaded"_cuqv;
+		EXPECT_EQ(view.count("2022-01-01 [info]"_cuqv), 2);
+		EXPECT_EQ(view.count("] "_cuqv), 3);
+		EXPECT_EQ(view.count("2022-01-01 [info] loading; 2022-01-01 [warn] slow"_cuqv), 1);
+		EXPECT_EQ(view.count(""_cuqv), 0);
+		constexpr u64 count = view.count("2022-01-01 [info]"_cuqv);
+		EXPECT_EQ(count, 2);
+	}
 }
 
 TEST(codeunit_sequence_view, iterate)
@@ -148,6 +176,55 @@ TEST(codeunit_sequence_view, equal)
 	}
 }
 
+TEST(codeunit_sequence_view, compare)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		static_assert("abc"_cuqv.compare("abd"_cuqv) < 0);
+		static_assert("abc"_cuqv.compare("abc"_cuqv) == 0);
+		static_assert("abc"_cuqv.compare("ab"_cuqv) > 0);
+		static_assert(codeunit_sequence_view{ }.compare(""_cuqv) == 0);
+		static_assert("a"_cuqv < "b"_cuqv && "a"_cuqv <= "a"_cuqv && "b"_cuqv > "a"_cuqv && "b"_cuqv >= "b"_cuqv);
+
+		EXPECT_LT("abc"_cuqv.compare("abd"_cuqv), 0);
+		EXPECT_EQ("abc"_cuqv.compare("abc"_cuqv), 0);
+		EXPECT_GT("abc"_cuqv.compare("ab"_cuqv), 0);
+		EXPECT_LT(""_cuqv.compare("a"_cuqv), 0);
+		EXPECT_LT("ab"_cuqv, "abc");
+		EXPECT_LE("abc"_cuqv, "abc");
+		EXPECT_GT("b"_cuqv, "abc");
+		EXPECT_GE("b"_cuqv, "b");
+		// Codeunits are compared unsigned, so non-ascii ones are ordered after ascii ones like their codepoints.
+		EXPECT_LT("z"_cuqv, "你"_cuqv);
+		EXPECT_LT("你"_cuqv, "😀"_cuqv);
+		EXPECT_LT("\x7F"_cuqv, "\x80"_cuqv);
+	}
+	{
+		// Longer than any vector block, with the difference at each position.
+		const std::string base(100, 'k');
+		const codeunit_sequence_view view{ base.data(), base.size() };
+		for(u64 i = 0; i < base.size(); ++i)
+		{
+			std::string other = base;
+			other[i] = 'm';
+			const codeunit_sequence_view other_view{ other.data(), other.size() };
+			EXPECT_NE(view, other_view);
+			EXPECT_LT(view, other_view);
+			EXPECT_GT(other_view, view);
+			EXPECT_LT(view.subview(0, i), other_view);
+			EXPECT_EQ(view.subview(0, i), other_view.subview(0, i));
+		}
+	}
+	{
+		std::vector<codeunit_sequence_view> names = { "delta"_cuqv, "alpha"_cuqv, "charlie"_cuqv, "bravo"_cuqv, "alph"_cuqv };
+		std::sort(names.begin(), names.end());
+		const std::vector<codeunit_sequence_view> sorted = { "alph"_cuqv, "alpha"_cuqv, "bravo"_cuqv, "charlie"_cuqv, "delta"_cuqv };
+		EXPECT_EQ(names, sorted);
+		EXPECT_TRUE(std::binary_search(names.begin(), names.end(), "charlie"_cuqv));
+		EXPECT_FALSE(std::binary_search(names.begin(), names.end(), "char"_cuqv));
+	}
+}
+
 TEST(codeunit_sequence_view, trim)
 {
 	SCOPED_DETECT_MEMORY_LEAK()
@@ -199,6 +276,43 @@ TEST(codeunit_sequence_view, trim)
 	}
 }
 
+TEST(codeunit_sequence_view, codeunit_set)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		constexpr codeunit_set braces{ "{}" };
+		static_assert(braces.size() == 2);
+		static_assert(braces.contains('{') && braces.contains('}') && !braces.contains('a'));
+		static_assert(braces.complement().size() == 254);
+		static_assert(codeunit_set{ }.is_empty());
+		static_assert(codeunit_set{ "}{" } == braces);
+
+		constexpr auto view = "a{b}c{{d}}"_cuqv;
+		static_assert(view.index_of_any(braces) == 1);
+		static_assert(view.index_of_any(braces, 2) == 3);
+		static_assert(view.last_index_of_any(braces) == 9);
+		static_assert(view.last_index_of_any(braces, 0, 5) == 3);
+		EXPECT_EQ(view.index_of_any(braces), 1);
+		EXPECT_EQ(view.index_of_any(braces, 2), 3);
+		EXPECT_EQ(view.index_of_any(braces, 10), global_constant::INDEX_INVALID);
+		EXPECT_EQ(view.last_index_of_any(braces), 9);
+		EXPECT_EQ(view.last_index_of_any(braces, 0, 5), 3);
+		EXPECT_EQ(view.last_index_of_any(braces, 6, 2), 6);
+		EXPECT_EQ(view.last_index_of_any(codeunit_set{ "xyz" }), global_constant::INDEX_INVALID);
+		EXPECT_EQ(view.last_index_of_any("abc"_cuqv, 1), 4);
+	}
+	{
+		constexpr codeunit_set blanks{ " \t" };
+		constexpr auto view = "\t 你 好\t  "_cuqv;
+		static_assert(view.trim(blanks) == "你 好"_cuqv);
+		EXPECT_EQ(view.trim_start(blanks), "你 好\t  "_cuqv);
+		EXPECT_EQ(view.trim_end(blanks), "\t 你 好"_cuqv);
+		EXPECT_EQ(view.trim(blanks), "你 好"_cuqv);
+		EXPECT_TRUE("\t \t"_cuqv.trim(blanks).is_empty());
+		EXPECT_TRUE(codeunit_sequence_view{ }.trim(blanks).is_empty());
+	}
+}
+
 TEST(codeunit_sequence_view, starts_ends_with)
 {
 	SCOPED_DETECT_MEMORY_LEAK()
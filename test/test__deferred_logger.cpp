@@ -0,0 +1,186 @@
+#include "pch.h"
+
+#include "deferred_logger.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ostr;
+
+namespace
+{
+	// Output lines collected from the consumer thread.
+	struct collected_output
+	{
+		std::mutex mutex;
+		std::string lines;
+		u64 batch_count = 0;
+
+		deferred_logger::output_function_type get_output_function()
+		{
+			return [this](const codeunit_sequence_view& batch)
+			{
+				const std::lock_guard<std::mutex> lock{ this->mutex };
+				this->lines.append(batch.data(), batch.size());
+				++this->batch_count;
+			};
+		}
+
+		std::string take()
+		{
+			const std::lock_guard<std::mutex> lock{ this->mutex };
+			return std::move(this->lines);
+		}
+	};
+
+	struct point
+	{
+		i32 x;
+		i32 y;
+	};
+}
+
+template<>
+struct ostr::argument_formatter<point>
+{
+	static void produce(format_sink& sink, const point& value, const codeunit_sequence_view& specification)
+	{
+		sink.append('(');
+		argument_formatter<i32>::produce(sink, value.x, specification);
+		sink.append(", "_cuqv);
+		argument_formatter<i32>::produce(sink, value.y, specification);
+		sink.append(')');
+	}
+};
+
+TEST(deferred_logger, log)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		collected_output output;
+		const prepared_format prepared{ "{player} has {gold} gold"_cuqv, { "player"_cuqv, "gold"_cuqv } };
+		{
+			deferred_logger logger{ output.get_output_function() };
+			EXPECT_TRUE(logger.log("{} {:.2f} {:x} {} {}"_cuqv, 42, 3.14159, 255u, true, point{ 1, -2 }));
+			EXPECT_TRUE(logger.log(OPEN_STRING_COMPILED_FORMAT("{1}-{0}"), 'a', "literal"));
+			EXPECT_TRUE(logger.log(prepared, "繁星明"_txtv, 300));
+			EXPECT_TRUE(logger.log("no argument"));
+
+			// Strings are copied into records, so they could be changed or destroyed right after logging.
+			codeunit_sequence name{ "a name longer than small string optimization" };
+			const char* c_string = "c string";
+			EXPECT_TRUE(logger.log("[{}] [{}] [{}]"_cuqv, name, name.view().subview(2, 4), c_string));
+			name = codeunit_sequence{ "changed" };
+			{
+				const text temporary{ "临时文本" };
+				EXPECT_TRUE(logger.log("{}"_cuqv, temporary));
+			}
+			logger.flush();
+			EXPECT_EQ(output.take(),
+				"42 3.14 ff 1 (1, -2)\n"
+				"literal-97\n"
+				"繁星明 has 300 gold\n"
+				"no argument\n"
+				"[a name longer than small string optimization] [name] [c string]\n"
+				"临时文本\n");
+
+			// Destruction outputs what is left.
+			EXPECT_TRUE(logger.log("last {}"_cuqv, 1));
+		}
+		EXPECT_EQ(output.take(), "last 1\n");
+		EXPECT_GE(output.batch_count, 2);
+	}
+}
+
+TEST(deferred_logger, overflow)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		// Output is held until released, so the queue fills up.
+		collected_output output;
+		std::atomic<bool> entered{ false };
+		std::atomic<bool> released{ false };
+		deferred_logger_settings settings;
+		settings.capacity = 3;
+		settings.record_size = 32;
+		settings.overflow_policy = log_overflow_policy::drop;
+		deferred_logger logger{ [&](const codeunit_sequence_view& batch)
+		{
+			entered.store(true);
+			while(!released.load())
+				std::this_thread::yield();
+			output.get_output_function()(batch);
+		}, settings };
+
+		EXPECT_TRUE(logger.log("{}"_cuqv, 0));
+		while(!entered.load())
+			std::this_thread::yield();
+		// Capacity is rounded up to 4.
+		for(i32 i = 1; i <= 4; ++i)
+			EXPECT_TRUE(logger.log("{}"_cuqv, i));
+		EXPECT_FALSE(logger.log("{}"_cuqv, 5));
+		EXPECT_EQ(logger.get_dropped_count(), 1);
+
+		// Larger than a record, whatever the policy is.
+		EXPECT_FALSE(logger.log("{}"_cuqv, "a string which is longer than thirty-two codeunits"));
+		EXPECT_EQ(logger.get_dropped_count(), 2);
+
+		released.store(true);
+		logger.flush();
+		EXPECT_EQ(output.take(), "0\n1\n2\n3\n4\n");
+		EXPECT_TRUE(logger.log("{}"_cuqv, 6));
+		logger.flush();
+		EXPECT_EQ(output.take(), "6\n");
+	}
+}
+
+TEST(deferred_logger, producers)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		// A small queue and batch, so producers block on it and lines are output in many batches.
+		collected_output output;
+		deferred_logger_settings settings;
+		settings.capacity = 16;
+		settings.batch_size = 256;
+		constexpr u64 producer_count = 4;
+		constexpr u64 record_count = 2000;
+		{
+			deferred_logger logger{ output.get_output_function(), settings };
+			std::vector<std::thread> producers;
+			for(u64 p = 0; p < producer_count; ++p)
+			{
+				producers.emplace_back([&logger, p]
+				{
+					for(u64 i = 0; i < record_count; ++i)
+						logger.log("{} {}"_cuqv, p, i);
+				});
+			}
+			for(std::thread& producer : producers)
+				producer.join();
+			EXPECT_EQ(logger.get_dropped_count(), 0);
+		}
+
+		// Every line is output once, and lines of a producer are in the order it logs them.
+		const std::string lines = output.take();
+		std::array<u64, producer_count> next_records{ };
+		u64 line_count = 0;
+		for(u64 from = 0; from < lines.size(); ++line_count)
+		{
+			const u64 end = lines.find('\n', from);
+			const codeunit_sequence_view line{ lines.data() + from, end - from };
+			const auto [ producer, record ] = line.split(" "_cuqv);
+			const u64 p = static_cast<u64>(producer.read_at(0) - '0');
+			ASSERT_LT(p, producer_count);
+			EXPECT_EQ(record, format("{}"_cuqv, next_records[p]));
+			++next_records[p];
+			from = end + 1;
+		}
+		EXPECT_EQ(line_count, producer_count * record_count);
+		EXPECT_GT(output.batch_count, 1);
+	}
+}
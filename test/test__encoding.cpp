@@ -0,0 +1,81 @@
+#include "pch.h"
+
+#include "encoding.h"
+
+using namespace ostr;
+
+TEST(encoding, hex)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+
+	const codeunit_sequence_view bytes{ "\xDE\xAD\xBE\xEF\x00\x7F", 6 };
+	EXPECT_EQ(to_hex(bytes), "deadbeef007f"_cuqv);
+	EXPECT_EQ(to_hex(bytes, { ' ', true }), "DE AD BE EF 00 7F"_cuqv);
+	EXPECT_EQ(to_hex(""_cuqv, { ':' }), ""_cuqv);
+	EXPECT_EQ(get_hex_encoded_size(6), 12);
+	EXPECT_EQ(get_hex_encoded_size(6, { ' ' }), 17);
+	EXPECT_EQ(get_hex_encoded_size(0, { ' ' }), 0);
+
+	// Into a presized buffer.
+	char buffer[17];
+	EXPECT_EQ(encode_hex(bytes, buffer, { '-' }), 17);
+	EXPECT_EQ(codeunit_sequence_view(buffer, 17), "de-ad-be-ef-00-7f"_cuqv);
+
+	EXPECT_EQ(from_hex("deADbeEF007f"_cuqv), bytes);
+	EXPECT_EQ(from_hex("de:ad:be:ef:00:7f"_cuqv, ':'), bytes);
+	EXPECT_EQ(from_hex(""_cuqv), ""_cuqv);
+	EXPECT_EQ(from_hex("dea"_cuqv), std::nullopt);
+	EXPECT_EQ(from_hex("0x12"_cuqv), std::nullopt);
+	EXPECT_EQ(from_hex("de ad"_cuqv, ':'), std::nullopt);
+	EXPECT_EQ(from_hex("de:ad:"_cuqv, ':'), std::nullopt);
+
+	byte decoded[3];
+	EXPECT_EQ(decode_hex("01 23 45"_cuqv, decoded, ' '), 3);
+	EXPECT_EQ(decoded[2], 0x45);
+}
+
+TEST(encoding, base64)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+
+	// Test vectors of RFC 4648.
+	const std::pair<codeunit_sequence_view, codeunit_sequence_view> vectors[] =
+	{
+		{ ""_cuqv, ""_cuqv },
+		{ "f"_cuqv, "Zg=="_cuqv },
+		{ "fo"_cuqv, "Zm8="_cuqv },
+		{ "foo"_cuqv, "Zm9v"_cuqv },
+		{ "foob"_cuqv, "Zm9vYg=="_cuqv },
+		{ "fooba"_cuqv, "Zm9vYmE="_cuqv },
+		{ "foobar"_cuqv, "Zm9vYmFy"_cuqv },
+	};
+	for(const auto& [ bytes, encoded ] : vectors)
+	{
+		EXPECT_EQ(to_base64(bytes), encoded);
+		EXPECT_EQ(get_base64_encoded_size(bytes.size()), encoded.size());
+		EXPECT_EQ(from_base64(encoded), bytes);
+		const codeunit_sequence unpadded = to_base64(bytes, base64_alphabet::standard, false);
+		EXPECT_EQ(unpadded, encoded.subview(0, encoded.index_of('=')));
+		EXPECT_EQ(get_base64_encoded_size(bytes.size(), false), unpadded.size());
+		EXPECT_EQ(from_base64(unpadded.view()), bytes);
+	}
+
+	// The url alphabet differs in the last two digits.
+	const codeunit_sequence_view bytes{ "\xFB\xEF\xFF\xFB", 4 };
+	EXPECT_EQ(to_base64(bytes), "++//+w=="_cuqv);
+	EXPECT_EQ(to_base64(bytes, base64_alphabet::url, false), "--__-w"_cuqv);
+	EXPECT_EQ(from_base64("--__-w"_cuqv, base64_alphabet::url), bytes);
+	EXPECT_EQ(from_base64("--__-w"_cuqv), std::nullopt);
+	EXPECT_EQ(from_base64("++//+w=="_cuqv, base64_alphabet::url), std::nullopt);
+
+	EXPECT_EQ(from_base64("Zm9v YmFy"_cuqv), std::nullopt);
+	EXPECT_EQ(from_base64("Zm9vY"_cuqv), std::nullopt);
+	EXPECT_EQ(from_base64("Zg="_cuqv), std::nullopt);
+
+	char buffer[8];
+	EXPECT_EQ(encode_base64("foob"_cuqv, buffer), 8);
+	EXPECT_EQ(codeunit_sequence_view(buffer, 8), "Zm9vYg=="_cuqv);
+	byte decoded[8];
+	EXPECT_EQ(decode_base64("Zm9vYg=="_cuqv, decoded), 4);
+	EXPECT_EQ(decoded[3], 'b');
+}
@@ -3,12 +3,56 @@
 
 #include "format.h"
 
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace ostr;
 
 #define EXPECT_CHECKED_WITH_MESSAGE(statement, expected_message)
 
+namespace
+{
+    struct sink_formatted
+    {
+        i32 x;
+        i32 y;
+    };
+
+    struct sequence_formatted
+    {
+        i32 id;
+    };
+}
+
+template<>
+struct ostr::argument_formatter<sink_formatted>
+{
+    static void produce(format_sink& sink, const sink_formatted& value, const codeunit_sequence_view& specification)
+    {
+        sink.append('(');
+        argument_formatter<i32>::produce(sink, value.x, specification);
+        sink.append(", "_cuqv);
+        argument_formatter<i32>::produce(sink, value.y, specification);
+        sink.append(')');
+    }
+};
+
+template<>
+struct ostr::argument_formatter<sequence_formatted>
+{
+    static codeunit_sequence produce(const sequence_formatted& value, const codeunit_sequence_view& specification)
+    {
+        return format("#{}"_cuqv, value.id);
+    }
+};
+
 TEST(format, built_in_types)
 {
     SCOPED_DETECT_MEMORY_LEAK()
@@ -27,12 +71,12 @@ TEST(format, built_in_types)
     EXPECT_EQ("3.14"_cuqv, format("{}"_cuqv, 3.14f));
     EXPECT_EQ("3.1"_cuqv, format("{:.1f}"_cuqv, 3.14f));
     EXPECT_EQ("-3.14000"_cuqv, format("{:.5f}"_cuqv, -3.14f));
-    EXPECT_EQ("-100"_cuqv, format("{}"_cuqv, -99.999999999));
+    EXPECT_EQ("-99.999999999"_cuqv, format("{}"_cuqv, -99.999999999));
     EXPECT_EQ("60.004"_cuqv, format("{}"_cuqv, 60.004));
     EXPECT_EQ("inf"_cuqv, format("{}"_cuqv, std::numeric_limits<f32>::infinity()));
     EXPECT_EQ("-inf"_txtv, format("{}"_txtv, -std::numeric_limits<f64>::infinity()));
     EXPECT_EQ("nan"_cuqv, format("{}"_cuqv, std::numeric_limits<f32>::quiet_NaN()));
-    EXPECT_CHECKED_WITH_MESSAGE(format("{:.10f}"_cuqv, 3.14f), "Too high precision for float type [10]!");
+    EXPECT_EQ("3.1400001049"_cuqv, format("{:.10f}"_cuqv, 3.14f));
 
     // pointer
     EXPECT_EQ("nullptr"_cuqv, format("{}"_cuqv, nullptr));
@@ -42,6 +86,106 @@ TEST(format, built_in_types)
     EXPECT_EQ("繁星明 😀"_cuqv, format("{}{}明{}"_cuqv, "繁", "星"_cuqv, codeunit_sequence(" 😀")));
 }
 
+TEST(format, integer)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+
+    EXPECT_EQ(format("{}"_cuqv, std::numeric_limits<i64>::min()), "-9223372036854775808"_cuqv);
+    EXPECT_EQ(format("{:x}"_cuqv, std::numeric_limits<i64>::min()), "-8000000000000000"_cuqv);
+    EXPECT_EQ(format("{:#b}"_cuqv, std::numeric_limits<i8>::min()), "-0b10000000"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, std::numeric_limits<i64>::max()), "9223372036854775807"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, std::numeric_limits<u64>::max()), "18446744073709551615"_cuqv);
+    EXPECT_EQ(format("{:o}"_cuqv, std::numeric_limits<u64>::max()), "1777777777777777777777"_cuqv);
+    EXPECT_EQ(format("{:#x}"_cuqv, std::numeric_limits<u64>::max()), "0xffffffffffffffff"_cuqv);
+    EXPECT_EQ(format("{:b} {:o} {:x} {}"_cuqv, 0u, 0u, 0u, 0u), "0 0 0 0"_cuqv);
+    EXPECT_EQ(format("{:#06o}"_cuqv, 8), "0o000010"_cuqv);
+    EXPECT_EQ(format("{: 5}"_cuqv, 42u), "   42"_cuqv);
+
+    // Every digit count of every base, compared with std::to_chars.
+    const auto expect_same_as_to_chars = [](const auto value)
+    {
+        constexpr std::pair<int, codeunit_sequence_view> bases[] = { { 2, "b"_cuqv }, { 8, "o"_cuqv }, { 10, "d"_cuqv }, { 16, "x"_cuqv } };
+        for(const auto& [ base, specification ] : bases)
+        {
+            char expected[80];
+            const auto [ last, error ] = std::to_chars(expected, expected + sizeof(expected), value, base);
+            codeunit_sequence formatted;
+            format_sink sink{ &formatted, details::append_to_sequence };
+            argument_formatter<std::decay_t<decltype(value)>>::produce(sink, value, specification);
+            EXPECT_EQ(formatted, codeunit_sequence_view(expected, last)) << value << " in base " << base;
+        }
+    };
+    for(u64 bit = 0; bit < 64; ++bit)
+    {
+        const u64 power_of_2 = 1ull << bit;
+        for(const u64 value : { power_of_2 - 1, power_of_2, power_of_2 + 1, power_of_2 * 3 / 2 })
+        {
+            expect_same_as_to_chars(value);
+            expect_same_as_to_chars(static_cast<i64>(value));
+            expect_same_as_to_chars(-static_cast<i64>(value >> 1));
+        }
+    }
+    for(u64 power_of_10 = 1; power_of_10 <= 1000000000000000000ull; power_of_10 *= 10)
+    {
+        for(const u64 value : { power_of_10 - 1, power_of_10, power_of_10 + 1 })
+        {
+            expect_same_as_to_chars(value);
+            expect_same_as_to_chars(-static_cast<i64>(value));
+        }
+    }
+}
+
+TEST(format, floating_point)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+
+    // Shortest representation which reads back to the same value.
+    EXPECT_EQ(format("{}"_cuqv, 0.1), "0.1"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, 0.1f), "0.1"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, 0.1 + 0.2), "0.30000000000000004"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, 1e300), "1e+300"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, 5e-324), "5e-324"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, -0.0), "-0"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, 3.0), "3"_cuqv);
+    EXPECT_EQ(format("{}"_cuqv, std::numeric_limits<f32>::max()), "3.4028235e+38"_cuqv);
+
+    // Fixed, scientific, general and hexadecimal, whose precision defaults to 6 but the hexadecimal one.
+    EXPECT_EQ(format("{:f} {:e} {:g} {:a}"_cuqv, 1234.5, 1234.5, 1234.5, 1234.5), "1234.500000 1.234500e+03 1234.5 1.34ap+10"_cuqv);
+    EXPECT_EQ(format("{:.2e} {:.3g} {:.4a} {:.0f}"_cuqv, 1234.5, 1234.5, 1234.5, 2.5), "1.23e+03 1.23e+03 1.34a0p+10 2"_cuqv);
+    // A precision without a type is fixed decimals, unlike std::format where it is significant digits.
+    EXPECT_EQ(format("{:.3}"_cuqv, 3.14159), "3.142"_cuqv);
+    EXPECT_EQ(format("{:.2}"_cuqv, 1234.56), "1234.56"_cuqv);
+    EXPECT_EQ(format("{:.0}"_cuqv, -2.75f), "-3"_cuqv);
+
+    // Arbitrary precision is exact.
+    EXPECT_EQ(format("{:.20f}"_cuqv, 0.1), "0.10000000000000000555"_cuqv);
+    const codeunit_sequence long_precision = format("{:.1000f}"_cuqv, 0.1);
+    EXPECT_EQ(long_precision.size(), 1002);
+    EXPECT_TRUE(long_precision.starts_with("0.1000000000000000055511151231257827021181583404541015625000"_cuqv));
+    const codeunit_sequence huge_fixed = format("{:f}"_cuqv, -std::numeric_limits<f64>::max());
+    EXPECT_EQ(huge_fixed.size(), 1 + 309 + 7);
+    EXPECT_TRUE(huge_fixed.starts_with("-179769313486231570814527423731704356798070567525844996598917476803157260780"_cuqv));
+
+    // Random values read back exactly.
+    std::mt19937_64 random{ 20240917 };
+    for(u64 i = 0; i < 10000; ++i)
+    {
+        const u64 bits = random();
+        f64 value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if(std::isnan(value) || std::isinf(value))
+            continue;
+        const codeunit_sequence formatted = format("{}"_cuqv, value);
+        EXPECT_EQ(std::strtod(formatted.c_str(), nullptr), value) << formatted.c_str();
+        f32 narrow_value;
+        std::memcpy(&narrow_value, &bits, sizeof(narrow_value));
+        if(std::isnan(narrow_value) || std::isinf(narrow_value))
+            continue;
+        const codeunit_sequence narrow_formatted = format("{}"_cuqv, narrow_value);
+        EXPECT_EQ(std::strtof(narrow_formatted.c_str(), nullptr), narrow_value) << narrow_formatted.c_str();
+    }
+}
+
 TEST(format, undefined_type)
 {
     SCOPED_DETECT_MEMORY_LEAK()
@@ -78,3 +222,146 @@ TEST(format, format_exception)
     EXPECT_CHECKED_WITH_MESSAGE(format("{abc}"_cuqv, 123), "Invalid format index [abc]!");      // named argument is not allowed.
     EXPECT_CHECKED_WITH_MESSAGE(format("{:.1fa}"_cuqv, 3.14f), "Invalid format specification [.1fa]!");
 }
+
+TEST(format, compiled_format)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("My name is {} and I'm {} years old."), "繁星明"_cuqv, 25), "My name is 繁星明 and I'm 25 years old."_cuqv);
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("My name is {1} and I'm {0} years old."), 25, "繁星明"_cuqv), "My name is 繁星明 and I'm 25 years old."_cuqv);
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("{{{}}} {:.2f} {:x} {}}}"), 12, 3.14159, 255, "end"), format("{{{}}} {:.2f} {:x} {}}}"_cuqv, 12, 3.14159, 255, "end"));
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("{0}{0}{0}"), "ab"), "ababab"_cuqv);
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("no argument")), "no argument"_cuqv);
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("")), ""_cuqv);
+
+    // Errors of format mold are found at compile time, and format with them would not compile.
+    using details::format_mold_error;
+    using details::parse_format_mold;
+    static_assert(parse_format_mold("{}{ {}"_cuqv, nullptr).error == format_mold_error::unclosed_left_brace);
+    static_assert(parse_format_mold("{}} "_cuqv, nullptr).error == format_mold_error::unclosed_right_brace);
+    static_assert(parse_format_mold("{} {0}"_cuqv, nullptr).error == format_mold_error::automatic_index_mixing_with_manual);
+    static_assert(parse_format_mold("{0} {}"_cuqv, nullptr).error == format_mold_error::manual_index_mixing_with_automatic);
+    static_assert(parse_format_mold("{abc}"_cuqv, nullptr).error == format_mold_error::invalid_index);
+    static_assert(parse_format_mold("{}{}"_cuqv, nullptr).argument_count == 2);
+    static_assert(parse_format_mold("{3:x}{1}"_cuqv, nullptr).argument_count == 4);
+    static_assert(parse_format_mold("a{{b}}c{}"_cuqv, nullptr).segment_count == 6);
+}
+
+TEST(format, format_to)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+
+    // Appended to the end of destination.
+    codeunit_sequence destination{ "log: " };
+    format_to(destination, "{} + {} = {}"_cuqv, 1, 2, 3);
+    EXPECT_EQ(destination, "log: 1 + 2 = 3"_cuqv);
+    format_to(destination, OPEN_STRING_COMPILED_FORMAT(", {:x}"), 255);
+    EXPECT_EQ(destination, "log: 1 + 2 = 3, ff"_cuqv);
+
+    // Truncated by the end of buffer, but the whole size is reported.
+    char buffer[8] = { };
+    const format_to_result fitted = format_to(buffer, sizeof(buffer), "{}-{}"_cuqv, 12, 34);
+    EXPECT_EQ(fitted.size, 5);
+    EXPECT_EQ(codeunit_sequence_view(buffer, fitted.last), "12-34"_cuqv);
+    const format_to_result truncated = format_to(buffer, sizeof(buffer), "{:08x}{}"_cuqv, 0xABCDu, "繁星明");
+    EXPECT_EQ(truncated.size, 17);
+    EXPECT_EQ(truncated.last, buffer + sizeof(buffer));
+    EXPECT_EQ(codeunit_sequence_view(buffer, sizeof(buffer)), "0000abcd"_cuqv);
+    EXPECT_EQ(format_to(buffer, 0, "{}"_cuqv, 1).size, 1);
+
+    // Output iterator.
+    std::string output;
+    auto last = format_to(std::back_inserter(output), "{:.2f}|{}|{}"_cuqv, 2.5, nullptr, "end"_cuqv);
+    *last = '!';
+    EXPECT_EQ(output, "2.50|nullptr|end!");
+    char array[16] = { };
+    EXPECT_EQ(format_to(array, "{}{}"_cuqv, "ab", "cd"), array + 4);
+
+    // Formatters appending into sink, or returning a sequence.
+    EXPECT_EQ(format("{:x} {}"_cuqv, sink_formatted{ 10, 11 }, sequence_formatted{ 7 }), "(a, b) #7"_cuqv);
+    EXPECT_EQ(format(OPEN_STRING_COMPILED_FORMAT("{1} {0}"), sink_formatted{ 1, 2 }, sequence_formatted{ 8 }), "#8 (1, 2)"_cuqv);
+}
+
+TEST(format, vformat)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+
+    // Wrappers forward packed arguments, so only packing is compiled for each list of argument types.
+    const auto log_line = [](const codeunit_sequence_view& mold, const format_args& arguments)
+    {
+        codeunit_sequence line{ "[log] " };
+        format_sink sink{ &line, details::append_to_sequence };
+        vformat_to(sink, mold, arguments);
+        return line;
+    };
+    EXPECT_EQ(log_line("{} + {:x}"_cuqv, make_format_args(1, 255)), "[log] 1 + ff"_cuqv);
+    EXPECT_EQ(log_line("no argument"_cuqv, make_format_args()), "[log] no argument"_cuqv);
+    EXPECT_EQ(vformat("{1}{0}"_cuqv, make_format_args("a", sink_formatted{ 1, 2 })), "(1, 2)a"_cuqv);
+    EXPECT_EQ(vformat(prepared_format{ "{name}!"_cuqv, { "name"_cuqv } }, make_format_args("繁星明"_cuqv)), "繁星明!"_cuqv);
+
+    // Formatting stops at the first error instead of reading beyond arguments.
+    EXPECT_EQ(vformat("{}-{}-{}"_cuqv, make_format_args(1)), "1-"_cuqv);
+    EXPECT_EQ(vformat("ab{0} {}"_cuqv, make_format_args(1)), "ab1 "_cuqv);
+}
+
+TEST(format, formatted_size)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+
+    EXPECT_EQ(formatted_size("{} + {} = {}"_cuqv, 1, 2, 3), 9);
+    EXPECT_EQ(formatted_size(""_cuqv), 0);
+    EXPECT_EQ(formatted_size(OPEN_STRING_COMPILED_FORMAT("{{{:08x}}}"), 255), 10);
+    EXPECT_EQ(formatted_size("{}明{}"_cuqv, "繁星", sink_formatted{ -1, 1 }), 16);
+
+    // Results of the same sizes as format, which allocates them once, see test_allocation.
+    EXPECT_EQ(formatted_size("{}+{}"_cuqv, 1, 2), format("{}+{}"_cuqv, 1, 2).size());
+    EXPECT_EQ(formatted_size("[{:.1f}]"_cuqv, 98.5), format("[{:.1f}]"_cuqv, 98.5).size());
+}
+
+TEST(format, prepared_format)
+{
+    SCOPED_DETECT_MEMORY_LEAK()
+    {
+        const prepared_format joined{ "{player} joined at {0}:{1:02}, {player} has {gold} gold{{!}}"_cuqv, { "hour"_cuqv, "minute"_cuqv, "player"_cuqv, "gold"_cuqv } };
+        EXPECT_TRUE(joined.is_valid());
+        EXPECT_EQ(joined.get_argument_count(), 4);
+        EXPECT_EQ(format(joined, 12, 5, "繁星明"_cuqv, 300), "繁星明 joined at 12:05, 繁星明 has 300 gold{!}"_cuqv);
+        EXPECT_EQ(formatted_size(joined, 1, 2, "a", 3), 33);
+
+        // The same results as molds parsed at each call.
+        const prepared_format mixed{ "{{{}}} {:.2f} {:x} {}}}"_cuqv };
+        EXPECT_EQ(format(mixed, 12, 3.14159, 255, "end"), format("{{{}}} {:.2f} {:x} {}}}"_cuqv, 12, 3.14159, 255, "end"));
+        EXPECT_EQ(format(prepared_format{ "{1} {0}"_cuqv }, sink_formatted{ 1, 2 }, sequence_formatted{ 8 }), "#8 (1, 2)"_cuqv);
+        EXPECT_EQ(format(prepared_format{ ""_cuqv }), ""_cuqv);
+
+        // Names mix with automatic indices.
+        EXPECT_EQ(format(prepared_format{ "{} {name} {}"_cuqv, { "name"_cuqv } }, "a", "b"), "a a b"_cuqv);
+
+        // Errors are kept instead of checked, since molds come from data.
+        EXPECT_EQ(prepared_format{ "{}{ {}"_cuqv }.get_error(), details::format_mold_error::unclosed_left_brace);
+        EXPECT_EQ(prepared_format{ "{} {0}"_cuqv }.get_error(), details::format_mold_error::automatic_index_mixing_with_manual);
+        EXPECT_EQ((prepared_format{ "{player}"_cuqv, { "gold"_cuqv } }.get_error()), details::format_mold_error::invalid_index);
+        EXPECT_FALSE(prepared_format{ "{player}"_cuqv }.is_valid());
+        EXPECT_CHECKED_WITH_MESSAGE(format(prepared_format{ "{}{}"_cuqv }, 1), "Invalid format index: Index should be less than count of argument [1]!");
+    }
+    {
+        // Shared by threads without synchronization.
+        const prepared_format shared{ "[{thread}] {value:08x}"_cuqv, { "thread"_cuqv, "value"_cuqv } };
+        std::array<bool, 4> matched{ };
+        std::vector<std::thread> threads;
+        for(u64 t = 0; t < matched.size(); ++t)
+        {
+            threads.emplace_back([&shared, &matched, t]
+            {
+                bool all = true;
+                for(u64 i = 0; i < 1000; ++i)
+                    all = all && format(shared, t, i) == format("[{}] {:08x}"_cuqv, t, i);
+                matched[t] = all;
+            });
+        }
+        for(std::thread& thread : threads)
+            thread.join();
+        for(const bool all : matched)
+            EXPECT_TRUE(all);
+    }
+}
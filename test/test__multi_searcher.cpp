@@ -0,0 +1,94 @@
+// ReSharper disable StringLiteralTypo
+#include "pch.h"
+
+#include "multi_searcher.h"
+
+using namespace ostr;
+
+TEST(multi_searcher, find_all)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const multi_searcher searcher({ "he"_cuqv, "she"_cuqv, "his"_cuqv, "hers"_cuqv });
+		std::vector<multi_searcher::match> matches;
+		EXPECT_EQ(searcher.find_all("ushers"_cuqv, matches), 3);
+		const std::vector<multi_searcher::match> answer{ { 1, 3, 1 }, { 2, 2, 0 }, { 2, 4, 3 } };
+		EXPECT_EQ(matches, answer);
+		EXPECT_TRUE(searcher.contains_any("ushers"_cuqv));
+		EXPECT_FALSE(searcher.contains_any("usher"_cuqv.subview(0, 2)));
+	}
+	{
+		const multi_searcher searcher({ "a"_cuqv, "aa"_cuqv, ""_cuqv, "aa"_cuqv });
+		std::vector<multi_searcher::match> matches;
+		EXPECT_EQ(searcher.find_all("aaa"_cuqv, matches), 5);
+		const std::vector<multi_searcher::match> answer{ { 0, 1, 0 }, { 0, 2, 1 }, { 1, 1, 0 }, { 1, 2, 1 }, { 2, 1, 0 } };
+		EXPECT_EQ(matches, answer);
+	}
+	{
+		const multi_searcher searcher({ "你好"_cuqv, "好人"_cuqv, "❤"_cuqv });
+		std::vector<multi_searcher::match> matches;
+		EXPECT_EQ(searcher.find_all("你好人❤"_cuqv, matches), 3);
+		const std::vector<multi_searcher::match> answer{ { 0, 6, 0 }, { 3, 6, 1 }, { 9, 3, 2 } };
+		EXPECT_EQ(matches, answer);
+		EXPECT_FALSE(searcher.contains_any("你人好"_cuqv));
+	}
+	{
+		const multi_searcher searcher({ });
+		std::vector<multi_searcher::match> matches;
+		EXPECT_EQ(searcher.find_all("anything"_cuqv, matches), 0);
+		EXPECT_FALSE(searcher.contains_any("anything"_cuqv));
+	}
+	{
+		const multi_searcher exact({ "Darn"_cuqv, "HECK"_cuqv });
+		const multi_searcher folded({ "Darn"_cuqv, "HECK"_cuqv }, true);
+		std::vector<multi_searcher::match> matches;
+		EXPECT_EQ(exact.find_all("darn, heck, DARN, Heck"_cuqv, matches), 0);
+		EXPECT_EQ(folded.find_all("darn, heck, DARN, Heck"_cuqv, matches), 4);
+		const std::vector<multi_searcher::match> answer{ { 0, 4, 0 }, { 6, 4, 1 }, { 12, 4, 0 }, { 18, 4, 1 } };
+		EXPECT_EQ(matches, answer);
+	}
+}
+
+TEST(multi_searcher, find_all_brute_force)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	const std::vector<codeunit_sequence_view> patterns{ "ab"_cuqv, "bab"_cuqv, "abba"_cuqv, "b"_cuqv, "aaab"_cuqv, "bbbb"_cuqv };
+	const multi_searcher searcher(patterns);
+	const codeunit_sequence_view text = "abbabaaabbbbabababbbaaabab"_cuqv;
+	std::vector<multi_searcher::match> matches;
+	searcher.find_all(text, matches);
+	std::vector<multi_searcher::match> answer;
+	for(u64 end = 1; end <= text.size(); ++end)
+		for(u32 pattern = 0; pattern < patterns.size(); ++pattern)
+			if(end >= patterns[pattern].size() && text.subview(end - patterns[pattern].size(), patterns[pattern].size()) == patterns[pattern])
+				answer.push_back({ end - patterns[pattern].size(), patterns[pattern].size(), pattern });
+	const auto order = [](const multi_searcher::match& a, const multi_searcher::match& b)
+	{
+		return a.index + a.size != b.index + b.size ? a.index + a.size < b.index + b.size : a.size > b.size;
+	};
+	std::sort(answer.begin(), answer.end(), order);
+	EXPECT_EQ(matches, answer);
+}
+
+TEST(multi_searcher, replace_all)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const multi_searcher searcher({ "darn"_cuqv, "heck"_cuqv, "arnhe"_cuqv }, true);
+		codeunit_sequence message("Darnheck, what the HECK!");
+		EXPECT_EQ(searcher.replace_all(message), 4);
+		EXPECT_EQ(message, "********, what the ****!"_cuqv);
+	}
+	{
+		const multi_searcher searcher({ "坏"_cuqv });
+		codeunit_sequence message("你坏, 这不坏");
+		EXPECT_EQ(searcher.replace_all(message, '#'), 2);
+		EXPECT_EQ(message, "你###, 这不###"_cuqv);
+	}
+	{
+		const multi_searcher searcher({ "bad"_cuqv });
+		codeunit_sequence message("all good here");
+		EXPECT_EQ(searcher.replace_all(message), 0);
+		EXPECT_EQ(message, "all good here"_cuqv);
+	}
+}
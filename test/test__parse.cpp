@@ -0,0 +1,240 @@
+#include "pch.h"
+
+#include "parse.h"
+#include "text_view.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace ostr;
+
+namespace
+{
+	template<class T>
+	void expect_parsed(const codeunit_sequence_view& view, const T value, const u64 size, const parse_error error = parse_error::none)
+	{
+		const parse_result<T> result = parse<T>(view);
+		EXPECT_EQ(result.error, error) << view;
+		EXPECT_EQ(result.size, size) << view;
+		if(error != parse_error::invalid)
+		{
+			EXPECT_EQ(result.value, value) << view;
+		}
+	}
+
+	// Digits of a random length, and a random exponent, which cover truncated mantissas and halfway cases.
+	std::string make_random_decimal(std::mt19937_64& random)
+	{
+		std::string result;
+		if(random() % 2)
+			result += '-';
+		const u64 digit_count = 1 + random() % 40;
+		const u64 dot_position = random() % (digit_count + 1);
+		for(u64 i = 0; i < digit_count; ++i)
+		{
+			if(i == dot_position && i > 0)
+				result += '.';
+			result += static_cast<char>('0' + random() % 10);
+		}
+		result += 'e';
+		result += std::to_string(static_cast<i64>(random() % 700) - 350);
+		return result;
+	}
+}
+
+TEST(parse, integer)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+
+	expect_parsed<i32>("12345,678"_cuqv, 12345, 5);
+	expect_parsed<i32>("-0"_cuqv, 0, 2);
+	expect_parsed<i32>("+42"_cuqv, 42, 3);
+	expect_parsed<u32>("-42"_cuqv, 0, 0, parse_error::invalid);
+	expect_parsed<i32>(""_cuqv, 0, 0, parse_error::invalid);
+	expect_parsed<i32>("-"_cuqv, 0, 0, parse_error::invalid);
+	expect_parsed<i32>("x1"_cuqv, 0, 0, parse_error::invalid);
+	expect_parsed<u64>("00000000000000000000000000000123"_cuqv, 123, 32);
+
+	// Limits of every width, and the first values beyond them.
+	expect_parsed<u8>("255"_cuqv, 255, 3);
+	expect_parsed<u8>("256"_cuqv, 255, 3, parse_error::out_of_range);
+	expect_parsed<i8>("-128"_cuqv, -128, 4);
+	expect_parsed<i8>("-129"_cuqv, -128, 4, parse_error::out_of_range);
+	expect_parsed<i16>("32767"_cuqv, 32767, 5);
+	expect_parsed<i16>("32768"_cuqv, 32767, 5, parse_error::out_of_range);
+	expect_parsed<u16>("65535"_cuqv, 65535, 5);
+	expect_parsed<i32>("-2147483648"_cuqv, std::numeric_limits<i32>::min(), 11);
+	expect_parsed<i32>("2147483648"_cuqv, std::numeric_limits<i32>::max(), 10, parse_error::out_of_range);
+	expect_parsed<u32>("4294967295"_cuqv, std::numeric_limits<u32>::max(), 10);
+	expect_parsed<i64>("-9223372036854775808"_cuqv, std::numeric_limits<i64>::min(), 20);
+	expect_parsed<i64>("-9223372036854775809"_cuqv, std::numeric_limits<i64>::min(), 20, parse_error::out_of_range);
+	expect_parsed<i64>("9223372036854775807"_cuqv, std::numeric_limits<i64>::max(), 19);
+	expect_parsed<u64>("18446744073709551615"_cuqv, std::numeric_limits<u64>::max(), 20);
+	expect_parsed<u64>("18446744073709551616"_cuqv, std::numeric_limits<u64>::max(), 20, parse_error::out_of_range);
+	expect_parsed<u64>("99999999999999999999"_cuqv, std::numeric_limits<u64>::max(), 20, parse_error::out_of_range);
+	expect_parsed<u64>("1844674407370955161500,"_cuqv, std::numeric_limits<u64>::max(), 22, parse_error::out_of_range);
+
+	// Bases.
+	EXPECT_EQ(parse<u32>("ff"_cuqv, 16).value, 255);
+	EXPECT_EQ(parse<u32>("FFg"_cuqv, 16).size, 2);
+	EXPECT_EQ(parse<i32>("-101"_cuqv, 2).value, -5);
+	EXPECT_EQ(parse<u64>("ffffffffffffffff"_cuqv, 16).value, std::numeric_limits<u64>::max());
+	EXPECT_EQ(parse<u64>("10000000000000000"_cuqv, 16).error, parse_error::out_of_range);
+	EXPECT_EQ(parse<u64>("3w5e11264sgsf"_cuqv, 36).value, std::numeric_limits<u64>::max());
+	EXPECT_EQ(parse<u8>("777"_cuqv, 8).error, parse_error::out_of_range);
+	EXPECT_EQ(parse<u8>("0x1f"_cuqv, 16).size, 1);
+
+	// Every length of digits, through eight-digit blocks and their tails, compared with std::to_chars.
+	std::mt19937_64 random{ 1234 };
+	for(u64 i = 0; i < 20000; ++i)
+	{
+		const u64 value = random() >> (random() % 64);
+		char buffer[32];
+		// A codeunit after the digits is left for the separator.
+		const auto [ last, error ] = std::to_chars(buffer, buffer + sizeof(buffer) - 1, value);
+		*last = ' ';
+		const codeunit_sequence_view view{ buffer, static_cast<u64>(last - buffer + 1) };
+		expect_parsed<u64>(view, value, last - buffer);
+		const auto [ signed_last, signed_error ] = std::to_chars(buffer, buffer + sizeof(buffer), -static_cast<i64>(value >> 1));
+		expect_parsed<i64>({ buffer, static_cast<u64>(signed_last - buffer) }, -static_cast<i64>(value >> 1), signed_last - buffer);
+		const auto [ hex_last, hex_error ] = std::to_chars(buffer, buffer + sizeof(buffer), value, 16);
+		EXPECT_EQ(parse<u64>(codeunit_sequence_view{ buffer, static_cast<u64>(hex_last - buffer) }, 16).value, value);
+	}
+
+	// text_view
+	EXPECT_EQ(parse<i32>("-17 apples"_txtv).value, -17);
+	EXPECT_EQ("2147483647"_txtv.try_as_integer(), 2147483647);
+	EXPECT_EQ("2147483648"_txtv.try_as_integer(), std::nullopt);
+	EXPECT_EQ("12a"_txtv.try_as_integer(), std::nullopt);
+	static_assert("-123"_txtv.try_as_integer() == -123);
+
+	// Compile time follows the same grammar and overflow rules as run time.
+	static_assert("-"_txtv.try_as_integer() == std::nullopt);
+	EXPECT_EQ("-"_txtv.try_as_integer(), std::nullopt);
+	static_assert("+"_txtv.try_as_integer() == std::nullopt);
+	EXPECT_EQ("+"_txtv.try_as_integer(), std::nullopt);
+	static_assert("+-5"_txtv.try_as_integer() == std::nullopt);
+	EXPECT_EQ("+-5"_txtv.try_as_integer(), std::nullopt);
+	static_assert("2147483648"_txtv.try_as_integer() == std::nullopt);
+	static_assert("2147483647"_txtv.try_as_integer() == 2147483647);
+	static_assert("-2147483648"_txtv.try_as_integer() == std::numeric_limits<i32>::min());
+	EXPECT_EQ("-2147483648"_txtv.try_as_integer(), std::numeric_limits<i32>::min());
+	static_assert("-2147483649"_txtv.try_as_integer() == std::nullopt);
+	EXPECT_EQ("-2147483649"_txtv.try_as_integer(), std::nullopt);
+}
+
+TEST(parse, floating_point)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+
+	expect_parsed<f64>("3.25,"_cuqv, 3.25, 4);
+	expect_parsed<f64>("-.5"_cuqv, -0.5, 3);
+	expect_parsed<f64>("5."_cuqv, 5.0, 2);
+	expect_parsed<f64>("+1e3"_cuqv, 1000.0, 4);
+	expect_parsed<f64>("1e"_cuqv, 1.0, 1);
+	expect_parsed<f64>("1e+"_cuqv, 1.0, 1);
+	expect_parsed<f64>("2E-2x"_cuqv, 0.02, 4);
+	expect_parsed<f64>("."_cuqv, 0.0, 0, parse_error::invalid);
+	expect_parsed<f64>("-"_cuqv, 0.0, 0, parse_error::invalid);
+	expect_parsed<f64>("e5"_cuqv, 0.0, 0, parse_error::invalid);
+	expect_parsed<f64>("0e99999999999"_cuqv, 0.0, 13);
+	expect_parsed<f64>("-0.0"_cuqv, -0.0, 4);
+	EXPECT_TRUE(std::signbit(parse<f64>("-0"_cuqv).value));
+
+	// Special values.
+	expect_parsed<f64>("inf"_cuqv, std::numeric_limits<f64>::infinity(), 3);
+	expect_parsed<f64>("-Infinity!"_cuqv, -std::numeric_limits<f64>::infinity(), 9);
+	expect_parsed<f32>("INFINIT"_cuqv, std::numeric_limits<f32>::infinity(), 3);
+	EXPECT_TRUE(std::isnan(parse<f64>("NaN"_cuqv).value));
+	EXPECT_EQ(parse<f64>("nan"_cuqv).size, 3);
+
+	// Rounding at the edges.
+	expect_parsed<f64>("9007199254740993"_cuqv, 9007199254740992.0, 16);
+	expect_parsed<f64>("9007199254740993.0000000000000000001"_cuqv, 9007199254740994.0, 36);
+	expect_parsed<f64>("1e23"_cuqv, 1e23, 4);
+
+	// More than 19 significant digits around a halfway point are rounded by comparing them exactly.
+	expect_parsed<f64>("9007199254740993.000000000000000000001"_cuqv, 9007199254740994.0, 38);
+	expect_parsed<f64>("9007199254740993.000000000000000000000"_cuqv, 9007199254740992.0, 38);
+	expect_parsed<f64>("9007199254740994.999999999999999999999"_cuqv, 9007199254740994.0, 38);
+	expect_parsed<f64>("9007199254740995.000000000000000000000"_cuqv, 9007199254740996.0, 38);
+	expect_parsed<f32>("16777217.00000000000000000001"_cuqv, 16777218.0f, 29);
+	expect_parsed<f32>("16777216.99999999999999999999"_cuqv, 16777216.0f, 29);
+	{
+		// Half of the smallest subnormal, whose 752 digits tie to zero, and anything above it which does not.
+		const std::string half_denorm_min = "2."
+			"47032822920623272088284396434110686182529901307162382212792841250337753635104375932649918180817996189898282347"
+			"72285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500"
+			"31937045767824921936562366986365848075700158576926990370631192827955855133292783433840935197801553124659726357"
+			"95746227664652728272200563740064854999770965994704540208281662262378573934507363390079677619305775067401763246"
+			"73600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524"
+			"91262365388187963623937328042389101867234849766823508986338858792562830275599565752445550725518931369083625477"
+			"9186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125";
+		const std::string exponent = "e-324";
+		expect_parsed<f64>({ (half_denorm_min + exponent).data(), half_denorm_min.size() + exponent.size() }, 0.0, half_denorm_min.size() + exponent.size(), parse_error::out_of_range);
+		const std::string above = half_denorm_min + "1" + exponent;
+		expect_parsed<f64>({ above.data(), above.size() }, std::numeric_limits<f64>::denorm_min(), above.size());
+		// Beyond the digits which are compared exactly, one nonzero digit still rounds up.
+		const std::string far_above = half_denorm_min + std::string(100, '0') + "1" + exponent;
+		expect_parsed<f64>({ far_above.data(), far_above.size() }, std::numeric_limits<f64>::denorm_min(), far_above.size());
+		const std::string negative_above = "-" + above;
+		expect_parsed<f64>({ negative_above.data(), negative_above.size() }, -std::numeric_limits<f64>::denorm_min(), negative_above.size());
+	}
+	{
+		// Halfway between the largest double and the next power of 2 ties to infinity, which is out of range as from the other paths.
+		const std::string half_beyond_max = "17976931348623158079372897140530341507993413271003782693617377898044496829276475094664901797758720709633028641"
+			"66928879109465555478519404026306574886715058206819089020007083836762738548458177115317644757302700698555713669"
+			"59622842914819860834936475292719074168444365510704342711559699508093042880177904174497792";
+		expect_parsed<f64>({ half_beyond_max.data(), half_beyond_max.size() }, std::numeric_limits<f64>::infinity(), half_beyond_max.size(), parse_error::out_of_range);
+		const std::string below = half_beyond_max.substr(0, half_beyond_max.size() - 1) + "1.99999999999999999999";
+		expect_parsed<f64>({ below.data(), below.size() }, std::numeric_limits<f64>::max(), below.size());
+	}
+	expect_parsed<f64>("2.2250738585072011e-308"_cuqv, 2.2250738585072011e-308, 23);
+	expect_parsed<f64>("4.9406564584124654e-324"_cuqv, std::numeric_limits<f64>::denorm_min(), 23);
+	expect_parsed<f64>("1.7976931348623157e308"_cuqv, std::numeric_limits<f64>::max(), 22);
+	expect_parsed<f64>("1.8e308"_cuqv, std::numeric_limits<f64>::infinity(), 7, parse_error::out_of_range);
+	expect_parsed<f64>("-1e-400"_cuqv, -0.0, 7, parse_error::out_of_range);
+	expect_parsed<f32>("3.4028235e38"_cuqv, std::numeric_limits<f32>::max(), 12);
+	expect_parsed<f32>("3.5e38"_cuqv, std::numeric_limits<f32>::infinity(), 6, parse_error::out_of_range);
+	expect_parsed<f32>("1.4e-45"_cuqv, std::numeric_limits<f32>::denorm_min(), 7);
+	expect_parsed<f32>("16777217"_cuqv, 16777216.0f, 8);
+	expect_parsed<f32>("0.1"_cuqv, 0.1f, 3);
+
+	// Shortest representations of random values read back exactly.
+	std::mt19937_64 random{ 5678 };
+	for(u64 i = 0; i < 20000; ++i)
+	{
+		const u64 bits = random();
+		f64 value;
+		std::memcpy(&value, &bits, sizeof(value));
+		if(std::isnan(value) || std::isinf(value))
+			continue;
+		char buffer[64];
+		const auto [ last, error ] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		expect_parsed<f64>({ buffer, static_cast<u64>(last - buffer) }, value, last - buffer);
+
+		f32 narrow_value;
+		std::memcpy(&narrow_value, &bits, sizeof(narrow_value));
+		if(std::isnan(narrow_value) || std::isinf(narrow_value))
+			continue;
+		const auto [ narrow_last, narrow_error ] = std::to_chars(buffer, buffer + sizeof(buffer), narrow_value);
+		expect_parsed<f32>({ buffer, static_cast<u64>(narrow_last - buffer) }, narrow_value, narrow_last - buffer);
+	}
+
+	// Random digits are rounded the same as strtod and strtof.
+	for(u64 i = 0; i < 20000; ++i)
+	{
+		const std::string decimal = make_random_decimal(random);
+		const codeunit_sequence_view view{ decimal.data(), decimal.size() };
+		const parse_result<f64> result = parse<f64>(view);
+		EXPECT_EQ(result.size, decimal.size()) << decimal;
+		EXPECT_EQ(result.value, std::strtod(decimal.c_str(), nullptr)) << decimal;
+		const parse_result<f32> narrow_result = parse<f32>(view);
+		EXPECT_EQ(narrow_result.value, std::strtof(decimal.c_str(), nullptr)) << decimal;
+	}
+}
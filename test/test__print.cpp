@@ -0,0 +1,130 @@
+#include "pch.h"
+
+#include "print.h"
+
+#include <string>
+
+using namespace ostr;
+
+namespace
+{
+	// A temporary file, which is written through its FILE* or its file descriptor, and read back.
+	struct temporary_file
+	{
+		std::FILE* file = std::tmpfile();
+
+		temporary_file(const temporary_file&) = delete;
+		temporary_file& operator=(const temporary_file&) = delete;
+		temporary_file() = default;
+
+		~temporary_file()
+		{
+			std::fclose(this->file);
+		}
+
+		[[nodiscard]] int get_file_descriptor() const
+		{
+#if _WIN64
+			return _fileno(this->file);
+#else
+			return fileno(this->file);
+#endif
+		}
+
+		std::string read()
+		{
+			std::fflush(this->file);
+			std::rewind(this->file);
+			std::string result;
+			char buffer[256];
+			while(const size_t size = std::fread(buffer, 1, sizeof(buffer), this->file))
+				result.append(buffer, size);
+			return result;
+		}
+	};
+}
+
+TEST(print, file)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		temporary_file file;
+		ASSERT_NE(file.file, nullptr);
+		EXPECT_TRUE(print(file.file, "{} + {} = {}"_cuqv, 1, 2.5, "3.5"));
+		EXPECT_TRUE(println(file.file, OPEN_STRING_COMPILED_FORMAT("[{}]"), "繁星"_cuqv));
+		const prepared_format prepared{ "{name}={value:x}"_cuqv, { "name"_cuqv, "value"_cuqv } };
+		EXPECT_TRUE(println(file.file, prepared, "mask", 255));
+		EXPECT_EQ(file.read(), "1 + 2.5 = 3.5[繁星]\nmask=ff\n");
+	}
+}
+
+TEST(print, file_descriptor)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		temporary_file file;
+		ASSERT_NE(file.file, nullptr);
+		const int file_descriptor = file.get_file_descriptor();
+		EXPECT_TRUE(println(file_descriptor, "{} {}"_cuqv, "first", 1));
+
+		// Results larger than the stack buffer are written in pieces.
+		const std::string large(details::PRINT_STACK_BUFFER_SIZE * 3 + 7, 'x');
+		const codeunit_sequence_view large_view{ large.data(), large.size() };
+		EXPECT_TRUE(println(file_descriptor, "<{}>"_cuqv, large_view));
+		EXPECT_EQ(file.read(), "first 1\n<" + large + ">\n");
+
+		// Writing to a closed file descriptor fails.
+		EXPECT_FALSE(println(-1, "{}"_cuqv, 0));
+	}
+}
+
+TEST(print, buffered_writer)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		temporary_file file;
+		ASSERT_NE(file.file, nullptr);
+		{
+			char buffer[16];
+			buffered_writer writer{ file.get_file_descriptor(), buffer, sizeof(buffer) };
+			EXPECT_EQ(writer.capacity(), 16);
+			println(writer, "line {}"_cuqv, 1);
+			EXPECT_EQ(writer.size(), 7);
+			EXPECT_EQ(file.read(), "");
+
+			// Filled up, what is buffered is written before the next line.
+			println(writer, "line {}"_cuqv, 2);
+			println(writer, "line {}"_cuqv, 3);
+			EXPECT_EQ(writer.size(), 7);
+			EXPECT_EQ(file.read(), "line 1\nline 2\n");
+
+			// Larger than the buffer, written along with what is buffered.
+			writer.append("0123456789abcdefghij\n"_cuqv);
+			EXPECT_EQ(writer.size(), 0);
+			EXPECT_EQ(file.read(), "line 1\nline 2\nline 3\n0123456789abcdefghij\n");
+
+			print(writer, "{}"_cuqv, "left");
+			EXPECT_FALSE(writer.has_failed());
+		}
+		// Destruction writes what is left.
+		EXPECT_EQ(file.read(), "line 1\nline 2\nline 3\n0123456789abcdefghij\nleft");
+
+		temporary_file other_file;
+		ASSERT_NE(other_file.file, nullptr);
+		{
+			buffered_writer writer{ other_file.file };
+			EXPECT_EQ(writer.capacity(), buffered_writer::DEFAULT_CAPACITY);
+			for(i32 i = 0; i < 3000; ++i)
+				println(writer, "{}"_cuqv, i);
+			EXPECT_TRUE(writer.flush());
+		}
+		const std::string lines = other_file.read();
+		EXPECT_EQ(lines.substr(0, 6), "0\n1\n2\n");
+		EXPECT_EQ(lines.substr(lines.size() - 10), "2998\n2999\n");
+
+		buffered_writer failed_writer{ -1 };
+		println(failed_writer, "{}"_cuqv, 0);
+		EXPECT_FALSE(failed_writer.flush());
+		EXPECT_TRUE(failed_writer.has_failed());
+	}
+}
@@ -0,0 +1,107 @@
+// ReSharper disable StringLiteralTypo
+#include "pch.h"
+
+#include "searcher.h"
+
+using namespace ostr;
+
+TEST(searcher, find)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const searcher long_searcher("long"_cuqv);
+		EXPECT_EQ(long_searcher.pattern(), "long"_cuqv);
+		constexpr auto view = "long long ago long"_cuqv;
+		EXPECT_EQ(long_searcher.find(view), 0);
+		EXPECT_EQ(long_searcher.find(view, 3), 5);
+		EXPECT_EQ(long_searcher.find(view, 15), global_constant::INDEX_INVALID);
+		EXPECT_EQ(long_searcher.find(view, 100), global_constant::INDEX_INVALID);
+		EXPECT_EQ(long_searcher.find("short"_cuqv), global_constant::INDEX_INVALID);
+		EXPECT_EQ(long_searcher.find(""_cuqv), global_constant::INDEX_INVALID);
+	}
+	{
+		const searcher empty_searcher(""_cuqv);
+		EXPECT_EQ(empty_searcher.find("long"_cuqv), global_constant::INDEX_INVALID);
+		EXPECT_EQ(empty_searcher.count("long"_cuqv), 0);
+	}
+	{
+		// Rare codeunits are in the middle of pattern.
+		const searcher key_searcher("user_id=Q7"_cuqv);
+		constexpr auto view = "user_id=12 user_id=Q8 user_id=Q7 user_id=Q7"_cuqv;
+		EXPECT_EQ(key_searcher.find(view), 22);
+		EXPECT_EQ(key_searcher.find(view, 23), 33);
+		EXPECT_EQ(key_searcher.find(view), view.index_of("user_id=Q7"_cuqv));
+	}
+	{
+		const searcher one_searcher("你"_cuqv);
+		EXPECT_EQ(one_searcher.find("你好你好"_cuqv, 1), 6);
+	}
+	{
+		// Long pattern on repetitive data goes on with two-way search.
+		codeunit_sequence haystack;
+		haystack.append('a', 4096);
+		codeunit_sequence pattern;
+		pattern.append('a', 20).append('b').append('a', 20);
+		const searcher repetitive_searcher(pattern.view());
+		EXPECT_EQ(repetitive_searcher.find(haystack.view()), global_constant::INDEX_INVALID);
+		haystack.append(pattern);
+		EXPECT_EQ(repetitive_searcher.find(haystack.view()), 4096);
+	}
+}
+
+TEST(searcher, find_all)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const searcher aa_searcher("aa"_cuqv);
+		std::vector<u64> indices;
+		EXPECT_EQ(aa_searcher.find_all("aaaaaaaaa"_cuqv, indices), 4);
+		EXPECT_EQ(indices, std::vector<u64>({ 0, 2, 4, 6 }));
+		EXPECT_EQ(aa_searcher.find_all("bab"_cuqv, indices), 0);
+		EXPECT_EQ(indices.size(), 4);
+	}
+	{
+		const searcher space_searcher(" "_cuqv);
+		EXPECT_EQ(space_searcher.count("This is a long string "_cuqv), 5);
+		EXPECT_EQ(space_searcher.count(""_cuqv), 0);
+	}
+}
+
+TEST(searcher, replace)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	// same size
+	{
+		codeunit_sequence cuq("abbabbabbabbab");
+		EXPECT_EQ(searcher("ab"_cuqv).replace(cuq, "ba"_cuqv), "babbabbabbabba"_cuqv);
+	}
+	// smaller size
+	{
+		codeunit_sequence cuq("abbabbabbabbab");
+		EXPECT_EQ(searcher("ab"_cuqv).replace(cuq, "a"_cuqv), "ababababa"_cuqv);
+		EXPECT_EQ(searcher("a"_cuqv).replace(cuq, ""_cuqv), "bbbb"_cuqv);
+		EXPECT_EQ(searcher("bbbb"_cuqv).replace(cuq, ""_cuqv), ""_cuqv);
+	}
+	// greater size
+	{
+		codeunit_sequence cuq("abbabbabbabbab");
+		EXPECT_EQ(searcher("ab"_cuqv).replace(cuq, "aabb"_cuqv), "aabbbaabbbaabbbaabbbaabb"_cuqv);
+		EXPECT_EQ(searcher("b"_cuqv).replace(cuq, "aabb"_cuqv), "aaaabbaabbaabbaaaabbaabbaabbaaaabbaabbaabbaaaabbaabbaabbaaaabbaabb"_cuqv);
+	}
+	{
+		codeunit_sequence cuq("This is a long string.");
+		EXPECT_EQ(searcher("long"_cuqv).replace(cuq, "short"_cuqv), "This is a short string."_cuqv);
+		EXPECT_EQ(searcher("is"_cuqv).replace(cuq, "isn't"_cuqv), "Thisn't isn't a short string."_cuqv);
+		EXPECT_EQ(searcher("none"_cuqv).replace(cuq, "any"_cuqv), "Thisn't isn't a short string."_cuqv);
+		EXPECT_EQ(searcher(""_cuqv).replace(cuq, "any"_cuqv), "Thisn't isn't a short string."_cuqv);
+	}
+	{
+		const searcher profanity("darn"_cuqv);
+		std::vector<codeunit_sequence> messages{ codeunit_sequence("darn it"), codeunit_sequence("no match"), codeunit_sequence("darn darn, darn!") };
+		for(codeunit_sequence& message : messages)
+			profanity.replace(message, "****"_cuqv);
+		EXPECT_EQ(messages[0], "**** it"_cuqv);
+		EXPECT_EQ(messages[1], "no match"_cuqv);
+		EXPECT_EQ(messages[2], "**** ****, ****!"_cuqv);
+	}
+}
@@ -0,0 +1,740 @@
+
+#include "pch.h"
+
+#include "common/simd.h"
+#include "common/constants.h"
+#include "unicode.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ostr;
+
+namespace
+{
+	constexpr simd::instruction_set instruction_sets[] =
+	{
+		simd::instruction_set::portable,
+		simd::instruction_set::sse2,
+		simd::instruction_set::avx2,
+		simd::instruction_set::neon,
+	};
+
+	// Run checks with every instruction set supported by this cpu.
+	template<class F>
+	void for_each_instruction_set(F&& checks)
+	{
+		const simd::instruction_set origin = simd::get_instruction_set();
+		for(const simd::instruction_set set : instruction_sets)
+		{
+			if(!simd::set_instruction_set(set))
+				continue;
+			SCOPED_TRACE(static_cast<int>(set));
+			checks();
+		}
+		simd::set_instruction_set(origin);
+	}
+
+	u64 index_of_naive(const std::vector<char>& data, const u64 size, const char codeunit)
+	{
+		for(u64 i = 0; i < size; ++i)
+			if(data[i] == codeunit)
+				return i;
+		return global_constant::INDEX_INVALID;
+	}
+
+	u64 last_index_of_naive(const std::vector<char>& data, const u64 size, const char codeunit)
+	{
+		for(u64 i = size; i > 0; --i)
+			if(data[i - 1] == codeunit)
+				return i - 1;
+		return global_constant::INDEX_INVALID;
+	}
+}
+
+TEST(simd, instruction_set)
+{
+	EXPECT_TRUE(simd::is_supported(simd::instruction_set::portable));
+	EXPECT_TRUE(simd::is_supported(simd::get_instruction_set()));
+}
+
+TEST(simd, byte_search)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		std::vector<char> data(200, 'a');
+		for(u64 size = 0; size < data.size(); ++size)
+		{
+			EXPECT_EQ(simd::index_of(data.data(), size, 'b'), global_constant::INDEX_INVALID);
+			EXPECT_EQ(simd::last_index_of(data.data(), size, 'b'), global_constant::INDEX_INVALID);
+		}
+		for(u64 position = 0; position < data.size(); ++position)
+		{
+			data[position] = '\xE4';
+			data[data.size() - 1 - position / 2] = '\xE4';
+			for(const u64 size : { position + 1, data.size() / 2, data.size() })
+			{
+				EXPECT_EQ(simd::index_of(data.data(), size, '\xE4'), index_of_naive(data, size, '\xE4'));
+				EXPECT_EQ(simd::last_index_of(data.data(), size, '\xE4'), last_index_of_naive(data, size, '\xE4'));
+			}
+			data[position] = 'a';
+			data[data.size() - 1 - position / 2] = 'a';
+		}
+	});
+}
+
+TEST(simd, substring_search)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		const auto check = [](const std::string_view data, const std::string_view pattern)
+		{
+			const u64 expected_first = pattern.empty() ? global_constant::INDEX_INVALID : data.find(pattern);
+			const u64 expected_last = pattern.empty() ? global_constant::INDEX_INVALID : data.rfind(pattern);
+			EXPECT_EQ(simd::index_of(data.data(), data.size(), pattern.data(), pattern.size()), expected_first == std::string_view::npos ? global_constant::INDEX_INVALID : expected_first);
+			EXPECT_EQ(simd::last_index_of(data.data(), data.size(), pattern.data(), pattern.size()), expected_last == std::string_view::npos ? global_constant::INDEX_INVALID : expected_last);
+		};
+
+		// Small alphabet makes lots of partial matches.
+		std::string data;
+		u32 seed = 7;
+		for(u64 i = 0; i < 600; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			data.push_back(static_cast<char>('a' + (seed >> 16) % 3));
+		}
+		const std::string_view view = data;
+		for(u64 size = 0; size < 40; ++size)
+		{
+			check(view, view.substr(0, size));
+			check(view, view.substr(300, size));
+			check(view, view.substr(view.size() - size));
+			check(view.substr(0, size), view.substr(100, 3));
+		}
+		check(view, "abcd");
+		check("", "a");
+
+		// Long patterns on repetitive data exhaust verifying budget and go on with two-way search.
+		const std::string repeated(5000, 'a');
+		std::string needle(40, 'a');
+		needle.back() = 'b';
+		check(repeated, needle);
+		check(repeated + needle + repeated, needle);
+		needle.back() = 'a';
+		needle.front() = 'b';
+		check(repeated, needle);
+		check(repeated + needle + repeated, needle);
+
+		std::string periodic;
+		for(u64 i = 0; i < 2000; ++i)
+			periodic += "abaab";
+		for(const u64 size : { 32ull, 33ull, 64ull, 100ull })
+		{
+			std::string near_miss = periodic.substr(3, size);
+			near_miss[size / 2] = 'c';
+			check(periodic, near_miss);
+			check(periodic + near_miss + periodic, near_miss);
+			check(periodic, periodic.substr(2, size));
+		}
+	});
+}
+
+TEST(simd, codeunit_set_search)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		const auto check = [](const std::vector<char>& data, const u64 size, const codeunit_set& units)
+		{
+			u64 expected_first = global_constant::INDEX_INVALID;
+			u64 expected_last = global_constant::INDEX_INVALID;
+			for(u64 i = 0; i < size; ++i)
+			{
+				if(!units.contains(data[i]))
+					continue;
+				if(expected_first == global_constant::INDEX_INVALID)
+					expected_first = i;
+				expected_last = i;
+			}
+			EXPECT_EQ(simd::index_of_any(data.data(), size, units), expected_first);
+			EXPECT_EQ(simd::last_index_of_any(data.data(), size, units), expected_last);
+		};
+
+		std::vector<char> data;
+		u32 seed = 11;
+		for(u64 i = 0; i < 300; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			data.push_back(static_cast<char>(seed >> 16));
+		}
+		const codeunit_set sets[] =
+		{
+			codeunit_set{ },
+			codeunit_set{ "{" },
+			codeunit_set{ "{}" },
+			codeunit_set{ " \t\r\n" },
+			codeunit_set{ "\x80\xE4\xFF" },
+			codeunit_set{ "0123456789" },
+			codeunit_set{ "aeiouAEIOU\x90\xA0\xC0\xF0" },
+		};
+		for(const codeunit_set& units : sets)
+		{
+			for(const codeunit_set& searched : { units, units.complement() })
+			{
+				for(u64 size = 0; size < 80; ++size)
+					check(data, size, searched);
+				check(data, data.size(), searched);
+			}
+		}
+
+		// Only the last or the first codeunit matches.
+		std::vector<char> spaces(100, ' ');
+		for(u64 size = 1; size < spaces.size(); ++size)
+		{
+			spaces[size - 1] = 'x';
+			check(spaces, size, codeunit_set{ "xyz" });
+			check(spaces, size, codeunit_set{ " " }.complement());
+			check(spaces, size, codeunit_set{ "abcdefghijklmnopqrstuvwxyz" });
+			spaces[size - 1] = ' ';
+		}
+	});
+}
+
+TEST(simd, utf8_counting)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		std::vector<char> data;
+		u32 seed = 5;
+		for(u64 i = 0; i < 9000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			data.push_back(static_cast<char>(seed >> 16));
+		}
+		// Include runs of ascii and long blocks, so every path of kernels is taken.
+		std::fill(data.begin() + 100, data.begin() + 200, 'a');
+		for(const u64 size : { 0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 17ull, 31ull, 32ull, 33ull, 63ull, 64ull, 65ull, 200ull, 4064ull, 4065ull, 9000ull })
+		{
+			u64 codepoint_count = 0;
+			u64 utf16_count = 0;
+			std::vector<u64> starts;
+			for(u64 i = 0; i < size; ++i)
+			{
+				if((static_cast<u8>(data[i]) & 0xC0) == 0x80)
+					continue;
+				starts.push_back(i);
+				++codepoint_count;
+				utf16_count += static_cast<u8>(data[i]) >= 0xF0 ? 2 : 1;
+			}
+			EXPECT_EQ(simd::count_codepoints(data.data(), size), codepoint_count);
+			EXPECT_EQ(simd::count_utf16(data.data(), size), utf16_count);
+			for(u64 n = 0; n < starts.size(); n += 1 + n / 16)
+				EXPECT_EQ(simd::index_of_codepoint(data.data(), size, n), starts[n]);
+			EXPECT_EQ(simd::index_of_codepoint(data.data(), size, starts.size()), global_constant::INDEX_INVALID);
+		}
+	});
+}
+
+TEST(simd, is_ascii)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		std::vector<char> data(300, 'a');
+		for(u64 size = 0; size <= data.size(); ++size)
+			EXPECT_TRUE(simd::is_ascii(data.data(), size));
+		// A single non-ascii codeunit at each position of each block.
+		for(u64 position = 0; position < data.size(); ++position)
+		{
+			data[position] = static_cast<char>(0x80 | position);
+			EXPECT_FALSE(simd::is_ascii(data.data(), data.size()));
+			EXPECT_TRUE(simd::is_ascii(data.data(), position));
+			data[position] = 'a';
+		}
+	});
+}
+
+namespace
+{
+	// Decode each sequence and check its codepoint, independent of lookup tables and unicode::match_utf8_sequence.
+	u64 first_invalid_utf8_naive(const std::vector<char>& data, const u64 size, u64& codepoint_count)
+	{
+		codepoint_count = 0;
+		for(u64 i = 0; i < size;)
+		{
+			const u8 lead = static_cast<u8>(data[i]);
+			const u64 length = lead < 0x80 ? 1 : lead >= 0xC0 && lead < 0xE0 ? 2 : lead >= 0xE0 && lead < 0xF0 ? 3 : lead >= 0xF0 && lead < 0xF8 ? 4 : 0;
+			if(length == 0 || i + length > size)
+				return i;
+			char32_t cp = length == 1 ? lead : lead & (0x7F >> length);
+			for(u64 j = 1; j < length; ++j)
+			{
+				const u8 c = static_cast<u8>(data[i + j]);
+				if((c & 0xC0) != 0x80)
+					return i;
+				cp = (cp << 6) | (c & 0x3F);
+			}
+			constexpr char32_t minimums[] = { 0, 0, 0x80, 0x800, 0x10000 };
+			if(cp < minimums[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+				return i;
+			++codepoint_count;
+			i += length;
+		}
+		return global_constant::INDEX_INVALID;
+	}
+}
+
+TEST(simd, utf8_validation)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		// Valid text of every length, with a long ascii run.
+		std::vector<char> valid;
+		u32 seed = 7;
+		const auto next = [&seed] { seed = seed * 1103515245 + 12345; return seed >> 8; };
+		while(valid.size() < 3000)
+		{
+			constexpr char32_t maximums[] = { 0x7F, 0x7FF, 0xFFFF, 0x10FFFF };
+			char32_t cp = next() % (maximums[next() % 4] + 1);
+			if(cp >= 0xD800 && cp <= 0xDFFF)
+				cp = 'x';
+			const codepoint encoded{ cp };
+			valid.insert(valid.end(), encoded.sequence.begin(), encoded.sequence.begin() + encoded.size());
+			if(valid.size() > 1000 && valid.size() < 1200)
+				valid.insert(valid.end(), 300, 'a');
+		}
+
+		u64 codepoint_count = 0;
+		u64 expected_count = 0;
+		for(const u64 size : { 0ull, 1ull, 15ull, 16ull, 31ull, 32ull, 33ull, 64ull, 100ull, 1500ull, 3000ull })
+		{
+			// Cut at a sequence boundary.
+			u64 cut = size;
+			while(cut > 0 && cut < valid.size() && (static_cast<u8>(valid[cut]) & 0xC0) == 0x80)
+				--cut;
+			EXPECT_EQ(simd::first_invalid_utf8(valid.data(), cut, codepoint_count), global_constant::INDEX_INVALID);
+			EXPECT_EQ(first_invalid_utf8_naive(valid, cut, expected_count), global_constant::INDEX_INVALID);
+			EXPECT_EQ(codepoint_count, expected_count);
+		}
+
+		// Every kind of error at many positions.
+		constexpr u8 corruptions[] = { 0x80, 0xBF, 0xC0, 0xC1, 0xC2, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF, 'a' };
+		for(u64 position = 0; position < 1400; position += 1 + position / 37)
+		{
+			for(const u8 corruption : corruptions)
+			{
+				std::vector<char> data = valid;
+				data[position] = static_cast<char>(corruption);
+				const u64 expected = first_invalid_utf8_naive(data, data.size(), expected_count);
+				EXPECT_EQ(simd::first_invalid_utf8(data.data(), data.size(), codepoint_count), expected);
+				EXPECT_EQ(codepoint_count, expected_count);
+				// Truncated right after the corruption.
+				const u64 truncated_expected = first_invalid_utf8_naive(data, position + 1, expected_count);
+				EXPECT_EQ(simd::first_invalid_utf8(data.data(), position + 1, codepoint_count), truncated_expected);
+				EXPECT_EQ(codepoint_count, expected_count);
+			}
+		}
+
+		// Boundary codepoints around each error class, at each offset of a block.
+		const std::vector<std::vector<u8>> sequences =
+		{
+			{ 0xC2, 0x80 }, { 0xDF, 0xBF }, { 0xE0, 0xA0, 0x80 }, { 0xE0, 0x9F, 0xBF }, { 0xED, 0x9F, 0xBF }, { 0xED, 0xA0, 0x80 },
+			{ 0xEF, 0xBF, 0xBF }, { 0xF0, 0x90, 0x80, 0x80 }, { 0xF0, 0x8F, 0xBF, 0xBF }, { 0xF4, 0x8F, 0xBF, 0xBF }, { 0xF4, 0x90, 0x80, 0x80 },
+			{ 0xE1, 0x80 }, { 0xF1, 0x80, 0x80 }, { 0x80 }, { 0xC2, 0x80, 0x80 }, { 0xF1, 0x80, 0x80, 0x80, 0x80 },
+		};
+		for(const std::vector<u8>& sequence : sequences)
+		{
+			for(u64 offset = 0; offset < 70; ++offset)
+			{
+				std::vector<char> data(offset, 'a');
+				data.insert(data.end(), sequence.begin(), sequence.end());
+				for(const u64 padding : { 0ull, 1ull, 40ull })
+				{
+					std::vector<char> padded = data;
+					padded.insert(padded.end(), padding, 'b');
+					const u64 expected = first_invalid_utf8_naive(padded, padded.size(), expected_count);
+					EXPECT_EQ(simd::first_invalid_utf8(padded.data(), padded.size(), codepoint_count), expected);
+					EXPECT_EQ(codepoint_count, expected_count);
+				}
+			}
+		}
+	});
+}
+
+namespace
+{
+	std::vector<char> utf16_to_utf8_naive(const std::vector<char16_t>& data)
+	{
+		std::vector<char> result;
+		for(u64 i = 0; i < data.size(); ++i)
+		{
+			char32_t cp = data[i];
+			if(cp >= 0xD800 && cp <= 0xDBFF && i + 1 < data.size() && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF)
+			{
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (data[i + 1] - 0xDC00);
+				++i;
+			}
+			else if(cp >= 0xD800 && cp <= 0xDFFF)
+				cp = 0xFFFD;
+			if(cp < 0x80)
+				result.push_back(static_cast<char>(cp));
+			else if(cp < 0x800)
+				result.insert(result.end(), { static_cast<char>(0xC0 | cp >> 6), static_cast<char>(0x80 | (cp & 0x3F)) });
+			else if(cp < 0x10000)
+				result.insert(result.end(), { static_cast<char>(0xE0 | cp >> 12), static_cast<char>(0x80 | (cp >> 6 & 0x3F)), static_cast<char>(0x80 | (cp & 0x3F)) });
+			else
+				result.insert(result.end(), { static_cast<char>(0xF0 | cp >> 18), static_cast<char>(0x80 | (cp >> 12 & 0x3F)),
+					static_cast<char>(0x80 | (cp >> 6 & 0x3F)), static_cast<char>(0x80 | (cp & 0x3F)) });
+		}
+		return result;
+	}
+
+	// Runs of codepoints with the same utf-8 length, so every vector path is taken.
+	std::vector<char16_t> make_utf16_corpus(u32 seed, const bool lone_surrogates)
+	{
+		const auto next = [&seed] { seed = seed * 1103515245 + 12345; return seed >> 8; };
+		constexpr char32_t minimums[] = { 0x01, 0x80, 0x800, 0x10000 };
+		constexpr char32_t maximums[] = { 0x7F, 0x7FF, 0xFFFF, 0x10FFFF };
+		std::vector<char16_t> corpus;
+		while(corpus.size() < 2000)
+		{
+			const u32 kind = next() % 4;
+			const u32 run = next() % 40;
+			for(u32 i = 0; i < run; ++i)
+			{
+				char32_t cp = minimums[kind] + next() % (maximums[kind] - minimums[kind] + 1);
+				if(cp >= 0xD800 && cp <= 0xDFFF)
+					cp = 0xE000;
+				const std::array<char16_t, unicode::utf16::SEQUENCE_MAXIMUM_LENGTH> encoded = unicode::utf32_to_utf16(cp);
+				corpus.insert(corpus.end(), encoded.begin(), encoded.begin() + (cp > 0xFFFF ? 2 : 1));
+			}
+			if(lone_surrogates && next() % 3 == 0)
+				corpus.push_back(static_cast<char16_t>(0xD800 + next() % 0x800));
+		}
+		return corpus;
+	}
+}
+
+TEST(simd, utf16_transcoding)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	// Surrogate pairs take the offset of supplementary planes.
+	static_assert(unicode::utf16_to_utf32(u"😀", 2) == U'😀');
+	static_assert(unicode::utf32_to_utf16(U'😀')[0] == u'\xD83D' && unicode::utf32_to_utf16(U'😀')[1] == u'\xDE00');
+	for_each_instruction_set([]
+	{
+		for(const bool lone_surrogates : { false, true })
+		{
+			for(u32 seed = 1; seed < 6; ++seed)
+			{
+				const std::vector<char16_t> corpus = make_utf16_corpus(seed, lone_surrogates);
+				const u64 sizes[] = { 0, 1, 7, 8, 9, 17, 100, 333, corpus.size() };
+				for(u64 size : sizes)
+				{
+					// Do not split a pair.
+					if(size > 0 && unicode::utf16::is_leading_surrogate(corpus[size - 1]))
+						--size;
+					const std::vector<char16_t> source{ corpus.begin(), corpus.begin() + static_cast<i64>(size) };
+					const std::vector<char> expected = utf16_to_utf8_naive(source);
+					EXPECT_EQ(simd::count_utf8_of_utf16(source.data(), size), expected.size());
+					std::vector<char> encoded(expected.size());
+					EXPECT_EQ(simd::utf16_to_utf8(source.data(), size, encoded.data()), expected.size());
+					EXPECT_EQ(encoded, expected);
+
+					// Back to utf-16, lone surrogates are U+FFFD in utf-8 already.
+					std::vector<char16_t> decoded(simd::count_utf16(encoded.data(), encoded.size()));
+					EXPECT_EQ(simd::utf8_to_utf16(encoded.data(), encoded.size(), decoded.data()), decoded.size());
+					if(!lone_surrogates)
+					{
+						EXPECT_EQ(decoded, source);
+					}
+				}
+			}
+		}
+
+		// A pair split by the end of a block, and a lone surrogate at the end.
+		for(u64 offset = 0; offset < 40; ++offset)
+		{
+			std::vector<char16_t> source(offset, u'a');
+			source.insert(source.end(), { u'\xD83D', u'\xDE00', u'b', u'\xD83D' });
+			const std::vector<char> expected = utf16_to_utf8_naive(source);
+			std::vector<char> encoded(simd::count_utf8_of_utf16(source.data(), source.size()));
+			EXPECT_EQ(encoded.size(), expected.size());
+			EXPECT_EQ(simd::utf16_to_utf8(source.data(), source.size(), encoded.data()), expected.size());
+			EXPECT_EQ(encoded, expected);
+		}
+
+		// Ill-formed utf-8 becomes U+FFFD per maximal subpart, stray continuations are skipped.
+		const char ill_formed[] = "ab\xE4\xB8" "c\xF0\x9F\x98" "d\x80\x80" "\xC0\xAF" "e";
+		const std::u16string expected = u"ab\xFFFD" u"c\xFFFD" u"d\xFFFD" u"e";
+		for(u64 offset = 0; offset < 40; ++offset)
+		{
+			std::string data(offset, 'x');
+			data += ill_formed;
+			std::u16string decoded(simd::count_utf16(data.data(), data.size()), u'\0');
+			decoded.resize(simd::utf8_to_utf16(data.data(), data.size(), decoded.data()));
+			EXPECT_EQ(decoded, std::u16string(offset, u'x') + expected);
+		}
+
+		// Overlong, surrogate and truncated ones within runs of three-byte sequences.
+		const std::pair<std::string, std::u16string> ill_formed_three_bytes[] =
+		{
+			{ "\xE0\x80\x80", u"\xFFFD" }, { "\xED\xA0\x80", u"\xFFFD" }, { "\xE4\x41\x80", u"\xFFFD" u"A" }, { "\xE0\xA0\x80", u"\x0800" },
+		};
+		for(const auto& [bad, replaced] : ill_formed_three_bytes)
+		{
+			for(u64 position = 0; position < 20; ++position)
+			{
+				std::string data;
+				std::u16string expected_three_bytes;
+				for(u64 i = 0; i < 20; ++i)
+				{
+					data += i == position ? bad : "\xE4\xBD\xA0";
+					expected_three_bytes += i == position ? replaced : u"\x4F60";
+				}
+				std::u16string decoded(simd::count_utf16(data.data(), data.size()), u'\0');
+				decoded.resize(simd::utf8_to_utf16(data.data(), data.size(), decoded.data()));
+				EXPECT_EQ(decoded, expected_three_bytes);
+			}
+		}
+	});
+}
+
+TEST(simd, utf32_transcoding)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		for(u32 seed = 1; seed < 6; ++seed)
+		{
+			// The same runs as utf-16 tests, decoded to utf-32 by the naive encoder.
+			const std::vector<char16_t> corpus = make_utf16_corpus(seed, false);
+			const std::vector<char> utf8 = utf16_to_utf8_naive(corpus);
+			std::vector<char32_t> utf32;
+			for(u64 i = 0; i < corpus.size(); ++i)
+			{
+				const u64 length = unicode::utf16::parse_utf16_length(corpus[i]);
+				utf32.push_back(unicode::utf16_to_utf32(corpus.data() + i, length));
+				i += length - 1;
+			}
+
+			const u64 sizes[] = { 0, 1, 7, 8, 9, 17, 100, 333, utf32.size() };
+			for(const u64 size : sizes)
+			{
+				std::vector<char16_t> source16;
+				for(u64 i = 0; i < size; ++i)
+				{
+					const std::array<char16_t, unicode::utf16::SEQUENCE_MAXIMUM_LENGTH> encoded = unicode::utf32_to_utf16(utf32[i]);
+					source16.insert(source16.end(), encoded.begin(), encoded.begin() + (utf32[i] > 0xFFFF ? 2 : 1));
+				}
+				const std::vector<char> expected = utf16_to_utf8_naive(source16);
+				EXPECT_EQ(simd::count_utf8_of_utf32(utf32.data(), size), expected.size());
+				std::vector<char> encoded(expected.size());
+				EXPECT_EQ(simd::utf32_to_utf8(utf32.data(), size, encoded.data()), expected.size());
+				EXPECT_EQ(encoded, expected);
+
+				std::vector<char32_t> decoded(simd::count_codepoints(encoded.data(), encoded.size()));
+				EXPECT_EQ(decoded.size(), size);
+				EXPECT_EQ(simd::utf8_to_utf32(encoded.data(), encoded.size(), decoded.data()), size);
+				EXPECT_EQ(decoded, std::vector<char32_t>(utf32.begin(), utf32.begin() + static_cast<i64>(size)));
+			}
+			EXPECT_EQ(simd::count_utf8_of_utf32(utf32.data(), utf32.size()), utf8.size());
+		}
+
+		// Surrogates and values beyond U+10FFFF are replaced, at each offset of a block.
+		const char32_t invalid[] = { 0xD800, 0xDFFF, 0x110000, 0xFFFFFFFF };
+		for(const char32_t value : invalid)
+		{
+			for(u64 offset = 0; offset < 20; ++offset)
+			{
+				std::vector<char32_t> source(20, U'你');
+				source[offset] = value;
+				std::string expected;
+				for(u64 i = 0; i < source.size(); ++i)
+					expected += i == offset ? "�" : "你";
+				std::string encoded(simd::count_utf8_of_utf32(source.data(), source.size()), '\0');
+				EXPECT_EQ(encoded.size(), expected.size());
+				encoded.resize(simd::utf32_to_utf8(source.data(), source.size(), encoded.data()));
+				EXPECT_EQ(encoded, expected);
+			}
+		}
+
+		// Ill-formed utf-8 is decoded like utf8_to_utf16 does.
+		const char ill_formed[] = "ab\xE4\xB8" "c\xF0\x9F\x98" "d\x80\x80" "\xC0\xAF" "e\xE0\x80\x80" "\xE4\xBD\xA0";
+		const std::u32string expected = U"ab\xFFFD" U"c\xFFFD" U"d\xFFFD" U"e\xFFFD" U"你";
+		for(u64 offset = 0; offset < 40; ++offset)
+		{
+			std::string data(offset, 'x');
+			data += ill_formed;
+			for(u64 i = 0; i < 10; ++i)
+				data += "\xE4\xBD\xA0";
+			std::u32string decoded(simd::count_codepoints(data.data(), data.size()), U'\0');
+			decoded.resize(simd::utf8_to_utf32(data.data(), data.size(), decoded.data()));
+			EXPECT_EQ(decoded, std::u32string(offset, U'x') + expected + std::u32string(10, U'你'));
+		}
+	});
+}
+
+namespace
+{
+	std::vector<byte> make_random_bytes(const u64 size, const u32 seed)
+	{
+		std::mt19937 random{ seed };
+		std::vector<byte> bytes(size);
+		for(byte& b : bytes)
+			b = static_cast<byte>(random());
+		return bytes;
+	}
+
+	std::string hex_encode_naive(const std::vector<byte>& bytes, const u64 size, const bool uppercase, const char separator)
+	{
+		const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+		std::string result;
+		for(u64 i = 0; i < size; ++i)
+		{
+			if(i > 0 && separator != '\0')
+				result += separator;
+			result += digits[bytes[i] >> 4];
+			result += digits[bytes[i] & 0xF];
+		}
+		return result;
+	}
+
+	std::string base64_encode_naive(const std::vector<byte>& bytes, const u64 size, const simd::base64_alphabet alphabet, const bool padding)
+	{
+		const std::string digits = std::string{ "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789" }
+			+ (alphabet == simd::base64_alphabet::url ? "-_" : "+/");
+		std::string result;
+		u32 bits = 0;
+		u64 bit_count = 0;
+		for(u64 i = 0; i < size; ++i)
+		{
+			bits = bits << 8 | bytes[i];
+			bit_count += 8;
+			while(bit_count >= 6)
+			{
+				bit_count -= 6;
+				result += digits[bits >> bit_count & 0x3F];
+			}
+		}
+		if(bit_count > 0)
+			result += digits[bits << (6 - bit_count) & 0x3F];
+		while(padding && result.size() % 4 != 0)
+			result += '=';
+		return result;
+	}
+}
+
+TEST(simd, hex)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		const std::vector<byte> bytes = make_random_bytes(300, 7);
+		const u64 sizes[] = { 0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 300 };
+		for(const u64 size : sizes)
+		{
+			for(const char separator : { '\0', ' ', ':' })
+			{
+				for(const bool uppercase : { false, true })
+				{
+					const std::string expected = hex_encode_naive(bytes, size, uppercase, separator);
+					std::string encoded(expected.size(), '\0');
+					EXPECT_EQ(simd::hex_encode(bytes.data(), size, encoded.data(), uppercase, separator), expected.size());
+					EXPECT_EQ(encoded, expected);
+
+					std::vector<byte> decoded(size);
+					EXPECT_EQ(simd::hex_decode(encoded.data(), encoded.size(), decoded.data(), separator), size);
+					EXPECT_EQ(decoded, std::vector<byte>(bytes.begin(), bytes.begin() + static_cast<i64>(size)));
+				}
+			}
+		}
+
+		// Invalid codeunits and separators are found at each offset of a block.
+		const std::string valid = hex_encode_naive(bytes, 40, false, '\0');
+		const std::string separated = hex_encode_naive(bytes, 40, true, '-');
+		std::vector<byte> decoded(40);
+		for(u64 offset = 0; offset < valid.size(); ++offset)
+		{
+			for(const char invalid : { 'g', 'G', '/', ':', '@', '`', ' ', '\x80', '\xFF' })
+			{
+				std::string data = valid;
+				data[offset] = invalid;
+				EXPECT_EQ(simd::hex_decode(data.data(), data.size(), decoded.data(), '\0'), global_constant::INDEX_INVALID) << offset;
+			}
+		}
+		for(u64 offset = 0; offset < separated.size(); ++offset)
+		{
+			std::string data = separated;
+			data[offset] = offset % 3 == 2 ? ' ' : 'x';
+			EXPECT_EQ(simd::hex_decode(data.data(), data.size(), decoded.data(), '-'), global_constant::INDEX_INVALID) << offset;
+		}
+		EXPECT_EQ(simd::hex_decode("abc", 3, decoded.data(), '\0'), global_constant::INDEX_INVALID);
+		EXPECT_EQ(simd::hex_decode("ab-", 3, decoded.data(), '-'), global_constant::INDEX_INVALID);
+		EXPECT_EQ(simd::hex_decode("aB-Cd", 5, decoded.data(), '-'), 2);
+		EXPECT_EQ(decoded[0], 0xAB);
+		EXPECT_EQ(decoded[1], 0xCD);
+	});
+}
+
+TEST(simd, base64)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	for_each_instruction_set([]
+	{
+		const std::vector<byte> bytes = make_random_bytes(300, 11);
+		const u64 sizes[] = { 0, 1, 2, 3, 4, 5, 23, 24, 25, 27, 28, 29, 47, 48, 49, 100, 299, 300 };
+		for(const u64 size : sizes)
+		{
+			for(const simd::base64_alphabet alphabet : { simd::base64_alphabet::standard, simd::base64_alphabet::url })
+			{
+				for(const bool padding : { true, false })
+				{
+					const std::string expected = base64_encode_naive(bytes, size, alphabet, padding);
+					std::string encoded(expected.size(), '\0');
+					EXPECT_EQ(simd::base64_encode(bytes.data(), size, encoded.data(), alphabet, padding), expected.size());
+					EXPECT_EQ(encoded, expected);
+
+					std::vector<byte> decoded(encoded.size() / 4 * 3 + 2);
+					EXPECT_EQ(simd::base64_decode(encoded.data(), encoded.size(), decoded.data(), alphabet), size);
+					decoded.resize(size);
+					EXPECT_EQ(decoded, std::vector<byte>(bytes.begin(), bytes.begin() + static_cast<i64>(size)));
+				}
+			}
+		}
+
+		// Invalid codeunits are found at each offset of a block, including digits of the other alphabet.
+		const std::string valid = base64_encode_naive(bytes, 61, simd::base64_alphabet::standard, false);
+		std::vector<byte> decoded(valid.size());
+		for(u64 offset = 0; offset < valid.size(); ++offset)
+		{
+			for(const char invalid : { '-', '_', '=', '@', '[', '`', '{', '\0', '\x80', '\xFF' })
+			{
+				std::string data = valid;
+				data[offset] = invalid;
+				EXPECT_EQ(simd::base64_decode(data.data(), data.size(), decoded.data(), simd::base64_alphabet::standard), global_constant::INDEX_INVALID) << offset;
+			}
+		}
+		const std::string url = base64_encode_naive(bytes, 60, simd::base64_alphabet::url, false);
+		for(u64 offset = 0; offset < url.size(); ++offset)
+		{
+			std::string data = url;
+			data[offset] = offset % 2 ? '+' : '/';
+			EXPECT_EQ(simd::base64_decode(data.data(), data.size(), decoded.data(), simd::base64_alphabet::url), global_constant::INDEX_INVALID) << offset;
+		}
+
+		// Padding must complete a quantum.
+		const simd::base64_alphabet standard = simd::base64_alphabet::standard;
+		EXPECT_EQ(simd::base64_decode("QQ==", 4, decoded.data(), standard), 1);
+		EXPECT_EQ(simd::base64_decode("QUI=", 4, decoded.data(), standard), 2);
+		EXPECT_EQ(simd::base64_decode("QQ=", 3, decoded.data(), standard), global_constant::INDEX_INVALID);
+		EXPECT_EQ(simd::base64_decode("Q===", 4, decoded.data(), standard), global_constant::INDEX_INVALID);
+		EXPECT_EQ(simd::base64_decode("QUJDR", 5, decoded.data(), standard), global_constant::INDEX_INVALID);
+		EXPECT_EQ(simd::base64_decode("QQ==QQ==", 8, decoded.data(), standard), global_constant::INDEX_INVALID);
+	});
+}
@@ -1,6 +1,8 @@
 
 #include "pch.h"
 
+#include <algorithm>
+
 #include "text.h"
 
 using namespace ostr;
@@ -27,6 +29,23 @@ TEST(text, construct)
 		EXPECT_FALSE(t.is_empty());
 		EXPECT_EQ(t.size(), 8);
 	}
+	{
+		const text t = text::from_utf16(u"Hello 🌏! 你好, Grüße");
+		EXPECT_EQ(t, "Hello 🌏! 你好, Grüße");
+		EXPECT_EQ(t.size(), 18);
+		EXPECT_EQ(t.get_utf16_index(t.size()), 19);
+	}
+	{
+		// Lone surrogates are replaced.
+		const char16_t lone[] = { u'a', 0xD83C, u'b', 0xDF0F, 0 };
+		EXPECT_EQ(text::from_utf16(lone), "a\uFFFDb\uFFFD");
+		EXPECT_TRUE(text::from_utf16(u"").is_empty());
+	}
+	{
+		const char32_t invalid[] = { U'a', 0xD83C, U'😀', 0x110000, 0 };
+		EXPECT_EQ(text::from_utf32(invalid), "a\uFFFD😀\uFFFD");
+		EXPECT_TRUE(text::from_utf32(U"").is_empty());
+	}
 }
 
 TEST(text, concatenate)
@@ -199,3 +218,179 @@ TEST(text, trim)
 		EXPECT_EQ(t.self_trim("你 😙\t"_txtv), "好"_txtv);
 	}
 }
+
+TEST(text, compare)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const text a("你好");
+		const text b("你好，世界");
+		EXPECT_LT(a.compare(b.view()), 0);
+		EXPECT_EQ(a.compare("你好"_txtv), 0);
+		EXPECT_LT(a, b);
+		EXPECT_LE(a, "你好");
+		EXPECT_GT(b, "你");
+		EXPECT_GE(b, a);
+		EXPECT_LT("abc"_txtv, a);
+		EXPECT_GE("😀"_txtv, b);
+		EXPECT_LT("你好"_txtv.compare("😀"_txtv), 0);
+		EXPECT_LT("你好"_txtv, "你好啊");
+	}
+}
+
+TEST(text, random_access)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		// Long enough to build the codepoint index.
+		text t;
+		for(u64 i = 0; i < 200; ++i)
+			t.append("a你😀"_txtv);
+		EXPECT_EQ(t.size(), 600);
+		EXPECT_EQ(t.read_at(0), 'a'_cp);
+		EXPECT_EQ(t.read_at(301), U'你');
+		EXPECT_EQ(t[599], U'😀');
+		EXPECT_EQ(t.subview(299, 4), "😀a你😀"_txtv);
+		EXPECT_EQ(t.index_of("😀a"_txtv, 100), 101);
+		EXPECT_EQ(t.last_index_of("a你"_txtv), 597);
+		EXPECT_EQ(t.get_codeunit_index(3), 8);
+		EXPECT_EQ(t.get_codepoint_index(8), 3);
+		EXPECT_EQ(t.get_utf16_index(3), 4);
+		EXPECT_EQ(t.get_utf16_index(600), 800);
+		EXPECT_EQ(t.get_codepoint_index_from_utf16(4), 3);
+
+		// Mutations drop the index.
+		t.write_at(1, 'b'_cp);
+		EXPECT_EQ(t.read_at(1), 'b'_cp);
+		EXPECT_EQ(t.read_at(301), U'你');
+		EXPECT_EQ(t.get_codeunit_index(3), 6);
+		t.append("😙"_txtv);
+		EXPECT_EQ(t.size(), 601);
+		EXPECT_EQ(t[600], U'😙');
+		t.replace("x"_txtv, "😀"_txtv);
+		EXPECT_EQ(t.size(), 601);
+		EXPECT_EQ(t.raw().size(), 200 + 600 - 2 + 200 + 4);
+		EXPECT_EQ(t[599], 'x'_cp);
+		t.raw().append("yz"_cuqv);
+		EXPECT_EQ(t.size(), 603);
+		EXPECT_EQ(t[602], 'z'_cp);
+
+		text copied = t;
+		EXPECT_EQ(copied.size(), 603);
+		text moved = std::move(copied);
+		EXPECT_EQ(moved.size(), 603);
+		EXPECT_EQ(moved[2], 'x'_cp);
+		moved = t.subview(0, 300);
+		EXPECT_EQ(moved.size(), 300);
+		moved.subtext(99, 3);
+		EXPECT_EQ(moved, "a你x"_txtv);
+	}
+	{
+		text t("你好😙😙你");
+		EXPECT_EQ(t.get_utf16_index(3), 4);
+		EXPECT_EQ(t.get_codepoint_index_from_utf16(5), 4);
+		t.subtext(1, 2);
+		EXPECT_EQ(t, "好😙"_txtv);
+	}
+}
+
+TEST(text, metadata)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const auto expect_metadata = [](const text& t)
+		{
+			const text_view v = t.view();
+			EXPECT_EQ(t.size(), v.size());
+			EXPECT_EQ(t.is_ascii(), std::all_of(v.raw().data(), v.raw().data() + v.raw().size(), [](const char c) { return static_cast<u8>(c) < 0x80; }));
+		};
+
+		text t;
+		expect_metadata(t);
+		t.append("hello world"_txtv);
+		EXPECT_TRUE(t.is_ascii());
+		expect_metadata(t);
+		EXPECT_EQ(t.get_codeunit_index(6), 6);
+		EXPECT_EQ(t.get_codeunit_index(100), 11);
+		EXPECT_EQ(t.get_utf16_index(6), 6);
+		EXPECT_EQ(t.get_codepoint_index_from_utf16(6), 6);
+		EXPECT_EQ(t.read_at(6), 'w'_cp);
+		EXPECT_EQ(t.subview(6, 3), "wor"_txtv);
+		EXPECT_EQ(t.index_of("o"_txtv, 5), 7);
+
+		t.append('!', 3);
+		expect_metadata(t);
+		t.write_at(5, U'你'_cp);
+		EXPECT_FALSE(t.is_ascii());
+		expect_metadata(t);
+		EXPECT_EQ(t.read_at(6), 'w'_cp);
+		t.write_at(5, ' '_cp);
+		EXPECT_TRUE(t.is_ascii());
+		expect_metadata(t);
+
+		t.append(text{ "😀" });
+		expect_metadata(t);
+		t.self_remove_suffix("😀"_txtv);
+		EXPECT_TRUE(t.is_ascii());
+		expect_metadata(t);
+		t.append("😀"_txtv);
+		t.replace("o"_txtv, "😀"_txtv);
+		EXPECT_TRUE(t.is_ascii());
+		expect_metadata(t);
+		t.replace("😙😙"_txtv, "o"_txtv);
+		expect_metadata(t);
+		t.reverse(2, 5);
+		expect_metadata(t);
+		EXPECT_EQ(t, "he 😙😙llw😙😙rld!!!😙😙"_txtv);
+		t.self_trim_start("he "_txtv);
+		expect_metadata(t);
+		t.self_trim_end("😙!"_txtv);
+		expect_metadata(t);
+		t.subtext(1, 3);
+		EXPECT_EQ(t, "😙ll"_txtv);
+		expect_metadata(t);
+		*t.begin() = 'w';
+		EXPECT_EQ(t, "wll"_txtv);
+		EXPECT_TRUE(t.is_ascii());
+		expect_metadata(t);
+		t.raw().append("你"_cuqv);
+		expect_metadata(t);
+		t.empty();
+		expect_metadata(t);
+
+		const text from_raw{ "a你好"_cuqv };
+		expect_metadata(from_raw);
+		text copied = from_raw;
+		expect_metadata(copied);
+		const text moved = std::move(copied);
+		expect_metadata(moved);
+	}
+}
+
+TEST(text, from_untrusted_utf8)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		const std::optional<text> valid = text::from_utf8_checked("a你😀é"_cuqv);
+		ASSERT_TRUE(valid.has_value());
+		EXPECT_EQ(*valid, "a你😀é"_txtv);
+		EXPECT_EQ(valid->size(), 4);
+		EXPECT_FALSE(valid->is_ascii());
+		const std::optional<text> ascii = text::from_utf8_checked("hello"_cuqv);
+		ASSERT_TRUE(ascii.has_value());
+		EXPECT_TRUE(ascii->is_ascii());
+		EXPECT_EQ(ascii->size(), 5);
+		EXPECT_FALSE(text::from_utf8_checked("a\xC0\x80"_cuqv).has_value());
+		EXPECT_FALSE(text::from_utf8_checked("abc\xE4\xBD"_cuqv).has_value());
+	}
+	{
+		EXPECT_EQ(text::from_utf8_repaired("a你😀é"_cuqv), "a你😀é"_txtv);
+		EXPECT_EQ(text::from_utf8_repaired(""_cuqv), ""_txtv);
+		// Each maximal subpart is replaced by a single U+FFFD.
+		const text repaired = text::from_utf8_repaired("a\xC0\x80" "b\xE0\x80" "c\xF0\x9F\x98" "d\xED\xA0\x80" "e\xE4\xBD"_cuqv);
+		EXPECT_EQ(repaired, "a��b��c�d���e�"_txtv);
+		EXPECT_EQ(repaired.size(), repaired.view().size());
+		EXPECT_TRUE(repaired.view().is_valid());
+		EXPECT_FALSE(repaired.is_ascii());
+	}
+}
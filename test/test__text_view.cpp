@@ -156,3 +156,63 @@ TEST(text_view, starts_ends_with)
 		EXPECT_TRUE(view.ends_with(""_txtv));
 	}
 }
+
+TEST(text_view, index_conversion)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		constexpr auto view = "a你😀é"_txtv;
+		static_assert(view.size() == 4);
+		static_assert(view.get_codeunit_index(2) == 4);
+		static_assert(view.get_codepoint_index(5) == 3);
+		static_assert(view.get_utf16_index(3) == 4);
+		static_assert(view.get_codepoint_index_from_utf16(3) == 3);
+		EXPECT_EQ(view.size(), 4);
+		EXPECT_EQ(view.get_codeunit_index(0), 0);
+		EXPECT_EQ(view.get_codeunit_index(2), 4);
+		EXPECT_EQ(view.get_codeunit_index(4), 10);
+		EXPECT_EQ(view.get_codeunit_index(100), 10);
+		EXPECT_EQ(view.get_codepoint_index(2), 2);
+		EXPECT_EQ(view.get_codepoint_index(5), 3);
+		EXPECT_EQ(view.get_codepoint_index(100), 4);
+		EXPECT_EQ(view.get_utf16_index(3), 4);
+		EXPECT_EQ(view.get_utf16_index(4), 5);
+		EXPECT_EQ(view.get_codepoint_index_from_utf16(3), 3);
+		EXPECT_EQ(view.get_codepoint_index_from_utf16(4), 3);
+	}
+	{
+		// Longer than vector blocks.
+		text_view view = "😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀 and some ascii after them"_txtv;
+		EXPECT_EQ(view.size(), 46);
+		EXPECT_EQ(view.get_codeunit_index(21), 81);
+		EXPECT_EQ(view.read_at(21), 'a'_cp);
+		EXPECT_EQ(view.get_utf16_index(21), 41);
+		EXPECT_EQ(view.subview(19, 5), "😀 and"_txtv);
+	}
+}
+
+TEST(text_view, validate)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		static_assert("a你😀é"_txtv.is_valid());
+		static_assert(text_view{ "a\xC0\x80" }.first_invalid_offset() == 1);
+		EXPECT_TRUE("a你😀é"_txtv.is_valid());
+		EXPECT_TRUE(text_view{ }.is_valid());
+		// Overlong, surrogate, beyond U+10FFFF, stray continuation and truncated sequences.
+		EXPECT_EQ(text_view{ "a\xC0\x80" }.first_invalid_offset(), 1);
+		EXPECT_EQ(text_view{ "ab\xE0\x9F\xBF" }.first_invalid_offset(), 2);
+		EXPECT_EQ(text_view{ "你\xED\xA0\x80" }.first_invalid_offset(), 3);
+		EXPECT_EQ(text_view{ "\xF4\x90\x80\x80" }.first_invalid_offset(), 0);
+		EXPECT_EQ(text_view{ "😀\x80" }.first_invalid_offset(), 4);
+		EXPECT_EQ(text_view{ "abc\xE4\xBD" }.first_invalid_offset(), 3);
+		EXPECT_FALSE(text_view{ "\xFF" }.is_valid());
+	}
+	{
+		// Longer than vector blocks.
+		const text_view valid = "😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀😀 and some ascii after them, 你好"_txtv;
+		EXPECT_TRUE(valid.is_valid());
+		const text_view truncated = valid.raw().subview(0, valid.raw().size() - 1);
+		EXPECT_EQ(truncated.first_invalid_offset(), valid.raw().size() - 3);
+	}
+}
@@ -0,0 +1,142 @@
+// ReSharper disable StringLiteralTypo
+#include "pch.h"
+
+#include "common/simd.h"
+#include "text.h"
+#include "utf8_decoder.h"
+
+using namespace ostr;
+
+namespace
+{
+	// Well-formed codepoints of every length, and ill-formed sequences of every kind.
+	std::string make_chunked_input()
+	{
+		std::string data;
+		for(u64 i = 0; i < 20; ++i)
+		{
+			data += "a你😀\xC3\xA9";
+			if(i % 3 == 0)
+				data += "\x80" "b\xE4\xB8" "c\xF0\x9F\x98" "\xED\xA0\x80" "\xC0\xAF";
+		}
+		return data + "\xF0\x9F";
+	}
+}
+
+TEST(utf8_decoder, runs)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	{
+		utf8_decoder decoder;
+		const char* data = "ab你";
+		codeunit_sequence_view chunk{ data };
+		text_view run;
+		EXPECT_TRUE(decoder.next(chunk, run));
+		// The whole chunk is handed back without copy.
+		EXPECT_EQ(run.raw().data(), data);
+		EXPECT_EQ(run, "ab你");
+		EXPECT_FALSE(decoder.next(chunk, run));
+		EXPECT_FALSE(decoder.is_pending());
+		EXPECT_FALSE(decoder.finish(run));
+	}
+	{
+		// 😀 is split into three chunks.
+		utf8_decoder decoder;
+		text_view run;
+		codeunit_sequence_view chunk{ "a\xF0" };
+		EXPECT_TRUE(decoder.next(chunk, run));
+		EXPECT_EQ(run, "a");
+		EXPECT_FALSE(decoder.next(chunk, run));
+		EXPECT_TRUE(decoder.is_pending());
+		chunk = codeunit_sequence_view{ "\x9F\x98" };
+		EXPECT_FALSE(decoder.next(chunk, run));
+		EXPECT_TRUE(decoder.is_pending());
+		chunk = codeunit_sequence_view{ "\x80z" };
+		EXPECT_TRUE(decoder.next(chunk, run));
+		EXPECT_EQ(run, "😀");
+		EXPECT_TRUE(decoder.next(chunk, run));
+		EXPECT_EQ(run, "z");
+		EXPECT_FALSE(decoder.next(chunk, run));
+	}
+	{
+		// A kept sequence turns out to be ill-formed, and the codeunit breaking it starts the next run.
+		utf8_decoder decoder;
+		text_view run;
+		codeunit_sequence_view chunk{ "\xE4\xB8" };
+		EXPECT_FALSE(decoder.next(chunk, run));
+		chunk = codeunit_sequence_view{ "b" };
+		EXPECT_TRUE(decoder.next(chunk, run));
+		EXPECT_EQ(run, "�");
+		EXPECT_TRUE(decoder.next(chunk, run));
+		EXPECT_EQ(run, "b");
+	}
+	{
+		// The input ends in an incomplete sequence.
+		utf8_decoder decoder;
+		text_view run;
+		codeunit_sequence_view chunk{ "\xE4\xB8" };
+		EXPECT_FALSE(decoder.next(chunk, run));
+		EXPECT_TRUE(decoder.finish(run));
+		EXPECT_EQ(run, "�");
+		EXPECT_FALSE(decoder.is_pending());
+		EXPECT_FALSE(decoder.finish(run));
+	}
+}
+
+TEST(utf8_decoder, chunked)
+{
+	SCOPED_DETECT_MEMORY_LEAK()
+	const std::string data = make_chunked_input();
+	const codeunit_sequence_view input{ data.data(), data.size() };
+	const text expected = text::from_utf8_repaired(input);
+	const codeunit_sequence_view expected_raw = expected.view().raw();
+	std::vector<char16_t> expected_utf16(simd::count_utf16(expected_raw.data(), expected_raw.size()));
+	expected_utf16.resize(simd::utf8_to_utf16(expected_raw.data(), expected_raw.size(), expected_utf16.data()));
+	std::vector<char32_t> expected_utf32;
+	for(const codepoint cp : expected.view())
+		expected_utf32.push_back(cp.get_codepoint());
+
+	// Every chunk size splits sequences at every position.
+	for(u64 chunk_size = 1; chunk_size <= 9; ++chunk_size)
+	{
+		utf8_decoder utf8;
+		utf8_decoder utf16;
+		utf8_decoder utf32;
+		utf8_decoder codepoints;
+		codeunit_sequence decoded;
+		std::vector<char16_t> decoded_utf16;
+		std::vector<char32_t> decoded_utf32;
+		std::vector<char32_t> decoded_codepoints;
+		for(u64 offset = 0; offset < input.size(); offset += chunk_size)
+		{
+			const codeunit_sequence_view chunk = input.subview(offset, chunk_size);
+			utf8.decode(chunk, decoded);
+
+			const u64 utf16_size = decoded_utf16.size();
+			decoded_utf16.resize(utf16_size + utf8_decoder::get_maximum_decoded_size(chunk.size()));
+			decoded_utf16.resize(utf16_size + utf16.decode(chunk, decoded_utf16.data() + utf16_size));
+
+			const u64 utf32_size = decoded_utf32.size();
+			decoded_utf32.resize(utf32_size + utf8_decoder::get_maximum_decoded_size(chunk.size()));
+			decoded_utf32.resize(utf32_size + utf32.decode(chunk, decoded_utf32.data() + utf32_size));
+
+			codepoints.decode_codepoints(chunk, [&decoded_codepoints](const codepoint cp)
+			{
+				decoded_codepoints.push_back(cp.get_codepoint());
+			});
+		}
+		utf8.finish(decoded);
+		decoded_utf16.resize(decoded_utf16.size() + 1);
+		decoded_utf16.resize(decoded_utf16.size() - 1 + utf16.finish(&decoded_utf16.back()));
+		decoded_utf32.resize(decoded_utf32.size() + 1);
+		decoded_utf32.resize(decoded_utf32.size() - 1 + utf32.finish(&decoded_utf32.back()));
+		if(text_view run; codepoints.finish(run))
+			decoded_codepoints.push_back(run.read_at(0).get_codepoint());
+
+		SCOPED_TRACE(chunk_size);
+		EXPECT_EQ(decoded, expected_raw);
+		EXPECT_EQ(decoded_utf16, expected_utf16);
+		EXPECT_EQ(decoded_utf32, expected_utf32);
+		EXPECT_EQ(decoded_codepoints, expected_utf32);
+	}
+}
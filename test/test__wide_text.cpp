@@ -26,4 +26,11 @@ TEST(wide_text, construct)
 #endif
 		}
 	}
+	{
+		// Ill-formed sequences are decoded as U+FFFD.
+		const wide_text wt{ "a\xF0\x9F\x98" "b 你好 😙"_cuqv };
+		codeunit_sequence decoded;
+		wt.decode(decoded);
+		EXPECT_EQ(decoded, "a\uFFFD" "b 你好 😙"_cuqv);
+	}
 }
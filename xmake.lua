@@ -11,6 +11,9 @@ target("OpenString")
     set_kind("static")
     add_includedirs("include")
     add_files("source/*.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread", {public = true})
+    end
 target_end()
 
 target("test")
@@ -21,6 +24,15 @@ target("test")
     add_deps("OpenString")
 target_end()
 
+-- Replaces the global operator new to count allocations, so it is kept apart from the other tests.
+target("test_allocation")
+    set_kind("binary")
+    add_packages("gtest")
+    add_includedirs("include", "test")
+    add_files("test/main.cpp", "test/allocation/*.cpp")
+    add_deps("OpenString")
+target_end()
+
 -- target("benchmark")
 --     set_kind("binary")
 --     add_cxflags(cxflags, {force = true})